@@ -13,6 +13,8 @@
 #include "../../InputSource/LibUVCEngine.h"
 #include "../../InputSource/RealSenseEngine.h"
 #include "../../InputSource/FFMPEGReader.h"
+#include "../../InputSource/PackedSequenceReader.h"
+#include "../../InputSource/PrefetchingImageSourceEngine.h"
 #include "../../ITMLib/ITMLibDefines.h"
 #include "../../ITMLib/Core/ITMBasicEngine.h"
 #include "../../ITMLib/Core/ITMBasicSurfelEngine.h"
@@ -66,6 +68,18 @@ static void CreateDefaultImageSource(ImageSourceEngine* & imageSource, IMUSource
 			imuSource = NULL;
 			imageSource = NULL;
 		}
+		else imageSource = new PrefetchingImageSourceEngine(imageSource);
+	}
+
+	if ((imageSource == NULL) && (filename1 != NULL) && (filename2 == NULL) && (filename_imu == NULL))
+	{
+		imageSource = new PackedSequenceReader(calibFile, filename1);
+		if (imageSource->getDepthImageSize().x == 0)
+		{
+			delete imageSource;
+			imageSource = NULL;
+		}
+		else printf("using packed sequence: %s\n", filename1);
 	}
 
 	if ((imageSource == NULL) && (filename1 != NULL) && (filename_imu == NULL))
@@ -76,6 +90,7 @@ static void CreateDefaultImageSource(ImageSourceEngine* & imageSource, IMUSource
 			delete imageSource;
 			imageSource = NULL;
 		}
+		else imageSource = new PrefetchingImageSourceEngine(imageSource);
 	}
 
 	if (imageSource == NULL)
@@ -161,7 +176,7 @@ try
 	if (arg == 1) {
 		printf("usage: %s [<calibfile> [<imagesource>] ]\n"
 		       "  <calibfile>   : path to a file containing intrinsic calibration parameters\n"
-		       "  <imagesource> : either one argument to specify OpenNI device ID\n"
+		       "  <imagesource> : either one argument to specify OpenNI device ID or a packed sequence\n"
 		       "                  or two arguments specifying rgb and depth file masks\n"
 		       "\n"
 		       "examples:\n"
@@ -206,6 +206,19 @@ void UIEngine::glutKeyUpFunction(unsigned char key, int x, int y)
 			uiEngine->depthVideoWriter = new FFMPEGWriter();
 		}
 		break;
+	case 'p':
+		if (uiEngine->sequenceWriter != NULL)
+		{
+			printf("stop recording packed sequence\n");
+			delete uiEngine->sequenceWriter;
+			uiEngine->sequenceWriter = NULL;
+		}
+		else
+		{
+			printf("start recording packed sequence\n");
+			uiEngine->sequenceWriter = new PackedSequenceWriter();
+		}
+		break;
 	case 'e':
 	case 27: // esc key
 		printf("exiting ...\n");
@@ -538,6 +551,7 @@ void UIEngine::Initialise(int & argc, char** argv, ImageSourceEngine *imageSourc
 	this->currentFrameNo = 0;
 	this->rgbVideoWriter = NULL;
 	this->depthVideoWriter = NULL;
+	this->sequenceWriter = NULL;
 
 	glutInit(&argc, argv);
 	glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE);
@@ -608,7 +622,13 @@ void UIEngine::GetScreenshot(ITMUChar4Image *dest) const
 
 void UIEngine::ProcessFrame()
 {
-	if (!imageSource->hasMoreImages()) return;
+	if (!imageSource->hasMoreImages())
+	{
+		// the last frame is still pending in pipelined mode
+		mainEngine->FlushPipeline();
+		return;
+	}
+
 	imageSource->getImages(inputRGBImage, inputRawDepthImage);
 
 	if (imuSource != NULL) {
@@ -636,6 +656,19 @@ void UIEngine::ProcessFrame()
 		if (!depthVideoWriter->isOpen()) depthVideoWriter->open("out_d.avi", inputRawDepthImage->noDims.x, inputRawDepthImage->noDims.y, true, 30);
 		depthVideoWriter->writeFrame(inputRawDepthImage);
 	}
+	if ((sequenceWriter != NULL) && (inputRawDepthImage->noDims.x != 0)) {
+		if (!sequenceWriter->isOpen()) {
+			char str[250];
+			sprintf(str, "%s/out.itmseq", outFolder);
+			if (!sequenceWriter->open(str, imageSource->getCalib(), inputRGBImage->noDims, inputRawDepthImage->noDims, imuSource != NULL, PACKED_SEQUENCE_ENCODING_RVL))
+			{
+				printf("error: could not open '%s' for recording, stopped recording\n", str);
+				delete sequenceWriter;
+				sequenceWriter = NULL;
+			}
+		}
+		if (sequenceWriter != NULL) sequenceWriter->writeFrame(inputRGBImage, inputRawDepthImage, imuSource != NULL ? inputIMUMeasurement : NULL);
+	}
 
 	sdkResetTimer(&timer_instant);
 	sdkStartTimer(&timer_instant); sdkStartTimer(&timer_average);
@@ -666,6 +699,7 @@ void UIEngine::Shutdown()
 
 	if (rgbVideoWriter != NULL) delete rgbVideoWriter;
 	if (depthVideoWriter != NULL) delete depthVideoWriter;
+	if (sequenceWriter != NULL) delete sequenceWriter;
 
 	for (int w = 0; w < NUM_WIN; w++)
 		delete outImage[w];
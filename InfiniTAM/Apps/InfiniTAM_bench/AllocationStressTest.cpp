@@ -0,0 +1,216 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "Benchmarks.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include "../../ITMLib/Utils/ITMLibSettings.h"
+#include "../../ITMLib/Engines/Reconstruction/ITMSceneReconstructionEngineFactory.h"
+#include "../../ITMLib/ITMLibDefines.h"
+#include "../../ITMLib/Objects/RenderStates/ITMRenderStateFactory.h"
+
+using namespace ITMLib;
+
+namespace
+{
+	typedef ITMScene<ITMVoxel, ITMVoxelIndex> Scene;
+
+	/** One configuration of the hash table and of the depth
+	    images that are allocated from it.
+	*/
+	struct StressCase
+	{
+		const char *name;
+		int noVoxelBlocks, noHashBuckets, noExcessListEntries;
+		bool allowHashGrowth;
+		/// Random depth everywhere rather than a smooth surface, so that far more blocks are requested than fit
+		bool randomDepth;
+	};
+
+	/** Checks that every voxel block and every excess list entry
+	    is either in use by exactly one hash entry or on its free
+	    list exactly once, that no block position is allocated
+	    twice and that the list of allocated entries matches the
+	    hash table. Prints the problems and returns their number.
+	*/
+	int CheckScene(Scene *scene, int frameNo)
+	{
+		ITMVoxelBlockHash &index = scene->index;
+		const ITMHashEntry *hashTable = index.GetEntries();
+		int noVoxelBlocks = index.getNumAllocatedVoxelBlocks();
+		int noHashBuckets = index.getNumHashBuckets();
+		int noExcessListEntries = index.getExcessListSize();
+		int noTotalEntries = index.noTotalEntries;
+		int noErrors = 0;
+
+		std::vector<int> blockUses(noVoxelBlocks, 0), excessUses(noExcessListEntries, 0), parents(noTotalEntries, 0);
+		int noEntriesInUse = 0;
+
+		for (int entryId = 0; entryId < noTotalEntries; entryId++)
+		{
+			const ITMHashEntry &entry = hashTable[entryId];
+			if (entry.offset > 0) parents[noHashBuckets + entry.offset - 1]++;
+			if (entry.ptr < -1) continue;
+
+			noEntriesInUse++;
+			if (entry.ptr >= 0) blockUses[entry.ptr]++;
+			if (entryId >= noHashBuckets) excessUses[entryId - noHashBuckets]++;
+		}
+
+		const int *voxelAllocationList = scene->localVBA.GetAllocationList();
+		for (int listIdx = 0; listIdx <= scene->localVBA.lastFreeBlockId; listIdx++) blockUses[voxelAllocationList[listIdx]]++;
+
+		const int *excessAllocationList = index.GetExcessAllocationList();
+		int lastFreeExcessListId = index.GetLastFreeExcessListId();
+		for (int listIdx = 0; listIdx <= lastFreeExcessListId; listIdx++) excessUses[excessAllocationList[listIdx]]++;
+
+		for (int blockId = 0; blockId < noVoxelBlocks; blockId++) if (blockUses[blockId] != 1)
+		{
+			if (noErrors++ < 10) printf("  frame %d: voxel block %d is used or free %d times\n", frameNo, blockId, blockUses[blockId]);
+		}
+
+		for (int excessId = 0; excessId < noExcessListEntries; excessId++)
+		{
+			if (excessUses[excessId] != 1 && noErrors++ < 10)
+				printf("  frame %d: excess list entry %d is used or free %d times\n", frameNo, excessId, excessUses[excessId]);
+			if (hashTable[noHashBuckets + excessId].ptr >= -1 && parents[noHashBuckets + excessId] != 1 && noErrors++ < 10)
+				printf("  frame %d: excess list entry %d is linked from %d entries\n", frameNo, excessId, parents[noHashBuckets + excessId]);
+		}
+
+		// a block position must only be found once along its bucket's chain
+		std::vector<int> chain;
+		for (int bucketId = 0; bucketId < noHashBuckets; bucketId++)
+		{
+			chain.clear();
+			for (int entryId = bucketId; (int)chain.size() <= noExcessListEntries; entryId = noHashBuckets + hashTable[entryId].offset - 1)
+			{
+				if (hashTable[entryId].ptr >= -1) chain.push_back(entryId);
+				if (hashTable[entryId].offset <= 0) break;
+			}
+
+			for (size_t i = 0; i < chain.size(); i++) for (size_t j = i + 1; j < chain.size(); j++)
+			{
+				const Vector3s &pos = hashTable[chain[i]].pos;
+				if (pos == hashTable[chain[j]].pos && noErrors++ < 10)
+					printf("  frame %d: block (%d, %d, %d) is allocated twice\n", frameNo, pos.x, pos.y, pos.z);
+			}
+		}
+
+		std::vector<int> listed(noTotalEntries, 0);
+		const int *allocatedEntryIDs = index.GetAllocatedEntryIDs();
+		for (int listIdx = 0; listIdx < index.GetNumAllocatedEntries(); listIdx++) listed[allocatedEntryIDs[listIdx]]++;
+		for (int entryId = 0; entryId < noTotalEntries; entryId++)
+		{
+			if (listed[entryId] != (hashTable[entryId].ptr >= -1 ? 1 : 0) && noErrors++ < 10)
+				printf("  frame %d: hash entry %d is in the list of allocated entries %d times\n", frameNo, entryId, listed[entryId]);
+		}
+		if (index.GetNumAllocatedEntries() != noEntriesInUse && noErrors++ < 10)
+			printf("  frame %d: %d entries are listed as allocated, but %d are in use\n", frameNo, index.GetNumAllocatedEntries(), noEntriesInUse);
+
+		return noErrors;
+	}
+
+	/** Depth in metres of the pixels of a frame: a wavy wall with a
+	    different phase in every frame, or random depths.
+	*/
+	void MakeDepth(ITMFloatImage *depth, int frameNo, bool randomDepth, unsigned int &seed)
+	{
+		Vector2i imgSize = depth->noDims;
+		float *depthData = depth->GetData(MEMORYDEVICE_CPU);
+
+		for (int y = 0; y < imgSize.y; y++) for (int x = 0; x < imgSize.x; x++)
+		{
+			float d;
+			if (randomDepth)
+			{
+				seed = seed * 1664525u + 1013904223u;
+				d = 0.3f + 3.7f * (float)(seed >> 8) / (float)(1u << 24);
+			}
+			else d = 1.5f + 0.5f * sinf(0.05f * x + 0.3f * frameNo) * cosf(0.04f * y - 0.2f * frameNo);
+			depthData[x + y * imgSize.x] = d;
+		}
+	}
+
+	int RunStressCase(const StressCase &stressCase, int noFrames)
+	{
+		ITMSceneParams sceneParams(0.02f, 100, 0.005f, 0.2f, 5.0f, false,
+			stressCase.noVoxelBlocks, stressCase.noHashBuckets, stressCase.noExcessListEntries, stressCase.allowHashGrowth);
+
+		Vector2i imgSize(320, 240);
+		ITMRGBDCalib calib;
+		calib.intrinsics_d.SetFrom(290.0f, 290.0f, 160.0f, 120.0f);
+		calib.intrinsics_rgb = calib.intrinsics_d;
+
+		Scene *scene = new Scene(&sceneParams, false, MEMORYDEVICE_CPU);
+		ITMSceneReconstructionEngine<ITMVoxel, ITMVoxelIndex> *sceneRecoEngine =
+			ITMSceneReconstructionEngineFactory::MakeSceneReconstructionEngine<ITMVoxel, ITMVoxelIndex>(ITMLibSettings::DEVICE_CPU);
+		ITMView *view = new ITMView(calib, imgSize, imgSize, false);
+		ITMTrackingState *trackingState = new ITMTrackingState(imgSize, MEMORYDEVICE_CPU);
+		ITMRenderState *renderState = ITMRenderStateFactory<ITMVoxelIndex>::CreateRenderState(imgSize, &sceneParams, MEMORYDEVICE_CPU);
+
+		sceneRecoEngine->ResetScene(scene);
+
+		unsigned int seed = 1;
+		int noErrors = CheckScene(scene, -1);
+		for (int frameNo = 0; frameNo < noFrames && noErrors == 0; frameNo++)
+		{
+			MakeDepth(view->depth, frameNo, stressCase.randomDepth, seed);
+
+			// keep turning and moving, so that every frame asks for new blocks
+			trackingState->pose_d->SetFrom(0.05f * frameNo, 0.0f, 0.02f * frameNo, 0.0f, 0.1f * frameNo, 0.0f);
+
+			sceneRecoEngine->AllocateSceneFromDepth(scene, view, trackingState, renderState);
+			noErrors += CheckScene(scene, frameNo);
+		}
+
+		int noUsedBlocks = scene->index.getNumAllocatedVoxelBlocks() - scene->localVBA.lastFreeBlockId - 1;
+		printf("%-10s: %s, %d of %d voxel blocks and %d of %d excess list entries in use\n", stressCase.name, noErrors == 0 ? "passed" : "FAILED",
+			noUsedBlocks, scene->index.getNumAllocatedVoxelBlocks(), scene->index.getExcessListSize() - scene->index.GetLastFreeExcessListId() - 1,
+			scene->index.getExcessListSize());
+
+		delete renderState;
+		delete trackingState;
+		delete view;
+		delete sceneRecoEngine;
+		delete scene;
+
+		return noErrors;
+	}
+}
+
+int InfiniTAM::Benchmarks::RunAllocationStressTest(int argc, char **argv)
+{
+#ifndef WITH_OPENMP
+	// a serial run has no contention to stress, so report the test as skipped rather than passed
+	fprintf(stderr, "allocation-stress SKIPPED: the allocation only runs in parallel when built with WITH_OPENMP\n");
+	return ALLOCATION_STRESS_TEST_SKIPPED;
+#endif
+
+	int noFrames = argc > 0 ? atoi(argv[0]) : 20;
+
+#ifdef WITH_OPENMP
+	// more threads than cores, so that they also fight over the free lists on small machines
+	omp_set_num_threads(MAX(omp_get_num_procs() * 4, 16));
+	printf("allocating with %d threads\n", omp_get_max_threads());
+#endif
+
+	// few buckets, so that many blocks go into the excess list
+	const StressCase stressCases[] = {
+		{ "fits", 0x20000, 0x400, 0x8000, false, false },
+		{ "overflow", 0x1000, 0x4000, 0x800, false, true },
+		{ "growth", 0x1000, 0x400, 0x100, true, false }
+	};
+
+	int noFailedCases = 0;
+	for (size_t caseId = 0; caseId < sizeof(stressCases) / sizeof(stressCases[0]); caseId++)
+		if (RunStressCase(stressCases[caseId], noFrames) != 0) noFailedCases++;
+
+	return noFailedCases == 0 ? 0 : 1;
+}
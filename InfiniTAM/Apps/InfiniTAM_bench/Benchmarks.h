@@ -0,0 +1,38 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+namespace InfiniTAM
+{
+	namespace Benchmarks
+	{
+		/// Exit code of a skipped test, as registered with CTest.
+		const int ALLOCATION_STRESS_TEST_SKIPPED = 77;
+
+		/** Allocates voxel blocks from many threads over several
+		    frames, with hash tables that fit, overflow and grow, and
+		    checks after every frame that no voxel block or excess
+		    list entry leaked or was handed out twice. The optional
+		    argument is the number of frames. Returns 0 on success,
+		    and ALLOCATION_STRESS_TEST_SKIPPED without WITH_OPENMP,
+		    as a serial build has no contention to test.
+		*/
+		int RunAllocationStressTest(int argc, char **argv);
+
+		/** Times the scalar and each vectorised depth integration
+		    the CPU supports for ITMVoxel_s, ITMVoxel_f and
+		    ITMVoxel_s_rgb, and counts the voxels on which they
+		    disagree. The optional argument is the number of frames.
+		*/
+		int RunIntegrationBenchmark(int argc, char **argv);
+
+		/** Fuses a synthetic scene along its ground truth poses and
+		    times ray casting full frames from it, within the ranges
+		    of the visible blocks and within the whole view frustum,
+		    each with and without skipping the voxel blocks that
+		    hold no surface. The optional arguments are the name of
+		    the scene and the number of frames.
+		*/
+		int RunRaycastBenchmark(int argc, char **argv);
+	}
+}
@@ -0,0 +1,36 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <stdio.h>
+#include <string.h>
+
+#include "Benchmarks.h"
+
+using namespace InfiniTAM::Benchmarks;
+
+int main(int argc, char** argv)
+try
+{
+	if (argc >= 2 && strcmp(argv[1], "allocation-stress") == 0) return RunAllocationStressTest(argc - 2, argv + 2);
+	if (argc >= 2 && strcmp(argv[1], "integration") == 0) return RunIntegrationBenchmark(argc - 2, argv + 2);
+	if (argc >= 2 && strcmp(argv[1], "raycast") == 0) return RunRaycastBenchmark(argc - 2, argv + 2);
+
+	printf("usage: %s <benchmark> [<arguments>]\n"
+	       "benchmarks and tests:\n"
+	       "  allocation-stress [<frames>]        : allocate voxel blocks from many threads and check that none\n"
+	       "                                        leak or are allocated twice, 20 frames by default; needs a\n"
+	       "                                        build with WITH_OPENMP\n"
+	       "  integration [<frames>]              : time the scalar and vectorised depth integration of each\n"
+	       "                                        voxel type and compare their results, 10 frames by default\n"
+	       "  raycast [<scene> [<frames>]]        : time ray casting a fused synthetic scene (room, corridor or\n"
+	       "                                        clutter) with and without skipping empty voxel blocks,\n"
+	       "                                        corridor and 200 frames by default\n", argv[0]);
+	return EXIT_FAILURE;
+}
+catch(std::exception& e)
+{
+	std::cerr << e.what() << '\n';
+	return EXIT_FAILURE;
+}
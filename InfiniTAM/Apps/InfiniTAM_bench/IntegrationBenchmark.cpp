@@ -0,0 +1,223 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "../../ITMLib/Engines/Reconstruction/CPU/ITMVoxelBlockIntegration_CPU.h"
+#include "../../ITMLib/Engines/Reconstruction/Shared/ITMSceneReconstructionEngine_Shared.h"
+#include "../../ORUtils/NVTimer.h"
+
+using namespace ITMLib;
+
+namespace
+{
+	/** A depth and colour image of a wavy wall and the voxel
+	    blocks around its surface, as they would be visible in a
+	    frame of the reconstruction.
+	*/
+	struct IntegrationInput
+	{
+		Vector2i imgSize;
+		std::vector<float> depth;
+		std::vector<Vector4u> rgb;
+
+		Matrix4f M_d;
+		Vector4f projParams_d;
+		float voxelSize, mu;
+		int maxW;
+
+		std::vector<Vector3i> blockPositions;
+	};
+
+	void MakeIntegrationInput(IntegrationInput &input)
+	{
+		input.imgSize = Vector2i(640, 480);
+		input.projParams_d = Vector4f(580.0f, 580.0f, 320.0f, 240.0f);
+		input.M_d.setIdentity();
+		input.voxelSize = 0.005f; input.mu = 0.02f; input.maxW = 100;
+
+		int noPixels = input.imgSize.x * input.imgSize.y;
+		input.depth.resize(noPixels);
+		input.rgb.resize(noPixels);
+		for (int y = 0; y < input.imgSize.y; y++) for (int x = 0; x < input.imgSize.x; x++)
+		{
+			int locId = x + y * input.imgSize.x;
+			input.depth[locId] = 1.5f + 0.2f * sinf(0.02f * x) * cosf(0.03f * y);
+			input.rgb[locId] = Vector4u((uchar)x, (uchar)y, (uchar)(x + y), 255);
+		}
+
+		// the blocks within mu of the surface, found as the allocation does
+		float blockSize = input.voxelSize * SDF_BLOCK_SIZE;
+		std::vector<Vector3i> &blockPositions = input.blockPositions;
+		for (int y = 0; y < input.imgSize.y; y += 2) for (int x = 0; x < input.imgSize.x; x += 2)
+		{
+			float depth = input.depth[x + y * input.imgSize.x];
+			for (float d = depth - input.mu; d <= depth + input.mu; d += 0.5f * blockSize)
+			{
+				Vector3f pt((x - input.projParams_d.z) * d / input.projParams_d.x, (y - input.projParams_d.w) * d / input.projParams_d.y, d);
+				blockPositions.push_back(Vector3i((int)floorf(pt.x / blockSize), (int)floorf(pt.y / blockSize), (int)floorf(pt.z / blockSize)));
+			}
+		}
+
+		struct LessBlockPos
+		{
+			bool operator()(const Vector3i &a, const Vector3i &b) const
+			{
+				if (a.z != b.z) return a.z < b.z;
+				if (a.y != b.y) return a.y < b.y;
+				return a.x < b.x;
+			}
+		};
+		std::sort(blockPositions.begin(), blockPositions.end(), LessBlockPos());
+		blockPositions.erase(std::unique(blockPositions.begin(), blockPositions.end()), blockPositions.end());
+	}
+
+	/** Fuses the input into all blocks @p noFrames times, as
+	    ITMSceneReconstructionEngine_CPU::IntegrateIntoScene() does,
+	    with the given vectorised depth update or, if it is NULL,
+	    the scalar one. Returns the time per frame in ms.
+	*/
+	template<class TVoxel>
+	float IntegrateBlocks(std::vector<TVoxel> &voxels, const IntegrationInput &input, int noFrames,
+		typename ITMVoxelBlockIntegrator<TVoxel>::IntegrateFunction integrateVoxelBlockDepth)
+	{
+		int noBlocks = (int)input.blockPositions.size();
+		voxels.assign(noBlocks * SDF_BLOCK_SIZE3, TVoxel());
+
+		ITMVoxelBlockIntegrationParams integrationParams;
+		for (int i = 0; i < 16; i++) integrationParams.M_d[i] = input.M_d.m[i];
+		for (int i = 0; i < 4; i++) integrationParams.projParams_d[i] = input.projParams_d[i];
+		integrationParams.depthImgWidth = input.imgSize.x; integrationParams.depthImgHeight = input.imgSize.y;
+		integrationParams.depth = &input.depth[0];
+		integrationParams.voxelSize = input.voxelSize; integrationParams.mu = input.mu; integrationParams.maxW = input.maxW;
+		integrationParams.stopIntegratingAtMaxW = false;
+
+		// the colour camera is the depth camera
+		const Matrix4f &M_rgb = input.M_d;
+		const Vector4f &projParams_rgb = input.projParams_d;
+		const Vector4u *rgb = &input.rgb[0];
+
+		StopWatchInterface *timer;
+		sdkCreateTimer(&timer);
+		sdkStartTimer(&timer);
+
+		for (int frameNo = 0; frameNo < noFrames; frameNo++) for (int blockId = 0; blockId < noBlocks; blockId++)
+		{
+			Vector3i globalPos = input.blockPositions[blockId] * SDF_BLOCK_SIZE;
+			TVoxel *localVoxelBlock = &voxels[blockId * SDF_BLOCK_SIZE3];
+
+			if (integrateVoxelBlockDepth != NULL)
+			{
+				float eta[SDF_BLOCK_SIZE3];
+				integrateVoxelBlockDepth(localVoxelBlock, globalPos.x, globalPos.y, globalPos.z, integrationParams, eta);
+
+				if (TVoxel::hasColorInformation) for (int locId = 0; locId < SDF_BLOCK_SIZE3; locId++)
+				{
+					Vector4f pt_model;
+
+					pt_model.x = (float)(globalPos.x + locId % SDF_BLOCK_SIZE) * input.voxelSize;
+					pt_model.y = (float)(globalPos.y + (locId / SDF_BLOCK_SIZE) % SDF_BLOCK_SIZE) * input.voxelSize;
+					pt_model.z = (float)(globalPos.z + locId / (SDF_BLOCK_SIZE * SDF_BLOCK_SIZE)) * input.voxelSize;
+					pt_model.w = 1.0f;
+
+					ComputeUpdatedVoxelColor<TVoxel::hasColorInformation, TVoxel>::compute(localVoxelBlock[locId], pt_model, M_rgb,
+						projParams_rgb, input.mu, input.maxW, eta[locId], rgb, input.imgSize);
+				}
+			}
+			else for (int z = 0; z < SDF_BLOCK_SIZE; z++) for (int y = 0; y < SDF_BLOCK_SIZE; y++) for (int x = 0; x < SDF_BLOCK_SIZE; x++)
+			{
+				int locId = x + y * SDF_BLOCK_SIZE + z * SDF_BLOCK_SIZE * SDF_BLOCK_SIZE;
+
+				Vector4f pt_model;
+				pt_model.x = (float)(globalPos.x + x) * input.voxelSize;
+				pt_model.y = (float)(globalPos.y + y) * input.voxelSize;
+				pt_model.z = (float)(globalPos.z + z) * input.voxelSize;
+				pt_model.w = 1.0f;
+
+				ComputeUpdatedVoxelInfo<TVoxel::hasColorInformation, TVoxel::hasConfidenceInformation, TVoxel>::compute(localVoxelBlock[locId], pt_model,
+					input.M_d, input.projParams_d, M_rgb, projParams_rgb, input.mu, input.maxW, &input.depth[0], NULL, input.imgSize, rgb, input.imgSize);
+			}
+		}
+
+		sdkStopTimer(&timer);
+		float time = sdkGetTimerValue(&timer) / noFrames;
+		sdkDeleteTimer(&timer);
+
+		return time;
+	}
+
+	/** Number of voxels whose depth weight or SDF value differs,
+	    allowing for a few steps of the short representation.
+	*/
+	template<class TVoxel>
+	int CountDifferentVoxels(const std::vector<TVoxel> &voxels, const std::vector<TVoxel> &reference)
+	{
+		const float tolerance = 1e-4f;
+
+		int noDifferentVoxels = 0;
+		for (size_t i = 0; i < voxels.size(); i++)
+		{
+			if (voxels[i].w_depth != reference[i].w_depth ||
+				fabsf(TVoxel::valueToFloat(voxels[i].sdf) - TVoxel::valueToFloat(reference[i].sdf)) > tolerance) noDifferentVoxels++;
+		}
+		return noDifferentVoxels;
+	}
+
+	template<class TVoxel>
+	void BenchmarkVoxelType(const char *voxelName, const IntegrationInput &input, int noFrames)
+	{
+		std::vector<TVoxel> reference, voxels;
+		float scalarTime = IntegrateBlocks<TVoxel>(reference, input, noFrames, NULL);
+		printf("%-16s %-8s %10.2f ms\n", voxelName, "scalar", scalarTime);
+
+#ifdef WITH_SIMD
+		typedef typename ITMVoxelBlockIntegrator<TVoxel>::IntegrateFunction IntegrateFunction;
+		struct Kernel { const char *name; ITMCPUInstructionSet instructionSet; IntegrateFunction integrate; };
+		const Kernel kernels[] = {
+			{ "SSE4", CPU_INSTRUCTIONSET_SSE4, &SSE4::IntegrateVoxelBlockDepth },
+			{ "AVX2", CPU_INSTRUCTIONSET_AVX2, &AVX2::IntegrateVoxelBlockDepth },
+			{ "AVX512", CPU_INSTRUCTIONSET_AVX512, &AVX512::IntegrateVoxelBlockDepth }
+		};
+
+		for (size_t kernelId = 0; kernelId < sizeof(kernels) / sizeof(kernels[0]); kernelId++)
+		{
+			const Kernel &kernel = kernels[kernelId];
+			if (GetCPUInstructionSet() < kernel.instructionSet)
+			{
+				printf("%-16s %-8s not supported by this CPU\n", voxelName, kernel.name);
+				continue;
+			}
+
+			float time = IntegrateBlocks<TVoxel>(voxels, input, noFrames, kernel.integrate);
+			printf("%-16s %-8s %10.2f ms, %5.2fx, %d of %d voxels differ\n", voxelName, kernel.name, time, scalarTime / time,
+				CountDifferentVoxels(voxels, reference), (int)voxels.size());
+		}
+#else
+		(void)voxels;
+		printf("%-16s built without WITH_SIMD\n", voxelName);
+#endif
+	}
+}
+
+int InfiniTAM::Benchmarks::RunIntegrationBenchmark(int argc, char **argv)
+{
+	int noFrames = argc > 0 ? atoi(argv[0]) : 10;
+	if (noFrames <= 0) noFrames = 1;
+
+	IntegrationInput input;
+	MakeIntegrationInput(input);
+
+	printf("fusing a %dx%d depth image into %d voxel blocks, time per frame on one thread:\n", input.imgSize.x, input.imgSize.y,
+		(int)input.blockPositions.size());
+
+	BenchmarkVoxelType<ITMVoxel_s>("ITMVoxel_s", input, noFrames);
+	BenchmarkVoxelType<ITMVoxel_f>("ITMVoxel_f", input, noFrames);
+	BenchmarkVoxelType<ITMVoxel_s_rgb>("ITMVoxel_s_rgb", input, noFrames);
+
+	return 0;
+}
@@ -0,0 +1,189 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "Benchmarks.h"
+
+#include <math.h>
+#include <stdexcept>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "../../InputSource/SyntheticSceneEngine.h"
+#include "../../ITMLib/Core/ITMDenseMapper.h"
+#include "../../ITMLib/Engines/ViewBuilding/ITMViewBuilderFactory.h"
+#include "../../ITMLib/Engines/Visualisation/ITMVisualisationEngineFactory.h"
+#include "../../ITMLib/Engines/Visualisation/Shared/ITMVisualisationEngine_Shared.h"
+#include "../../ITMLib/ITMLibDefines.h"
+#include "../../ITMLib/Objects/RenderStates/ITMRenderStateFactory.h"
+#include "../../ORUtils/NVTimer.h"
+
+using namespace InputSource;
+using namespace ITMLib;
+
+namespace
+{
+	typedef ITMScene<ITMVoxel, ITMVoxelIndex> Scene;
+
+	/** Casts a ray for every pixel, as GenericRaycast() in
+	    ITMVisualisationEngine_CPU does, either within the ranges
+	    of @p minmaximg or, if it is NULL, within the view frustum.
+	    Without @p blockSummaries, no empty space is skipped.
+	    Returns the time in ms.
+	*/
+	float CastRays(std::vector<Vector4f> &pointsRay, const Scene *scene, const Vector2i &imgSize, const Matrix4f &invM,
+		const Vector4f &projParams, const Vector2f *minmaximg, const ITMVoxelBlockSummary *blockSummaries)
+	{
+		float mu = scene->sceneParams->mu;
+		float oneOverVoxelSize = 1.0f / scene->sceneParams->voxelSize;
+		Vector2f viewFrustum_minmax(scene->sceneParams->viewFrustum_min, scene->sceneParams->viewFrustum_max);
+		const ITMVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+		const ITMVoxelIndex::IndexData *voxelIndex = scene->index.getIndexData();
+		Vector4f invProjParams = InvertProjectionParams(projParams);
+
+		pointsRay.resize(imgSize.x * imgSize.y);
+		Vector4f *pointsRayData = &pointsRay[0];
+
+		StopWatchInterface *timer;
+		sdkCreateTimer(&timer);
+		sdkStartTimer(&timer);
+
+#ifdef WITH_OPENMP
+		#pragma omp parallel for
+#endif
+		for (int locId = 0; locId < imgSize.x * imgSize.y; ++locId)
+		{
+			int y = locId / imgSize.x;
+			int x = locId - y * imgSize.x;
+			int locId2 = (int)floor((float)x / minmaximg_subsample) + (int)floor((float)y / minmaximg_subsample) * imgSize.x;
+
+			castRay<ITMVoxel, ITMVoxelIndex, false>(pointsRayData[locId], NULL, 0, x, y, voxelData, voxelIndex, blockSummaries, invM, invProjParams,
+				oneOverVoxelSize, mu, minmaximg != NULL ? minmaximg[locId2] : viewFrustum_minmax);
+		}
+
+		sdkStopTimer(&timer);
+		float time = sdkGetTimerValue(&timer);
+		sdkDeleteTimer(&timer);
+
+		return time;
+	}
+
+	/** Counts the pixels that hit the surface in only one of the
+	    two images, and those that hit it at points more than a
+	    voxel apart.
+	*/
+	void CountDifferentPixels(int &noDifferentHits, int &noDistantHits, const std::vector<Vector4f> &pointsRay, const std::vector<Vector4f> &reference)
+	{
+		for (size_t i = 0; i < pointsRay.size(); i++)
+		{
+			bool found = pointsRay[i].w > 0, foundReference = reference[i].w > 0;
+			if (found != foundReference) noDifferentHits++;
+			else if (found && length(pointsRay[i].toVector3() - reference[i].toVector3()) > 1.0f) noDistantHits++;
+		}
+	}
+}
+
+int InfiniTAM::Benchmarks::RunRaycastBenchmark(int argc, char **argv)
+{
+	const char *sceneName = argc > 0 ? argv[0] : "corridor";
+	int noFrames = argc > 1 ? atoi(argv[1]) : 200;
+	if (noFrames <= 0) noFrames = 1;
+
+	SyntheticSceneEngine::SceneType sceneType;
+	if (!SyntheticSceneEngine::getSceneType(sceneName, sceneType)) throw std::runtime_error(std::string("unknown synthetic scene: ") + sceneName);
+
+	Vector2i imgSize(640, 480);
+	SyntheticSceneEngine imageSource("", sceneType, imgSize, noFrames);
+	ITMRGBDCalib calib = imageSource.getCalib();
+
+	ITMLibSettings settings;
+	settings.deviceType = ITMLibSettings::DEVICE_CPU;
+
+	Scene *scene = new Scene(&settings.sceneParams, false, MEMORYDEVICE_CPU);
+	ITMDenseMapper<ITMVoxel, ITMVoxelIndex> *denseMapper = new ITMDenseMapper<ITMVoxel, ITMVoxelIndex>(&settings);
+	ITMViewBuilder *viewBuilder = ITMViewBuilderFactory::MakeViewBuilder(calib, settings.deviceType);
+	ITMVisualisationEngine<ITMVoxel, ITMVoxelIndex> *visualisationEngine =
+		ITMVisualisationEngineFactory::MakeVisualisationEngine<ITMVoxel, ITMVoxelIndex>(settings.deviceType);
+	ITMTrackingState *trackingState = new ITMTrackingState(imgSize, MEMORYDEVICE_CPU);
+	ITMRenderState *renderState_live = ITMRenderStateFactory<ITMVoxelIndex>::CreateRenderState(imgSize, &settings.sceneParams, MEMORYDEVICE_CPU);
+	ITMRenderState *renderState = visualisationEngine->CreateRenderState(scene, imgSize);
+
+	ITMUChar4Image *rgb = new ITMUChar4Image(imgSize, true, false);
+	ITMShortImage *rawDepth = new ITMShortImage(imgSize, true, false);
+	ITMView *view = NULL;
+
+	denseMapper->ResetScene(scene);
+
+	// the ground truth poses, so that the scene does not depend on the tracker
+	printf("fusing %d frames of the %s scene at %dx%d ...\n", noFrames, sceneName, imgSize.x, imgSize.y);
+	std::vector<Matrix4f> poses;
+	while (imageSource.hasMoreImages())
+	{
+		poses.push_back(imageSource.getPose(imageSource.getCurrentFrameNo()));
+		imageSource.getImages(rgb, rawDepth);
+
+		viewBuilder->UpdateView(&view, rgb, rawDepth, settings.useBilateralFilter);
+		trackingState->pose_d->SetInvM(poses.back());
+		denseMapper->ProcessFrame(view, trackingState, scene, renderState_live);
+	}
+
+	int noUsedBlocks = scene->index.getNumAllocatedVoxelBlocks() - scene->localVBA.lastFreeBlockId - 1;
+	printf("%d voxel blocks in use, ray casting from every 10th pose:\n", noUsedBlocks);
+
+	const ITMVoxelBlockSummary *blockSummaries = scene->localVBA.GetBlockSummaries();
+	const ITMIntrinsics &intrinsics = calib.intrinsics_d;
+	const Vector2f *minmaximg = renderState->renderingRangeImage->GetData(MEMORYDEVICE_CPU);
+
+	float rangeTime = 0.0f;
+	float times[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	int noDifferentHits[4] = { 0, 0, 0, 0 }, noDistantHits[4] = { 0, 0, 0, 0 };
+	int noRenderedFrames = 0;
+
+	std::vector<Vector4f> reference, pointsRay;
+	for (size_t frameNo = 0; frameNo < poses.size(); frameNo += 10, noRenderedFrames++)
+	{
+		ORUtils::SE3Pose pose;
+		pose.SetInvM(poses[frameNo]);
+		Matrix4f invM = pose.GetInvM();
+
+		StopWatchInterface *timer;
+		sdkCreateTimer(&timer);
+		sdkStartTimer(&timer);
+		visualisationEngine->FindVisibleBlocks(scene, &pose, &intrinsics, renderState);
+		visualisationEngine->CreateExpectedDepths(scene, &pose, &intrinsics, renderState);
+		sdkStopTimer(&timer);
+		rangeTime += sdkGetTimerValue(&timer);
+		sdkDeleteTimer(&timer);
+
+		// within the ranges of the visible blocks and within the view frustum, without and with skipping
+		times[0] += CastRays(reference, scene, imgSize, invM, intrinsics.projectionParamsSimple.all, minmaximg, NULL);
+		times[1] += CastRays(pointsRay, scene, imgSize, invM, intrinsics.projectionParamsSimple.all, minmaximg, blockSummaries);
+		CountDifferentPixels(noDifferentHits[1], noDistantHits[1], pointsRay, reference);
+		times[2] += CastRays(pointsRay, scene, imgSize, invM, intrinsics.projectionParamsSimple.all, NULL, NULL);
+		CountDifferentPixels(noDifferentHits[2], noDistantHits[2], pointsRay, reference);
+		times[3] += CastRays(pointsRay, scene, imgSize, invM, intrinsics.projectionParamsSimple.all, NULL, blockSummaries);
+		CountDifferentPixels(noDifferentHits[3], noDistantHits[3], pointsRay, reference);
+	}
+
+	const char *names[4] = { "block ranges", "block ranges, skipping", "view frustum", "view frustum, skipping" };
+	printf("%-24s %10.2f ms per frame\n", "finding block ranges", rangeTime / noRenderedFrames);
+	for (int i = 0; i < 4; i++)
+	{
+		printf("%-24s %10.2f ms per frame, %5.2fx", names[i], times[i] / noRenderedFrames, times[0] / times[i]);
+		if (i > 0) printf(", per frame %.1f pixels hit only in one and %.1f more than a voxel apart", (float)noDifferentHits[i] / noRenderedFrames,
+			(float)noDistantHits[i] / noRenderedFrames);
+		printf("\n");
+	}
+
+	delete view;
+	delete rawDepth;
+	delete rgb;
+	delete renderState;
+	delete renderState_live;
+	delete trackingState;
+	delete visualisationEngine;
+	delete viewBuilder;
+	delete denseMapper;
+	delete scene;
+
+	return 0;
+}
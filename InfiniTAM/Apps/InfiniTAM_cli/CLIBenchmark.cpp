@@ -0,0 +1,312 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "CLIBenchmark.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace InfiniTAM::Engine;
+using namespace ITMLib;
+
+bool InfiniTAM::Engine::ApplySettingsProfile(ITMLibSettings *settings, const char *name)
+{
+	if (strcmp(name, "default") == 0) return true;
+
+	if (strcmp(name, "fast") == 0)
+	{
+		settings->useApproximateRaycast = true;
+		if (settings->libMode != ITMLibSettings::LIBMODE_BASIC_SURFELS)
+		{
+			settings->trackerConfig = "type=icp,levels=rrrbb,minstep=1e-3,"
+				"outlierC=0.01,outlierF=0.002,"
+				"numiterC=10,numiterF=2,failureDec=5.0";
+		}
+		return true;
+	}
+
+	if (strcmp(name, "filtered") == 0)
+	{
+		settings->useBilateralFilter = true;
+		return true;
+	}
+
+	return false;
+}
+
+// Hamilton quaternion (qw, qx, qy, qz) to rotation, in the column major layout of Matrix4f
+static void RotationFromQuaternion(double qw, double qx, double qy, double qz, Matrix4f &M)
+{
+	double norm = sqrt(qw * qw + qx * qx + qy * qy + qz * qz);
+	qw /= norm; qx /= norm; qy /= norm; qz /= norm;
+
+	M.m[0] = (float)(1 - 2 * (qy * qy + qz * qz)); M.m[4] = (float)(2 * (qx * qy - qz * qw)); M.m[8] = (float)(2 * (qx * qz + qy * qw));
+	M.m[1] = (float)(2 * (qx * qy + qz * qw)); M.m[5] = (float)(1 - 2 * (qx * qx + qz * qz)); M.m[9] = (float)(2 * (qy * qz - qx * qw));
+	M.m[2] = (float)(2 * (qx * qz - qy * qw)); M.m[6] = (float)(2 * (qy * qz + qx * qw)); M.m[10] = (float)(1 - 2 * (qx * qx + qy * qy));
+}
+
+static void QuaternionFromRotation(const Matrix4f &M, double &qw, double &qx, double &qy, double &qz)
+{
+	double r00 = M.m[0], r11 = M.m[5], r22 = M.m[10];
+	double r01 = M.m[4], r10 = M.m[1], r02 = M.m[8], r20 = M.m[2], r12 = M.m[9], r21 = M.m[6];
+
+	double trace = r00 + r11 + r22;
+	if (trace > 0)
+	{
+		double s = 2.0 * sqrt(trace + 1.0);
+		qw = 0.25 * s; qx = (r21 - r12) / s; qy = (r02 - r20) / s; qz = (r10 - r01) / s;
+	}
+	else if (r00 > r11 && r00 > r22)
+	{
+		double s = 2.0 * sqrt(1.0 + r00 - r11 - r22);
+		qw = (r21 - r12) / s; qx = 0.25 * s; qy = (r01 + r10) / s; qz = (r02 + r20) / s;
+	}
+	else if (r11 > r22)
+	{
+		double s = 2.0 * sqrt(1.0 + r11 - r00 - r22);
+		qw = (r02 - r20) / s; qx = (r01 + r10) / s; qy = 0.25 * s; qz = (r12 + r21) / s;
+	}
+	else
+	{
+		double s = 2.0 * sqrt(1.0 + r22 - r00 - r11);
+		qw = (r10 - r01) / s; qx = (r02 + r20) / s; qy = (r12 + r21) / s; qz = 0.25 * s;
+	}
+
+	if (qw < 0) { qw = -qw; qx = -qx; qy = -qy; qz = -qz; }
+}
+
+bool InfiniTAM::Engine::ReadTUMTrajectory(const char *fileName, CLITrajectory &trajectory, std::vector<double> *timestamps)
+{
+	FILE *f = fopen(fileName, "r");
+	if (f == NULL) return false;
+
+	trajectory.clear();
+	if (timestamps != NULL) timestamps->clear();
+
+	char line[1024];
+	while (fgets(line, sizeof(line), f) != NULL)
+	{
+		if (line[0] == '#') continue;
+
+		double t, tx, ty, tz, qx, qy, qz, qw;
+		if (sscanf(line, "%lf %lf %lf %lf %lf %lf %lf %lf", &t, &tx, &ty, &tz, &qx, &qy, &qz, &qw) != 8) continue;
+
+		Matrix4f M; M.setIdentity();
+		RotationFromQuaternion(qw, qx, qy, qz, M);
+		M.m[12] = (float)tx; M.m[13] = (float)ty; M.m[14] = (float)tz;
+
+		trajectory.push_back(M);
+		if (timestamps != NULL) timestamps->push_back(t);
+	}
+
+	fclose(f);
+	return true;
+}
+
+bool InfiniTAM::Engine::WriteTUMTrajectory(const char *fileName, const CLITrajectory &trajectory, const std::vector<double> &timestamps)
+{
+	FILE *f = fopen(fileName, "w");
+	if (f == NULL) return false;
+
+	fprintf(f, "# timestamp tx ty tz qx qy qz qw\n");
+	for (size_t i = 0; i < trajectory.size(); ++i)
+	{
+		const Matrix4f &M = trajectory[i];
+		double qw, qx, qy, qz;
+		QuaternionFromRotation(M, qw, qx, qy, qz);
+
+		double t = timestamps.size() == trajectory.size() ? timestamps[i] : (double)i;
+		fprintf(f, "%.6f %f %f %f %f %f %f %f\n", t, M.m[12], M.m[13], M.m[14], qx, qy, qz, qw);
+	}
+
+	return fclose(f) == 0;
+}
+
+bool InfiniTAM::Engine::ReadTimestamps(const char *fileName, std::vector<double> &timestamps)
+{
+	FILE *f = fopen(fileName, "r");
+	if (f == NULL) return false;
+
+	timestamps.clear();
+
+	char line[1024];
+	while (fgets(line, sizeof(line), f) != NULL)
+	{
+		if (line[0] == '#') continue;
+
+		double t;
+		if (sscanf(line, "%lf", &t) == 1) timestamps.push_back(t);
+	}
+
+	fclose(f);
+	return true;
+}
+
+// one pair of poses that were taken at about the same time
+struct PoseAssociation
+{
+	double timeDifference;
+	size_t estimateId, groundTruthId;
+
+	bool operator<(const PoseAssociation &other) const { return timeDifference < other.timeDifference; }
+};
+
+// as associate.py of the TUM RGB-D benchmark: of all pairs within the tolerance, the closest ones in time first,
+// using every pose at most once
+static void AssociatePoses(const std::vector<double> &estimateTimestamps, const std::vector<double> &groundTruthTimestamps,
+	double maxTimeDifference, std::vector<PoseAssociation> &associations)
+{
+	std::vector<PoseAssociation> candidates;
+	for (size_t i = 0; i < estimateTimestamps.size(); ++i) for (size_t j = 0; j < groundTruthTimestamps.size(); ++j)
+	{
+		double timeDifference = fabs(estimateTimestamps[i] - groundTruthTimestamps[j]);
+		if (timeDifference > maxTimeDifference) continue;
+
+		PoseAssociation candidate = { timeDifference, i, j };
+		candidates.push_back(candidate);
+	}
+	std::stable_sort(candidates.begin(), candidates.end());
+
+	std::vector<bool> estimateUsed(estimateTimestamps.size(), false), groundTruthUsed(groundTruthTimestamps.size(), false);
+	associations.clear();
+	for (size_t i = 0; i < candidates.size(); ++i)
+	{
+		const PoseAssociation &candidate = candidates[i];
+		if (estimateUsed[candidate.estimateId] || groundTruthUsed[candidate.groundTruthId]) continue;
+
+		estimateUsed[candidate.estimateId] = groundTruthUsed[candidate.groundTruthId] = true;
+		associations.push_back(candidate);
+	}
+}
+
+// eigenvector of the largest eigenvalue of a symmetric 4x4 matrix, with cyclic Jacobi rotations
+static void LargestEigenvector4(double A[4][4], double v[4])
+{
+	double V[4][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } };
+
+	for (int sweep = 0; sweep < 50; ++sweep)
+	{
+		double offDiagonal = 0.0;
+		for (int p = 0; p < 4; ++p) for (int q = p + 1; q < 4; ++q) offDiagonal += A[p][q] * A[p][q];
+		if (offDiagonal < 1e-30) break;
+
+		for (int p = 0; p < 4; ++p) for (int q = p + 1; q < 4; ++q)
+		{
+			if (A[p][q] == 0.0) continue;
+
+			double theta = (A[q][q] - A[p][p]) / (2.0 * A[p][q]);
+			double t = (theta >= 0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+			double c = 1.0 / sqrt(t * t + 1.0), s = t * c;
+
+			for (int k = 0; k < 4; ++k)
+			{
+				double akp = A[k][p], akq = A[k][q];
+				A[k][p] = c * akp - s * akq; A[k][q] = s * akp + c * akq;
+			}
+			for (int k = 0; k < 4; ++k)
+			{
+				double apk = A[p][k], aqk = A[q][k];
+				A[p][k] = c * apk - s * aqk; A[q][k] = s * apk + c * aqk;
+			}
+			for (int k = 0; k < 4; ++k)
+			{
+				double vkp = V[k][p], vkq = V[k][q];
+				V[k][p] = c * vkp - s * vkq; V[k][q] = s * vkp + c * vkq;
+			}
+		}
+	}
+
+	int largest = 0;
+	for (int i = 1; i < 4; ++i) if (A[i][i] > A[largest][largest]) largest = i;
+	for (int k = 0; k < 4; ++k) v[k] = V[k][largest];
+}
+
+int InfiniTAM::Engine::ComputeTrajectoryError(const CLITrajectory &estimate, const std::vector<double> &estimateTimestamps,
+	const CLITrajectory &groundTruth, const std::vector<double> &groundTruthTimestamps, double maxTimeDifference, double &rmse, double &maxError)
+{
+	rmse = maxError = 0.0;
+
+	std::vector<PoseAssociation> candidates, associations;
+	AssociatePoses(estimateTimestamps, groundTruthTimestamps, maxTimeDifference, candidates);
+
+	// e.g. after the tracker diverged
+	for (size_t i = 0; i < candidates.size(); ++i)
+	{
+		const Matrix4f &M = estimate[candidates[i].estimateId];
+		if (M.m[12] == M.m[12] && M.m[13] == M.m[13] && M.m[14] == M.m[14]) associations.push_back(candidates[i]);
+	}
+
+	int noComparedFrames = (int)associations.size();
+	if (noComparedFrames == 0) return 0;
+
+	// Horn's closed form least squares alignment of the estimated positions to the ground truth, see
+	// "Closed-form solution of absolute orientation using unit quaternions", JOSA A 4(4), 1987
+	double meanEstimate[3] = { 0, 0, 0 }, meanGroundTruth[3] = { 0, 0, 0 };
+	for (int i = 0; i < noComparedFrames; ++i) for (int k = 0; k < 3; ++k)
+	{
+		meanEstimate[k] += estimate[associations[i].estimateId].m[12 + k] / noComparedFrames;
+		meanGroundTruth[k] += groundTruth[associations[i].groundTruthId].m[12 + k] / noComparedFrames;
+	}
+
+	// S[a][b] = sum of (estimate_a - mean) * (groundTruth_b - mean)
+	double S[3][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+	for (int i = 0; i < noComparedFrames; ++i) for (int a = 0; a < 3; ++a) for (int b = 0; b < 3; ++b)
+	{
+		S[a][b] += (estimate[associations[i].estimateId].m[12 + a] - meanEstimate[a]) *
+			(groundTruth[associations[i].groundTruthId].m[12 + b] - meanGroundTruth[b]);
+	}
+
+	double N[4][4] = {
+		{ S[0][0] + S[1][1] + S[2][2], S[1][2] - S[2][1], S[2][0] - S[0][2], S[0][1] - S[1][0] },
+		{ S[1][2] - S[2][1], S[0][0] - S[1][1] - S[2][2], S[0][1] + S[1][0], S[2][0] + S[0][2] },
+		{ S[2][0] - S[0][2], S[0][1] + S[1][0], -S[0][0] + S[1][1] - S[2][2], S[1][2] + S[2][1] },
+		{ S[0][1] - S[1][0], S[2][0] + S[0][2], S[1][2] + S[2][1], -S[0][0] - S[1][1] + S[2][2] }
+	};
+
+	double q[4];
+	LargestEigenvector4(N, q);
+
+	Matrix4f rotation; rotation.setIdentity();
+	RotationFromQuaternion(q[0], q[1], q[2], q[3], rotation);
+
+	double sumSquares = 0.0;
+	for (int i = 0; i < noComparedFrames; ++i)
+	{
+		const Matrix4f &M = estimate[associations[i].estimateId], &G = groundTruth[associations[i].groundTruthId];
+
+		double squaredError = 0.0;
+		for (int a = 0; a < 3; ++a)
+		{
+			double aligned = meanGroundTruth[a];
+			for (int b = 0; b < 3; ++b) aligned += rotation.m[a + 4 * b] * (M.m[12 + b] - meanEstimate[b]);
+
+			double difference = aligned - G.m[12 + a];
+			squaredError += difference * difference;
+		}
+
+		sumSquares += squaredError;
+		if (sqrt(squaredError) > maxError) maxError = sqrt(squaredError);
+	}
+
+	rmse = sqrt(sumSquares / noComparedFrames);
+	return noComparedFrames;
+}
+
+long InfiniTAM::Engine::GetPeakMemoryUsage(void)
+{
+#ifndef _WIN32
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+	return (long)(usage.ru_maxrss / 1024);
+#else
+	return (long)usage.ru_maxrss;
+#endif
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,59 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+
+#include "../../ITMLib/Utils/ITMLibSettings.h"
+#include "../../ITMLib/Utils/ITMMath.h"
+
+namespace InfiniTAM
+{
+	namespace Engine
+	{
+		/** A camera trajectory as camera to world transformations, one per frame. */
+		typedef std::vector<Matrix4f> CLITrajectory;
+
+		/** Sets up @p settings for one of the fixed benchmark profiles:
+		    "default" keeps the defaults of ITMLibSettings, "fast" uses
+		    ICP tracking and approximate raycasts, and "filtered" adds
+		    bilateral filtering to the defaults. Returns false if there
+		    is no profile called @p name.
+		*/
+		bool ApplySettingsProfile(ITMLib::ITMLibSettings *settings, const char *name);
+
+		/** Reads a trajectory in the format of the TUM RGB-D benchmark,
+		    i.e. "timestamp tx ty tz qx qy qz qw" per line.
+		*/
+		bool ReadTUMTrajectory(const char *fileName, CLITrajectory &trajectory, std::vector<double> *timestamps = NULL);
+
+		/** Writes a trajectory in the format of the TUM RGB-D benchmark,
+		    with the given timestamps or the frame numbers if there are
+		    not enough timestamps.
+		*/
+		bool WriteTUMTrajectory(const char *fileName, const CLITrajectory &trajectory, const std::vector<double> &timestamps);
+
+		/** Reads the timestamps of the input frames from the first
+		    column of a file, e.g. depth.txt of a TUM RGB-D sequence.
+		    Lines starting with '#' are skipped.
+		*/
+		bool ReadTimestamps(const char *fileName, std::vector<double> &timestamps);
+
+		/** Absolute trajectory error, as in the TUM RGB-D benchmark:
+		    each estimated pose is paired with the ground truth pose
+		    nearest to it in time, if they are at most
+		    @p maxTimeDifference apart, and the estimated positions are
+		    then aligned to the ground truth by the rigid transformation
+		    that minimises the squared error over all pairs. Estimated
+		    poses that are not a number are skipped. Returns the number
+		    of pairs compared.
+		*/
+		int ComputeTrajectoryError(const CLITrajectory &estimate, const std::vector<double> &estimateTimestamps,
+			const CLITrajectory &groundTruth, const std::vector<double> &groundTruthTimestamps, double maxTimeDifference,
+			double &rmse, double &maxError);
+
+		/// Peak resident memory of the process in kB, or 0 where this is not supported
+		long GetPeakMemoryUsage(void);
+	}
+}
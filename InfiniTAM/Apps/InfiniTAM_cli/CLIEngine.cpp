@@ -4,6 +4,9 @@
 
 #include <string.h>
 
+#include "../../ITMLib/Core/ITMMultiEngine.h"
+#include "../../ITMLib/ITMLibDefines.h"
+#include "../../ITMLib/Utils/ITMProfiler.h"
 #include "../../ORUtils/FileUtils.h"
 
 using namespace InfiniTAM::Engine;
@@ -13,21 +16,36 @@ using namespace ITMLib;
 CLIEngine* CLIEngine::instance;
 
 void CLIEngine::Initialise(ImageSourceEngine *imageSource, IMUSourceEngine *imuSource, ITMMainEngine *mainEngine,
-	ITMLibSettings::DeviceType deviceType)
+	const ITMLibSettings *settings, const char *recordFilename)
 {
 	this->imageSource = imageSource;
 	this->imuSource = imuSource;
 	this->mainEngine = mainEngine;
 
 	this->currentFrameNo = 0;
+	this->frameLatency = settings->usePipelinedProcessing ? 1 : 0;
+	this->trajectory.clear();
 
 	bool allocateGPU = false;
-	if (deviceType == ITMLibSettings::DEVICE_CUDA) allocateGPU = true;
+	if (settings->deviceType == ITMLibSettings::DEVICE_CUDA) allocateGPU = true;
 
 	inputRGBImage = new ITMUChar4Image(imageSource->getRGBImageSize(), true, allocateGPU);
 	inputRawDepthImage = new ITMShortImage(imageSource->getDepthImageSize(), true, allocateGPU);
 	inputIMUMeasurement = new ITMIMUMeasurement();
 
+	sequenceWriter = NULL;
+	if (recordFilename != NULL)
+	{
+		sequenceWriter = new PackedSequenceWriter();
+		if (!sequenceWriter->open(recordFilename, imageSource->getCalib(), imageSource->getRGBImageSize(), imageSource->getDepthImageSize(),
+			imuSource != NULL, PACKED_SEQUENCE_ENCODING_RVL))
+		{
+			printf("error: could not open '%s' for recording\n", recordFilename);
+			delete sequenceWriter;
+			sequenceWriter = NULL;
+		}
+	}
+
 #ifndef COMPILE_WITHOUT_CUDA
 	ORcudaSafeCall(cudaThreadSynchronize());
 #endif
@@ -50,6 +68,8 @@ bool CLIEngine::ProcessFrame()
 		else imuSource->getMeasurement(inputIMUMeasurement);
 	}
 
+	if (sequenceWriter != NULL) sequenceWriter->writeFrame(inputRGBImage, inputRawDepthImage, imuSource != NULL ? inputIMUMeasurement : NULL);
+
 	sdkResetTimer(&timer_instant);
 	sdkStartTimer(&timer_instant); sdkStartTimer(&timer_average);
 
@@ -62,8 +82,12 @@ bool CLIEngine::ProcessFrame()
 #endif
 	sdkStopTimer(&timer_instant); sdkStopTimer(&timer_average);
 
+	ITMProfiler::Instance().EndFrame();
+	if (currentFrameNo >= frameLatency) trajectory.push_back(GetCameraToWorld());
+
 	float processedTime_inst = sdkGetTimerValue(&timer_instant);
 	float processedTime_avg = sdkGetAverageTimerValue(&timer_average);
+	processedTime = processedTime_avg;
 
 	printf("frame %i: time %.2f, avg %.2f\n", currentFrameNo, processedTime_inst, processedTime_avg);
 
@@ -72,11 +96,27 @@ bool CLIEngine::ProcessFrame()
 	return true;
 }
 
+Matrix4f CLIEngine::GetCameraToWorld(void)
+{
+	// the tracking state of the multi engine is relative to its primary local map
+	ITMMultiEngine<ITMVoxel, ITMVoxelIndex> *multiEngine = dynamic_cast<ITMMultiEngine<ITMVoxel, ITMVoxelIndex>*>(mainEngine);
+	if (multiEngine != NULL) return multiEngine->GetGlobalCameraPose().GetInvM();
+
+	return mainEngine->GetTrackingState()->pose_d->GetInvM();
+}
+
 void CLIEngine::Run()
 {
 	while (true) {
 		if (!ProcessFrame()) break;
 	}
+
+	// the last frame is still pending in pipelined mode
+	if (frameLatency > 0 && currentFrameNo > 0)
+	{
+		mainEngine->FlushPipeline();
+		trajectory.push_back(GetCameraToWorld());
+	}
 }
 
 void CLIEngine::Shutdown()
@@ -87,6 +127,7 @@ void CLIEngine::Shutdown()
 	delete inputRGBImage;
 	delete inputRawDepthImage;
 	delete inputIMUMeasurement;
+	delete sequenceWriter;
 
 	delete instance;
 }
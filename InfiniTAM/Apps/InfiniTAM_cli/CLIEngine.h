@@ -2,8 +2,11 @@
 
 #pragma once
 
+#include "CLIBenchmark.h"
+
 #include "../../InputSource/ImageSourceEngine.h"
 #include "../../InputSource/IMUSourceEngine.h"
+#include "../../InputSource/PackedSequenceWriter.h"
 #include "../../ITMLib/Core/ITMMainEngine.h"
 #include "../../ITMLib/Utils/ITMLibSettings.h"
 #include "../../ORUtils/FileUtils.h"
@@ -29,7 +32,16 @@ namespace InfiniTAM
 			ITMUChar4Image *inputRGBImage; ITMShortImage *inputRawDepthImage;
 			ITMLib::ITMIMUMeasurement *inputIMUMeasurement;
 
+			InputSource::PackedSequenceWriter *sequenceWriter;
+
+			/// Number of frames that the poses lag behind the input, see ITMLibSettings::usePipelinedProcessing
+			int frameLatency;
+			CLITrajectory trajectory;
+
 			int currentFrameNo;
+
+			/// The camera to world transformation of the last tracked frame, in global coordinates for ITMMultiEngine
+			Matrix4f GetCameraToWorld(void);
 		public:
 			static CLIEngine* Instance(void) {
 				if (instance == NULL) instance = new CLIEngine();
@@ -38,12 +50,18 @@ namespace InfiniTAM
 
 			float processedTime;
 
+			/** If @p recordFilename is given, the input is also recorded into a packed sequence with compressed depth. */
 			void Initialise(InputSource::ImageSourceEngine *imageSource, InputSource::IMUSourceEngine *imuSource, ITMLib::ITMMainEngine *mainEngine,
-				ITMLib::ITMLibSettings::DeviceType deviceType);
+				const ITMLib::ITMLibSettings *settings, const char *recordFilename = NULL);
 			void Shutdown();
 
 			void Run();
 			bool ProcessFrame();
+
+			int GetNoFrames(void) const { return currentFrameNo; }
+
+			/// The estimated camera to world transformation of every frame processed so far
+			const CLITrajectory& GetTrajectory(void) const { return trajectory; }
 		};
 	}
 }
@@ -2,14 +2,23 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string.h>
 
 #include "CLIEngine.h"
 
 #include "../../InputSource/OpenNIEngine.h"
 #include "../../InputSource/Kinect2Engine.h"
+#include "../../InputSource/PackedSequenceReader.h"
+#include "../../InputSource/PrefetchingImageSourceEngine.h"
+#include "../../InputSource/SyntheticSceneEngine.h"
 
 #include "../../ITMLib/ITMLibDefines.h"
 #include "../../ITMLib/Core/ITMBasicEngine.h"
+#include "../../ITMLib/Core/ITMBasicSurfelEngine.h"
+#include "../../ITMLib/Core/ITMMultiEngine.h"
+#include "../../ITMLib/Utils/ITMProfiler.h"
 
 using namespace InfiniTAM::Engine;
 using namespace InputSource;
@@ -22,8 +31,114 @@ try
 	const char *imagesource_part1 = NULL;
 	const char *imagesource_part2 = NULL;
 	const char *imagesource_part3 = NULL;
+	const char *recordFile = NULL;
+
+	bool pipelined = false;
+	bool swapping = false;
+	bool asyncSwapping = false;
+	const char *swapDirectory = NULL;
+	int maxHostBlocks = 0;
+	const char *swapCompression = "none";
+	int maxPrefetchBlocks = 0;
+	const char *swapEviction = "invisible";
+	int maxActiveBlocks = 0;
+	const char *profilePrefix = NULL;
+	const char *engineName = "basic";
+	const char *settingsProfile = "default";
+	const char *groundTruthFile = NULL;
+	const char *trajectoryFile = NULL;
+	const char *timestampFile = NULL;
+	const char *benchmarkFile = NULL;
+	const char *syntheticScene = NULL;
+	const char *poseMask = NULL;
+	const char *trackerConfig = NULL;
 
 	int arg = 1;
+	while (argv[arg] != NULL && strncmp(argv[arg], "--", 2) == 0) {
+		if (strcmp(argv[arg], "--record") == 0 && argv[arg + 1] != NULL) {
+			recordFile = argv[arg + 1];
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--pipelined") == 0) {
+			pipelined = true;
+			++arg;
+		}
+		else if (strcmp(argv[arg], "--swapping") == 0) {
+			swapping = true;
+			++arg;
+		}
+		else if (strcmp(argv[arg], "--async-swapping") == 0) {
+			swapping = asyncSwapping = true;
+			++arg;
+		}
+		else if (strcmp(argv[arg], "--swap-dir") == 0 && argv[arg + 1] != NULL) {
+			swapDirectory = argv[arg + 1];
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--swap-host-blocks") == 0 && argv[arg + 1] != NULL) {
+			maxHostBlocks = atoi(argv[arg + 1]);
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--swap-compression") == 0 && argv[arg + 1] != NULL) {
+			swapCompression = argv[arg + 1];
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--swap-prefetch") == 0 && argv[arg + 1] != NULL) {
+			maxPrefetchBlocks = atoi(argv[arg + 1]);
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--swap-eviction") == 0 && argv[arg + 1] != NULL) {
+			swapEviction = argv[arg + 1];
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--swap-active-blocks") == 0 && argv[arg + 1] != NULL) {
+			maxActiveBlocks = atoi(argv[arg + 1]);
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--profile") == 0 && argv[arg + 1] != NULL) {
+			profilePrefix = argv[arg + 1];
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--engine") == 0 && argv[arg + 1] != NULL) {
+			engineName = argv[arg + 1];
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--settings") == 0 && argv[arg + 1] != NULL) {
+			settingsProfile = argv[arg + 1];
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--groundtruth") == 0 && argv[arg + 1] != NULL) {
+			groundTruthFile = argv[arg + 1];
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--timestamps") == 0 && argv[arg + 1] != NULL) {
+			timestampFile = argv[arg + 1];
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--trajectory") == 0 && argv[arg + 1] != NULL) {
+			trajectoryFile = argv[arg + 1];
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--benchmark") == 0 && argv[arg + 1] != NULL) {
+			benchmarkFile = argv[arg + 1];
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--synthetic") == 0 && argv[arg + 1] != NULL) {
+			syntheticScene = argv[arg + 1];
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--poses") == 0 && argv[arg + 1] != NULL) {
+			poseMask = argv[arg + 1];
+			arg += 2;
+		}
+		else if (strcmp(argv[arg], "--tracker") == 0 && argv[arg + 1] != NULL) {
+			trackerConfig = argv[arg + 1];
+			arg += 2;
+		}
+		else break;
+	}
+
+	int firstArg = arg;
 	do {
 		if (argv[arg] != NULL) calibFile = argv[arg]; else break;
 		++arg;
@@ -34,10 +149,52 @@ try
 		if (argv[arg] != NULL) imagesource_part3 = argv[arg]; else break;
 	} while (false);
 
-	if (arg == 1) {
-		printf("usage: %s [<calibfile> [<imagesource>] ]\n"
+	if (arg == firstArg && syntheticScene == NULL) {
+		printf("usage: %s [<options>] [<calibfile> [<imagesource>] ]\n"
+		       "options:\n"
+		       "  --record <output>       : record the input into a packed sequence with losslessly compressed depth\n"
+		       "  --pipelined             : build the view of the next frame while tracking the current one, and\n"
+		       "                            report the time spent in each stage at the end\n"
+		       "  --swapping              : swap voxel blocks that are out of view to host memory\n"
+		       "  --async-swapping        : as --swapping, with the copies to and from host memory on a\n"
+		       "                            background thread\n"
+		       "  --swap-dir <directory>  : keep the swapped out blocks that do not fit into host memory in a\n"
+		       "                            file in <directory>\n"
+		       "  --swap-host-blocks <n>  : number of swapped out blocks kept in host memory with --swap-dir\n"
+		       "  --swap-compression <c>  : none (default), lossless or quantised compression of the swapped\n"
+		       "                            out blocks in host memory\n"
+		       "  --swap-prefetch <n>     : swap in up to <n> blocks per frame that the camera is predicted to\n"
+		       "                            see next, from its motion over the last frames\n"
+		       "  --swap-eviction <p>     : invisible (default) to swap out every block out of view, or lru to\n"
+		       "                            swap out the least recently seen blocks once active memory is full\n"
+		       "  --swap-active-blocks <n>: number of blocks kept in active memory with --swap-eviction lru\n"
+		       "  --profile <prefix>      : write the time spent in each stage and scene statistics per frame to\n"
+		       "                            <prefix>.csv and <prefix>.json, and a trace to <prefix>.trace.json\n"
+		       "                            (not in a build with WITH_PROFILING=OFF)\n"
+		       "  --engine <name>         : basic (default), surfels or loopclosure\n"
+		       "  --settings <profile>    : default, fast or filtered, see ApplySettingsProfile()\n"
+		       "  --groundtruth <file>    : TUM format trajectory to compute the absolute trajectory error against,\n"
+		       "                            pairing the poses that are at most 20 ms apart\n"
+		       "  --timestamps <file>     : timestamps of the input frames, one per line, e.g. depth.txt of a TUM\n"
+		       "                            sequence. Without it, the frames are assumed to have the timestamps of\n"
+		       "                            the --groundtruth poses in turn\n"
+		       "  --trajectory <file>     : write the estimated trajectory in TUM format\n"
+		       "  --benchmark <file>      : write a JSON report of the run, see below\n"
+		       "  --synthetic <spec>      : render the input from an analytic scene instead, where <spec> is\n"
+		       "                            <scene>[:<width>x<height>[:<frames>[:<noise level>]]] and <scene> is\n"
+		       "                            room, corridor or clutter, e.g. corridor:640x480:1000:1. The poses\n"
+		       "                            of the scene are the ground truth unless --groundtruth is given\n"
+		       "  --poses <mask>          : write the ground truth poses of a synthetic scene to files for the\n"
+		       "                            file based tracker, e.g. poses/%%04i.txt\n"
+		       "  --tracker <config>      : override the tracker configuration of the settings profile, e.g.\n"
+		       "                            \"type=file,mask=poses/%%04i.txt\"\n"
+		       "\n"
+		       "The benchmark report contains the ms per frame, peak memory, trajectory error and the mean and\n"
+		       "maximum of every stage and counter, e.g. allocated blocks, unless built with WITH_PROFILING=OFF.\n"
+		       "\n"
+		       "arguments:\n"
 		       "  <calibfile>   : path to a file containing intrinsic calibration parameters\n"
-		       "  <imagesource> : either one argument to specify OpenNI device ID\n"
+		       "  <imagesource> : either one argument to specify OpenNI device ID or a packed sequence\n"
 		       "                  or two arguments specifying rgb and depth file masks\n"
 		       "\n"
 		       "examples:\n"
@@ -46,19 +203,99 @@ try
 	}
 
 	printf("initialising ...\n");
-	ITMLibSettings *internalSettings = new ITMLibSettings();
+	ITMLibSettings::LibMode libMode = ITMLibSettings::LIBMODE_BASIC;
+	if (strcmp(engineName, "surfels") == 0) libMode = ITMLibSettings::LIBMODE_BASIC_SURFELS;
+	else if (strcmp(engineName, "loopclosure") == 0) libMode = ITMLibSettings::LIBMODE_LOOPCLOSURE;
+	else if (strcmp(engineName, "basic") != 0) throw std::runtime_error("Unknown engine: " + std::string(engineName));
+
+	ITMLibSettings *internalSettings = new ITMLibSettings(libMode);
+	if (!ApplySettingsProfile(internalSettings, settingsProfile)) throw std::runtime_error("Unknown settings profile: " + std::string(settingsProfile));
+	if (pipelined && libMode != ITMLibSettings::LIBMODE_BASIC) {
+		printf("warning: only the basic engine has a pipelined mode\n");
+		pipelined = false;
+	}
+	internalSettings->usePipelinedProcessing = pipelined;
+	if (trackerConfig != NULL) internalSettings->trackerConfig = trackerConfig;
+	if (swapping) {
+		internalSettings->swappingMode = ITMLibSettings::SWAPPINGMODE_ENABLED;
+		internalSettings->sceneParams.allowHashGrowth = false;
+	}
+	internalSettings->swappingParams.useAsyncTransfers = asyncSwapping;
+	if (swapDirectory != NULL) internalSettings->swappingParams.diskStoreDirectory = swapDirectory;
+	if (maxHostBlocks > 0) internalSettings->swappingParams.maxHostBlocks = maxHostBlocks;
+	if (strcmp(swapCompression, "lossless") == 0) internalSettings->swappingParams.compressBlocks = true;
+	else if (strcmp(swapCompression, "quantised") == 0) internalSettings->swappingParams.compressBlocks = internalSettings->swappingParams.quantiseBlocks = true;
+	else if (strcmp(swapCompression, "none") != 0) throw std::runtime_error("Unknown swap compression: " + std::string(swapCompression));
+	internalSettings->swappingParams.maxPrefetchBlocks = maxPrefetchBlocks;
+	if (strcmp(swapEviction, "lru") == 0) internalSettings->swappingParams.evictionPolicy = ITMSwappingParams::EVICTIONPOLICY_LEAST_RECENTLY_SEEN;
+	else if (strcmp(swapEviction, "invisible") != 0) throw std::runtime_error("Unknown swap eviction policy: " + std::string(swapEviction));
+	if (maxActiveBlocks > 0) internalSettings->swappingParams.maxActiveBlocks = maxActiveBlocks;
+
+	CLITrajectory groundTruth;
+	std::vector<double> groundTruthTimestamps, timestamps;
+	if (groundTruthFile != NULL && !ReadTUMTrajectory(groundTruthFile, groundTruth, &groundTruthTimestamps))
+		throw std::runtime_error("Could not read the ground truth trajectory: " + std::string(groundTruthFile));
+	if (timestampFile != NULL && !ReadTimestamps(timestampFile, timestamps))
+		throw std::runtime_error("Could not read the timestamps: " + std::string(timestampFile));
+	if (timestampFile == NULL) timestamps = groundTruthTimestamps;
 
-	ImageSourceEngine *imageSource;
+	ImageSourceEngine *imageSource = NULL;
 	IMUSourceEngine *imuSource = NULL;
 	printf("using calibration file: %s\n", calibFile);
-	if (imagesource_part2 == NULL) 
+	if (syntheticScene != NULL)
 	{
-		printf("using OpenNI device: %s\n", (imagesource_part1==NULL)?"<OpenNI default device>":imagesource_part1);
-		imageSource = new OpenNIEngine(calibFile, imagesource_part1);
-		if (imageSource->getDepthImageSize().x == 0) {
-			delete imageSource;
-			printf("trying MS Kinect device\n");
-			imageSource = new Kinect2Engine(calibFile);
+		char sceneName[64] = "";
+		Vector2i imageSize(640, 480);
+		int noFrames = 300;
+		float noiseLevel = 0.0f;
+		sscanf(syntheticScene, "%63[^:]:%dx%d:%d:%f", sceneName, &imageSize.x, &imageSize.y, &noFrames, &noiseLevel);
+
+		SyntheticSceneEngine::SceneType sceneType;
+		if (!SyntheticSceneEngine::getSceneType(sceneName, sceneType)) throw std::runtime_error("Unknown synthetic scene: " + std::string(sceneName));
+		if (imageSize.x <= 0 || imageSize.y <= 0 || noFrames <= 0) throw std::runtime_error("Invalid synthetic scene: " + std::string(syntheticScene));
+
+		printf("using synthetic scene: %s, %dx%d, %d frames, noise level %g\n", sceneName, imageSize.x, imageSize.y, noFrames, noiseLevel);
+		SyntheticSceneEngine *syntheticSource = new SyntheticSceneEngine(calibFile, sceneType, imageSize, noFrames, noiseLevel);
+
+		if (poseMask != NULL && !syntheticSource->writePoses(poseMask))
+			throw std::runtime_error("Could not write the poses to " + std::string(poseMask));
+
+		// the frames are timed by their numbers unless told otherwise
+		if (timestamps.empty())
+		{
+			for (int frameNo = 0; frameNo < noFrames; ++frameNo) timestamps.push_back(frameNo);
+		}
+
+		if (groundTruthFile == NULL)
+		{
+			for (int frameNo = 0; frameNo < noFrames; ++frameNo) groundTruth.push_back(syntheticSource->getPose(frameNo));
+			groundTruthTimestamps = timestamps;
+		}
+
+		// render the next frames while the current one is processed
+		imageSource = new PrefetchingImageSourceEngine(syntheticSource);
+	}
+	else if (imagesource_part2 == NULL) 
+	{
+		if (imagesource_part1 != NULL)
+		{
+			imageSource = new PackedSequenceReader(calibFile, imagesource_part1);
+			if (imageSource->getDepthImageSize().x == 0) {
+				delete imageSource;
+				imageSource = NULL;
+			}
+			else printf("using packed sequence: %s\n", imagesource_part1);
+		}
+
+		if (imageSource == NULL)
+		{
+			printf("using OpenNI device: %s\n", (imagesource_part1==NULL)?"<OpenNI default device>":imagesource_part1);
+			imageSource = new OpenNIEngine(calibFile, imagesource_part1);
+			if (imageSource->getDepthImageSize().x == 0) {
+				delete imageSource;
+				printf("trying MS Kinect device\n");
+				imageSource = new Kinect2Engine(calibFile);
+			}
 		}
 	} 
 	else
@@ -75,16 +312,66 @@ try
 			imageSource = new RawFileReader(calibFile, imagesource_part1, imagesource_part2, Vector2i(320, 240), 0.5f);
 			imuSource = new IMUSourceEngine(imagesource_part3);
 		}
+
+		// load and decode the next frames while the current one is processed
+		imageSource = new PrefetchingImageSourceEngine(imageSource);
 	}
 
-	ITMMainEngine *mainEngine = new ITMBasicEngine<ITMVoxel,ITMVoxelIndex>(
-		internalSettings, imageSource->getCalib(), imageSource->getRGBImageSize(), imageSource->getDepthImageSize()
-	);
+	ITMMainEngine *mainEngine = NULL;
+	ITMBasicEngine<ITMVoxel,ITMVoxelIndex> *basicEngine = NULL;
+	switch (libMode)
+	{
+	case ITMLibSettings::LIBMODE_BASIC:
+		mainEngine = basicEngine = new ITMBasicEngine<ITMVoxel,ITMVoxelIndex>(internalSettings, imageSource->getCalib(), imageSource->getRGBImageSize(), imageSource->getDepthImageSize());
+		break;
+	case ITMLibSettings::LIBMODE_BASIC_SURFELS:
+		mainEngine = new ITMBasicSurfelEngine<ITMSurfelT>(internalSettings, imageSource->getCalib(), imageSource->getRGBImageSize(), imageSource->getDepthImageSize());
+		break;
+	case ITMLibSettings::LIBMODE_LOOPCLOSURE:
+		mainEngine = new ITMMultiEngine<ITMVoxel,ITMVoxelIndex>(internalSettings, imageSource->getCalib(), imageSource->getRGBImageSize(), imageSource->getDepthImageSize());
+		break;
+	}
 
-	CLIEngine::Instance()->Initialise(imageSource, imuSource, mainEngine, internalSettings->deviceType);
+	if (profilePrefix != NULL) {
+		std::string prefix(profilePrefix);
+		if (!ITMProfiler::Instance().Open((prefix + ".csv").c_str(), (prefix + ".json").c_str(), (prefix + ".trace.json").c_str()))
+			printf("warning: could not open all profiling files\n");
+	}
+	else if (benchmarkFile != NULL) ITMProfiler::Instance().Open(NULL, NULL, NULL);
+
+	CLIEngine::Instance()->Initialise(imageSource, imuSource, mainEngine, internalSettings, recordFile);
 	CLIEngine::Instance()->Run();
+
+	ITMProfiler::Instance().Close();
+
+	const CLITrajectory &trajectory = CLIEngine::Instance()->GetTrajectory();
+	if (timestamps.size() > trajectory.size()) timestamps.resize(trajectory.size());
+	if (trajectoryFile != NULL && !WriteTUMTrajectory(trajectoryFile, trajectory, timestamps))
+		printf("error: could not write the trajectory to '%s'\n", trajectoryFile);
+
+	double rmse = 0.0, maxError = 0.0;
+	int noComparedFrames = ComputeTrajectoryError(trajectory, timestamps, groundTruth, groundTruthTimestamps, 0.02, rmse, maxError);
+	if (noComparedFrames > 0) printf("absolute trajectory error over %d frames: rmse %.4f m, max %.4f m\n", noComparedFrames, rmse, maxError);
+
+	if (benchmarkFile != NULL) {
+		FILE *f = fopen(benchmarkFile, "w");
+		if (f == NULL) throw std::runtime_error("Could not open the benchmark report: " + std::string(benchmarkFile));
+
+		fprintf(f, "{\n\"engine\":\"%s\",\n\"settings\":\"%s\",\n\"pipelined\":%s,\n", engineName, settingsProfile, pipelined ? "true" : "false");
+		fprintf(f, "\"swapping\":\"%s\",\n", !swapping ? "off" : asyncSwapping ? "async" : "sync");
+		fprintf(f, "\"frames\":%d,\n\"ms_per_frame\":%g,\n\"peak_memory_kb\":%ld,\n",
+			CLIEngine::Instance()->GetNoFrames(), CLIEngine::Instance()->processedTime, GetPeakMemoryUsage());
+		if (noComparedFrames > 0) fprintf(f, "\"ate_frames\":%d,\n\"ate_rmse_m\":%g,\n\"ate_max_m\":%g,\n", noComparedFrames, rmse, maxError);
+		fprintf(f, "\"stages\":");
+		ITMProfiler::Instance().WriteSummary(f);
+		fprintf(f, "\n}\n");
+		fclose(f);
+	}
+
 	CLIEngine::Instance()->Shutdown();
 
+	if (basicEngine != NULL && pipelined) basicEngine->GetPipelineReport().Print();
+
 	delete mainEngine;
 	delete internalSettings;
 	delete imageSource;
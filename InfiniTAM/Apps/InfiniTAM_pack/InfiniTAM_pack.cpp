@@ -0,0 +1,129 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include <cstdlib>
+#include <iostream>
+#include <string.h>
+
+#include "../../InputSource/FFMPEGReader.h"
+#include "../../InputSource/IMUSourceEngine.h"
+#include "../../InputSource/ImageSourceEngine.h"
+#include "../../InputSource/PackedSequenceWriter.h"
+
+using namespace InputSource;
+using namespace ITMLib;
+
+/** Opens the input in the same way as the InfiniTAM app: image masks
+    first, raw files if there is IMU data, and videos otherwise.
+*/
+static ImageSourceEngine *OpenImageSource(const char *calibFile, const char *filename1, const char *filename2, const char *filename_imu)
+{
+	ImageSourceEngine *imageSource = NULL;
+
+	if (filename2 != NULL)
+	{
+		if (filename_imu == NULL)
+		{
+			ImageMaskPathGenerator pathGenerator(filename1, filename2);
+			imageSource = new ImageFileReader<ImageMaskPathGenerator>(calibFile, pathGenerator);
+		}
+		else imageSource = new RawFileReader(calibFile, filename1, filename2, Vector2i(320, 240), 0.5f);
+
+		if (imageSource->getDepthImageSize().x == 0)
+		{
+			delete imageSource;
+			imageSource = NULL;
+		}
+	}
+
+	if (imageSource == NULL && filename_imu == NULL)
+	{
+		imageSource = new FFMPEGReader(calibFile, filename1, filename2);
+		if (imageSource->getDepthImageSize().x == 0)
+		{
+			delete imageSource;
+			imageSource = NULL;
+		}
+	}
+
+	return imageSource;
+}
+
+int main(int argc, char** argv)
+try
+{
+	// depth is compressed losslessly unless the first argument asks otherwise
+	PackedSequenceEncoding depthEncoding = PACKED_SEQUENCE_ENCODING_RVL;
+	if (argc > 1 && strcmp(argv[1], "--raw-depth") == 0)
+	{
+		depthEncoding = PACKED_SEQUENCE_ENCODING_RAW;
+		argv[1] = argv[0];
+		++argv; --argc;
+	}
+
+	if (argc < 4)
+	{
+		printf("usage: %s [--raw-depth] <output> <calibfile> <imagesource> [<imu>]\n"
+		       "  --raw-depth   : store the depth images uncompressed instead of with the RVL codec\n"
+		       "  <output>      : the packed sequence to write\n"
+		       "  <calibfile>   : path to a file containing intrinsic calibration parameters\n"
+		       "  <imagesource> : either two arguments specifying rgb and depth file masks\n"
+		       "                  or one or two video files (rgb and depth, or depth only)\n"
+		       "  <imu>         : file mask of IMU data that belongs to rgb and depth file masks\n"
+		       "\n"
+		       "examples:\n"
+		       "  %s teddy.itmseq ./Files/Teddy/calib.txt ./Files/Teddy/Frames/%%04i.ppm ./Files/Teddy/Frames/%%04i.pgm\n"
+		       "  %s teddy.itmseq ./Files/Teddy/calib.txt out_rgb.avi out_d.avi\n\n", argv[0], argv[0], argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const char *outputFile = argv[1];
+	const char *calibFile = argv[2];
+	const char *filename1 = argv[3];
+	const char *filename2 = argc > 4 ? argv[4] : NULL;
+	const char *filename_imu = argc > 5 ? argv[5] : NULL;
+
+	ImageSourceEngine *imageSource = OpenImageSource(calibFile, filename1, filename2, filename_imu);
+	if (imageSource == NULL)
+	{
+		fprintf(stderr, "error: could not open the image source\n");
+		return EXIT_FAILURE;
+	}
+
+	IMUSourceEngine *imuSource = filename_imu != NULL ? new IMUSourceEngine(filename_imu) : NULL;
+
+	Vector2i rgbSize = imageSource->getRGBImageSize(), depthSize = imageSource->getDepthImageSize();
+
+	PackedSequenceWriter writer;
+	if (!writer.open(outputFile, imageSource->getCalib(), rgbSize, depthSize, imuSource != NULL, depthEncoding))
+	{
+		fprintf(stderr, "error: could not open '%s' for writing\n", outputFile);
+		return EXIT_FAILURE;
+	}
+
+	ITMUChar4Image rgb(rgbSize, true, false);
+	ITMShortImage rawDepth(depthSize, true, false);
+	ITMIMUMeasurement imu;
+
+	int noFrames = 0;
+	bool success = true;
+	while (success && imageSource->hasMoreImages())
+	{
+		imageSource->getImages(&rgb, &rawDepth);
+		if (imuSource != NULL && imuSource->hasMoreMeasurements()) imuSource->getMeasurement(&imu);
+
+		success = writer.writeFrame(&rgb, &rawDepth, imuSource != NULL ? &imu : NULL);
+		if (success && ++noFrames % 100 == 0) printf("%d frames\n", noFrames);
+	}
+
+	if (!writer.close()) success = false;
+	printf("wrote %d frames to '%s'\n", noFrames, outputFile);
+
+	delete imuSource;
+	delete imageSource;
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+catch(std::exception& e)
+{
+	std::cerr << e.what() << '\n';
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,150 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "ITMAsyncViewBuilder.h"
+
+#include "../Utils/ITMProfiler.h"
+#include "../../ORUtils/NVTimer.h"
+
+#ifndef NO_CPP11
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#endif
+
+using namespace ITMLib;
+
+struct ITMAsyncViewBuilder::PrivateData
+{
+	PrivateData(ITMViewBuilder *viewBuilder, MemoryDeviceType memoryType)
+	{
+		this->viewBuilder = viewBuilder;
+		this->memoryType = memoryType;
+		busyTimer = NULL;
+		sdkCreateTimer(&busyTimer);
+
+#ifndef NO_CPP11
+		hasTask = false;
+		stopThread = false;
+		// the thread is kept for the lifetime of the engine, as OpenMP
+		// keeps a separate pool of worker threads for every native thread
+		workerThread = std::thread(&PrivateData::run, this);
+#endif
+	}
+
+	~PrivateData(void)
+	{
+#ifndef NO_CPP11
+		{
+			std::lock_guard<std::mutex> lock(taskMutex);
+			stopThread = true;
+		}
+		taskChanged.notify_all();
+		workerThread.join();
+#endif
+		sdkDeleteTimer(&busyTimer);
+	}
+
+	void updateView(void)
+	{
+		ITM_PROFILE_SCOPE("ViewBuilder");
+		sdkStartTimer(&busyTimer);
+
+		// the previous colour image is copied explicitly below, as *view
+		// held the frame before the previous one
+		if (imuMeasurement == NULL) viewBuilder->UpdateView(view, rgbImage, rawDepthImage, useBilateralFilter, false, false);
+		else viewBuilder->UpdateView(view, rgbImage, rawDepthImage, useBilateralFilter, imuMeasurement, false, false);
+
+		ITMView *newView = *view;
+		if (newView->rgb_prev == NULL) newView->rgb_prev = new ITMUChar4Image(newView->rgb->noDims, true, memoryType == MEMORYDEVICE_CUDA);
+		if (previousView != NULL)
+		{
+			newView->rgb_prev->SetFrom(previousView->rgb, memoryType == MEMORYDEVICE_CUDA ?
+				ORUtils::MemoryBlock<Vector4u>::CUDA_TO_CUDA : ORUtils::MemoryBlock<Vector4u>::CPU_TO_CPU);
+		}
+
+		sdkStopTimer(&busyTimer);
+	}
+
+#ifndef NO_CPP11
+	void run(void)
+	{
+		std::unique_lock<std::mutex> lock(taskMutex);
+		while (true)
+		{
+			taskChanged.wait(lock, [this] { return hasTask || stopThread; });
+			if (stopThread) break;
+
+			lock.unlock();
+			updateView();
+			lock.lock();
+
+			hasTask = false;
+			taskChanged.notify_all();
+		}
+	}
+
+	std::thread workerThread;
+	std::mutex taskMutex;
+	std::condition_variable taskChanged;
+	bool hasTask, stopThread;
+#endif
+
+	ITMViewBuilder *viewBuilder;
+	MemoryDeviceType memoryType;
+	StopWatchInterface *busyTimer;
+
+	// the current task
+	ITMView **view;
+	ITMUChar4Image *rgbImage;
+	ITMShortImage *rawDepthImage;
+	bool useBilateralFilter;
+	ITMIMUMeasurement *imuMeasurement;
+	const ITMView *previousView;
+};
+
+ITMAsyncViewBuilder::ITMAsyncViewBuilder(ITMViewBuilder *viewBuilder, MemoryDeviceType memoryType)
+{
+	privateData = new PrivateData(viewBuilder, memoryType);
+}
+
+ITMAsyncViewBuilder::~ITMAsyncViewBuilder(void)
+{
+	Wait();
+	delete privateData;
+}
+
+void ITMAsyncViewBuilder::StartUpdateView(ITMView **view, ITMUChar4Image *rgbImage, ITMShortImage *rawDepthImage, bool useBilateralFilter,
+	ITMIMUMeasurement *imuMeasurement, const ITMView *previousView)
+{
+	Wait();
+
+	privateData->view = view;
+	privateData->rgbImage = rgbImage;
+	privateData->rawDepthImage = rawDepthImage;
+	privateData->useBilateralFilter = useBilateralFilter;
+	privateData->imuMeasurement = imuMeasurement;
+	privateData->previousView = previousView;
+
+#ifndef NO_CPP11
+	{
+		std::lock_guard<std::mutex> lock(privateData->taskMutex);
+		privateData->hasTask = true;
+	}
+	privateData->taskChanged.notify_all();
+#else
+	privateData->updateView();
+#endif
+}
+
+void ITMAsyncViewBuilder::Wait(void)
+{
+#ifndef NO_CPP11
+	std::unique_lock<std::mutex> lock(privateData->taskMutex);
+	privateData->taskChanged.wait(lock, [this] { return !privateData->hasTask; });
+#endif
+}
+
+double ITMAsyncViewBuilder::GetBusyTime(void) const
+{
+	return sdkGetTimerValue(&privateData->busyTimer);
+}
@@ -0,0 +1,44 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include "../Engines/ViewBuilding/Interface/ITMViewBuilder.h"
+
+namespace ITMLib
+{
+	/** \brief
+	    Runs ITMViewBuilder::UpdateView() on a background thread, so
+	    that the view of the next frame can be built while the
+	    current one is tracked and fused.
+
+	    Only one view is built at a time. Neither the view builder
+	    nor the view that is being built may be used by anyone else
+	    until Wait() has returned. Without C++11 the views are built
+	    synchronously in StartUpdateView().
+	*/
+	class ITMAsyncViewBuilder
+	{
+	private:
+		struct PrivateData;
+		PrivateData *privateData;
+
+	public:
+		ITMAsyncViewBuilder(ITMViewBuilder *viewBuilder, MemoryDeviceType memoryType);
+		~ITMAsyncViewBuilder(void);
+
+		/** Starts building *view from the given images, which must
+		    stay unchanged until Wait() returns. As the caller usually
+		    alternates between two views, rgb_prev of the new view is
+		    set to the colour image of @p previousView, if given,
+		    rather than to what *view contained before.
+		*/
+		void StartUpdateView(ITMView **view, ITMUChar4Image *rgbImage, ITMShortImage *rawDepthImage, bool useBilateralFilter,
+			ITMIMUMeasurement *imuMeasurement, const ITMView *previousView);
+
+		/// Waits until the view passed to StartUpdateView() is ready
+		void Wait(void);
+
+		/// Total time spent building views so far in ms, only valid after Wait()
+		double GetBusyTime(void) const;
+	};
+}
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "ITMAsyncViewBuilder.h"
 #include "ITMDenseMapper.h"
 #include "ITMMainEngine.h"
 #include "ITMTrackingController.h"
@@ -10,9 +11,12 @@
 #include "../Engines/ViewBuilding/Interface/ITMViewBuilder.h"
 #include "../Engines/Visualisation/Interface/ITMVisualisationEngine.h"
 #include "../Objects/Misc/ITMIMUCalibrator.h"
+#include "../Objects/Misc/ITMPipelineReport.h"
 
 #include "../../FernRelocLib/Relocaliser.h"
 
+class StopWatchInterface;
+
 namespace ITMLib
 {
 	template <typename TVoxel, typename TIndex>
@@ -46,6 +50,17 @@ namespace ITMLib
 		/// Pointer for storing the current input frame
 		ITMView *view;
 
+		/// In pipelined mode, the view of the frame after the current one
+		ITMView *nextView;
+		bool hasPendingView;
+		ITMAsyncViewBuilder *asyncViewBuilder;
+
+		int noTrackedFrames;
+		StopWatchInterface *timer_total, *timer_viewBuilding, *timer_tracking, *timer_fusion, *timer_raycast, *timer_wait;
+
+		/// Tracks the current view and fuses it into the scene
+		ITMTrackingState::TrackingResult ProcessView(void);
+
 		/// Pointer to the current camera pose and additional tracking information
 		ITMTrackingState *trackingState;
 
@@ -56,8 +71,23 @@ namespace ITMLib
 		/// Gives access to the internal world representation
 		ITMScene<TVoxel, TIndex>* GetScene(void) { return scene; }
 
+		/** \brief Processes a frame
+		    With ITMLibSettings::usePipelinedProcessing, the view of
+		    this frame is built in the background while the previous
+		    frame is tracked and fused. This hides the time spent in
+		    view building, at the cost of one frame of latency: the
+		    result, the tracking state and the view all belong to the
+		    previous frame, and the first call only returns
+		    TRACKING_FAILED. The images must stay unchanged until the
+		    call returns, but may be reused afterwards.
+		*/
 		ITMTrackingState::TrackingResult ProcessFrame(ITMUChar4Image *rgbImage, ITMShortImage *rawDepthImage, ITMIMUMeasurement *imuMeasurement = NULL);
 
+		ITMTrackingState::TrackingResult FlushPipeline(void);
+
+		/// Time spent in the different stages of ProcessFrame() so far
+		ITMPipelineReport GetPipelineReport(void);
+
 		/// Extracts a mesh from the current scene and saves it to the model file specified by the file name
 		void SaveSceneToMesh(const char *fileName);
 
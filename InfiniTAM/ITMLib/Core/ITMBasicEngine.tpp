@@ -11,6 +11,9 @@
 
 #include "../../ORUtils/NVTimer.h"
 #include "../../ORUtils/FileUtils.h"
+#include "../Utils/ITMProfiler.h"
+
+#include <algorithm>
 
 //#define OUTPUT_TRAJECTORY_QUATERNIONS
 
@@ -24,7 +27,7 @@ ITMBasicEngine<TVoxel,TIndex>::ITMBasicEngine(const ITMLibSettings *settings, co
 	if ((imgSize_d.x == -1) || (imgSize_d.y == -1)) imgSize_d = imgSize_rgb;
 
 	MemoryDeviceType memoryType = settings->GetMemoryType();
-	this->scene = new ITMScene<TVoxel,TIndex>(&settings->sceneParams, settings->swappingMode == ITMLibSettings::SWAPPINGMODE_ENABLED, memoryType);
+	this->scene = new ITMScene<TVoxel,TIndex>(&settings->sceneParams, settings->swappingMode == ITMLibSettings::SWAPPINGMODE_ENABLED, memoryType, settings->swappingParams);
 
 	const ITMLibSettings::DeviceType deviceType = settings->deviceType;
 
@@ -52,6 +55,17 @@ ITMBasicEngine<TVoxel,TIndex>::ITMBasicEngine(const ITMLibSettings *settings, co
 	tracker->UpdateInitialPose(trackingState);
 
 	view = NULL; // will be allocated by the view builder
+	nextView = NULL;
+	hasPendingView = false;
+	asyncViewBuilder = settings->usePipelinedProcessing ? new ITMAsyncViewBuilder(viewBuilder, memoryType) : NULL;
+
+	noTrackedFrames = 0;
+	timer_total = NULL; sdkCreateTimer(&timer_total);
+	timer_viewBuilding = NULL; sdkCreateTimer(&timer_viewBuilding);
+	timer_tracking = NULL; sdkCreateTimer(&timer_tracking);
+	timer_fusion = NULL; sdkCreateTimer(&timer_fusion);
+	timer_raycast = NULL; sdkCreateTimer(&timer_raycast);
+	timer_wait = NULL; sdkCreateTimer(&timer_wait);
 	
 	if (settings->behaviourOnFailure == settings->FAILUREMODE_RELOCALISE)
 		relocaliser = new FernRelocLib::Relocaliser<float>(imgSize_d, Vector2f(settings->sceneParams.viewFrustum_min, settings->sceneParams.viewFrustum_max), 0.2f, 500, 4);
@@ -81,11 +95,22 @@ ITMBasicEngine<TVoxel,TIndex>::~ITMBasicEngine()
 	delete tracker;
 	delete imuCalibrator;
 
+	// stops the view building thread before the view builder goes away
+	if (asyncViewBuilder != NULL) delete asyncViewBuilder;
+
 	delete lowLevelEngine;
 	delete viewBuilder;
 
 	delete trackingState;
 	if (view != NULL) delete view;
+	if (nextView != NULL) delete nextView;
+
+	sdkDeleteTimer(&timer_total);
+	sdkDeleteTimer(&timer_viewBuilding);
+	sdkDeleteTimer(&timer_tracking);
+	sdkDeleteTimer(&timer_fusion);
+	sdkDeleteTimer(&timer_raycast);
+	sdkDeleteTimer(&timer_wait);
 
 	delete visualisationEngine;
 
@@ -99,8 +124,11 @@ template <typename TVoxel, typename TIndex>
 void ITMBasicEngine<TVoxel,TIndex>::SaveSceneToMesh(const char *objFileName)
 {
 	if (meshingEngine == NULL) return;
-	ITMMesh *mesh = new ITMMesh(settings->GetMemoryType());
-	meshingEngine->MeshScene(mesh, scene);
+	ITMMesh *mesh = new ITMMesh(settings->GetMemoryType(), ITMMesh::GetMaxTriangles(scene->index.getNumAllocatedVoxelBlocks()));
+	{
+		ITM_PROFILE_SCOPE("Meshing");
+		meshingEngine->MeshScene(mesh, scene);
+	}
 	mesh->WriteSTL(objFileName);
 
 	delete mesh;
@@ -242,13 +270,83 @@ static void QuaternionFromRotationMatrix(const double *matrix, double *q) {
 template <typename TVoxel, typename TIndex>
 ITMTrackingState::TrackingResult ITMBasicEngine<TVoxel,TIndex>::ProcessFrame(ITMUChar4Image *rgbImage, ITMShortImage *rawDepthImage, ITMIMUMeasurement *imuMeasurement)
 {
-	// prepare image and turn it into a depth image
-	if (imuMeasurement == NULL) viewBuilder->UpdateView(&view, rgbImage, rawDepthImage, settings->useBilateralFilter);
-	else viewBuilder->UpdateView(&view, rgbImage, rawDepthImage, settings->useBilateralFilter, imuMeasurement);
+	ITMTrackingState::TrackingResult trackerResult = ITMTrackingState::TRACKING_FAILED;
+	sdkStartTimer(&timer_total);
+
+	if (asyncViewBuilder == NULL || !mainProcessingActive)
+	{
+		// prepare image and turn it into a depth image
+		ITM_PROFILE_SCOPE("ViewBuilder");
+		sdkStartTimer(&timer_viewBuilding);
+		if (imuMeasurement == NULL) viewBuilder->UpdateView(&view, rgbImage, rawDepthImage, settings->useBilateralFilter);
+		else viewBuilder->UpdateView(&view, rgbImage, rawDepthImage, settings->useBilateralFilter, imuMeasurement);
+		sdkStopTimer(&timer_viewBuilding);
+
+		// a frame that is still pending is dropped along with this one
+		hasPendingView = false;
+
+		if (mainProcessingActive) trackerResult = ProcessView();
+	}
+	else if (!hasPendingView)
+	{
+		// nothing to overlap with yet, just keep this frame for the next call
+		asyncViewBuilder->StartUpdateView(&nextView, rgbImage, rawDepthImage, settings->useBilateralFilter, imuMeasurement, view);
+		asyncViewBuilder->Wait();
+		hasPendingView = true;
+	}
+	else
+	{
+		// process the frame from the last call while building the view of this one
+		std::swap(view, nextView);
+		asyncViewBuilder->StartUpdateView(&nextView, rgbImage, rawDepthImage, settings->useBilateralFilter, imuMeasurement, view);
+
+		trackerResult = ProcessView();
+
+		sdkStartTimer(&timer_wait);
+		asyncViewBuilder->Wait();
+		sdkStopTimer(&timer_wait);
+	}
+
+	sdkStopTimer(&timer_total);
+	return trackerResult;
+}
+
+template <typename TVoxel, typename TIndex>
+ITMTrackingState::TrackingResult ITMBasicEngine<TVoxel,TIndex>::FlushPipeline(void)
+{
+	if (!hasPendingView) return ITMTrackingState::TRACKING_FAILED;
+
+	sdkStartTimer(&timer_total);
+	std::swap(view, nextView);
+	hasPendingView = false;
+	ITMTrackingState::TrackingResult trackerResult = ProcessView();
+	sdkStopTimer(&timer_total);
+
+	return trackerResult;
+}
+
+template <typename TVoxel, typename TIndex>
+ITMPipelineReport ITMBasicEngine<TVoxel,TIndex>::GetPipelineReport(void)
+{
+	ITMPipelineReport report;
+	report.noFrames = noTrackedFrames;
+	report.totalTime = sdkGetTimerValue(&timer_total);
+	report.viewBuildingTime = sdkGetTimerValue(&timer_viewBuilding);
+	if (asyncViewBuilder != NULL) report.viewBuildingTime += asyncViewBuilder->GetBusyTime();
+	report.trackingTime = sdkGetTimerValue(&timer_tracking);
+	report.fusionTime = sdkGetTimerValue(&timer_fusion);
+	report.raycastTime = sdkGetTimerValue(&timer_raycast);
+	report.waitTime = sdkGetTimerValue(&timer_wait);
+	return report;
+}
 
-	if (!mainProcessingActive) return ITMTrackingState::TRACKING_FAILED;
+template <typename TVoxel, typename TIndex>
+ITMTrackingState::TrackingResult ITMBasicEngine<TVoxel,TIndex>::ProcessView(void)
+{
+	noTrackedFrames++;
 
 	// tracking
+	sdkStartTimer(&timer_tracking);
 	ORUtils::SE3Pose oldPose(*(trackingState->pose_d));
 	if (trackingActive) trackingController->Track(trackingState, view);
 
@@ -273,10 +371,14 @@ ITMTrackingState::TrackingResult ITMBasicEngine<TVoxel,TIndex>::ProcessFrame(ITM
 		if (trackerResult == ITMTrackingState::TRACKING_GOOD && relocalisationCount > 0) relocalisationCount--;
 
 		int NN; float distances;
-		view->depth->UpdateHostFromDevice();
+		bool hasAddedKeyframe;
+		{
+			ITM_PROFILE_SCOPE("Relocaliser");
+			view->depth->UpdateHostFromDevice();
 
-		//find and add keyframe, if necessary
-		bool hasAddedKeyframe = relocaliser->ProcessFrame(view->depth, trackingState->pose_d, 0, 1, &NN, &distances, trackerResult == ITMTrackingState::TRACKING_GOOD && relocalisationCount == 0);
+			//find and add keyframe, if necessary
+			hasAddedKeyframe = relocaliser->ProcessFrame(view->depth, trackingState->pose_d, 0, 1, &NN, &distances, trackerResult == ITMTrackingState::TRACKING_GOOD && relocalisationCount == 0);
+		}
 
 		//frame not added and tracking failed -> we need to relocalise
 		if (!hasAddedKeyframe && trackerResult == ITMTrackingState::TRACKING_FAILED)
@@ -296,11 +398,14 @@ ITMTrackingState::TrackingResult ITMBasicEngine<TVoxel,TIndex>::ProcessFrame(ITM
 			trackerResult = trackingState->trackerResult;
 		}
 	}
+	sdkStopTimer(&timer_tracking);
 
 	bool didFusion = false;
 	if ((trackerResult == ITMTrackingState::TRACKING_GOOD || !trackingInitialised) && (fusionActive) && (relocalisationCount == 0)) {
 		// fusion
+		sdkStartTimer(&timer_fusion);
 		denseMapper->ProcessFrame(view, trackingState, scene, renderState_live);
+		sdkStopTimer(&timer_fusion);
 		didFusion = true;
 		if (framesProcessed > 50) trackingInitialised = true;
 
@@ -309,6 +414,7 @@ ITMTrackingState::TrackingResult ITMBasicEngine<TVoxel,TIndex>::ProcessFrame(ITM
 
 	if (trackerResult == ITMTrackingState::TRACKING_GOOD || trackerResult == ITMTrackingState::TRACKING_POOR)
 	{
+		sdkStartTimer(&timer_raycast);
 		if (!didFusion) denseMapper->UpdateVisibleList(view, trackingState, scene, renderState_live);
 
 		// raycast to renderState_live for tracking and free visualisation
@@ -321,6 +427,7 @@ ITMTrackingState::TrackingResult ITMBasicEngine<TVoxel,TIndex>::ProcessFrame(ITM
 
 			kfRaycast->SetFrom(renderState_live->raycastImage, memoryCopyDirection);
 		}
+		sdkStopTimer(&timer_raycast);
 	}
 	else *trackingState->pose_d = oldPose;
 
@@ -5,13 +5,39 @@
 #include "../Engines/Reconstruction/ITMSceneReconstructionEngineFactory.h"
 #include "../Engines/Swapping/ITMSwappingEngineFactory.h"
 #include "../Objects/RenderStates/ITMRenderState_VH.h"
+#include "../Utils/ITMProfiler.h"
 using namespace ITMLib;
 
+namespace
+{
+	// scene statistics for the profiler, which only make sense for voxel block hashes
+	template<class TVoxel>
+	void SetSceneCounters(ITMScene<TVoxel,ITMVoxelBlockHash> *scene, const ITMRenderState *renderState)
+	{
+		ITM_PROFILE_COUNTER("visible blocks", ((const ITMRenderState_VH*)renderState)->noVisibleEntries);
+		ITM_PROFILE_COUNTER("allocated blocks", scene->index.getNumAllocatedVoxelBlocks() - scene->localVBA.lastFreeBlockId - 1);
+		ITM_PROFILE_COUNTER("used excess list entries", scene->index.getExcessListSize() - scene->index.GetLastFreeExcessListId() - 1);
+		if (scene->globalCache != NULL)
+		{
+			ITM_PROFILE_COUNTER("stored blocks", scene->globalCache->GetNoStoredBlocks());
+			ITM_PROFILE_COUNTER("blocks on disk", scene->globalCache->GetNoBlocksOnDisk());
+			if (scene->globalCache->GetNoHostBlocks() > 0)
+				ITM_PROFILE_COUNTER("host bytes per stored block", scene->globalCache->GetStoredMemoryUsage() / scene->globalCache->GetNoHostBlocks());
+		}
+	}
+
+	template<class TVoxel>
+	void SetSceneCounters(ITMScene<TVoxel,ITMPlainVoxelArray> *scene, const ITMRenderState *renderState) { }
+}
+
 template<class TVoxel, class TIndex>
 ITMDenseMapper<TVoxel, TIndex>::ITMDenseMapper(const ITMLibSettings *settings)
 {
+	if (settings->swappingMode != ITMLibSettings::SWAPPINGMODE_DISABLED && settings->sceneParams.allowHashGrowth)
+		throw std::runtime_error("Swapping needs a voxel block array of fixed size, set sceneParams.allowHashGrowth to false");
+
 	sceneRecoEngine = ITMSceneReconstructionEngineFactory::MakeSceneReconstructionEngine<TVoxel,TIndex>(settings->deviceType);
-	swappingEngine = settings->swappingMode != ITMLibSettings::SWAPPINGMODE_DISABLED ? ITMSwappingEngineFactory::MakeSwappingEngine<TVoxel,TIndex>(settings->deviceType) : NULL;
+	swappingEngine = settings->swappingMode != ITMLibSettings::SWAPPINGMODE_DISABLED ? ITMSwappingEngineFactory::MakeSwappingEngine<TVoxel,TIndex>(settings->swappingParams, settings->deviceType) : NULL;
 
 	swappingMode = settings->swappingMode;
 }
@@ -33,14 +59,28 @@ template<class TVoxel, class TIndex>
 void ITMDenseMapper<TVoxel,TIndex>::ProcessFrame(const ITMView *view, const ITMTrackingState *trackingState, ITMScene<TVoxel,TIndex> *scene, ITMRenderState *renderState)
 {
 	// allocation
-	sceneRecoEngine->AllocateSceneFromDepth(scene, view, trackingState, renderState);
+	{
+		ITM_PROFILE_SCOPE("AllocateSceneFromDepth");
+		sceneRecoEngine->AllocateSceneFromDepth(scene, view, trackingState, renderState);
+	}
 
 	// integration
-	sceneRecoEngine->IntegrateIntoScene(scene, view, trackingState, renderState);
+	{
+		ITM_PROFILE_SCOPE("IntegrateIntoScene");
+		sceneRecoEngine->IntegrateIntoScene(scene, view, trackingState, renderState);
+	}
 
 	if (swappingEngine != NULL) {
-		// swapping: CPU -> GPU
-		if (swappingMode == ITMLibSettings::SWAPPINGMODE_ENABLED) swappingEngine->IntegrateGlobalIntoLocal(scene, renderState);
+		ITM_PROFILE_SCOPE("Swapping");
+
+		// swapping: CPU -> GPU, including the blocks the camera is predicted to see next
+		if (swappingMode == ITMLibSettings::SWAPPINGMODE_ENABLED)
+		{
+			int noPrefetchedBlocks = swappingEngine->PrefetchFromGlobalMemory(scene, view, trackingState, renderState);
+			ITM_PROFILE_COUNTER("prefetched blocks", noPrefetchedBlocks);
+
+			swappingEngine->IntegrateGlobalIntoLocal(scene, renderState);
+		}
 
 		// swapping: GPU -> CPU
 		switch (swappingMode)
@@ -55,10 +95,15 @@ void ITMDenseMapper<TVoxel,TIndex>::ProcessFrame(const ITMView *view, const ITMT
 			break;
 		} 
 	}
+
+#ifdef WITH_PROFILING
+	SetSceneCounters(scene, renderState);
+#endif
 }
 
 template<class TVoxel, class TIndex>
 void ITMDenseMapper<TVoxel,TIndex>::UpdateVisibleList(const ITMView *view, const ITMTrackingState *trackingState, ITMScene<TVoxel,TIndex> *scene, ITMRenderState *renderState, bool resetVisibleList)
 {
+	ITM_PROFILE_SCOPE("AllocateSceneFromDepth");
 	sceneRecoEngine->AllocateSceneFromDepth(scene, view, trackingState, renderState, true, resetVisibleList);
 }
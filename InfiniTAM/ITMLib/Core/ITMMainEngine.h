@@ -71,6 +71,13 @@ namespace ITMLib
 		/// Process a frame with rgb and depth images and optionally a corresponding imu measurement
         virtual ITMTrackingState::TrackingResult ProcessFrame(ITMUChar4Image *rgbImage, ITMShortImage *rawDepthImage, ITMIMUMeasurement *imuMeasurement = NULL) = 0;
 
+		/** Processes a frame that ProcessFrame() has received but not
+		    yet processed, which can only happen in pipelined mode. Call
+		    this after the last frame of a sequence. Returns
+		    TRACKING_FAILED if there was no such frame.
+		*/
+		virtual ITMTrackingState::TrackingResult FlushPipeline(void) { return ITMTrackingState::TRACKING_FAILED; }
+
 		/// Get a result image as output
 		virtual Vector2i GetImageSize(void) const = 0;
 
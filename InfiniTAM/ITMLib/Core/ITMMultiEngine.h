@@ -57,6 +57,13 @@ namespace ITMLib
 
 		ITMTrackingState* GetTrackingState(void);
 
+		/** The camera pose of GetTrackingState(), which is relative
+		    to the primary local map, combined with the estimated
+		    global pose of that map, i.e. the transformation from
+		    global coordinates to the camera.
+		*/
+		ORUtils::SE3Pose GetGlobalCameraPose(void);
+
 		/// Process a frame with rgb and depth images and (optionally) a corresponding imu measurement
 		ITMTrackingState::TrackingResult ProcessFrame(ITMUChar4Image *rgbImage, ITMShortImage *rawDepthImage, ITMIMUMeasurement *imuMeasurement = NULL);
 
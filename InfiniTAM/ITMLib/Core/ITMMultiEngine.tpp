@@ -7,6 +7,7 @@
 #include "../Engines/Visualisation/ITMVisualisationEngineFactory.h"
 #include "../Engines/Visualisation/ITMMultiVisualisationEngineFactory.h"
 #include "../Trackers/ITMTrackerFactory.h"
+#include "../Utils/ITMProfiler.h"
 
 #include "../../MiniSlamGraphLib/QuaternionHelpers.h"
 
@@ -118,6 +119,14 @@ ITMTrackingState* ITMMultiEngine<TVoxel, TIndex>::GetTrackingState(void)
 	return mapManager->getLocalMap(idx)->trackingState;
 }
 
+template <typename TVoxel, typename TIndex>
+ORUtils::SE3Pose ITMMultiEngine<TVoxel, TIndex>::GetGlobalCameraPose(void)
+{
+	int idx = mActiveDataManager->findPrimaryLocalMapIdx();
+	if (idx < 0) idx = 0;
+	return ORUtils::SE3Pose(mapManager->getLocalMap(idx)->trackingState->pose_d->GetM() * mapManager->getEstimatedGlobalPose(idx).GetM());
+}
+
 // -whenever a new local scene is added, add to list of "to be established 3D relations"
 // - whenever a relocalisation is detected, add to the same list, preserving any existing information on that 3D relation
 //
@@ -147,8 +156,11 @@ ITMTrackingState::TrackingResult ITMMultiEngine<TVoxel, TIndex>::ProcessFrame(IT
 	ITMTrackingState::TrackingResult primaryLocalMapTrackingResult;
 
 	// prepare image and turn it into a depth image
-	if (imuMeasurement == NULL) viewBuilder->UpdateView(&view, rgbImage, rawDepthImage, settings->useBilateralFilter);
-	else viewBuilder->UpdateView(&view, rgbImage, rawDepthImage, settings->useBilateralFilter, imuMeasurement);
+	{
+		ITM_PROFILE_SCOPE("ViewBuilder");
+		if (imuMeasurement == NULL) viewBuilder->UpdateView(&view, rgbImage, rawDepthImage, settings->useBilateralFilter);
+		else viewBuilder->UpdateView(&view, rgbImage, rawDepthImage, settings->useBilateralFilter, imuMeasurement);
+	}
 
 	// find primary data, if available
 	int primaryDataIdx = mActiveDataManager->findPrimaryDataIdx();
@@ -193,7 +205,11 @@ ITMTrackingState::TrackingResult ITMMultiEngine<TVoxel, TIndex>::ProcessFrame(IT
 
 			//check if relocaliser has fired
 			ORUtils::SE3Pose *pose = primaryLocalMapIdx >= 0 ? mapManager->getLocalMap(primaryLocalMapIdx)->trackingState->pose_d : NULL;
-			bool hasAddedKeyframe = relocaliser->ProcessFrame(view->depth, pose, primaryLocalMapIdx, k_loopcloseneighbours, NN, distances, primaryTrackingSuccess);
+			bool hasAddedKeyframe;
+			{
+				ITM_PROFILE_SCOPE("Relocaliser");
+				hasAddedKeyframe = relocaliser->ProcessFrame(view->depth, pose, primaryLocalMapIdx, k_loopcloseneighbours, NN, distances, primaryTrackingSuccess);
+			}
 
 			//frame not added and tracking failed -> we need to relocalise
 			if (!hasAddedKeyframe)
@@ -302,9 +318,12 @@ void ITMMultiEngine<TVoxel, TIndex>::SaveSceneToMesh(const char *modelFileName)
 {
 	if (meshingEngine == NULL) return;
 
-	ITMMesh *mesh = new ITMMesh(settings->GetMemoryType());
+	ITMMesh *mesh = new ITMMesh(settings->GetMemoryType(), ITMMesh::GetMaxTriangles(settings->sceneParams.noVoxelBlocks));
 
-	meshingEngine->MeshScene(mesh, *mapManager);
+	{
+		ITM_PROFILE_SCOPE("Meshing");
+		meshingEngine->MeshScene(mesh, *mapManager);
+	}
 	mesh->WriteSTL(modelFileName);
 	
 	delete mesh;
@@ -8,6 +8,7 @@
 #include "../Engines/Visualisation/Interface/ITMVisualisationEngine.h"
 #include "../Trackers/Interface/ITMTracker.h"
 #include "../Utils/ITMLibSettings.h"
+#include "../Utils/ITMProfiler.h"
 
 namespace ITMLib
 {
@@ -22,6 +23,7 @@ namespace ITMLib
 	public:
 		void Track(ITMTrackingState *trackingState, const ITMView *view)
 		{
+			ITM_PROFILE_SCOPE("Tracking");
 			if (!tracker->requiresPointCloudRendering() || trackingState->age_pointCloud != -1)
 				tracker->TrackCamera(trackingState, view);
 		}
@@ -33,6 +35,8 @@ namespace ITMLib
 			if (!tracker->requiresPointCloudRendering())
 				return;
 
+			ITM_PROFILE_SCOPE("Raycast");
+
 			//render for tracking
 			bool requiresColourRendering = tracker->requiresColourRendering();
 			bool requiresFullRendering = trackingState->TrackerFarFromPointCloud() || !settings->useApproximateRaycast;
@@ -69,6 +73,8 @@ namespace ITMLib
 			if (!tracker->requiresPointCloudRendering())
 				return;
 
+			ITM_PROFILE_SCOPE("Raycast");
+
 			//render for tracking
 			bool requiresColourRendering = tracker->requiresColourRendering();
 			bool requiresFullRendering = trackingState->TrackerFarFromPointCloud() || !settings->useApproximateRaycast;
@@ -10,20 +10,25 @@ void ITMMeshingEngine_CPU<TVoxel, ITMVoxelBlockHash>::MeshScene(ITMMesh *mesh, c
 {
 	ITMMesh::Triangle *triangles = mesh->triangles->GetData(MEMORYDEVICE_CPU);
 	const TVoxel *localVBA = scene->localVBA.GetVoxelBlocks();
+	const ITMVoxelBlockSummary *blockSummaries = scene->localVBA.GetBlockSummaries();
 	const ITMHashEntry *hashTable = scene->index.GetEntries();
+	const int *allocatedEntryIDs = scene->index.GetAllocatedEntryIDs();
 
-	int noTriangles = 0, noMaxTriangles = mesh->noMaxTriangles, noTotalEntries = scene->index.noTotalEntries;
+	int noTriangles = 0, noMaxTriangles = mesh->noMaxTriangles, noAllocatedEntries = scene->index.GetNumAllocatedEntries();
 	float factor = scene->sceneParams->voxelSize;
 
 	mesh->triangles->Clear();
 
-	for (int entryId = 0; entryId < noTotalEntries; entryId++)
+	for (int listIdx = 0; listIdx < noAllocatedEntries; listIdx++)
 	{
 		Vector3i globalPos;
-		const ITMHashEntry &currentHashEntry = hashTable[entryId];
+		const ITMHashEntry &currentHashEntry = hashTable[allocatedEntryIDs[listIdx]];
 
 		if (currentHashEntry.ptr < 0) continue;
 
+		// buildVertList() skips every cube with a corner at 1, and the first corner is in this block
+		if (blockSummaries[currentHashEntry.ptr].minSDF >= 1.0f) continue;
+
 		globalPos = currentHashEntry.pos.toInt() * SDF_BLOCK_SIZE;
 
 		for (int z = 0; z < SDF_BLOCK_SIZE; z++) for (int y = 0; y < SDF_BLOCK_SIZE; y++) for (int x = 0; x < SDF_BLOCK_SIZE; x++)
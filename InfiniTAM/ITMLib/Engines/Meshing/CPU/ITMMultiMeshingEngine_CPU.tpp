@@ -30,24 +30,27 @@ inline void ITMMultiMeshingEngine_CPU<TVoxel, ITMVoxelBlockHash>::MeshScene(ITMM
 		hashTables.posesInv[localMapId].m32 /= sceneParams.voxelSize;
 
 		hashTables.index[localMapId] = sceneManager.getLocalMap(localMapId)->scene->index.getIndexData();
+		hashTables.noTotalEntries[localMapId] = sceneManager.getLocalMap(localMapId)->scene->index.noTotalEntries;
 		localVBAs.voxels[localMapId] = sceneManager.getLocalMap(localMapId)->scene->localVBA.GetVoxelBlocks();
 	}
 
 	ITMMesh::Triangle *triangles = mesh->triangles->GetData(MEMORYDEVICE_CPU);
 	mesh->triangles->Clear();
 
-	int noTriangles = 0, noMaxTriangles = mesh->noMaxTriangles, noTotalEntriesPerLocalMap = ITMVoxelBlockHash::noTotalEntries;
+	int noTriangles = 0, noMaxTriangles = mesh->noMaxTriangles;
 	float factor = sceneParams.voxelSize;
 
 	// very dumb rendering -- likely to generate lots of duplicates
 	for (int localMapId = 0; localMapId < numLocalMaps; ++localMapId)
 	{
 		ITMHashEntry *hashTable = hashTables.index[localMapId];
+		const int *allocatedEntryIDs = sceneManager.getLocalMap(localMapId)->scene->index.GetAllocatedEntryIDs();
+		int noAllocatedEntries = sceneManager.getLocalMap(localMapId)->scene->index.GetNumAllocatedEntries();
 
-		for (int entryId = 0; entryId < noTotalEntriesPerLocalMap; entryId++)
+		for (int listIdx = 0; listIdx < noAllocatedEntries; listIdx++)
 		{
 			Vector3i globalPos;
-			const ITMHashEntry &currentHashEntry = hashTable[entryId];
+			const ITMHashEntry &currentHashEntry = hashTable[allocatedEntryIDs[listIdx]];
 
 			if (currentHashEntry.ptr < 0) continue;
 
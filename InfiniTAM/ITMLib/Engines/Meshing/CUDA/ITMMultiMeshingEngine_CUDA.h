@@ -20,6 +20,7 @@ namespace ITMLib
 	private:
 		unsigned int  *noTriangles_device;
 		Vector4s *visibleBlockGlobalPos_device;
+		int noVisibleBlockGlobalPosPerLocalMap;
 
 	public:
 		typedef typename ITMMultiIndex<ITMVoxelBlockHash>::IndexData MultiIndexData;
@@ -18,6 +18,26 @@ namespace ITMLib
 		ORUtils::MemoryBlock<unsigned char> *entriesAllocType;
 		ORUtils::MemoryBlock<Vector4s> *blockCoords;
 
+		/** Hash entries that may need allocation, as found by
+		    each row of the depth image, and the number of them
+		    found by each row.
+		*/
+		ORUtils::MemoryBlock<int> *allocationCandidates;
+		ORUtils::MemoryBlock<int> *noAllocationCandidates;
+
+		/** Deduplicated allocation requests, as the hash entry
+		    index and the allocation type of each.
+		*/
+		ORUtils::MemoryBlock<int> *allocationRequestIDs;
+		ORUtils::MemoryBlock<int> *allocationRequestTypes;
+
+		/** Grow the voxel block array and the excess list of
+		    the scene, if that is needed to allocate another
+		    @p noNeededBlocks voxel blocks, @p noNeededExcessEntries
+		    of which go into the excess list.
+		*/
+		void GrowScene(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, const ITMRenderState *renderState, int noNeededBlocks, int noNeededExcessEntries);
+
 	public:
 		void ResetScene(ITMScene<TVoxel, ITMVoxelBlockHash> *scene);
 
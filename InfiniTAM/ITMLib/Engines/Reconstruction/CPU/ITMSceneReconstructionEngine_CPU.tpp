@@ -1,17 +1,35 @@
 // Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
 
 #include "ITMSceneReconstructionEngine_CPU.h"
+#include "ITMVoxelBlockIntegration_CPU.h"
 
 #include "../Shared/ITMSceneReconstructionEngine_Shared.h"
 #include "../../../Objects/RenderStates/ITMRenderState_VH.h"
+
+#include <atomic>
+
 using namespace ITMLib;
 
+// pop an id off a free list, returns -1 and leaves the list alone if it is empty
+static inline int popFreeListId(std::atomic<int> &lastFreeId)
+{
+	int id = lastFreeId.load();
+	while (id >= 0 && !lastFreeId.compare_exchange_weak(id, id - 1)) ;
+	return id;
+}
+
 template<class TVoxel>
 ITMSceneReconstructionEngine_CPU<TVoxel,ITMVoxelBlockHash>::ITMSceneReconstructionEngine_CPU(void) 
 {
-	int noTotalEntries = ITMVoxelBlockHash::noTotalEntries;
-	entriesAllocType = new ORUtils::MemoryBlock<unsigned char>(noTotalEntries, MEMORYDEVICE_CPU);
-	blockCoords = new ORUtils::MemoryBlock<Vector4s>(noTotalEntries, MEMORYDEVICE_CPU);
+	// grown to the size of the scene in AllocateSceneFromDepth
+	entriesAllocType = new ORUtils::MemoryBlock<unsigned char>(1, MEMORYDEVICE_CPU);
+	blockCoords = new ORUtils::MemoryBlock<Vector4s>(1, MEMORYDEVICE_CPU);
+	allocationRequestIDs = new ORUtils::MemoryBlock<int>(1, MEMORYDEVICE_CPU);
+	allocationRequestTypes = new ORUtils::MemoryBlock<int>(1, MEMORYDEVICE_CPU);
+
+	// resized to the depth image in AllocateSceneFromDepth
+	allocationCandidates = new ORUtils::MemoryBlock<int>(1, MEMORYDEVICE_CPU);
+	noAllocationCandidates = new ORUtils::MemoryBlock<int>(1, MEMORYDEVICE_CPU);
 }
 
 template<class TVoxel>
@@ -19,6 +37,10 @@ ITMSceneReconstructionEngine_CPU<TVoxel,ITMVoxelBlockHash>::~ITMSceneReconstruct
 {
 	delete entriesAllocType;
 	delete blockCoords;
+	delete allocationRequestIDs;
+	delete allocationRequestTypes;
+	delete allocationCandidates;
+	delete noAllocationCandidates;
 }
 
 template<class TVoxel>
@@ -29,6 +51,8 @@ void ITMSceneReconstructionEngine_CPU<TVoxel,ITMVoxelBlockHash>::ResetScene(ITMS
 
 	TVoxel *voxelBlocks_ptr = scene->localVBA.GetVoxelBlocks();
 	for (int i = 0; i < numBlocks * blockSize; ++i) voxelBlocks_ptr[i] = TVoxel();
+	ITMVoxelBlockSummary *blockSummaries_ptr = scene->localVBA.GetBlockSummaries();
+	for (int i = 0; i < numBlocks; ++i) blockSummaries_ptr[i] = ITMVoxelBlockSummary::initialSummary();
 	int *vbaAllocationList_ptr = scene->localVBA.GetAllocationList();
 	for (int i = 0; i < numBlocks; ++i) vbaAllocationList_ptr[i] = i;
 	scene->localVBA.lastFreeBlockId = numBlocks - 1;
@@ -39,9 +63,65 @@ void ITMSceneReconstructionEngine_CPU<TVoxel,ITMVoxelBlockHash>::ResetScene(ITMS
 	ITMHashEntry *hashEntry_ptr = scene->index.GetEntries();
 	for (int i = 0; i < scene->index.noTotalEntries; ++i) hashEntry_ptr[i] = tmpEntry;
 	int *excessList_ptr = scene->index.GetExcessAllocationList();
-	for (int i = 0; i < SDF_EXCESS_LIST_SIZE; ++i) excessList_ptr[i] = i;
+	int excessListSize = scene->index.getExcessListSize();
+	for (int i = 0; i < excessListSize; ++i) excessList_ptr[i] = i;
+
+	scene->index.SetLastFreeExcessListId(excessListSize - 1);
+	scene->index.SetNumAllocatedEntries(0);
+}
+
+template<class TVoxel>
+void ITMSceneReconstructionEngine_CPU<TVoxel, ITMVoxelBlockHash>::GrowScene(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, const ITMRenderState *renderState,
+	int noNeededBlocks, int noNeededExcessEntries)
+{
+	int noFreeBlocks = scene->localVBA.lastFreeBlockId + 1;
+	if (noNeededBlocks > noFreeBlocks)
+	{
+		int oldNoBlocks = scene->index.getNumAllocatedVoxelBlocks();
+		int newNoBlocks = oldNoBlocks * 2;
+		while (newNoBlocks - oldNoBlocks + noFreeBlocks < noNeededBlocks) newNoBlocks *= 2;
+
+		int blockSize = scene->index.getVoxelBlockSize();
+		scene->localVBA.Grow(newNoBlocks, blockSize);
+		scene->index.SetNumAllocatedVoxelBlocks(newNoBlocks);
+
+		TVoxel *voxelBlocks_ptr = scene->localVBA.GetVoxelBlocks();
+		for (int i = oldNoBlocks * blockSize; i < newNoBlocks * blockSize; ++i) voxelBlocks_ptr[i] = TVoxel();
+		ITMVoxelBlockSummary *blockSummaries_ptr = scene->localVBA.GetBlockSummaries();
+		for (int i = oldNoBlocks; i < newNoBlocks; ++i) blockSummaries_ptr[i] = ITMVoxelBlockSummary::initialSummary();
+
+		// push the new blocks on top of the free list
+		int *vbaAllocationList_ptr = scene->localVBA.GetAllocationList();
+		for (int i = oldNoBlocks; i < newNoBlocks; ++i) vbaAllocationList_ptr[++scene->localVBA.lastFreeBlockId] = i;
+	}
 
-	scene->index.SetLastFreeExcessListId(SDF_EXCESS_LIST_SIZE - 1);
+	int noFreeExcessEntries = scene->index.GetLastFreeExcessListId() + 1;
+	if (noNeededExcessEntries > noFreeExcessEntries)
+	{
+		int oldExcessListSize = scene->index.getExcessListSize();
+		int newExcessListSize = oldExcessListSize * 2;
+		while (newExcessListSize - oldExcessListSize + noFreeExcessEntries < noNeededExcessEntries) newExcessListSize *= 2;
+
+		int oldNoTotalEntries = scene->index.noTotalEntries;
+		scene->index.GrowExcessList(newExcessListSize);
+
+		ITMHashEntry tmpEntry = ITMHashEntry();
+		tmpEntry.ptr = -2;
+		ITMHashEntry *hashEntry_ptr = scene->index.GetEntries();
+		for (int i = oldNoTotalEntries; i < scene->index.noTotalEntries; ++i) hashEntry_ptr[i] = tmpEntry;
+
+		// push the new excess list entries on top of the free list
+		int *excessList_ptr = scene->index.GetExcessAllocationList();
+		int lastFreeExcessListId = scene->index.GetLastFreeExcessListId();
+		for (int i = oldExcessListSize; i < newExcessListSize; ++i) excessList_ptr[++lastFreeExcessListId] = i;
+		scene->index.SetLastFreeExcessListId(lastFreeExcessListId);
+
+		// everything indexed by hash entry has to follow
+		((ITMRenderState_VH*)renderState)->Resize(scene->index.noTotalEntries);
+		if (scene->globalCache != NULL) scene->globalCache->Resize(scene->index.noTotalEntries);
+		entriesAllocType->Grow(scene->index.noTotalEntries);
+		blockCoords->Grow(scene->index.noTotalEntries);
+	}
 }
 
 template<class TVoxel>
@@ -69,6 +149,7 @@ void ITMSceneReconstructionEngine_CPU<TVoxel, ITMVoxelBlockHash>::IntegrateIntoS
 	float *confidence = view->depthConfidence->GetData(MEMORYDEVICE_CPU);
 	Vector4u *rgb = view->rgb->GetData(MEMORYDEVICE_CPU);
 	TVoxel *localVBA = scene->localVBA.GetVoxelBlocks();
+	ITMVoxelBlockSummary *blockSummaries = scene->localVBA.GetBlockSummaries();
 	ITMHashEntry *hashTable = scene->index.GetEntries();
 
 	int *visibleEntryIds = renderState_vh->GetVisibleEntryIDs();
@@ -77,6 +158,18 @@ void ITMSceneReconstructionEngine_CPU<TVoxel, ITMVoxelBlockHash>::IntegrateIntoS
 	bool stopIntegratingAtMaxW = scene->sceneParams->stopIntegratingAtMaxW;
 	//bool approximateIntegration = !trackingState->requiresFullRendering;
 
+	// vectorised depth update, if there is one for this voxel type and CPU
+	typename ITMVoxelBlockIntegrator<TVoxel>::IntegrateFunction integrateVoxelBlockDepth = ITMVoxelBlockIntegrator<TVoxel>::Select();
+
+	ITMVoxelBlockIntegrationParams integrationParams;
+	for (int i = 0; i < 16; i++) integrationParams.M_d[i] = M_d.m[i];
+	integrationParams.projParams_d[0] = projParams_d.x; integrationParams.projParams_d[1] = projParams_d.y;
+	integrationParams.projParams_d[2] = projParams_d.z; integrationParams.projParams_d[3] = projParams_d.w;
+	integrationParams.depthImgWidth = depthImgSize.x; integrationParams.depthImgHeight = depthImgSize.y;
+	integrationParams.depth = depth;
+	integrationParams.voxelSize = voxelSize; integrationParams.mu = mu; integrationParams.maxW = maxW;
+	integrationParams.stopIntegratingAtMaxW = stopIntegratingAtMaxW;
+
 #ifdef WITH_OPENMP
 	#pragma omp parallel for
 #endif
@@ -87,6 +180,9 @@ void ITMSceneReconstructionEngine_CPU<TVoxel, ITMVoxelBlockHash>::IntegrateIntoS
 
 		if (currentHashEntry.ptr < 0) continue;
 
+		// no voxel of a saturated block would be updated
+		if (stopIntegratingAtMaxW && blockSummaries[currentHashEntry.ptr].saturated) continue;
+
 		globalPos.x = currentHashEntry.pos.x;
 		globalPos.y = currentHashEntry.pos.y;
 		globalPos.z = currentHashEntry.pos.z;
@@ -94,7 +190,25 @@ void ITMSceneReconstructionEngine_CPU<TVoxel, ITMVoxelBlockHash>::IntegrateIntoS
 
 		TVoxel *localVoxelBlock = &(localVBA[currentHashEntry.ptr * (SDF_BLOCK_SIZE3)]);
 
-		for (int z = 0; z < SDF_BLOCK_SIZE; z++) for (int y = 0; y < SDF_BLOCK_SIZE; y++) for (int x = 0; x < SDF_BLOCK_SIZE; x++)
+		if (integrateVoxelBlockDepth != NULL)
+		{
+			float eta[SDF_BLOCK_SIZE3];
+			integrateVoxelBlockDepth(localVoxelBlock, globalPos.x, globalPos.y, globalPos.z, integrationParams, eta);
+
+			if (TVoxel::hasColorInformation) for (int locId = 0; locId < SDF_BLOCK_SIZE3; locId++)
+			{
+				Vector4f pt_model;
+
+				pt_model.x = (float)(globalPos.x + locId % SDF_BLOCK_SIZE) * voxelSize;
+				pt_model.y = (float)(globalPos.y + (locId / SDF_BLOCK_SIZE) % SDF_BLOCK_SIZE) * voxelSize;
+				pt_model.z = (float)(globalPos.z + locId / (SDF_BLOCK_SIZE * SDF_BLOCK_SIZE)) * voxelSize;
+				pt_model.w = 1.0f;
+
+				ComputeUpdatedVoxelColor<TVoxel::hasColorInformation, TVoxel>::compute(localVoxelBlock[locId], pt_model, M_rgb,
+					projParams_rgb, mu, maxW, eta[locId], rgb, rgbImgSize);
+			}
+		}
+		else for (int z = 0; z < SDF_BLOCK_SIZE; z++) for (int y = 0; y < SDF_BLOCK_SIZE; y++) for (int x = 0; x < SDF_BLOCK_SIZE; x++)
 		{
 			Vector4f pt_model; int locId;
 
@@ -111,6 +225,8 @@ void ITMSceneReconstructionEngine_CPU<TVoxel, ITMVoxelBlockHash>::IntegrateIntoS
 			ComputeUpdatedVoxelInfo<TVoxel::hasColorInformation,TVoxel::hasConfidenceInformation, TVoxel>::compute(localVoxelBlock[locId], pt_model, M_d, 
 				projParams_d, M_rgb, projParams_rgb, mu, maxW, depth, confidence, depthImgSize, rgb, rgbImgSize);
 		}
+
+		blockSummaries[currentHashEntry.ptr] = computeVoxelBlockSummary(localVoxelBlock, maxW);
 	}
 }
 
@@ -125,6 +241,14 @@ void ITMSceneReconstructionEngine_CPU<TVoxel, ITMVoxelBlockHash>::AllocateSceneF
 	Vector4f projParams_d, invProjParams_d;
 
 	ITMRenderState_VH *renderState_vh = (ITMRenderState_VH*)renderState;
+
+	// the scene may have grown since the last frame
+	renderState_vh->Resize(scene->index.noTotalEntries);
+	this->entriesAllocType->Grow(scene->index.noTotalEntries);
+	this->blockCoords->Grow(scene->index.noTotalEntries);
+	this->allocationRequestIDs->Grow(scene->index.noTotalEntries);
+	this->allocationRequestTypes->Grow(scene->index.noTotalEntries);
+
 	if (resetVisibleList) renderState_vh->noVisibleEntries = 0;
 
 	M_d = trackingState->pose_d->GetM(); M_d.inv(invM_d);
@@ -136,140 +260,214 @@ void ITMSceneReconstructionEngine_CPU<TVoxel, ITMVoxelBlockHash>::AllocateSceneF
 
 	float mu = scene->sceneParams->mu;
 
+	float oneOverVoxelSize = 1.0f / (voxelSize * SDF_BLOCK_SIZE);
+
+	// every pixel visits ceil(2 * 2mu / blockSize) blocks along its ray in buildHashAllocAndVisibleTypePP
+	int maxCandidatesPerRow = depthImgSize.x * ((int)ceil(4.0f * mu * oneOverVoxelSize) + 1);
+	this->allocationCandidates->Resize(maxCandidatesPerRow * depthImgSize.y, false);
+	this->noAllocationCandidates->Resize(depthImgSize.y, false);
+
 	float *depth = view->depth->GetData(MEMORYDEVICE_CPU);
 	int *voxelAllocationList = scene->localVBA.GetAllocationList();
 	int *excessAllocationList = scene->index.GetExcessAllocationList();
 	ITMHashEntry *hashTable = scene->index.GetEntries();
 	ITMHashSwapState *swapStates = scene->globalCache != NULL ? scene->globalCache->GetSwapStates(false) : 0;
 	int *visibleEntryIDs = renderState_vh->GetVisibleEntryIDs();
-	uchar *entriesVisibleType = renderState_vh->GetEntriesVisibleType();
+	uint *entriesVisibleStamp = renderState_vh->GetEntriesVisibleStamp();
 	uchar *entriesAllocType = this->entriesAllocType->GetData(MEMORYDEVICE_CPU);
 	Vector4s *blockCoords = this->blockCoords->GetData(MEMORYDEVICE_CPU);
-	int noTotalEntries = scene->index.noTotalEntries;
+	int *allocationCandidates = this->allocationCandidates->GetData(MEMORYDEVICE_CPU);
+	int *noAllocationCandidates = this->noAllocationCandidates->GetData(MEMORYDEVICE_CPU);
+	int *allocationRequestIDs = this->allocationRequestIDs->GetData(MEMORYDEVICE_CPU);
+	int *allocationRequestTypes = this->allocationRequestTypes->GetData(MEMORYDEVICE_CPU);
 
 	bool useSwapping = scene->globalCache != NULL;
 
-	float oneOverVoxelSize = 1.0f / (voxelSize * SDF_BLOCK_SIZE);
-
-	int lastFreeVoxelBlockId = scene->localVBA.lastFreeBlockId;
-	int lastFreeExcessListId = scene->index.GetLastFreeExcessListId();
-
 	int noVisibleEntries = 0;
 
-	memset(entriesAllocType, 0, noTotalEntries);
+	renderState_vh->AdvanceVisibleStamp();
+	uint visibleStamp = renderState_vh->visibleStamp, checkStamp = visibleStamp - 1;
 
 	for (int i = 0; i < renderState_vh->noVisibleEntries; i++)
-		entriesVisibleType[visibleEntryIDs[i]] = 3; // visible at previous frame and unstreamed
+		entriesVisibleStamp[visibleEntryIDs[i]] = checkStamp; // visible at previous frame and unstreamed
 
-	//build hashVisibility
+	//build hashVisibility, collecting the candidates for allocation per row
 #ifdef WITH_OPENMP
 	#pragma omp parallel for
 #endif
-	for (int locId = 0; locId < depthImgSize.x*depthImgSize.y; locId++)
+	for (int y = 0; y < depthImgSize.y; y++)
 	{
-		int y = locId / depthImgSize.x;
-		int x = locId - y * depthImgSize.x;
-		buildHashAllocAndVisibleTypePP(entriesAllocType, entriesVisibleType, x, y, blockCoords, depth, invM_d,
-			invProjParams_d, mu, depthImgSize, oneOverVoxelSize, hashTable, scene->sceneParams->viewFrustum_min,
-			scene->sceneParams->viewFrustum_max);
+		int noRowCandidates = 0;
+		for (int x = 0; x < depthImgSize.x; x++)
+		{
+			buildHashAllocAndVisibleTypePP(entriesAllocType, entriesVisibleStamp, visibleStamp, x, y, blockCoords, depth, invM_d,
+				invProjParams_d, mu, depthImgSize, oneOverVoxelSize, hashTable, scene->sceneParams->viewFrustum_min,
+				scene->sceneParams->viewFrustum_max, allocationCandidates + y * maxCandidatesPerRow, &noRowCandidates);
+		}
+		noAllocationCandidates[y] = noRowCandidates;
+	}
+
+	// compact the candidates into the request list, dropping duplicates and leaving entriesAllocType cleared for the next frame
+	int noAllocationRequests = 0, noExcessAllocationRequests = 0;
+	for (int y = 0; y < depthImgSize.y; y++)
+	{
+		const int *rowCandidates = allocationCandidates + y * maxCandidatesPerRow;
+		for (int i = 0; i < noAllocationCandidates[y]; i++)
+		{
+			int targetIdx = rowCandidates[i];
+			unsigned char hashChangeType = entriesAllocType[targetIdx];
+			if (hashChangeType == 0) continue;
+
+			entriesAllocType[targetIdx] = 0;
+			allocationRequestIDs[noAllocationRequests] = targetIdx;
+			allocationRequestTypes[noAllocationRequests++] = hashChangeType;
+			if (hashChangeType == 2) noExcessAllocationRequests++;
+		}
 	}
 
 	if (onlyUpdateVisibleList) useSwapping = false;
-	if (!onlyUpdateVisibleList)
+	if (!onlyUpdateVisibleList && noAllocationRequests > 0)
 	{
+		if (scene->sceneParams->allowHashGrowth)
+		{
+			GrowScene(scene, renderState, noAllocationRequests, noExcessAllocationRequests);
+
+			// growing may have moved any of these
+			voxelAllocationList = scene->localVBA.GetAllocationList();
+			excessAllocationList = scene->index.GetExcessAllocationList();
+			hashTable = scene->index.GetEntries();
+			swapStates = scene->globalCache != NULL ? scene->globalCache->GetSwapStates(false) : 0;
+			visibleEntryIDs = renderState_vh->GetVisibleEntryIDs();
+			entriesVisibleStamp = renderState_vh->GetEntriesVisibleStamp();
+			blockCoords = this->blockCoords->GetData(MEMORYDEVICE_CPU);
+		}
+
+		int *allocatedEntryIDs = scene->index.GetAllocatedEntryIDs();
+
+		std::atomic<int> lastFreeVoxelBlockId(scene->localVBA.lastFreeBlockId);
+		std::atomic<int> lastFreeExcessListId(scene->index.GetLastFreeExcessListId());
+		std::atomic<int> noAllocatedEntries(scene->index.GetNumAllocatedEntries());
+
+		int mask = hashMask(hashTable);
+
 		//allocate
-		for (int targetIdx = 0; targetIdx < noTotalEntries; targetIdx++)
+#ifdef WITH_OPENMP
+		// if not all requests can be served, which ones are is decided serially, as the excess list
+		// entry of a request that then fails to get a voxel block could not be given back safely
+		bool allRequestsFit = noAllocationRequests <= lastFreeVoxelBlockId + 1 && noExcessAllocationRequests <= lastFreeExcessListId + 1;
+
+		#pragma omp parallel for if(allRequestsFit)
+#endif
+		for (int requestId = 0; requestId < noAllocationRequests; requestId++)
 		{
-			int vbaIdx, exlIdx;
-			unsigned char hashChangeType = entriesAllocType[targetIdx];
+			int targetIdx = allocationRequestIDs[requestId];
+			Vector4s pt_block_all = blockCoords[targetIdx];
 
-			switch (hashChangeType)
+			ITMHashEntry hashEntry;
+			hashEntry.pos.x = pt_block_all.x; hashEntry.pos.y = pt_block_all.y; hashEntry.pos.z = pt_block_all.z;
+			hashEntry.offset = 0;
+
+			switch (allocationRequestTypes[requestId])
 			{
 			case 1: //needs allocation, fits in the ordered list
-				vbaIdx = lastFreeVoxelBlockId; lastFreeVoxelBlockId--;
+			{
+				int vbaIdx = popFreeListId(lastFreeVoxelBlockId);
 
 				if (vbaIdx >= 0) //there is room in the voxel block array
 				{
-					Vector4s pt_block_all = blockCoords[targetIdx];
-
-					ITMHashEntry hashEntry;
-					hashEntry.pos.x = pt_block_all.x; hashEntry.pos.y = pt_block_all.y; hashEntry.pos.z = pt_block_all.z;
 					hashEntry.ptr = voxelAllocationList[vbaIdx];
-					hashEntry.offset = 0;
-
 					hashTable[targetIdx] = hashEntry;
+
+					allocatedEntryIDs[noAllocatedEntries++] = targetIdx;
 				}
 				else
 				{
 					// Mark entry as not visible since we couldn't allocate it but buildHashAllocAndVisibleTypePP changed its state.
-					entriesVisibleType[targetIdx] = 0;
-
-					// Restore previous value to avoid leaks.
-					lastFreeVoxelBlockId++;
+					entriesVisibleStamp[targetIdx] = 0;
 				}
 
 				break;
+			}
 			case 2: //needs allocation in the excess list
-				vbaIdx = lastFreeVoxelBlockId; lastFreeVoxelBlockId--;
-				exlIdx = lastFreeExcessListId; lastFreeExcessListId--;
+			{
+				int exlIdx = popFreeListId(lastFreeExcessListId);
+				if (exlIdx < 0) break; // no room in the excess list
 
-				if (vbaIdx >= 0 && exlIdx >= 0) //there is room in the voxel block array and excess list
+				int vbaIdx = popFreeListId(lastFreeVoxelBlockId);
+				if (vbaIdx < 0) //no room in the voxel block array, only reachable when running serially
 				{
-					Vector4s pt_block_all = blockCoords[targetIdx];
+					// No need to mark the entry as not visible since buildHashAllocAndVisibleTypePP did not mark it.
+					// Restore previous value to avoid leaks.
+					lastFreeExcessListId++;
+					break;
+				}
 
-					ITMHashEntry hashEntry;
-					hashEntry.pos.x = pt_block_all.x; hashEntry.pos.y = pt_block_all.y; hashEntry.pos.z = pt_block_all.z;
-					hashEntry.ptr = voxelAllocationList[vbaIdx];
-					hashEntry.offset = 0;
+				hashEntry.ptr = voxelAllocationList[vbaIdx];
 
-					int exlOffset = excessAllocationList[exlIdx];
+				int exlOffset = excessAllocationList[exlIdx];
 
-					hashTable[targetIdx].offset = exlOffset + 1; //connect to child
+				hashTable[targetIdx].offset = exlOffset + 1; //connect to child
 
-					hashTable[SDF_BUCKET_NUM + exlOffset] = hashEntry; //add child to the excess list
+				int childIdx = excessListIndex(mask, exlOffset + 1);
 
-					entriesVisibleType[SDF_BUCKET_NUM + exlOffset] = 1; //make child visible and in memory
-				}
-				else
-				{
-					// No need to mark the entry as not visible since buildHashAllocAndVisibleTypePP did not mark it.
-					// Restore previous value to avoid leaks.
-					lastFreeVoxelBlockId++;
-					lastFreeExcessListId++;
-				}
+				hashTable[childIdx] = hashEntry; //add child to the excess list
+
+				entriesVisibleStamp[childIdx] = visibleStamp; //make child visible and in memory
+
+				allocatedEntryIDs[noAllocatedEntries++] = childIdx;
 
 				break;
 			}
+			}
 		}
+
+		scene->localVBA.lastFreeBlockId = lastFreeVoxelBlockId;
+		scene->index.SetLastFreeExcessListId(lastFreeExcessListId);
+		scene->index.SetNumAllocatedEntries(noAllocatedEntries);
+	}
+
+	if (onlyUpdateVisibleList)
+	{
+		// new entries stay unallocated, so the sweep below would not see that buildHashAllocAndVisibleTypePP marked them
+		for (int requestId = 0; requestId < noAllocationRequests; requestId++)
+			if (allocationRequestTypes[requestId] == 1) entriesVisibleStamp[allocationRequestIDs[requestId]] = 0;
 	}
 
-	//build visible list
-	for (int targetIdx = 0; targetIdx < noTotalEntries; targetIdx++)
+	int lastFreeVoxelBlockId = scene->localVBA.lastFreeBlockId;
+
+	const int *allocatedEntryIDs = scene->index.GetAllocatedEntryIDs();
+	int noAllocatedEntries = scene->index.GetNumAllocatedEntries();
+
+	//build visible list, only entries in use can be visible
+	for (int listIdx = 0; listIdx < noAllocatedEntries; listIdx++)
 	{
-		unsigned char hashVisibleType = entriesVisibleType[targetIdx];
+		int targetIdx = allocatedEntryIDs[listIdx];
+		uint hashVisibleStamp = entriesVisibleStamp[targetIdx];
 		const ITMHashEntry &hashEntry = hashTable[targetIdx];
 		
-		if (hashVisibleType == 3)
+		if (hashVisibleStamp == checkStamp)
 		{
 			bool isVisibleEnlarged, isVisible;
 
 			if (useSwapping)
 			{
 				checkBlockVisibility<true>(isVisible, isVisibleEnlarged, hashEntry.pos, M_d, projParams_d, voxelSize, depthImgSize);
-				if (!isVisibleEnlarged) hashVisibleType = 0;
+				if (isVisibleEnlarged) hashVisibleStamp = visibleStamp;
 			} else {
 				checkBlockVisibility<false>(isVisible, isVisibleEnlarged, hashEntry.pos, M_d, projParams_d, voxelSize, depthImgSize);
-				if (!isVisible) { hashVisibleType = 0; }
+				if (isVisible) hashVisibleStamp = visibleStamp;
 			}
-			entriesVisibleType[targetIdx] = hashVisibleType;
+			entriesVisibleStamp[targetIdx] = hashVisibleStamp;
 		}
 
+		bool hashIsVisible = hashVisibleStamp == visibleStamp;
+
 		if (useSwapping)
 		{
-			if (hashVisibleType > 0 && swapStates[targetIdx].state != 2) swapStates[targetIdx].state = 1;
+			if (hashIsVisible && swapStates[targetIdx].state != 2) swapStates[targetIdx].state = 1;
 		}
 
-		if (hashVisibleType > 0)
+		if (hashIsVisible)
 		{	
 			visibleEntryIDs[noVisibleEntries] = targetIdx;
 			noVisibleEntries++;
@@ -277,7 +475,7 @@ void ITMSceneReconstructionEngine_CPU<TVoxel, ITMVoxelBlockHash>::AllocateSceneF
 
 #if 0
 		// "active list", currently disabled
-		if (hashVisibleType == 1)
+		if (hashIsVisible && hashEntry.ptr >= 0)
 		{
 			activeEntryIDs[noActiveEntries] = targetIdx;
 			noActiveEntries++;
@@ -288,12 +486,13 @@ void ITMSceneReconstructionEngine_CPU<TVoxel, ITMVoxelBlockHash>::AllocateSceneF
 	//reallocate deleted ones from previous swap operation
 	if (useSwapping)
 	{
-		for (int targetIdx = 0; targetIdx < noTotalEntries; targetIdx++)
+		for (int visibleIdx = 0; visibleIdx < noVisibleEntries; visibleIdx++)
 		{
 			int vbaIdx;
+			int targetIdx = visibleEntryIDs[visibleIdx];
 			ITMHashEntry hashEntry = hashTable[targetIdx];
 
-			if (entriesVisibleType[targetIdx] > 0 && hashEntry.ptr == -1) 
+			if (hashEntry.ptr == -1) 
 			{
 				vbaIdx = lastFreeVoxelBlockId; lastFreeVoxelBlockId--;
 				if (vbaIdx >= 0) hashTable[targetIdx].ptr = voxelAllocationList[vbaIdx];
@@ -305,7 +504,6 @@ void ITMSceneReconstructionEngine_CPU<TVoxel, ITMVoxelBlockHash>::AllocateSceneF
 	renderState_vh->noVisibleEntries = noVisibleEntries;
 
 	scene->localVBA.lastFreeBlockId = lastFreeVoxelBlockId;
-	scene->index.SetLastFreeExcessListId(lastFreeExcessListId);
 }
 
 template<class TVoxel>
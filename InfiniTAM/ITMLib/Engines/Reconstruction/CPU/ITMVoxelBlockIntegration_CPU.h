@@ -0,0 +1,92 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <stdlib.h>
+
+#include "../../../Objects/Scene/ITMVoxelTypes.h"
+#include "../../../Utils/ITMCPUFeatures.h"
+
+namespace ITMLib
+{
+	/** \brief
+	    Everything the vectorised depth integration of a voxel
+	    block needs, as plain data so that the kernels do not
+	    call into code shared with the scalar build.
+	*/
+	struct ITMVoxelBlockIntegrationParams
+	{
+		/** Depth camera pose, column major as in Matrix4f::m. */
+		float M_d[16];
+		/** fx, fy, cx, cy of the depth camera. */
+		float projParams_d[4];
+		int depthImgWidth, depthImgHeight;
+		const float *depth;
+
+		float voxelSize, mu;
+		int maxW;
+		bool stopIntegratingAtMaxW;
+	};
+
+	/** Fuse the depth image into all voxels of one block, several
+	    voxels at a time, with exactly the arithmetic of
+	    computeUpdatedVoxelDepthInfo(). @p blockPos is the position
+	    of the first voxel in voxel units. For each voxel, @p eta
+	    receives what computeUpdatedVoxelDepthInfo() returns, or
+	    a value above mu if the voxel was skipped at maxW, so that
+	    the caller can do the colour update.
+	*/
+#define ITM_DECLARE_VOXEL_BLOCK_INTEGRATION(TVoxel) \
+	void IntegrateVoxelBlockDepth(TVoxel *voxelBlock, int blockPosX, int blockPosY, int blockPosZ, \
+		const ITMVoxelBlockIntegrationParams &params, float *eta);
+
+#define ITM_DECLARE_VOXEL_BLOCK_INTEGRATIONS \
+	ITM_DECLARE_VOXEL_BLOCK_INTEGRATION(ITMVoxel_s) \
+	ITM_DECLARE_VOXEL_BLOCK_INTEGRATION(ITMVoxel_f) \
+	ITM_DECLARE_VOXEL_BLOCK_INTEGRATION(ITMVoxel_s_rgb) \
+	ITM_DECLARE_VOXEL_BLOCK_INTEGRATION(ITMVoxel_f_rgb)
+
+#ifdef WITH_SIMD
+	namespace SSE4 { ITM_DECLARE_VOXEL_BLOCK_INTEGRATIONS }
+	namespace AVX2 { ITM_DECLARE_VOXEL_BLOCK_INTEGRATIONS }
+	namespace AVX512 { ITM_DECLARE_VOXEL_BLOCK_INTEGRATIONS }
+#endif
+
+	/** \brief
+	    Picks the vectorised depth integration for a voxel type
+	    and the instruction set of the CPU. Select() returns NULL
+	    if there is none, e.g. for voxels with confidence, or if
+	    it is no faster than the scalar code: the SSE4 kernels
+	    lose to it on the gathers and scatters, and with colour
+	    the scalar colour update dominates at every width.
+	*/
+	template<class TVoxel>
+	struct ITMVoxelBlockIntegrator
+	{
+		typedef void (*IntegrateFunction)(TVoxel *voxelBlock, int blockPosX, int blockPosY, int blockPosZ,
+			const ITMVoxelBlockIntegrationParams &params, float *eta);
+
+		static IntegrateFunction Select(void) { return NULL; }
+	};
+
+#ifdef WITH_SIMD
+#define ITM_SELECT_VOXEL_BLOCK_INTEGRATION(TVoxel) \
+	template<> inline ITMVoxelBlockIntegrator<TVoxel>::IntegrateFunction ITMVoxelBlockIntegrator<TVoxel>::Select(void) \
+	{ \
+		switch (GetCPUInstructionSet()) \
+		{ \
+		case CPU_INSTRUCTIONSET_AVX512: return &AVX512::IntegrateVoxelBlockDepth; \
+		case CPU_INSTRUCTIONSET_AVX2: return &AVX2::IntegrateVoxelBlockDepth; \
+		default: return NULL; \
+		} \
+	}
+
+	ITM_SELECT_VOXEL_BLOCK_INTEGRATION(ITMVoxel_s)
+	ITM_SELECT_VOXEL_BLOCK_INTEGRATION(ITMVoxel_f)
+
+#undef ITM_SELECT_VOXEL_BLOCK_INTEGRATION
+#endif
+
+#undef ITM_DECLARE_VOXEL_BLOCK_INTEGRATIONS
+#undef ITM_DECLARE_VOXEL_BLOCK_INTEGRATION
+}
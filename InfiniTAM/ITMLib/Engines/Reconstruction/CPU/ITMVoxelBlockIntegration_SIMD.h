@@ -0,0 +1,140 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+// Only to be included by the ITMVoxelBlockIntegration_<ISA>.cpp files, after
+// they have included the SIMDOps for their instruction set. Since these
+// files are compiled with their own instruction set flags, nothing in here may
+// call inline functions that are shared with the rest of the library (voxel
+// conversions, ORUtils vectors and matrices), or the linker might pick the
+// vectorised copy for code that runs on any CPU.
+
+#include "ITMVoxelBlockIntegration_CPU.h"
+#include "../../../Objects/Scene/ITMVoxelBlockHash.h"
+
+namespace
+{
+	inline float sdfToFloat(short sdf) { return (float)(sdf) / 32767.0f; }
+	inline float sdfToFloat(float sdf) { return sdf; }
+
+	inline void floatToSdf(short &sdf, float f) { sdf = (short)((f) * 32767.0f); }
+	inline void floatToSdf(float &sdf, float f) { sdf = f; }
+
+	template<class TVoxel>
+	void integrateVoxelBlockDepth(TVoxel *voxelBlock, int blockPosX, int blockPosY, int blockPosZ,
+		const ITMLib::ITMVoxelBlockIntegrationParams &params, float *eta)
+	{
+		typedef SIMDOps::vf vf; typedef SIMDOps::vi vi; typedef SIMDOps::mask mask;
+		const int W = SIMDOps::W;
+
+		const float *m = params.M_d;
+		const vf m0 = SIMDOps::set1(m[0]), m1 = SIMDOps::set1(m[1]), m2 = SIMDOps::set1(m[2]);
+		const vf m4 = SIMDOps::set1(m[4]), m5 = SIMDOps::set1(m[5]), m6 = SIMDOps::set1(m[6]);
+		const vf m8 = SIMDOps::set1(m[8]), m9 = SIMDOps::set1(m[9]), m10 = SIMDOps::set1(m[10]);
+		const vf m12 = SIMDOps::set1(m[12]), m13 = SIMDOps::set1(m[13]), m14 = SIMDOps::set1(m[14]);
+
+		const vf fx = SIMDOps::set1(params.projParams_d[0]), fy = SIMDOps::set1(params.projParams_d[1]);
+		const vf cx = SIMDOps::set1(params.projParams_d[2]), cy = SIMDOps::set1(params.projParams_d[3]);
+
+		const vf zero = SIMDOps::set1(0.0f), one = SIMDOps::set1(1.0f), half = SIMDOps::set1(0.5f), minusOne = SIMDOps::set1(-1.0f);
+		const vf minX = one, maxX = SIMDOps::set1((float)(params.depthImgWidth - 2));
+		const vf minY = one, maxY = SIMDOps::set1((float)(params.depthImgHeight - 2));
+		const vi width = SIMDOps::set1i(params.depthImgWidth);
+
+		const vf voxelSize = SIMDOps::set1(params.voxelSize);
+		const vf mu = SIMDOps::set1(params.mu), minusMu = SIMDOps::set1(-params.mu);
+		const int maxW = params.maxW;
+
+		for (int locId0 = 0; locId0 < SDF_BLOCK_SIZE3; locId0 += W)
+		{
+			int posX[W], posY[W], posZ[W];
+			float oldF[W], oldW[W], newF[W], eta_out[W];
+			int activeBits = 0;
+
+			// the voxels are stored as structs, so gather them into lanes here
+			for (int i = 0; i < W; i++)
+			{
+				int locId = locId0 + i;
+				const TVoxel &voxel = voxelBlock[locId];
+
+				posX[i] = blockPosX + (locId & (SDF_BLOCK_SIZE - 1));
+				posY[i] = blockPosY + ((locId / SDF_BLOCK_SIZE) & (SDF_BLOCK_SIZE - 1));
+				posZ[i] = blockPosZ + locId / (SDF_BLOCK_SIZE * SDF_BLOCK_SIZE);
+
+				oldF[i] = sdfToFloat(voxel.sdf);
+				oldW[i] = (float)voxel.w_depth;
+
+				if (!params.stopIntegratingAtMaxW || voxel.w_depth != maxW) activeBits |= 1 << i;
+			}
+
+			if (activeBits == 0)
+			{
+				for (int i = 0; i < W; i++) eta[locId0 + i] = params.mu + 1.0f;
+				continue;
+			}
+
+			// project the voxel centres into the depth image
+			vf px = SIMDOps::mul(SIMDOps::cvt(SIMDOps::loadi(posX)), voxelSize);
+			vf py = SIMDOps::mul(SIMDOps::cvt(SIMDOps::loadi(posY)), voxelSize);
+			vf pz = SIMDOps::mul(SIMDOps::cvt(SIMDOps::loadi(posZ)), voxelSize);
+
+			vf camX = SIMDOps::add(SIMDOps::add(SIMDOps::add(SIMDOps::mul(m0, px), SIMDOps::mul(m4, py)), SIMDOps::mul(m8, pz)), m12);
+			vf camY = SIMDOps::add(SIMDOps::add(SIMDOps::add(SIMDOps::mul(m1, px), SIMDOps::mul(m5, py)), SIMDOps::mul(m9, pz)), m13);
+			vf camZ = SIMDOps::add(SIMDOps::add(SIMDOps::add(SIMDOps::mul(m2, px), SIMDOps::mul(m6, py)), SIMDOps::mul(m10, pz)), m14);
+
+			mask valid = SIMDOps::gt(camZ, zero);
+
+			vf imgX = SIMDOps::add(SIMDOps::div(SIMDOps::mul(fx, camX), camZ), cx);
+			vf imgY = SIMDOps::add(SIMDOps::div(SIMDOps::mul(fy, camY), camZ), cy);
+
+			valid = SIMDOps::and_(valid, SIMDOps::and_(SIMDOps::ge(imgX, minX), SIMDOps::le(imgX, maxX)));
+			valid = SIMDOps::and_(valid, SIMDOps::and_(SIMDOps::ge(imgY, minY), SIMDOps::le(imgY, maxY)));
+
+			// get measured depth from image
+			vi idx = SIMDOps::addi(SIMDOps::cvtt(SIMDOps::add(imgX, half)), SIMDOps::muli(SIMDOps::cvtt(SIMDOps::add(imgY, half)), width));
+			vf depthMeasure = SIMDOps::gather(params.depth, idx, valid, zero);
+			valid = SIMDOps::and_(valid, SIMDOps::gt(depthMeasure, zero));
+
+			// same as computeUpdatedVoxelDepthInfo()
+			vf e = SIMDOps::sub(depthMeasure, camZ);
+			mask update = SIMDOps::and_(valid, SIMDOps::ge(e, minusMu));
+
+			vf f = SIMDOps::min(one, SIMDOps::div(e, mu));
+			vf w = SIMDOps::loadf(oldW);
+			f = SIMDOps::div(SIMDOps::add(SIMDOps::mul(w, SIMDOps::loadf(oldF)), f), SIMDOps::add(w, one));
+
+			SIMDOps::storef(newF, f);
+			SIMDOps::storef(eta_out, SIMDOps::select(valid, e, minusOne));
+
+			int updateBits = SIMDOps::bits(update) & activeBits;
+
+			for (int i = 0; i < W; i++)
+			{
+				int locId = locId0 + i;
+
+				if (!(activeBits & (1 << i))) { eta[locId] = params.mu + 1.0f; continue; }
+				eta[locId] = eta_out[i];
+
+				if (!(updateBits & (1 << i))) continue;
+
+				TVoxel &voxel = voxelBlock[locId];
+				int newW = voxel.w_depth + 1;
+				floatToSdf(voxel.sdf, newF[i]);
+				voxel.w_depth = newW < maxW ? newW : maxW;
+			}
+		}
+	}
+}
+
+#define ITM_DEFINE_VOXEL_BLOCK_INTEGRATION(TVoxel) \
+	void IntegrateVoxelBlockDepth(TVoxel *voxelBlock, int blockPosX, int blockPosY, int blockPosZ, \
+		const ITMVoxelBlockIntegrationParams &params, float *eta) \
+	{ \
+		integrateVoxelBlockDepth(voxelBlock, blockPosX, blockPosY, blockPosZ, params, eta); \
+	}
+
+#define ITM_DEFINE_VOXEL_BLOCK_INTEGRATIONS \
+	ITM_DEFINE_VOXEL_BLOCK_INTEGRATION(ITMVoxel_s) \
+	ITM_DEFINE_VOXEL_BLOCK_INTEGRATION(ITMVoxel_f) \
+	ITM_DEFINE_VOXEL_BLOCK_INTEGRATION(ITMVoxel_s_rgb) \
+	ITM_DEFINE_VOXEL_BLOCK_INTEGRATION(ITMVoxel_f_rgb)
@@ -19,6 +19,19 @@ namespace ITMLib
 		void *allocationTempData_host;
 		unsigned char *entriesAllocType_device;
 		Vector4s *blockCoords_device;
+		int noEntriesInBuffers;
+
+		/** Make sure entriesAllocType_device and blockCoords_device
+		    cover @p noTotalEntries hash entries, keeping their content.
+		*/
+		void ResizeBuffers(int noTotalEntries);
+
+		/** Grow the voxel block array and the excess list of
+		    the scene, if that is needed to allocate another
+		    @p noNeededBlocks voxel blocks, @p noNeededExcessEntries
+		    of which go into the excess list.
+		*/
+		void GrowScene(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, const ITMRenderState *renderState, int noNeededBlocks, int noNeededExcessEntries);
 
 	public:
 		void ResetScene(ITMScene<TVoxel, ITMVoxelBlockHash> *scene);
@@ -47,7 +47,7 @@ kernel void integrateIntoScene_vh_device(DEVICEPTR(ITMVoxel) *localVBA
 }
 
 kernel void buildAllocAndVisibleType_vh_device(DEVICEPTR(unsigned char) *entriesAllocType                   [[ buffer(0) ]],
-                                               DEVICEPTR(unsigned char) *entriesVisibleType                 [[ buffer(1) ]],
+                                               DEVICEPTR(uint) *entriesVisibleStamp                         [[ buffer(1) ]],
                                                DEVICEPTR(Vector4s) *blockCoords                             [[ buffer(2) ]],
                                                const CONSTPTR(ITMHashEntry) *hashTable                      [[ buffer(3) ]],
                                                const CONSTPTR(float) *depth                                 [[ buffer(4) ]],
@@ -60,7 +60,7 @@ kernel void buildAllocAndVisibleType_vh_device(DEVICEPTR(unsigned char) *entries
     
     if (x >= params->depthImgSize.x || y >= params->depthImgSize.y) return;
     
-    buildHashAllocAndVisibleTypePP(entriesAllocType, entriesVisibleType, x, y, blockCoords, depth, params->invM_d,
+    buildHashAllocAndVisibleTypePP(entriesAllocType, entriesVisibleStamp, params->visibleStamp, x, y, blockCoords, depth, params->invM_d,
                                    params->invProjParams_d, params->others.x, params->depthImgSize, params->others.y,
                                    hashTable, params->others.z, params->others.w);
 }
@@ -51,6 +51,7 @@ struct BuildAllocVisibleType_VH_Params
     Vector4f invProjParams_d;
     Vector4f others;
     Vector2i depthImgSize;
+    uint visibleStamp;
 };
 
 #endif
\ No newline at end of file
@@ -63,7 +63,7 @@ void ITMSceneReconstructionEngine_Metal<TVoxel,ITMVoxelBlockHash>::IntegrateInto
 
     [commandEncoder setComputePipelineState:sr_metalBits.p_integrateIntoScene_vh_device];
     [commandEncoder setBuffer:(__bridge id<MTLBuffer>) scene->localVBA.GetVoxelBlocks_MB()      offset:0 atIndex:0];
-    [commandEncoder setBuffer:(__bridge id<MTLBuffer>) scene->index.GetEntries_MB()             offset:0 atIndex:1];
+    [commandEncoder setBuffer:(__bridge id<MTLBuffer>) scene->index.GetEntries_MB()             offset:sizeof(ITMHashEntry) atIndex:1];
     [commandEncoder setBuffer:(__bridge id<MTLBuffer>) renderState_vh->GetVisibleEntryIDs_MB()  offset:0 atIndex:2];
     [commandEncoder setBuffer:(__bridge id<MTLBuffer>) view->rgb->GetMetalBuffer()              offset:0 atIndex:3];
     [commandEncoder setBuffer:(__bridge id<MTLBuffer>) view->depth->GetMetalBuffer()            offset:0 atIndex:4];
@@ -77,6 +77,16 @@ void ITMSceneReconstructionEngine_Metal<TVoxel,ITMVoxelBlockHash>::IntegrateInto
 
     [commandBuffer commit];
 
+    // the kernel does not maintain the block summaries, so forget what they said about the blocks it touched
+    ITMVoxelBlockSummary *blockSummaries = scene->localVBA.GetBlockSummaries();
+    const ITMHashEntry *hashTable = scene->index.GetEntries();
+    const int *visibleEntryIDs = renderState_vh->GetVisibleEntryIDs();
+    for (int visibleHash = 0; visibleHash < renderState_vh->noVisibleEntries; visibleHash++)
+    {
+        int ptr = hashTable[visibleEntryIDs[visibleHash]].ptr;
+        if (ptr >= 0) blockSummaries[ptr] = ITMVoxelBlockSummary::unknownSummary();
+    }
+
 //    [commandBuffer waitUntilCompleted];
 }
 
@@ -105,20 +115,21 @@ void ITMSceneReconstructionEngine_Metal<TVoxel,ITMVoxelBlockHash>::BuildAllocAnd
     params->others.y = 1.0f / (voxelSize * SDF_BLOCK_SIZE);
     params->others.z = scene->sceneParams->viewFrustum_min;
     params->others.w = scene->sceneParams->viewFrustum_max;
+    params->visibleStamp = renderState_vh->visibleStamp;
 
     memset(this->entriesAllocType->GetData(MEMORYDEVICE_CPU), 0, scene->index.noTotalEntries);
     memset(this->blockCoords->GetData(MEMORYDEVICE_CPU), 0, scene->index.noTotalEntries * sizeof(Vector4s));
 
-    uchar *entriesVisibleType = renderState_vh->GetEntriesVisibleType();
+    uint *entriesVisibleStamp = renderState_vh->GetEntriesVisibleStamp();
     int *visibleEntryIDs = renderState_vh->GetVisibleEntryIDs();
     for (int i = 0; i < renderState_vh->noVisibleEntries; i++)
-        entriesVisibleType[visibleEntryIDs[i]] = 3; // visible at previous frame and unstreamed
+        entriesVisibleStamp[visibleEntryIDs[i]] = renderState_vh->visibleStamp - 1; // visible at previous frame and unstreamed
 
     [commandEncoder setComputePipelineState:sr_metalBits.p_buildAllocAndVisibleType_vh_device];
     [commandEncoder setBuffer:(__bridge id<MTLBuffer>) this->entriesAllocType->GetMetalBuffer()     offset:0 atIndex:0];
-    [commandEncoder setBuffer:(__bridge id<MTLBuffer>) renderState_vh->GetEntriesVisibleType_MB()   offset:0 atIndex:1];
+    [commandEncoder setBuffer:(__bridge id<MTLBuffer>) renderState_vh->GetEntriesVisibleStamp_MB()  offset:0 atIndex:1];
     [commandEncoder setBuffer:(__bridge id<MTLBuffer>) this->blockCoords->GetMetalBuffer()          offset:0 atIndex:2];
-    [commandEncoder setBuffer:(__bridge id<MTLBuffer>) scene->index.GetEntries_MB()                 offset:0 atIndex:3];
+    [commandEncoder setBuffer:(__bridge id<MTLBuffer>) scene->index.GetEntries_MB()                 offset:sizeof(ITMHashEntry) atIndex:3];
     [commandEncoder setBuffer:(__bridge id<MTLBuffer>) view->depth->GetMetalBuffer()                offset:0 atIndex:4];
     [commandEncoder setBuffer:sr_metalBits.paramsBuffer                                             offset:0 atIndex:5];
 
@@ -146,6 +157,12 @@ void ITMSceneReconstructionEngine_Metal<TVoxel, ITMVoxelBlockHash>::AllocateScen
     Vector4f projParams_d, invProjParams_d;
 
     ITMRenderState_VH *renderState_vh = (ITMRenderState_VH*)renderState;
+
+    // the scene may have grown since the last frame
+    renderState_vh->Resize(scene->index.noTotalEntries);
+    this->entriesAllocType->Grow(scene->index.noTotalEntries);
+    this->blockCoords->Grow(scene->index.noTotalEntries);
+
     if (resetVisibleList) renderState_vh->noVisibleEntries = 0;
 
     M_d = trackingState->pose_d->GetM(); M_d.inv(invM_d);
@@ -163,7 +180,7 @@ void ITMSceneReconstructionEngine_Metal<TVoxel, ITMVoxelBlockHash>::AllocateScen
     ITMHashEntry *hashTable = scene->index.GetEntries();
     ITMHashSwapState *swapStates = scene->useSwapping ? scene->globalCache->GetSwapStates(false) : 0;
     int *visibleEntryIDs = renderState_vh->GetVisibleEntryIDs();
-    uchar *entriesVisibleType = renderState_vh->GetEntriesVisibleType();
+    uint *entriesVisibleStamp = renderState_vh->GetEntriesVisibleStamp();
     uchar *entriesAllocType = this->entriesAllocType->GetData(MEMORYDEVICE_CPU);
     Vector4s *blockCoords = this->blockCoords->GetData(MEMORYDEVICE_CPU);
     int noTotalEntries = scene->index.noTotalEntries;
@@ -175,12 +192,18 @@ void ITMSceneReconstructionEngine_Metal<TVoxel, ITMVoxelBlockHash>::AllocateScen
     int lastFreeVoxelBlockId = scene->localVBA.lastFreeBlockId;
     int lastFreeExcessListId = scene->index.GetLastFreeExcessListId();
 
+    int *allocatedEntryIDs = scene->index.GetAllocatedEntryIDs();
+    int noAllocatedEntries = scene->index.GetNumAllocatedEntries();
+
     int noVisibleEntries = 0;
 
     memset(entriesAllocType, 0, noTotalEntries);
 
+    renderState_vh->AdvanceVisibleStamp();
+    uint visibleStamp = renderState_vh->visibleStamp, checkStamp = visibleStamp - 1;
+
     for (int i = 0; i < renderState_vh->noVisibleEntries; i++)
-        entriesVisibleType[visibleEntryIDs[i]] = 3; // visible at previous frame and unstreamed
+        entriesVisibleStamp[visibleEntryIDs[i]] = checkStamp; // visible at previous frame and unstreamed
 
     //build hashVisibility
     this->BuildAllocAndVisibleType(scene, view, trackingState, renderState);
@@ -209,6 +232,8 @@ void ITMSceneReconstructionEngine_Metal<TVoxel, ITMVoxelBlockHash>::AllocateScen
                         hashEntry.offset = 0;
 
                         hashTable[targetIdx] = hashEntry;
+
+                        allocatedEntryIDs[noAllocatedEntries++] = targetIdx;
                     }
 
                     break;
@@ -229,9 +254,13 @@ void ITMSceneReconstructionEngine_Metal<TVoxel, ITMVoxelBlockHash>::AllocateScen
 
                         hashTable[targetIdx].offset = exlOffset + 1; //connect to child
 
-                        hashTable[SDF_BUCKET_NUM + exlOffset] = hashEntry; //add child to the excess list
+                        int childIdx = excessListIndex(hashMask(hashTable), exlOffset + 1);
+
+                        hashTable[childIdx] = hashEntry; //add child to the excess list
 
-                        entriesVisibleType[SDF_BUCKET_NUM + exlOffset] = 1; //make child visible and in memory
+                        entriesVisibleStamp[childIdx] = visibleStamp; //make child visible and in memory
+
+                        allocatedEntryIDs[noAllocatedEntries++] = childIdx;
                     }
 
                     break;
@@ -242,30 +271,32 @@ void ITMSceneReconstructionEngine_Metal<TVoxel, ITMVoxelBlockHash>::AllocateScen
     //build visible list
     for (int targetIdx = 0; targetIdx < noTotalEntries; targetIdx++)
     {
-        unsigned char hashVisibleType = entriesVisibleType[targetIdx];
+        uint hashVisibleStamp = entriesVisibleStamp[targetIdx];
         const ITMHashEntry &hashEntry = hashTable[targetIdx];
 
-        if (hashVisibleType == 3)
+        if (hashVisibleStamp == checkStamp)
         {
             bool isVisibleEnlarged, isVisible;
 
             if (useSwapping)
             {
                 checkBlockVisibility<true>(isVisible, isVisibleEnlarged, hashEntry.pos, M_d, projParams_d, voxelSize, depthImgSize);
-                if (!isVisibleEnlarged) hashVisibleType = 0;
+                if (isVisibleEnlarged) hashVisibleStamp = visibleStamp;
             } else {
                 checkBlockVisibility<false>(isVisible, isVisibleEnlarged, hashEntry.pos, M_d, projParams_d, voxelSize, depthImgSize);
-                if (!isVisible) { hashVisibleType = 0; }
+                if (isVisible) hashVisibleStamp = visibleStamp;
             }
-            entriesVisibleType[targetIdx] = hashVisibleType;
+            entriesVisibleStamp[targetIdx] = hashVisibleStamp;
         }
 
+        bool hashIsVisible = hashVisibleStamp == visibleStamp;
+
         if (useSwapping)
         {
-            if (hashVisibleType > 0 && swapStates[targetIdx].state != 2) swapStates[targetIdx].state = 1;
+            if (hashIsVisible && swapStates[targetIdx].state != 2) swapStates[targetIdx].state = 1;
         }
 
-        if (hashVisibleType > 0)
+        if (hashIsVisible)
         {
             visibleEntryIDs[noVisibleEntries] = targetIdx;
             noVisibleEntries++;
@@ -273,7 +304,7 @@ void ITMSceneReconstructionEngine_Metal<TVoxel, ITMVoxelBlockHash>::AllocateScen
 
 #if 0
         // "active list", currently disabled
-        if (hashVisibleType == 1)
+        if (hashIsVisible && hashEntry.ptr >= 0)
         {
             activeEntryIDs[noActiveEntries] = targetIdx;
             noActiveEntries++;
@@ -289,7 +320,7 @@ void ITMSceneReconstructionEngine_Metal<TVoxel, ITMVoxelBlockHash>::AllocateScen
             int vbaIdx;
             ITMHashEntry hashEntry = hashTable[targetIdx];
 
-            if (entriesVisibleType[targetIdx] > 0 && hashEntry.ptr == -1)
+            if (entriesVisibleStamp[targetIdx] == visibleStamp && hashEntry.ptr == -1)
             {
                 vbaIdx = lastFreeVoxelBlockId; lastFreeVoxelBlockId--;
                 if (vbaIdx >= 0) hashTable[targetIdx].ptr = voxelAllocationList[vbaIdx];
@@ -301,6 +332,7 @@ void ITMSceneReconstructionEngine_Metal<TVoxel, ITMVoxelBlockHash>::AllocateScen
 
     scene->localVBA.lastFreeBlockId = lastFreeVoxelBlockId;
     scene->index.SetLastFreeExcessListId(lastFreeExcessListId);
+    scene->index.SetNumAllocatedEntries(noAllocatedEntries);
 }
 
 #endif
@@ -181,9 +181,36 @@ struct ComputeUpdatedVoxelInfo<true, true, TVoxel> {
 	}
 };
 
-_CPU_AND_GPU_CODE_ inline void buildHashAllocAndVisibleTypePP(DEVICEPTR(uchar) *entriesAllocType, DEVICEPTR(uchar) *entriesVisibleType, int x, int y,
+// colour half of ComputeUpdatedVoxelInfo, for when eta has come from a separate depth update
+template<bool hasColor, class TVoxel> struct ComputeUpdatedVoxelColor;
+
+template<class TVoxel>
+struct ComputeUpdatedVoxelColor<false, TVoxel> {
+	_CPU_AND_GPU_CODE_ static void compute(DEVICEPTR(TVoxel) & voxel, const THREADPTR(Vector4f) & pt_model,
+		const CONSTPTR(Matrix4f) & M_rgb, const CONSTPTR(Vector4f) & projParams_rgb, float mu, int maxW, float eta,
+		const CONSTPTR(Vector4u) *rgb, const CONSTPTR(Vector2i) & imgSize_rgb)
+	{
+	}
+};
+
+template<class TVoxel>
+struct ComputeUpdatedVoxelColor<true, TVoxel> {
+	_CPU_AND_GPU_CODE_ static void compute(DEVICEPTR(TVoxel) & voxel, const THREADPTR(Vector4f) & pt_model,
+		const CONSTPTR(Matrix4f) & M_rgb, const CONSTPTR(Vector4f) & projParams_rgb, float mu, int maxW, float eta,
+		const CONSTPTR(Vector4u) *rgb, const CONSTPTR(Vector2i) & imgSize_rgb)
+	{
+		if ((eta > mu) || (fabs(eta / mu) > 0.25f)) return;
+		computeUpdatedVoxelColorInfo(voxel, pt_model, M_rgb, projParams_rgb, mu, maxW, eta, rgb, imgSize_rgb);
+	}
+};
+
+// if allocationRequests is given, the index of every entry whose alloc type changes from 0 is appended to it;
+// concurrent callers may append the same index, so the caller has to deduplicate against entriesAllocType;
+// visible entries are marked by setting their entry in entriesVisibleStamp to visibleStamp
+_CPU_AND_GPU_CODE_ inline void buildHashAllocAndVisibleTypePP(DEVICEPTR(uchar) *entriesAllocType, DEVICEPTR(uint) *entriesVisibleStamp, uint visibleStamp, int x, int y,
 	DEVICEPTR(Vector4s) *blockCoords, const CONSTPTR(float) *depth, Matrix4f invM_d, Vector4f projParams_d, float mu, Vector2i imgSize,
-	float oneOverVoxelSize, const CONSTPTR(ITMHashEntry) *hashTable, float viewFrustum_min, float viewFrustum_max)
+	float oneOverVoxelSize, const CONSTPTR(ITMHashEntry) *hashTable, float viewFrustum_min, float viewFrustum_max,
+	DEVICEPTR(int) *allocationRequests = 0, THREADPTR(int) *noAllocationRequests = 0)
 {
 	float depth_measure; unsigned int hashIdx; int noSteps;
 	Vector4f pt_camera_f; Vector3f point_e, point, direction; Vector3s blockPos;
@@ -211,13 +238,15 @@ _CPU_AND_GPU_CODE_ inline void buildHashAllocAndVisibleTypePP(DEVICEPTR(uchar) *
 
 	direction /= (float)(noSteps - 1);
 
+	int mask = hashMask(hashTable);
+
 	//add neighbouring blocks
 	for (int i = 0; i < noSteps; i++)
 	{
 		blockPos = TO_SHORT_FLOOR3(point);
 
 		//compute index in hash table
-		hashIdx = hashIndex(blockPos);
+		hashIdx = hashIndex(blockPos, mask);
 
 		//check if hash table contains entry
 		bool isFound = false;
@@ -227,7 +256,7 @@ _CPU_AND_GPU_CODE_ inline void buildHashAllocAndVisibleTypePP(DEVICEPTR(uchar) *
 		if (IS_EQUAL3(hashEntry.pos, blockPos) && hashEntry.ptr >= -1)
 		{
 			//entry has been streamed out but is visible or in memory and visible
-			entriesVisibleType[hashIdx] = (hashEntry.ptr == -1) ? 2 : 1;
+			entriesVisibleStamp[hashIdx] = visibleStamp;
 
 			isFound = true;
 		}
@@ -239,13 +268,13 @@ _CPU_AND_GPU_CODE_ inline void buildHashAllocAndVisibleTypePP(DEVICEPTR(uchar) *
 			{
 				while (hashEntry.offset >= 1)
 				{
-					hashIdx = SDF_BUCKET_NUM + hashEntry.offset - 1;
+					hashIdx = excessListIndex(mask, hashEntry.offset);
 					hashEntry = hashTable[hashIdx];
 
 					if (IS_EQUAL3(hashEntry.pos, blockPos) && hashEntry.ptr >= -1)
 					{
 						//entry has been streamed out but is visible or in memory and visible
-						entriesVisibleType[hashIdx] = (hashEntry.ptr == -1) ? 2 : 1;
+						entriesVisibleStamp[hashIdx] = visibleStamp;
 
 						isFound = true;
 						break;
@@ -257,8 +286,11 @@ _CPU_AND_GPU_CODE_ inline void buildHashAllocAndVisibleTypePP(DEVICEPTR(uchar) *
 
 			if (!isFound) //still not found
 			{
+				if (allocationRequests != 0 && entriesAllocType[hashIdx] == 0)
+					allocationRequests[(*noAllocationRequests)++] = (int)hashIdx;
+
 				entriesAllocType[hashIdx] = isExcess ? 2 : 1; //needs allocation 
-				if (!isExcess) entriesVisibleType[hashIdx] = 1; //new entry is visible
+				if (!isExcess) entriesVisibleStamp[hashIdx] = visibleStamp; //new entry is visible
 
 				blockCoords[hashIdx] = Vector4s(blockPos.x, blockPos.y, blockPos.z, 1);
 			}
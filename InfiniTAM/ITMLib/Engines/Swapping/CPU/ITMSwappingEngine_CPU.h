@@ -2,6 +2,9 @@
 
 #pragma once
 
+#include <utility>
+#include <vector>
+
 #include "../Interface/ITMSwappingEngine.h"
 
 namespace ITMLib
@@ -10,26 +13,70 @@ namespace ITMLib
 	class ITMSwappingEngine_CPU : public ITMSwappingEngine < TVoxel, TIndex >
 	{
 	public:
+		int PrefetchFromGlobalMemory(ITMScene<TVoxel, TIndex> *scene, const ITMView *view, const ITMTrackingState *trackingState,
+			ITMRenderState *renderState) { return 0; }
 		void IntegrateGlobalIntoLocal(ITMScene<TVoxel, TIndex> *scene, ITMRenderState *renderState) {}
 		void SaveToGlobalMemory(ITMScene<TVoxel, TIndex> *scene, ITMRenderState *renderState) {}
 		void CleanLocalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, ITMRenderState *renderState) {}
+
+		explicit ITMSwappingEngine_CPU(const ITMSwappingParams& swappingParams) {}
 	};
 
 	template<class TVoxel>
 	class ITMSwappingEngine_CPU<TVoxel, ITMVoxelBlockHash> : public ITMSwappingEngine < TVoxel, ITMVoxelBlockHash >
 	{
 	private:
+		ITMSwappingParams swappingParams;
+
+		/// The blocks selected by CleanLocalMemory(), at most SDF_TRANSFER_BLOCK_NUM
+		int *entriesToClean;
+
+		/// With asynchronous transfers, the entries in the swap-in buffers of the cache that still have to be fetched
+		int noRequestedEntries;
+
+		/** The camera pose of the last call to PrefetchFromGlobalMemory()
+		    and its scene, the motion is only predicted from two poses
+		    in the same scene.
+		*/
+		Matrix4f lastM_d;
+		const ITMScene<TVoxel, ITMVoxelBlockHash> *lastPrefetchScene;
+
+		/// Candidates for prefetching, as distance from the predicted camera and entry id
+		std::vector<std::pair<float, int> > prefetchCandidates;
+
+		/// Candidates for eviction, as frames since they were last seen and entry id
+		std::vector<std::pair<uint, int> > evictionCandidates;
+
+		/** Selects at most SDF_TRANSFER_BLOCK_NUM blocks in active
+		    memory to be swapped out or deleted, following
+		    ITMSwappingParams::evictionPolicy. If @p swapStates is
+		    not NULL, only blocks whose most recent data is in active
+		    memory are selected.
+		*/
+		int BuildListToEvict(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, const ITMRenderState *renderState, const ITMHashSwapState *swapStates,
+			int *entryIDs);
+
+		int BuildListToSwapIn(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, int *neededEntryIDs);
 		int LoadFromGlobalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene);
+		void CombineWithLocal(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, const int *neededEntryIDs, const bool *hasSyncedData,
+			const TVoxel *syncedVoxelBlocks, int noNeededEntries);
 
 	public:
 		// This class is currently just for debugging purposes -- swaps CPU memory to CPU memory.
 		// Potentially this could stream into the host memory from somwhere else (disk, database, etc.).
 
+		int PrefetchFromGlobalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, const ITMView *view, const ITMTrackingState *trackingState,
+			ITMRenderState *renderState);
 		void IntegrateGlobalIntoLocal(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, ITMRenderState *renderState);
 		void SaveToGlobalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, ITMRenderState *renderState);
 		void CleanLocalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, ITMRenderState *renderState);
 
-		ITMSwappingEngine_CPU(void);
+		explicit ITMSwappingEngine_CPU(const ITMSwappingParams& swappingParams);
 		~ITMSwappingEngine_CPU(void);
+
+	private:
+		// Suppress the default copy constructor and assignment operator
+		ITMSwappingEngine_CPU(const ITMSwappingEngine_CPU&);
+		ITMSwappingEngine_CPU& operator=(const ITMSwappingEngine_CPU&);
 	};
 }
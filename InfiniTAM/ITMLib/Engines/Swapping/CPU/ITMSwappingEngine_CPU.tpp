@@ -2,67 +2,200 @@
 
 #include "ITMSwappingEngine_CPU.h"
 
+#include <algorithm>
+#include <functional>
+
 #include "../Shared/ITMSwappingEngine_Shared.h"
 #include "../../../Objects/RenderStates/ITMRenderState_VH.h"
 using namespace ITMLib;
 
 template<class TVoxel>
-ITMSwappingEngine_CPU<TVoxel,ITMVoxelBlockHash>::ITMSwappingEngine_CPU(void)
+ITMSwappingEngine_CPU<TVoxel,ITMVoxelBlockHash>::ITMSwappingEngine_CPU(const ITMSwappingParams& swappingParams)
+	: swappingParams(swappingParams)
 {
+	entriesToClean = new int[SDF_TRANSFER_BLOCK_NUM];
+
+	noRequestedEntries = 0;
+	lastPrefetchScene = NULL;
 }
 
 template<class TVoxel>
 ITMSwappingEngine_CPU<TVoxel,ITMVoxelBlockHash>::~ITMSwappingEngine_CPU(void)
 {
+	delete[] entriesToClean;
 }
 
 template<class TVoxel>
-int ITMSwappingEngine_CPU<TVoxel, ITMVoxelBlockHash>::LoadFromGlobalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene)
+int ITMSwappingEngine_CPU<TVoxel, ITMVoxelBlockHash>::BuildListToSwapIn(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, int *neededEntryIDs)
 {
-	ITMGlobalCache<TVoxel> *globalCache = scene->globalCache;
+	ITMHashSwapState *swapStates = scene->globalCache->GetSwapStates(false);
 
-	ITMHashSwapState *swapStates = globalCache->GetSwapStates(false);
-
-	int *neededEntryIDs_local = globalCache->GetNeededEntryIDs(false);
-
-	TVoxel *syncedVoxelBlocks_global = globalCache->GetSyncedVoxelBlocks(false);
-	bool *hasSyncedData_global = globalCache->GetHasSyncedData(false);
-	int *neededEntryIDs_global = globalCache->GetNeededEntryIDs(false);
-
-	int noTotalEntries = globalCache->noTotalEntries;
+	const int *allocatedEntryIDs = scene->index.GetAllocatedEntryIDs();
+	int noAllocatedEntries = scene->index.GetNumAllocatedEntries();
 
 	int noNeededEntries = 0;
-	for (int entryId = 0; entryId < noTotalEntries; entryId++)
+	for (int listIdx = 0; listIdx < noAllocatedEntries; listIdx++)
 	{
 		if (noNeededEntries >= SDF_TRANSFER_BLOCK_NUM) break;
+
+		int entryId = allocatedEntryIDs[listIdx];
 		if (swapStates[entryId].state == 1)
 		{
-			neededEntryIDs_local[noNeededEntries] = entryId;
+			neededEntryIDs[noNeededEntries] = entryId;
 			noNeededEntries++;
 		}
 	}
 
+	return noNeededEntries;
+}
+
+template<class TVoxel>
+int ITMSwappingEngine_CPU<TVoxel, ITMVoxelBlockHash>::LoadFromGlobalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene)
+{
+	ITMGlobalCache<TVoxel> *globalCache = scene->globalCache;
+
+	int *neededEntryIDs_local = globalCache->GetNeededEntryIDs(false);
+
+	TVoxel *syncedVoxelBlocks_global = globalCache->GetSyncedVoxelBlocks(false);
+	bool *hasSyncedData_global = globalCache->GetHasSyncedData(false);
+	int *neededEntryIDs_global = globalCache->GetNeededEntryIDs(false);
+
+	int noNeededEntries = BuildListToSwapIn(scene, neededEntryIDs_local);
+
 	// would copy neededEntryIDs_local into neededEntryIDs_global here
 
-	if (noNeededEntries > 0)
+	globalCache->FetchStoredBlocks(neededEntryIDs_global, noNeededEntries, hasSyncedData_global, syncedVoxelBlocks_global);
+
+	// would copy syncedVoxelBlocks_global and hasSyncedData_global and syncedVoxelBlocks_local and hasSyncedData_local here
+
+	return noNeededEntries;
+}
+
+template<class TVoxel>
+void ITMSwappingEngine_CPU<TVoxel, ITMVoxelBlockHash>::CombineWithLocal(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, const int *neededEntryIDs,
+	const bool *hasSyncedData, const TVoxel *syncedVoxelBlocks, int noNeededEntries)
+{
+	ITMHashEntry *hashTable = scene->index.GetEntries();
+
+	ITMHashSwapState *swapStates = scene->globalCache->GetSwapStates(false);
+
+	TVoxel *localVBA = scene->localVBA.GetVoxelBlocks();
+	ITMVoxelBlockSummary *blockSummaries = scene->localVBA.GetBlockSummaries();
+
+	int maxW = scene->sceneParams->maxW;
+	bool stopIntegratingAtMaxW = scene->sceneParams->stopIntegratingAtMaxW;
+
+	for (int i = 0; i < noNeededEntries; i++)
 	{
-		memset(syncedVoxelBlocks_global, 0, noNeededEntries * SDF_BLOCK_SIZE3 * sizeof(TVoxel));
-		memset(hasSyncedData_global, 0, noNeededEntries * sizeof(bool));
-		for (int i = 0; i < noNeededEntries; i++)
+		int entryDestId = neededEntryIDs[i];
+		int dstPtr = hashTable[entryDestId].ptr;
+
+		// no active memory was left for the block, it is requested again later
+		if (dstPtr < 0) continue;
+
+		if (hasSyncedData[i])
 		{
-			int entryId = neededEntryIDs_global[i];
+			const TVoxel *srcVB = syncedVoxelBlocks + i * SDF_BLOCK_SIZE3;
+			TVoxel *dstVB = localVBA + dstPtr * SDF_BLOCK_SIZE3;
+
+			ITMVoxelBlockSummary srcSummary = computeVoxelBlockSummary(srcVB, maxW);
 
-			if (globalCache->HasStoredData(entryId))
+			if (stopIntegratingAtMaxW && srcSummary.saturated)
 			{
-				hasSyncedData_global[i] = true;
-				memcpy(syncedVoxelBlocks_global + i * SDF_BLOCK_SIZE3, globalCache->GetStoredVoxelBlock(entryId), SDF_BLOCK_SIZE3 * sizeof(TVoxel));
+				// had the block stayed in active memory, it would have ignored the new data as well
+				memcpy(dstVB, srcVB, SDF_BLOCK_SIZE3 * sizeof(TVoxel));
+				blockSummaries[dstPtr] = srcSummary;
+			}
+			else
+			{
+				for (int vIdx = 0; vIdx < SDF_BLOCK_SIZE3; vIdx++)
+				{
+					CombineVoxelInformation<TVoxel::hasColorInformation, TVoxel>::compute(srcVB[vIdx], dstVB[vIdx], maxW);
+				}
+
+				blockSummaries[dstPtr] = computeVoxelBlockSummary(dstVB, maxW);
 			}
 		}
+
+		swapStates[entryDestId].state = 2;
 	}
+}
 
-	// would copy syncedVoxelBlocks_global and hasSyncedData_global and syncedVoxelBlocks_local and hasSyncedData_local here
+template<class TVoxel>
+int ITMSwappingEngine_CPU<TVoxel, ITMVoxelBlockHash>::PrefetchFromGlobalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, const ITMView *view,
+	const ITMTrackingState *trackingState, ITMRenderState *renderState)
+{
+	Matrix4f M_d = trackingState->pose_d->GetM();
 
-	return noNeededEntries;
+	bool hasPreviousPose = lastPrefetchScene == scene;
+	Matrix4f M_previous = lastM_d;
+	lastM_d = M_d;
+	lastPrefetchScene = scene;
+
+	int maxPrefetchBlocks = swappingParams.maxPrefetchBlocks;
+	if (!hasPreviousPose || maxPrefetchBlocks <= 0) return 0;
+
+	Matrix4f predictedM_d = predictNextPose(M_previous, M_d);
+	Vector4f projParams_d = view->calib.intrinsics_d.projectionParamsSimple.all;
+	Vector2i depthImgSize = view->depth->noDims;
+	float voxelSize = scene->sceneParams->voxelSize;
+	float viewFrustum_max = scene->sceneParams->viewFrustum_max;
+
+	ITMHashSwapState *swapStates = scene->globalCache->GetSwapStates(false);
+
+	ITMHashEntry *hashTable = scene->index.GetEntries();
+	uint *entriesVisibleStamp = ((ITMRenderState_VH*)renderState)->GetEntriesVisibleStamp();
+	uint visibleStamp = ((ITMRenderState_VH*)renderState)->visibleStamp;
+
+	int *voxelAllocationList = scene->localVBA.GetAllocationList();
+
+	const int *allocatedEntryIDs = scene->index.GetAllocatedEntryIDs();
+	int noAllocatedEntries = scene->index.GetNumAllocatedEntries();
+
+	// the blocks requested by the allocation are visible already, so they go first into the transfer buffers
+	int noNeededEntries = 0;
+	prefetchCandidates.clear();
+
+	for (int listIdx = 0; listIdx < noAllocatedEntries; listIdx++)
+	{
+		int entryId = allocatedEntryIDs[listIdx];
+		const ITMHashEntry &hashEntry = hashTable[entryId];
+
+		if (swapStates[entryId].state == 1) noNeededEntries++;
+
+		float depth;
+		if (!checkBlockPrefetch(depth, hashEntry.pos, predictedM_d, projParams_d, voxelSize, depthImgSize, viewFrustum_max)) continue;
+
+		// keeps blocks that are about to be seen from being swapped out by SaveToGlobalMemory, also
+		// those still waiting for their stored data, which would otherwise go right after it arrived
+		if (hashEntry.ptr >= 0) entriesVisibleStamp[entryId] = visibleStamp;
+		else if (swapStates[entryId].state == 0) prefetchCandidates.push_back(std::make_pair(depth, entryId));
+	}
+
+	// leaves as many free blocks as a swap out can give back, for the allocation of new blocks
+	int noFreeBlocks = scene->localVBA.lastFreeBlockId + 1 - SDF_TRANSFER_BLOCK_NUM;
+
+	int noPrefetchedEntries = MIN(maxPrefetchBlocks, SDF_TRANSFER_BLOCK_NUM - noNeededEntries);
+	noPrefetchedEntries = MIN(noPrefetchedEntries, MIN(noFreeBlocks, (int)prefetchCandidates.size()));
+	if (noPrefetchedEntries <= 0) return 0;
+
+	// the closest blocks are the most likely to be seen
+	std::partial_sort(prefetchCandidates.begin(), prefetchCandidates.begin() + noPrefetchedEntries, prefetchCandidates.end());
+
+	int lastFreeVoxelBlockId = scene->localVBA.lastFreeBlockId;
+	for (int i = 0; i < noPrefetchedEntries; i++)
+	{
+		int entryId = prefetchCandidates[i].second;
+
+		hashTable[entryId].ptr = voxelAllocationList[lastFreeVoxelBlockId];
+		lastFreeVoxelBlockId--;
+
+		swapStates[entryId].state = 1;
+		entriesVisibleStamp[entryId] = visibleStamp;
+	}
+	scene->localVBA.lastFreeBlockId = lastFreeVoxelBlockId;
+
+	return noPrefetchedEntries;
 }
 
 template<class TVoxel>
@@ -70,37 +203,77 @@ void ITMSwappingEngine_CPU<TVoxel, ITMVoxelBlockHash>::IntegrateGlobalIntoLocal(
 {
 	ITMGlobalCache<TVoxel> *globalCache = scene->globalCache;
 
-	ITMHashEntry *hashTable = scene->index.GetEntries();
+	if (globalCache->UsesAsyncTransfers())
+	{
+		// the blocks requested in the previous frame, which stayed in state 1 and kept receiving new data meanwhile
+		globalCache->WaitForTransfers();
+		CombineWithLocal(scene, globalCache->GetSwapInEntryIDs(), globalCache->GetHasSwapInData(), globalCache->GetSwapInVoxelBlocks(),
+			globalCache->GetNoSwapInEntries());
+
+		// fetched by the transfers started in SaveToGlobalMemory
+		noRequestedEntries = BuildListToSwapIn(scene, globalCache->GetSwapInEntryIDs());
+		return;
+	}
 
-	ITMHashSwapState *swapStates = globalCache->GetSwapStates(false);
+	int noNeededEntries = this->LoadFromGlobalMemory(scene);
 
-	TVoxel *syncedVoxelBlocks_local = globalCache->GetSyncedVoxelBlocks(false);
-	bool *hasSyncedData_local = globalCache->GetHasSyncedData(false);
-	int *neededEntryIDs_local = globalCache->GetNeededEntryIDs(false);
+	CombineWithLocal(scene, globalCache->GetNeededEntryIDs(false), globalCache->GetHasSyncedData(false), globalCache->GetSyncedVoxelBlocks(false),
+		noNeededEntries);
+}
 
-	TVoxel *localVBA = scene->localVBA.GetVoxelBlocks();
+template<class TVoxel>
+int ITMSwappingEngine_CPU<TVoxel, ITMVoxelBlockHash>::BuildListToEvict(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, const ITMRenderState *renderState,
+	const ITMHashSwapState *swapStates, int *entryIDs)
+{
+	const ITMHashEntry *hashTable = scene->index.GetEntries();
+	const uint *entriesVisibleStamp = ((const ITMRenderState_VH*)renderState)->GetEntriesVisibleStamp();
+	uint visibleStamp = ((const ITMRenderState_VH*)renderState)->visibleStamp;
 
-	int noNeededEntries = this->LoadFromGlobalMemory(scene);
+	const int *allocatedEntryIDs = scene->index.GetAllocatedEntryIDs();
+	int noAllocatedEntries = scene->index.GetNumAllocatedEntries();
 
-	int maxW = scene->sceneParams->maxW;
+	int noEntries = 0;
 
-	for (int i = 0; i < noNeededEntries; i++)
+	if (swappingParams.evictionPolicy == ITMSwappingParams::EVICTIONPOLICY_INVISIBLE)
 	{
-		int entryDestId = neededEntryIDs_local[i];
-
-		if (hasSyncedData_local[i])
+		for (int listIdx = 0; listIdx < noAllocatedEntries; listIdx++)
 		{
-			TVoxel *srcVB = syncedVoxelBlocks_local + i * SDF_BLOCK_SIZE3;
-			TVoxel *dstVB = localVBA + hashTable[entryDestId].ptr * SDF_BLOCK_SIZE3;
+			if (noEntries >= SDF_TRANSFER_BLOCK_NUM) break;
 
-			for (int vIdx = 0; vIdx < SDF_BLOCK_SIZE3; vIdx++)
-			{
-				CombineVoxelInformation<TVoxel::hasColorInformation, TVoxel>::compute(srcVB[vIdx], dstVB[vIdx], maxW);
-			}
+			int entryId = allocatedEntryIDs[listIdx];
+			if (hashTable[entryId].ptr >= 0 && entriesVisibleStamp[entryId] != visibleStamp && (swapStates == NULL || swapStates[entryId].state == 2))
+				entryIDs[noEntries++] = entryId;
 		}
 
-		swapStates[entryDestId].state = 2;
+		return noEntries;
 	}
+
+	// nothing is evicted until active memory holds more blocks than allowed, by default the configured number of
+	// voxel blocks less one transfer, which stays the same when hash growth enlarges the voxel block array
+	int noVoxelBlocks = scene->index.getNumAllocatedVoxelBlocks();
+	int maxActiveBlocks = swappingParams.maxActiveBlocks > 0 ? swappingParams.maxActiveBlocks : scene->sceneParams->noVoxelBlocks - SDF_TRANSFER_BLOCK_NUM;
+	int noExcessBlocks = noVoxelBlocks - scene->localVBA.lastFreeBlockId - 1 - maxActiveBlocks;
+	if (noExcessBlocks <= 0) return 0;
+
+	// visible blocks are 0 frames old
+	uint minEvictionAge = (uint)MAX(swappingParams.minEvictionAge, 1);
+
+	evictionCandidates.clear();
+	for (int listIdx = 0; listIdx < noAllocatedEntries; listIdx++)
+	{
+		int entryId = allocatedEntryIDs[listIdx];
+		if (hashTable[entryId].ptr < 0 || (swapStates != NULL && swapStates[entryId].state != 2)) continue;
+
+		uint age = framesSinceVisible(entriesVisibleStamp[entryId], visibleStamp);
+		if (age >= minEvictionAge) evictionCandidates.push_back(std::make_pair(age, entryId));
+	}
+
+	noEntries = MIN(MIN(noExcessBlocks, SDF_TRANSFER_BLOCK_NUM), (int)evictionCandidates.size());
+
+	std::partial_sort(evictionCandidates.begin(), evictionCandidates.begin() + noEntries, evictionCandidates.end(), std::greater<std::pair<uint, int> >());
+	for (int i = 0; i < noEntries; i++) entryIDs[i] = evictionCandidates[i].second;
+
+	return noEntries;
 }
 
 template<class TVoxel>
@@ -111,53 +284,47 @@ void ITMSwappingEngine_CPU<TVoxel, ITMVoxelBlockHash>::SaveToGlobalMemory(ITMSce
 	ITMHashSwapState *swapStates = globalCache->GetSwapStates(false);
 
 	ITMHashEntry *hashTable = scene->index.GetEntries();
-	uchar *entriesVisibleType = ((ITMRenderState_VH*)renderState)->GetEntriesVisibleType();
 
 	TVoxel *syncedVoxelBlocks_local = globalCache->GetSyncedVoxelBlocks(false);
 	bool *hasSyncedData_local = globalCache->GetHasSyncedData(false);
 	int *neededEntryIDs_local = globalCache->GetNeededEntryIDs(false);
+	Vector3s *syncedBlockPositions_local = globalCache->GetSyncedBlockPositions(false);
 
 	TVoxel *syncedVoxelBlocks_global = globalCache->GetSyncedVoxelBlocks(false);
 	bool *hasSyncedData_global = globalCache->GetHasSyncedData(false);
 	int *neededEntryIDs_global = globalCache->GetNeededEntryIDs(false);
+	Vector3s *syncedBlockPositions_global = globalCache->GetSyncedBlockPositions(false);
 
 	TVoxel *localVBA = scene->localVBA.GetVoxelBlocks();
+	ITMVoxelBlockSummary *blockSummaries = scene->localVBA.GetBlockSummaries();
 	int *voxelAllocationList = scene->localVBA.GetAllocationList();
 
-	int noTotalEntries = globalCache->noTotalEntries;
-	
-	int noNeededEntries = 0;
+	int noNeededEntries = BuildListToEvict(scene, renderState, swapStates, neededEntryIDs_local);
 	int noAllocatedVoxelEntries = scene->localVBA.lastFreeBlockId;
 
-	for (int entryDestId = 0; entryDestId < noTotalEntries; entryDestId++)
+	for (int i = 0; i < noNeededEntries; i++)
 	{
-		if (noNeededEntries >= SDF_TRANSFER_BLOCK_NUM) break;
+		int entryDestId = neededEntryIDs_local[i];
 
 		int localPtr = hashTable[entryDestId].ptr;
-		ITMHashSwapState &swapState = swapStates[entryDestId];
-
-		if (swapState.state == 2 && localPtr >= 0 && entriesVisibleType[entryDestId] == 0)
-		{
-			TVoxel *localVBALocation = localVBA + localPtr * SDF_BLOCK_SIZE3;
+		TVoxel *localVBALocation = localVBA + localPtr * SDF_BLOCK_SIZE3;
 
-			neededEntryIDs_local[noNeededEntries] = entryDestId;
+		syncedBlockPositions_local[i] = hashTable[entryDestId].pos;
 
-			hasSyncedData_local[noNeededEntries] = true;
-			memcpy(syncedVoxelBlocks_local + noNeededEntries * SDF_BLOCK_SIZE3, localVBALocation, SDF_BLOCK_SIZE3 * sizeof(TVoxel));
+		hasSyncedData_local[i] = true;
+		memcpy(syncedVoxelBlocks_local + i * SDF_BLOCK_SIZE3, localVBALocation, SDF_BLOCK_SIZE3 * sizeof(TVoxel));
 
-			swapStates[entryDestId].state = 0;
+		swapStates[entryDestId].state = 0;
 
-			int vbaIdx = noAllocatedVoxelEntries;
-			if (vbaIdx < SDF_BUCKET_NUM - 1)
-			{
-				noAllocatedVoxelEntries++;
-				voxelAllocationList[vbaIdx + 1] = localPtr;
-				hashTable[entryDestId].ptr = -1;
-
-				for (int i = 0; i < SDF_BLOCK_SIZE3; i++) localVBALocation[i] = TVoxel();
-			}
+		int vbaIdx = noAllocatedVoxelEntries;
+		if (vbaIdx < scene->index.getNumAllocatedVoxelBlocks() - 1)
+		{
+			noAllocatedVoxelEntries++;
+			voxelAllocationList[vbaIdx + 1] = localPtr;
+			hashTable[entryDestId].ptr = -1;
 
-			noNeededEntries++;
+			for (int vIdx = 0; vIdx < SDF_BLOCK_SIZE3; vIdx++) localVBALocation[vIdx] = TVoxel();
+			blockSummaries[localPtr] = ITMVoxelBlockSummary::initialSummary();
 		}
 	}
 
@@ -165,53 +332,44 @@ void ITMSwappingEngine_CPU<TVoxel, ITMVoxelBlockHash>::SaveToGlobalMemory(ITMSce
 
 	// would copy neededEntryIDs_local, hasSyncedData_local and syncedVoxelBlocks_local into *_global here
 
-	if (noNeededEntries > 0)
+	if (globalCache->UsesAsyncTransfers())
 	{
-		for (int entryId = 0; entryId < noNeededEntries; entryId++)
-		{
-			if (hasSyncedData_global[entryId])
-				globalCache->SetStoredData(neededEntryIDs_global[entryId], syncedVoxelBlocks_global + entryId * SDF_BLOCK_SIZE3);
-		}
+		globalCache->StartTransfers(noNeededEntries, noRequestedEntries);
+		noRequestedEntries = 0;
 	}
+	else globalCache->StoreBlocks(neededEntryIDs_global, syncedBlockPositions_global, noNeededEntries, hasSyncedData_global, syncedVoxelBlocks_global);
 }
 
 template<class TVoxel>
 void ITMSwappingEngine_CPU<TVoxel, ITMVoxelBlockHash>::CleanLocalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, ITMRenderState *renderState)
 {
 	ITMHashEntry *hashTable = scene->index.GetEntries();
-	uchar *entriesVisibleType = ((ITMRenderState_VH*)renderState)->GetEntriesVisibleType();
 
 	TVoxel *localVBA = scene->localVBA.GetVoxelBlocks();
+	ITMVoxelBlockSummary *blockSummaries = scene->localVBA.GetBlockSummaries();
 	int *voxelAllocationList = scene->localVBA.GetAllocationList();
 
-	int noTotalEntries = scene->index.noTotalEntries;
-
-	int noNeededEntries = 0;
+	int noNeededEntries = BuildListToEvict(scene, renderState, NULL, entriesToClean);
 	int noAllocatedVoxelEntries = scene->localVBA.lastFreeBlockId;
 
-	for (int entryDestId = 0; entryDestId < noTotalEntries; entryDestId++)
+	for (int i = 0; i < noNeededEntries; i++)
 	{
-		if (noNeededEntries >= SDF_TRANSFER_BLOCK_NUM) break;
+		int entryDestId = entriesToClean[i];
 
 		int localPtr = hashTable[entryDestId].ptr;
+		TVoxel *localVBALocation = localVBA + localPtr * SDF_BLOCK_SIZE3;
 
-		if (localPtr >= 0 && entriesVisibleType[entryDestId] == 0)
+		int vbaIdx = noAllocatedVoxelEntries;
+		if (vbaIdx < scene->index.getNumAllocatedVoxelBlocks() - 1)
 		{
-			TVoxel *localVBALocation = localVBA + localPtr * SDF_BLOCK_SIZE3;
-
-			int vbaIdx = noAllocatedVoxelEntries;
-			if (vbaIdx < SDF_BUCKET_NUM - 1)
-			{
-				noAllocatedVoxelEntries++;
-				voxelAllocationList[vbaIdx + 1] = localPtr;
-				hashTable[entryDestId].ptr = -1;
+			noAllocatedVoxelEntries++;
+			voxelAllocationList[vbaIdx + 1] = localPtr;
+			hashTable[entryDestId].ptr = -1;
 
-				for (int i = 0; i < SDF_BLOCK_SIZE3; i++) localVBALocation[i] = TVoxel();
-			}
-
-			noNeededEntries++;
+			for (int vIdx = 0; vIdx < SDF_BLOCK_SIZE3; vIdx++) localVBALocation[vIdx] = TVoxel();
+			blockSummaries[localPtr] = ITMVoxelBlockSummary::initialSummary();
 		}
 	}
 
 	scene->localVBA.lastFreeBlockId = noAllocatedVoxelEntries;
-}
\ No newline at end of file
+}
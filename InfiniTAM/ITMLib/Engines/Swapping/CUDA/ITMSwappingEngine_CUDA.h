@@ -10,26 +10,73 @@ namespace ITMLib
 	class ITMSwappingEngine_CUDA : public ITMSwappingEngine < TVoxel, TIndex >
 	{
 	public:
+		int PrefetchFromGlobalMemory(ITMScene<TVoxel, TIndex> *scene, const ITMView *view, const ITMTrackingState *trackingState,
+			ITMRenderState *renderState) { return 0; }
 		void IntegrateGlobalIntoLocal(ITMScene<TVoxel, TIndex> *scene, ITMRenderState *renderState) {}
 		void SaveToGlobalMemory(ITMScene<TVoxel, TIndex> *scene, ITMRenderState *renderState) {}
 		void CleanLocalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, ITMRenderState *renderState) {}
+
+		explicit ITMSwappingEngine_CUDA(const ITMSwappingParams& swappingParams) {}
 	};
 
 	template<class TVoxel>
 	class ITMSwappingEngine_CUDA<TVoxel, ITMVoxelBlockHash> : public ITMSwappingEngine < TVoxel, ITMVoxelBlockHash >
 	{
 	private:
+		ITMSwappingParams swappingParams;
+
 		int *noNeededEntries_device, *noAllocatedVoxelEntries_device;
 		int *entriesToClean_device;
 
+		/** Scratch space for removing deleted entries from the
+		    list of allocated entries, grown as needed.
+		*/
+		int *allocatedEntryIDs_device, noAllocatedEntryIDs;
+
+		/// With asynchronous transfers, the entries in the swap-in buffers of the cache that still have to be fetched
+		int noRequestedEntries;
+
+		/** The camera pose of the last call to PrefetchFromGlobalMemory()
+		    and its scene, the motion is only predicted from two poses
+		    in the same scene.
+		*/
+		Matrix4f lastM_d;
+		const ITMScene<TVoxel, ITMVoxelBlockHash> *lastPrefetchScene;
+
+		/// Candidates for prefetching, and the numbers of candidates and of blocks requested by the allocation
+		int *prefetchEntryIDs_device, *prefetchCounts_device;
+
+		/// For EVICTIONPOLICY_LEAST_RECENTLY_SEEN, the number of evictable blocks by frames since they were last seen
+		int *evictionAgeHistogram_device;
+
+		int BuildListToSwapIn(ITMScene<TVoxel, ITMVoxelBlockHash> *scene);
+		/** Selects at most SDF_TRANSFER_BLOCK_NUM blocks in active
+		    memory to be swapped out or deleted, following
+		    ITMSwappingParams::evictionPolicy. If @p swapStates is
+		    not NULL, only blocks whose most recent data is in active
+		    memory are selected. The least recently seen blocks are
+		    only selected approximately, by a threshold on the number
+		    of frames since they were seen.
+		*/
+		int BuildListToEvict(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, ITMRenderState *renderState, const ITMHashSwapState *swapStates,
+			int *entryIDs_device);
 		int LoadFromGlobalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene);
+		/// Copies the blocks fetched by the asynchronous transfers to the device
+		int LoadSwappedInBlocks(ITMScene<TVoxel, ITMVoxelBlockHash> *scene);
 
 	public:
+		int PrefetchFromGlobalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, const ITMView *view, const ITMTrackingState *trackingState,
+			ITMRenderState *renderState);
 		void IntegrateGlobalIntoLocal(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, ITMRenderState *renderState);
 		void SaveToGlobalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, ITMRenderState *renderState);
 		void CleanLocalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, ITMRenderState *renderState);
 
-		ITMSwappingEngine_CUDA(void);
+		explicit ITMSwappingEngine_CUDA(const ITMSwappingParams& swappingParams);
 		~ITMSwappingEngine_CUDA(void);
+
+	private:
+		// Suppress the default copy constructor and assignment operator
+		ITMSwappingEngine_CUDA(const ITMSwappingEngine_CUDA&);
+		ITMSwappingEngine_CUDA& operator=(const ITMSwappingEngine_CUDA&);
 	};
 }
@@ -23,26 +23,27 @@ struct ITMSwappingEngineFactory
   /**
    * \brief Makes a swapping engine.
    *
-   * \param deviceType  The device on which the swapping engine should operate.
+   * \param swappingParams  The settings of the swapping engine, such as which blocks it evicts.
+   * \param deviceType      The device on which the swapping engine should operate.
    */
   template <typename TVoxel, typename TIndex>
-  static ITMSwappingEngine<TVoxel,TIndex> *MakeSwappingEngine(ITMLibSettings::DeviceType deviceType)
+  static ITMSwappingEngine<TVoxel,TIndex> *MakeSwappingEngine(const ITMSwappingParams& swappingParams, ITMLibSettings::DeviceType deviceType)
   {
     ITMSwappingEngine<TVoxel,TIndex> *swappingEngine = NULL;
 
     switch(deviceType)
     {
       case ITMLibSettings::DEVICE_CPU:
-        swappingEngine = new ITMSwappingEngine_CPU<TVoxel,TIndex>;
+        swappingEngine = new ITMSwappingEngine_CPU<TVoxel,TIndex>(swappingParams);
         break;
       case ITMLibSettings::DEVICE_CUDA:
 #ifndef COMPILE_WITHOUT_CUDA
-        swappingEngine = new ITMSwappingEngine_CUDA<TVoxel,TIndex>;
+        swappingEngine = new ITMSwappingEngine_CUDA<TVoxel,TIndex>(swappingParams);
 #endif
         break;
       case ITMLibSettings::DEVICE_METAL:
 #ifdef COMPILE_WITH_METAL
-        swappingEngine = new ITMSwappingEngine_CPU<TVoxel,TIndex>;
+        swappingEngine = new ITMSwappingEngine_CPU<TVoxel,TIndex>(swappingParams);
 #endif
         break;
     }
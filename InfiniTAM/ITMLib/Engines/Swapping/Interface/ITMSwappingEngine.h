@@ -4,6 +4,7 @@
 
 #include "../../../Objects/RenderStates/ITMRenderState.h"
 #include "../../../Objects/Scene/ITMScene.h"
+#include "../../../Objects/Tracking/ITMTrackingState.h"
 #include "../../../Objects/Views/ITMView.h"
 
 namespace ITMLib
@@ -17,6 +18,16 @@ namespace ITMLib
 	class ITMSwappingEngine
 	{
 	public:
+		/** Requests the stored blocks that the camera is predicted
+		    to see in the next frame, up to
+		    ITMSwappingParams::maxPrefetchBlocks of them, so that the
+		    following IntegrateGlobalIntoLocal() swaps them in before
+		    they are visible. Blocks in the predicted view are not
+		    swapped out by SaveToGlobalMemory() either. Returns the
+		    number of requested blocks.
+		*/
+		virtual int PrefetchFromGlobalMemory(ITMScene<TVoxel, TIndex> *scene, const ITMView *view, const ITMTrackingState *trackingState,
+			ITMRenderState *renderState) = 0;
 		virtual void IntegrateGlobalIntoLocal(ITMScene<TVoxel, TIndex> *scene, ITMRenderState *renderState) = 0;
 		virtual void SaveToGlobalMemory(ITMScene<TVoxel, TIndex> *scene, ITMRenderState *renderState) = 0;
 		virtual void CleanLocalMemory(ITMScene<TVoxel, ITMVoxelBlockHash> *scene, ITMRenderState *renderState) = 0;
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "../../../Utils/ITMMath.h"
+#include "../../Reconstruction/Shared/ITMSceneReconstructionEngine_Shared.h"
 
 template<class TVoxel>
 _CPU_AND_GPU_CODE_ inline void combineVoxelDepthInformation(const CONSTPTR(TVoxel) & src, DEVICEPTR(TVoxel) & dst, int maxW)
@@ -62,3 +63,40 @@ struct CombineVoxelInformation<true,TVoxel> {
 	}
 };
 
+/** The next pose of a camera moving at constant velocity, where
+    @p M_previous and @p M_current are the world to camera
+    transformations of the last two frames.
+*/
+inline Matrix4f predictNextPose(const Matrix4f &M_previous, const Matrix4f &M_current)
+{
+	Matrix4f invM_previous;
+	M_previous.inv(invM_previous);
+	return M_current * invM_previous * M_current;
+}
+
+// whether a block is worth keeping in or fetching into active memory for a camera at M_d, with its distance from the camera
+_CPU_AND_GPU_CODE_ inline bool checkBlockPrefetch(THREADPTR(float) &depth, const THREADPTR(Vector3s) &hashPos, const CONSTPTR(Matrix4f) &M_d,
+	const CONSTPTR(Vector4f) &projParams_d, float voxelSize, const CONSTPTR(Vector2i) &imgSize, float viewFrustum_max)
+{
+	float blockSize = (float)SDF_BLOCK_SIZE * voxelSize;
+	Vector4f centre((hashPos.x + 0.5f) * blockSize, (hashPos.y + 0.5f) * blockSize, (hashPos.z + 0.5f) * blockSize, 1.0f);
+
+	depth = (M_d * centre).z;
+	if (depth > viewFrustum_max + blockSize) return false;
+
+	bool isVisible, isVisibleEnlarged;
+	checkBlockVisibility<true>(isVisible, isVisibleEnlarged, hashPos, M_d, projParams_d, voxelSize, imgSize);
+	return isVisibleEnlarged;
+}
+
+/** Frames since an entry was last visible, from its stamp in
+    ITMRenderState_VH::GetEntriesVisibleStamp(), which advances by
+    two per frame. A stamp at or ahead of the current one, e.g. of a
+    block that was marked visible while this frame was processed,
+    is 0 frames old.
+*/
+_CPU_AND_GPU_CODE_ inline uint framesSinceVisible(uint entryVisibleStamp, uint visibleStamp)
+{
+	int stampsSinceVisible = (int)(visibleStamp - entryVisibleStamp);
+	return stampsSinceVisible <= 0 ? 0 : (uint)(stampsSinceVisible + 1) / 2;
+}
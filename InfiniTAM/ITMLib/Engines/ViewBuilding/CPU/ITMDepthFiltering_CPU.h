@@ -0,0 +1,49 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <stdlib.h>
+
+#include "../../../Utils/ITMCPUFeatures.h"
+
+namespace ITMLib
+{
+	/** Bilateral filter the pixels [@p x0, @p x1) of one row, several
+	    pixels at a time, like filterDepth() but with a polynomial
+	    approximation of exp(). @p in and @p out point to the first
+	    pixel of the row, @p stride is the distance between rows in
+	    @p in, which must have two valid rows and columns around the
+	    filtered pixels. Returns the number of pixels that were done,
+	    the caller filters the remaining ones at the end of the row.
+	*/
+#define ITM_DECLARE_DEPTH_ROW_FILTER \
+	int FilterDepthRow(float *out, const float *in, int stride, int x0, int x1);
+
+#ifdef WITH_SIMD
+	namespace SSE4 { ITM_DECLARE_DEPTH_ROW_FILTER }
+	namespace AVX2 { ITM_DECLARE_DEPTH_ROW_FILTER }
+	namespace AVX512 { ITM_DECLARE_DEPTH_ROW_FILTER }
+#endif
+
+#undef ITM_DECLARE_DEPTH_ROW_FILTER
+
+	typedef int (*ITMDepthRowFilterFunction)(float *out, const float *in, int stride, int x0, int x1);
+
+	/** Picks the vectorised depth row filter for the instruction
+	    set of the CPU, or returns NULL if there is none.
+	*/
+	inline ITMDepthRowFilterFunction SelectDepthRowFilter(void)
+	{
+#ifdef WITH_SIMD
+		switch (GetCPUInstructionSet())
+		{
+		case CPU_INSTRUCTIONSET_AVX512: return &AVX512::FilterDepthRow;
+		case CPU_INSTRUCTIONSET_AVX2: return &AVX2::FilterDepthRow;
+		case CPU_INSTRUCTIONSET_SSE4: return &SSE4::FilterDepthRow;
+		default: return NULL;
+		}
+#else
+		return NULL;
+#endif
+	}
+}
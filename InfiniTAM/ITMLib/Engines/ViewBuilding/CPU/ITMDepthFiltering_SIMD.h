@@ -0,0 +1,82 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+// Only to be included by the ITMDepthFiltering_<ISA>.cpp files, after they
+// have included the SIMDOps for their instruction set. As for the voxel block
+// integration, nothing in here may call inline functions that are shared with
+// the rest of the library, so the constants of filterDepth() are repeated.
+
+#include "ITMDepthFiltering_CPU.h"
+
+namespace
+{
+	typedef SIMDOps::vf vf;
+
+	// exp() for arguments <= 0, with the polynomial from the Cephes library
+	inline vf expNonPositive(vf x)
+	{
+		x = SIMDOps::max(x, SIMDOps::set1(-87.0f));
+
+		vf fx = SIMDOps::floor(SIMDOps::add(SIMDOps::mul(x, SIMDOps::set1(1.44269504088896341f)), SIMDOps::set1(0.5f)));
+		x = SIMDOps::sub(x, SIMDOps::mul(fx, SIMDOps::set1(0.693359375f)));
+		x = SIMDOps::sub(x, SIMDOps::mul(fx, SIMDOps::set1(-2.12194440e-4f)));
+
+		vf y = SIMDOps::set1(1.9875691500e-4f);
+		y = SIMDOps::add(SIMDOps::mul(y, x), SIMDOps::set1(1.3981999507e-3f));
+		y = SIMDOps::add(SIMDOps::mul(y, x), SIMDOps::set1(8.3334519073e-3f));
+		y = SIMDOps::add(SIMDOps::mul(y, x), SIMDOps::set1(4.1665795894e-2f));
+		y = SIMDOps::add(SIMDOps::mul(y, x), SIMDOps::set1(1.6666665459e-1f));
+		y = SIMDOps::add(SIMDOps::mul(y, x), SIMDOps::set1(5.0000001201e-1f));
+		y = SIMDOps::add(SIMDOps::add(SIMDOps::mul(y, SIMDOps::mul(x, x)), x), SIMDOps::set1(1.0f));
+
+		return SIMDOps::scale2(y, SIMDOps::cvtt(fx));
+	}
+
+	int filterDepthRow(float *out, const float *in, int stride, int x0, int x1)
+	{
+		const int W = SIMDOps::W;
+		const float meanSigmaL = 1.2232f;
+
+		const vf zero = SIMDOps::set1(0.0f), one = SIMDOps::set1(1.0f), minusOne = SIMDOps::set1(-1.0f), minusHalf = SIMDOps::set1(-0.5f);
+
+		// the spatial part of the weight only depends on |i| + |j|
+		vf spatial[5];
+		for (int n = 0; n < 5; n++) spatial[n] = SIMDOps::set1((float)n * meanSigmaL * meanSigmaL);
+
+		int x = x0;
+		for (; x + W <= x1; x += W)
+		{
+			vf z = SIMDOps::loadf(in + x);
+
+			vf dz0 = SIMDOps::sub(z, SIMDOps::set1(0.4f));
+			vf sigma_z = SIMDOps::add(SIMDOps::set1(0.0012f), SIMDOps::mul(SIMDOps::mul(SIMDOps::set1(0.0019f), dz0), dz0));
+			sigma_z = SIMDOps::add(sigma_z, SIMDOps::mul(SIMDOps::div(SIMDOps::set1(0.0001f), SIMDOps::sqrt(z)), SIMDOps::set1(0.25f)));
+			sigma_z = SIMDOps::div(one, sigma_z);
+
+			vf w_sum = zero, final_depth = zero;
+
+			for (int i = -2; i <= 2; i++) for (int j = -2; j <= 2; j++)
+			{
+				vf tmpz = SIMDOps::loadf(in + x + j + i * stride);
+
+				vf dz = SIMDOps::sub(tmpz, z); dz = SIMDOps::mul(dz, dz);
+				vf w = SIMDOps::mul(minusHalf, SIMDOps::add(spatial[abs(i) + abs(j)], SIMDOps::mul(SIMDOps::mul(dz, sigma_z), sigma_z)));
+				w = SIMDOps::select(SIMDOps::ge(tmpz, zero), expNonPositive(w), zero);
+
+				w_sum = SIMDOps::add(w_sum, w);
+				final_depth = SIMDOps::add(final_depth, SIMDOps::mul(w, tmpz));
+			}
+
+			SIMDOps::storef(out + x, SIMDOps::select(SIMDOps::gt(zero, z), minusOne, SIMDOps::div(final_depth, w_sum)));
+		}
+
+		return x - x0;
+	}
+}
+
+#define ITM_DEFINE_DEPTH_ROW_FILTER \
+	int FilterDepthRow(float *out, const float *in, int stride, int x0, int x1) \
+	{ \
+		return filterDepthRow(out, in, stride, x0, x1); \
+	}
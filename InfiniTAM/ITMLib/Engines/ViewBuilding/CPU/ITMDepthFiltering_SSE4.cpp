@@ -0,0 +1,10 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#ifdef WITH_SIMD
+
+#include "../../../Utils/ITMSIMDOps_SSE4.h"
+#include "ITMDepthFiltering_SIMD.h"
+
+namespace ITMLib { namespace SSE4 { ITM_DEFINE_DEPTH_ROW_FILTER } }
+
+#endif
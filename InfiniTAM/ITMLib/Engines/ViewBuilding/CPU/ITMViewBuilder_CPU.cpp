@@ -1,6 +1,7 @@
 // Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
 
 #include "ITMViewBuilder_CPU.h"
+#include "ITMDepthFiltering_CPU.h"
 
 #include "../Shared/ITMViewBuilder_Shared.h"
 #include "../../../../ORUtils/MetalContext.h"
@@ -8,8 +9,12 @@
 using namespace ITMLib;
 using namespace ORUtils;
 
-ITMViewBuilder_CPU::ITMViewBuilder_CPU(const ITMRGBDCalib& calib):ITMViewBuilder(calib) { }
-ITMViewBuilder_CPU::~ITMViewBuilder_CPU(void) { }
+// rows per band of DepthFilteringMultiPass(), the bands are filtered in
+// parallel and each one recomputes 4 * (noPasses - 1) rows of its neighbours
+static const int filterBandHeight = 64;
+
+ITMViewBuilder_CPU::ITMViewBuilder_CPU(const ITMRGBDCalib& calib):ITMViewBuilder(calib) { filterBuffer = NULL; }
+ITMViewBuilder_CPU::~ITMViewBuilder_CPU(void) { if (filterBuffer != NULL) delete filterBuffer; }
 
 void ITMViewBuilder_CPU::UpdateView(ITMView **view_ptr, ITMUChar4Image *rgbImage, ITMShortImage *rawDepthImage, bool useBilateralFilter, bool modelSensorNoise, bool storePreviousImage)
 { 
@@ -53,11 +58,7 @@ void ITMViewBuilder_CPU::UpdateView(ITMView **view_ptr, ITMUChar4Image *rgbImage
 	if (useBilateralFilter)
 	{
 		//5 steps of bilateral filtering
-		this->DepthFiltering(this->floatImage, view->depth);
-		this->DepthFiltering(view->depth, this->floatImage);
-		this->DepthFiltering(this->floatImage, view->depth);
-		this->DepthFiltering(view->depth, this->floatImage);
-		this->DepthFiltering(this->floatImage, view->depth);
+		this->DepthFilteringMultiPass(this->floatImage, view->depth, 5);
 		view->depth->SetFrom(this->floatImage, MemoryBlock<float>::CPU_TO_CPU);
 	}
 
@@ -115,17 +116,93 @@ void ITMViewBuilder_CPU::ConvertDepthAffineToFloat(ITMFloatImage *depth_out, con
 		convertDepthAffineToFloat(d_out, x, y, d_in, imgSize, depthCalibParams);
 }
 
+// one output row of DepthFiltering(), the rows are zero at the image border
+static void filterDepthRow(float *out, const float *in, int y, Vector2i imgSize, ITMDepthRowFilterFunction filterRow)
+{
+	if (y < 2 || y >= imgSize.y - 2)
+	{
+		for (int x = 0; x < imgSize.x; x++) out[x] = 0.0f;
+		return;
+	}
+
+	out[0] = out[1] = 0.0f;
+	out[imgSize.x - 2] = out[imgSize.x - 1] = 0.0f;
+
+	int x = 2;
+	if (filterRow != NULL) x += filterRow(out, in, imgSize.x, 2, imgSize.x - 2);
+	for (; x < imgSize.x - 2; x++) filterDepth(out, in, x, 0, imgSize);
+}
+
 void ITMViewBuilder_CPU::DepthFiltering(ITMFloatImage *image_out, const ITMFloatImage *image_in)
 {
 	Vector2i imgSize = image_in->noDims;
 
-	image_out->Clear();
+	float *imout = image_out->GetData(MEMORYDEVICE_CPU);
+	const float *imin = image_in->GetData(MEMORYDEVICE_CPU);
+
+	ITMDepthRowFilterFunction filterRow = SelectDepthRowFilter();
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < imgSize.y; y++)
+		filterDepthRow(imout + y * imgSize.x, imin + y * imgSize.x, y, imgSize, filterRow);
+}
+
+void ITMViewBuilder_CPU::DepthFilteringMultiPass(ITMFloatImage *image_out, const ITMFloatImage *image_in, int noPasses)
+{
+	Vector2i imgSize = image_in->noDims;
 
 	float *imout = image_out->GetData(MEMORYDEVICE_CPU);
 	const float *imin = image_in->GetData(MEMORYDEVICE_CPU);
 
-	for (int y = 2; y < imgSize.y - 2; y++) for (int x = 2; x < imgSize.x - 2; x++)
-		filterDepth(imout, imin, x, y, imgSize);
+	ITMDepthRowFilterFunction filterRow = SelectDepthRowFilter();
+
+	// All but the last pass keep the five rows that the next pass reads
+	// in a ring. Every row is stored twice, at slots k and k + 5, so that
+	// the five rows around any row are consecutive in memory.
+	int noBands = (imgSize.y + filterBandHeight - 1) / filterBandHeight;
+	size_t ringSize = 10 * (size_t)imgSize.x, bandBufferSize = (noPasses - 1) * ringSize;
+
+	if (filterBuffer == NULL) filterBuffer = new ORUtils::MemoryBlock<float>(MAX(noBands * bandBufferSize, (size_t)1), MEMORYDEVICE_CPU);
+	else if (filterBuffer->dataSize < noBands * bandBufferSize) filterBuffer->Resize(noBands * bandBufferSize);
+
+	float *buffers = filterBuffer->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int bandId = 0; bandId < noBands; bandId++)
+	{
+		int bandStart = bandId * filterBandHeight;
+		int bandEnd = MIN(bandStart + filterBandHeight, imgSize.y);
+		float *rings = buffers + bandId * bandBufferSize;
+
+		// Pass p computes row y - 2p in step y, right after pass p - 1 has
+		// computed the last row it needs. Every pass also has to produce
+		// the rows of the neighbouring bands that the later passes read.
+		for (int y = bandStart - 2 * (noPasses - 1); y < bandEnd + 2 * (noPasses - 1); y++)
+		{
+			for (int pass = 0; pass < noPasses; pass++)
+			{
+				int row = y - 2 * pass, margin = 2 * (noPasses - 1 - pass);
+				if (row < MAX(bandStart - margin, 0) || row >= MIN(bandEnd + margin, imgSize.y)) continue;
+
+				// rows row - 2 to row + 2 start at slot (row - 2) % 5, only rows >= 2 read their inputs
+				const float *in = pass == 0 ? imin + row * imgSize.x : rings + (pass - 1) * ringSize + ((row + 3) % 5 + 2) * imgSize.x;
+
+				if (pass == noPasses - 1)
+				{
+					filterDepthRow(imout + row * imgSize.x, in, row, imgSize, filterRow);
+					continue;
+				}
+
+				float *out = rings + pass * ringSize + (row % 5) * imgSize.x;
+				filterDepthRow(out, in, row, imgSize, filterRow);
+				memcpy(out + 5 * imgSize.x, out, imgSize.x * sizeof(float));
+			}
+		}
+	}
 }
 
 void ITMViewBuilder_CPU::ComputeNormalAndWeights(ITMFloat4Image *normal_out, ITMFloatImage *sigmaZ_out, const ITMFloatImage *depth_in, Vector4f intrinsic)
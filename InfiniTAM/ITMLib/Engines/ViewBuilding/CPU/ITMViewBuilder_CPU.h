@@ -8,12 +8,22 @@ namespace ITMLib
 {
 	class ITMViewBuilder_CPU : public ITMViewBuilder
 	{
+	private:
+		/** Scratch rows for DepthFilteringMultiPass(), two buffers per band. */
+		ORUtils::MemoryBlock<float> *filterBuffer;
+
 	public:
 		void ConvertDisparityToDepth(ITMFloatImage *depth_out, const ITMShortImage *disp_in, const ITMIntrinsics *depthIntrinsics, 
 			Vector2f disparityCalibParams);
 		void ConvertDepthAffineToFloat(ITMFloatImage *depth_out, const ITMShortImage *depth_in, Vector2f depthCalibParams);
 
 		void DepthFiltering(ITMFloatImage *image_out, const ITMFloatImage *image_in);
+		/** Same as calling DepthFiltering() @p noPasses times, but the
+		    image is processed in bands of rows that go through all
+		    passes while they are in the cache. @p image_out must not
+		    be @p image_in.
+		*/
+		void DepthFilteringMultiPass(ITMFloatImage *image_out, const ITMFloatImage *image_in, int noPasses);
 		void ComputeNormalAndWeights(ITMFloat4Image *normal_out, ITMFloatImage *sigmaZ_out, const ITMFloatImage *depth_in, Vector4f intrinsic);
 
 		void UpdateView(ITMView **view, ITMUChar4Image *rgbImage, ITMShortImage *rawDepthImage, bool useBilateralFilter, bool modelSensorNoise = false, bool storePreviousImage = true);
@@ -44,7 +44,7 @@ void ITMMultiVisualisationEngine_CPU<TVoxel, TIndex>::CreateExpectedDepths(const
 	{
 		float voxelSize = renderState->sceneParams.voxelSize;
 		const ITMHashEntry *hash_entries = renderState->indexData_host.index[localMapId];
-		int noHashEntries = ITMVoxelBlockHash::noTotalEntries;
+		int noHashEntries = renderState->indexData_host.noTotalEntries[localMapId];
 
 		std::vector<RenderingBlock> renderingBlocks(MAX_RENDERING_BLOCKS);
 		int numRenderingBlocks = 0;
@@ -120,7 +120,7 @@ void ITMMultiVisualisationEngine_CPU<TVoxel, TIndex>::RenderImage(const ORUtils:
 			int x = locId - y*imgSize.x;
 			int locId2 = (int)floor((float)x / minmaximg_subsample) + (int)floor((float)y / minmaximg_subsample) * imgSize.x;
 
-			castRay<VD, ID, false>(pointsRay[locId], NULL, x, y, &renderState->voxelData_host, &renderState->indexData_host, invM, invProjParams, oneOverVoxelSize, mu, minmaximg[locId2]);
+			castRay<VD, ID, false>(pointsRay[locId], NULL, 0, x, y, &renderState->voxelData_host, &renderState->indexData_host, NULL, invM, invProjParams, oneOverVoxelSize, mu, minmaximg[locId2]);
 		}
 	}
 
@@ -5,10 +5,16 @@
 #include "../Shared/ITMVisualisationEngine_Shared.h"
 #include "../../Reconstruction/Shared/ITMSceneReconstructionEngine_Shared.h"
 
+#include <string.h>
 #include <vector>
 
 using namespace ITMLib;
 
+// number of entries of the allocated entry list that FindVisibleBlocks checks in one go
+static const int visibleListChunkSize = 4096;
+// size of the screen tiles, in pixels of the rendering range image, that CreateExpectedDepths fills in one go
+static const int renderingTileSize = 8;
+
 template<class TVoxel, class TIndex>
 static int RenderPointCloud(Vector4u *outRendering, Vector4f *locations, Vector4f *colours, const Vector4f *ptsRay, 
 	const TVoxel *voxelData, const typename TIndex::IndexData *voxelIndex, bool skipPoints, float voxelSize, 
@@ -26,7 +32,7 @@ template<class TVoxel>
 ITMRenderState_VH* ITMVisualisationEngine_CPU<TVoxel, ITMVoxelBlockHash>::CreateRenderState(const ITMScene<TVoxel, ITMVoxelBlockHash> *scene, const Vector2i & imgSize) const
 {
 	return new ITMRenderState_VH(
-		ITMVoxelBlockHash::noTotalEntries, imgSize, scene->sceneParams->viewFrustum_min, scene->sceneParams->viewFrustum_max, MEMORYDEVICE_CPU
+		scene->index.noTotalEntries, imgSize, scene->sceneParams->viewFrustum_min, scene->sceneParams->viewFrustum_max, MEMORYDEVICE_CPU
 	);
 }
 
@@ -41,6 +47,8 @@ void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::FindVisibleBlocks(con
 {
 	const ITMHashEntry *hashTable = scene->index.GetEntries();
 	int noTotalEntries = scene->index.noTotalEntries;
+	const int *allocatedEntryIDs = scene->index.GetAllocatedEntryIDs();
+	int noAllocatedEntries = scene->index.GetNumAllocatedEntries();
 	float voxelSize = scene->sceneParams->voxelSize;
 	Vector2i imgSize = renderState->renderingRangeImage->noDims;
 
@@ -48,28 +56,46 @@ void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::FindVisibleBlocks(con
 	Vector4f projParams = intrinsics->projectionParamsSimple.all;
 
 	ITMRenderState_VH *renderState_vh = (ITMRenderState_VH*)renderState;
+	renderState_vh->Resize(noTotalEntries);
 
-	int noVisibleEntries = 0;
 	int *visibleEntryIDs = renderState_vh->GetVisibleEntryIDs();
 
+	// each chunk of the allocated entry list collects its visible entries at its own
+	// position in the visible list, then the chunks are packed in order
+	int noChunks = (noAllocatedEntries + visibleListChunkSize - 1) / visibleListChunkSize;
+	std::vector<int> noChunkVisibleEntries(noChunks);
+
 	//build visible list
-	for (int targetIdx = 0; targetIdx < noTotalEntries; targetIdx++)
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int chunkId = 0; chunkId < noChunks; chunkId++)
 	{
-		unsigned char hashVisibleType = 0;// = entriesVisibleType[targetIdx];
-		const ITMHashEntry &hashEntry = hashTable[targetIdx];
+		int chunkStart = chunkId * visibleListChunkSize;
+		int chunkEnd = MIN(chunkStart + visibleListChunkSize, noAllocatedEntries);
+		int noVisibleInChunk = 0;
 
-		if (hashEntry.ptr >= 0)
+		for (int listIdx = chunkStart; listIdx < chunkEnd; listIdx++)
 		{
+			int targetIdx = allocatedEntryIDs[listIdx];
+			const ITMHashEntry &hashEntry = hashTable[targetIdx];
+
+			if (hashEntry.ptr < 0) continue;
+
 			bool isVisible, isVisibleEnlarged;
 			checkBlockVisibility<false>(isVisible, isVisibleEnlarged, hashEntry.pos, M, projParams, voxelSize, imgSize);
-			hashVisibleType = isVisible;
-		}
 
-		if (hashVisibleType > 0)
-		{
-			visibleEntryIDs[noVisibleEntries] = targetIdx;
-			noVisibleEntries++;
+			if (isVisible) visibleEntryIDs[chunkStart + noVisibleInChunk++] = targetIdx;
 		}
+
+		noChunkVisibleEntries[chunkId] = noVisibleInChunk;
+	}
+
+	int noVisibleEntries = 0;
+	for (int chunkId = 0; chunkId < noChunks; chunkId++)
+	{
+		memmove(visibleEntryIDs + noVisibleEntries, visibleEntryIDs + chunkId * visibleListChunkSize, noChunkVisibleEntries[chunkId] * sizeof(int));
+		noVisibleEntries += noChunkVisibleEntries[chunkId];
 	}
 
 	renderState_vh->noVisibleEntries = noVisibleEntries;
@@ -119,55 +145,107 @@ void ITMVisualisationEngine_CPU<TVoxel,ITMVoxelBlockHash>::CreateExpectedDepths(
 	Vector2i imgSize = renderState->renderingRangeImage->noDims;
 	Vector2f *minmaxData = renderState->renderingRangeImage->GetData(MEMORYDEVICE_CPU);
 
-	for (int locId = 0; locId < imgSize.x*imgSize.y; ++locId) {
-		Vector2f & pixel = minmaxData[locId];
-		pixel.x = FAR_AWAY;
-		pixel.y = VERY_CLOSE;
-	}
-
 	float voxelSize = scene->sceneParams->voxelSize;
-
-	std::vector<RenderingBlock> renderingBlocks(MAX_RENDERING_BLOCKS);
-	int numRenderingBlocks = 0;
+	Matrix4f M = pose->GetM();
+	Vector4f projParams = intrinsics->projectionParamsSimple.all;
 
 	ITMRenderState_VH* renderState_vh = (ITMRenderState_VH*)renderState;
 
+	const ITMHashEntry *hashTable = scene->index.GetEntries();
 	const int *visibleEntryIDs = renderState_vh->GetVisibleEntryIDs();
 	int noVisibleEntries = renderState_vh->noVisibleEntries;
 
-	//go through list of visible 8x8x8 blocks
+	// project the visible 8x8x8 blocks
+	std::vector<Vector2i> upperLefts(noVisibleEntries), lowerRights(noVisibleEntries);
+	std::vector<Vector2f> zRanges(noVisibleEntries);
+	std::vector<int> renderingBlockOffsets(noVisibleEntries);
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
 	for (int blockNo = 0; blockNo < noVisibleEntries; ++blockNo) {
-		const ITMHashEntry & blockData(scene->index.GetEntries()[visibleEntryIDs[blockNo]]);
+		const ITMHashEntry & blockData(hashTable[visibleEntryIDs[blockNo]]);
 
-		Vector2i upperLeft, lowerRight;
-		Vector2f zRange;
 		bool validProjection = false;
 		if (blockData.ptr>=0) {
-			validProjection = ProjectSingleBlock(blockData.pos, pose->GetM(), intrinsics->projectionParamsSimple.all, imgSize, voxelSize, upperLeft, lowerRight, zRange);
+			validProjection = ProjectSingleBlock(blockData.pos, M, projParams, imgSize, voxelSize, upperLefts[blockNo], lowerRights[blockNo], zRanges[blockNo]);
 		}
-		if (!validProjection) continue;
+		renderingBlockOffsets[blockNo] = validProjection ? 0 : -1;
+	}
 
-		Vector2i requiredRenderingBlocks((int)ceilf((float)(lowerRight.x - upperLeft.x + 1) / (float)renderingBlockSizeX), 
-			(int)ceilf((float)(lowerRight.y - upperLeft.y + 1) / (float)renderingBlockSizeY));
+	// hand out the rendering blocks in the order of the visible list, so that the
+	// same ones are dropped as when running serially if there are too many
+	int numRenderingBlocks = 0;
+	for (int blockNo = 0; blockNo < noVisibleEntries; ++blockNo) {
+		if (renderingBlockOffsets[blockNo] < 0) continue;
+
+		Vector2i requiredRenderingBlocks((int)ceilf((float)(lowerRights[blockNo].x - upperLefts[blockNo].x + 1) / (float)renderingBlockSizeX),
+			(int)ceilf((float)(lowerRights[blockNo].y - upperLefts[blockNo].y + 1) / (float)renderingBlockSizeY));
 		int requiredNumBlocks = requiredRenderingBlocks.x * requiredRenderingBlocks.y;
 
-		if (numRenderingBlocks + requiredNumBlocks >= MAX_RENDERING_BLOCKS) continue;
-		int offset = numRenderingBlocks;
+		if (numRenderingBlocks + requiredNumBlocks >= MAX_RENDERING_BLOCKS) { renderingBlockOffsets[blockNo] = -1; continue; }
+		renderingBlockOffsets[blockNo] = numRenderingBlocks;
 		numRenderingBlocks += requiredNumBlocks;
+	}
+
+	std::vector<RenderingBlock> renderingBlocks(MAX(numRenderingBlocks, 1));
 
-		CreateRenderingBlocks(&(renderingBlocks[0]), offset, upperLeft, lowerRight, zRange);
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int blockNo = 0; blockNo < noVisibleEntries; ++blockNo) {
+		if (renderingBlockOffsets[blockNo] < 0) continue;
+		CreateRenderingBlocks(&(renderingBlocks[0]), renderingBlockOffsets[blockNo], upperLefts[blockNo], lowerRights[blockNo], zRanges[blockNo]);
 	}
 
-	// go through rendering blocks
+	// sort the rendering blocks into the screen tiles they overlap
+	Vector2i noTiles((imgSize.x + renderingTileSize - 1) / renderingTileSize, (imgSize.y + renderingTileSize - 1) / renderingTileSize);
+	std::vector<int> tileOffsets(noTiles.x * noTiles.y + 1, 0);
+
 	for (int blockNo = 0; blockNo < numRenderingBlocks; ++blockNo) {
-		// fill minmaxData
 		const RenderingBlock & b(renderingBlocks[blockNo]);
+		for (int ty = b.upperLeft.y / renderingTileSize; ty <= b.lowerRight.y / renderingTileSize; ++ty)
+			for (int tx = b.upperLeft.x / renderingTileSize; tx <= b.lowerRight.x / renderingTileSize; ++tx)
+				tileOffsets[tx + ty * noTiles.x + 1]++;
+	}
+
+	for (int tileId = 0; tileId < noTiles.x * noTiles.y; ++tileId) tileOffsets[tileId + 1] += tileOffsets[tileId];
 
-		for (int y = b.upperLeft.y; y <= b.lowerRight.y; ++y) {
-			for (int x = b.upperLeft.x; x <= b.lowerRight.x; ++x) {
+	std::vector<int> tileBlocks(MAX(tileOffsets[noTiles.x * noTiles.y], 1));
+	std::vector<int> tileFill(tileOffsets.begin(), tileOffsets.end() - 1);
+
+	for (int blockNo = 0; blockNo < numRenderingBlocks; ++blockNo) {
+		const RenderingBlock & b(renderingBlocks[blockNo]);
+		for (int ty = b.upperLeft.y / renderingTileSize; ty <= b.lowerRight.y / renderingTileSize; ++ty)
+			for (int tx = b.upperLeft.x / renderingTileSize; tx <= b.lowerRight.x / renderingTileSize; ++tx)
+				tileBlocks[tileFill[tx + ty * noTiles.x]++] = blockNo;
+	}
+
+	// fill minmaxData, each tile with the rendering blocks that overlap it
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int tileId = 0; tileId < noTiles.x * noTiles.y; ++tileId) {
+		int tileX = (tileId % noTiles.x) * renderingTileSize, tileY = (tileId / noTiles.x) * renderingTileSize;
+		int tileEndX = MIN(tileX + renderingTileSize, imgSize.x) - 1, tileEndY = MIN(tileY + renderingTileSize, imgSize.y) - 1;
+
+		for (int y = tileY; y <= tileEndY; ++y) {
+			for (int x = tileX; x <= tileEndX; ++x) {
 				Vector2f & pixel(minmaxData[x + y*imgSize.x]);
-				if (pixel.x > b.zRange.x) pixel.x = b.zRange.x;
-				if (pixel.y < b.zRange.y) pixel.y = b.zRange.y;
+				pixel.x = FAR_AWAY;
+				pixel.y = VERY_CLOSE;
+			}
+		}
+
+		for (int binNo = tileOffsets[tileId]; binNo < tileOffsets[tileId + 1]; ++binNo) {
+			const RenderingBlock & b(renderingBlocks[tileBlocks[binNo]]);
+
+			for (int y = MAX(b.upperLeft.y, tileY); y <= MIN(b.lowerRight.y, tileEndY); ++y) {
+				for (int x = MAX(b.upperLeft.x, tileX); x <= MIN(b.lowerRight.x, tileEndX); ++x) {
+					Vector2f & pixel(minmaxData[x + y*imgSize.x]);
+					if (pixel.x > b.zRange.x) pixel.x = b.zRange.x;
+					if (pixel.y < b.zRange.y) pixel.y = b.zRange.y;
+				}
 			}
 		}
 	}
@@ -182,10 +260,13 @@ static void GenericRaycast(const ITMScene<TVoxel, TIndex> *scene, const Vector2i
 	Vector4f *pointsRay = renderState->raycastResult->GetData(MEMORYDEVICE_CPU);
 	const TVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
 	const typename ITMVoxelBlockHash::IndexData *voxelIndex = scene->index.getIndexData();
-	uchar *entriesVisibleType = NULL;
+	const ITMVoxelBlockSummary *blockSummaries = scene->localVBA.GetBlockSummaries();
+	uint *entriesVisibleStamp = NULL, visibleStamp = 0;
 	if (updateVisibleList&&(dynamic_cast<const ITMRenderState_VH*>(renderState)!=NULL))
 	{
-		entriesVisibleType = ((ITMRenderState_VH*)renderState)->GetEntriesVisibleType();
+		// blocks hit by the rays stay in the live list of the next frame
+		entriesVisibleStamp = ((ITMRenderState_VH*)renderState)->GetEntriesVisibleStamp();
+		visibleStamp = ((ITMRenderState_VH*)renderState)->NextVisibleStamp();
 	}
 
 #ifdef WITH_OPENMP
@@ -197,12 +278,14 @@ static void GenericRaycast(const ITMScene<TVoxel, TIndex> *scene, const Vector2i
 		int x = locId - y*imgSize.x;
 		int locId2 = (int)floor((float)x / minmaximg_subsample) + (int)floor((float)y / minmaximg_subsample) * imgSize.x;
 
-		if (entriesVisibleType!=NULL) castRay<TVoxel, TIndex, true>(
+		if (entriesVisibleStamp!=NULL) castRay<TVoxel, TIndex, true>(
 				pointsRay[locId],
-				entriesVisibleType,
+				entriesVisibleStamp,
+				visibleStamp,
 				x, y,
 				voxelData,
 				voxelIndex,
+				blockSummaries,
 				invM,
 				InvertProjectionParams(projParams),
 				oneOverVoxelSize,
@@ -212,9 +295,11 @@ static void GenericRaycast(const ITMScene<TVoxel, TIndex> *scene, const Vector2i
 		else castRay<TVoxel, TIndex, false>(
 				pointsRay[locId],
 				NULL,
+				0,
 				x, y,
 				voxelData,
 				voxelIndex,
+				blockSummaries,
 				invM,
 				InvertProjectionParams(projParams),
 				oneOverVoxelSize,
@@ -394,6 +479,7 @@ static void ForwardRender_common(const ITMScene<TVoxel, TIndex> *scene, const IT
 	float voxelSize = scene->sceneParams->voxelSize;
 	const TVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
 	const typename TIndex::IndexData *voxelIndex = scene->index.getIndexData();
+	const ITMVoxelBlockSummary *blockSummaries = scene->localVBA.GetBlockSummaries();
 
 	renderState->forwardProjection->Clear();
 
@@ -433,7 +519,7 @@ static void ForwardRender_common(const ITMScene<TVoxel, TIndex> *scene, const IT
 		int y = locId / imgSize.x, x = locId - y*imgSize.x;
 		int locId2 = (int)floor((float)x / minmaximg_subsample) + (int)floor((float)y / minmaximg_subsample) * imgSize.x;
 
-		castRay<TVoxel, TIndex, false>(forwardProjection[locId], NULL, x, y, voxelData, voxelIndex, invM, invProjParams,
+		castRay<TVoxel, TIndex, false>(forwardProjection[locId], NULL, 0, x, y, voxelData, voxelIndex, blockSummaries, invM, invProjParams,
 			1.0f / scene->sceneParams->voxelSize, scene->sceneParams->mu, minmaximg[locId2]);
 	}
 }
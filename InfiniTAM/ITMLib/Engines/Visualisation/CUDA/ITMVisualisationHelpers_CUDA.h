@@ -14,7 +14,7 @@ namespace ITMLib
 	// declaration of device functions
 
 	__global__ void buildCompleteVisibleList_device(const ITMHashEntry *hashTable, /*ITMHashCacheState *cacheStates, bool useSwapping,*/ int noTotalEntries,
-		int *visibleEntryIDs, int *noVisibleEntries, uchar *entriesVisibleType, Matrix4f M, Vector4f projParams, Vector2i imgSize, float voxelSize);
+		int *visibleEntryIDs, int *noVisibleEntries, uint *entriesVisibleStamp, Matrix4f M, Vector4f projParams, Vector2i imgSize, float voxelSize);
 
 	__global__ void countVisibleBlocks_device(const int *visibleEntryIDs, int noVisibleEntries, const ITMHashEntry *hashTable, uint *noBlocks, int minBlockId, int maxBlockId);
 
@@ -36,8 +36,8 @@ namespace ITMLib
 		Vector4f projParams, float voxelSize);
 
 	template<class TVoxel, class TIndex, bool modifyVisibleEntries>
-	__global__ void genericRaycast_device(Vector4f *out_ptsRay, uchar *entriesVisibleType, const TVoxel *voxelData,
-		const typename TIndex::IndexData *voxelIndex, Vector2i imgSize, Matrix4f invM, Vector4f invProjParams,
+	__global__ void genericRaycast_device(Vector4f *out_ptsRay, uint *entriesVisibleStamp, uint visibleStamp, const TVoxel *voxelData,
+		const typename TIndex::IndexData *voxelIndex, const ITMVoxelBlockSummary *blockSummaries, Vector2i imgSize, Matrix4f invM, Vector4f invProjParams,
 		float oneOverVoxelSize, const Vector2f *minmaximg, float mu)
 	{
 		int x = (threadIdx.x + blockIdx.x * blockDim.x), y = (threadIdx.y + blockIdx.y * blockDim.y);
@@ -47,12 +47,12 @@ namespace ITMLib
 		int locId = x + y * imgSize.x;
 		int locId2 = (int)floor((float)x / minmaximg_subsample) + (int)floor((float)y / minmaximg_subsample) * imgSize.x;
 
-		castRay<TVoxel, TIndex, modifyVisibleEntries>(out_ptsRay[locId], entriesVisibleType, x, y, voxelData, voxelIndex, invM, invProjParams, oneOverVoxelSize, mu, minmaximg[locId2]);
+		castRay<TVoxel, TIndex, modifyVisibleEntries>(out_ptsRay[locId], entriesVisibleStamp, visibleStamp, x, y, voxelData, voxelIndex, blockSummaries, invM, invProjParams, oneOverVoxelSize, mu, minmaximg[locId2]);
 	}
 
 	template<class TVoxel, class TIndex, bool modifyVisibleEntries>
-	__global__ void genericRaycastMissingPoints_device(Vector4f *forwardProjection, uchar *entriesVisibleType, const TVoxel *voxelData,
-		const typename TIndex::IndexData *voxelIndex, Vector2i imgSize, Matrix4f invM, Vector4f invProjParams, float oneOverVoxelSize,
+	__global__ void genericRaycastMissingPoints_device(Vector4f *forwardProjection, uint *entriesVisibleStamp, uint visibleStamp, const TVoxel *voxelData,
+		const typename TIndex::IndexData *voxelIndex, const ITMVoxelBlockSummary *blockSummaries, Vector2i imgSize, Matrix4f invM, Vector4f invProjParams, float oneOverVoxelSize,
 		int *fwdProjMissingPoints, int noMissingPoints, const Vector2f *minmaximg, float mu)
 	{
 		int pointId = threadIdx.x + blockIdx.x * blockDim.x;
@@ -63,7 +63,7 @@ namespace ITMLib
 		int y = locId / imgSize.x, x = locId - y*imgSize.x;
 		int locId2 = (int)floor((float)x / minmaximg_subsample) + (int)floor((float)y / minmaximg_subsample) * imgSize.x;
 
-		castRay<TVoxel, TIndex, modifyVisibleEntries>(forwardProjection[locId], entriesVisibleType, x, y, voxelData, voxelIndex, invM, invProjParams, oneOverVoxelSize, mu, minmaximg[locId2]);
+		castRay<TVoxel, TIndex, modifyVisibleEntries>(forwardProjection[locId], entriesVisibleStamp, visibleStamp, x, y, voxelData, voxelIndex, blockSummaries, invM, invProjParams, oneOverVoxelSize, mu, minmaximg[locId2]);
 	}
 
 	template<bool flipNormals>
@@ -8,7 +8,7 @@ using namespace metal;
 #include "../../../ITMLibDefines.h"
 
 kernel void genericRaycastVH_device(DEVICEPTR(Vector4f) *pointsRay                                  [[ buffer(0) ]],
-                                    DEVICEPTR(uchar) *entriesVisibleType                            [[ buffer(1) ]],
+                                    DEVICEPTR(uint) *entriesVisibleStamp                            [[ buffer(1) ]],
                                     const CONSTPTR(ITMVoxel) *voxelData                             [[ buffer(2) ]],
                                     const CONSTPTR(typename ITMVoxelIndex::IndexData) *voxelIndex   [[ buffer(3) ]],
                                     const CONSTPTR(Vector2f) *minmaxdata                            [[ buffer(4) ]],
@@ -25,10 +25,10 @@ kernel void genericRaycastVH_device(DEVICEPTR(Vector4f) *pointsRay
     int locId2 = (int)floor((float)x / minmaximg_subsample) + (int)floor((float)y / minmaximg_subsample) * params->imgSize.x;
     
     if (params->imgSize.w > 0)
-        castRay<ITMVoxel, ITMVoxelIndex, true>(pointsRay[locId], entriesVisibleType, x, y, voxelData, voxelIndex, params->invM, params->invProjParams,
+        castRay<ITMVoxel, ITMVoxelIndex, true>(pointsRay[locId], entriesVisibleStamp, params->visibleStamp, x, y, voxelData, voxelIndex, NULL, params->invM, params->invProjParams,
                                                params->voxelSizes.y, params->lightSource.w, minmaxdata[locId2]);
     else
-        castRay<ITMVoxel, ITMVoxelIndex, false>(pointsRay[locId], NULL, x, y, voxelData, voxelIndex, params->invM, params->invProjParams,
+        castRay<ITMVoxel, ITMVoxelIndex, false>(pointsRay[locId], NULL, 0, x, y, voxelData, voxelIndex, NULL, params->invM, params->invProjParams,
                                                params->voxelSizes.y, params->lightSource.w, minmaxdata[locId2]);
 }
 
@@ -38,6 +38,7 @@ struct CreateICPMaps_Params
     Vector4f lightSource;
     Vector4i imgSize;
     Vector2f voxelSizes;
+    uint visibleStamp;
 };
 
 #endif
\ No newline at end of file
@@ -43,10 +43,13 @@ ITMVisualisationEngine_Metal<TVoxel, ITMVoxelBlockHash>::ITMVisualisationEngine_
 template<class TVoxel, class TIndex>
 static void CreateICPMaps_common_metal(const ITMScene<TVoxel,TIndex> *scene, const ITMView *view, ITMTrackingState *trackingState, ITMRenderState *renderState)
 {
-    const void *entriesVisibleType = NULL;
+    const void *entriesVisibleStamp = NULL;
+    uint visibleStamp = 0;
     if ((dynamic_cast<const ITMRenderState_VH*>(renderState)!=NULL))
     {
-        entriesVisibleType = ((ITMRenderState_VH*)renderState)->GetEntriesVisibleType_MB();
+        // blocks hit by the rays stay in the live list of the next frame
+        entriesVisibleStamp = ((ITMRenderState_VH*)renderState)->GetEntriesVisibleStamp_MB();
+        visibleStamp = ((ITMRenderState_VH*)renderState)->NextVisibleStamp();
     }
 
     id<MTLCommandBuffer> commandBuffer = [[[MetalContext instance]commandQueue]commandBuffer];
@@ -64,12 +67,13 @@ static void CreateICPMaps_common_metal(const ITMScene<TVoxel,TIndex> *scene, con
     params->lightSource.y = -Vector3f(params->invM.getColumn(2)).y;
     params->lightSource.z = -Vector3f(params->invM.getColumn(2)).z;
     params->lightSource.w = scene->sceneParams->mu;
+    params->visibleStamp = visibleStamp;
 
     [commandEncoder setComputePipelineState:vis_metalBits.p_genericRaycastVH_device];
     [commandEncoder setBuffer:(__bridge id<MTLBuffer>) renderState->raycastResult->GetMetalBuffer()             offset:0 atIndex:0];
-    [commandEncoder setBuffer:(__bridge id<MTLBuffer>) entriesVisibleType                                       offset:0 atIndex:1];
+    [commandEncoder setBuffer:(__bridge id<MTLBuffer>) entriesVisibleStamp                                      offset:0 atIndex:1];
     [commandEncoder setBuffer:(__bridge id<MTLBuffer>) scene->localVBA.GetVoxelBlocks_MB()                      offset:0 atIndex:2];
-    [commandEncoder setBuffer:(__bridge id<MTLBuffer>) scene->index.getIndexData_MB()                           offset:0 atIndex:3];
+    [commandEncoder setBuffer:(__bridge id<MTLBuffer>) scene->index.getIndexData_MB()                           offset:sizeof(ITMHashEntry) atIndex:3];
     [commandEncoder setBuffer:(__bridge id<MTLBuffer>) renderState->renderingRangeImage->GetMetalBuffer()       offset:0 atIndex:4];
     [commandEncoder setBuffer:vis_metalBits.paramsBuffer                                                        offset:0 atIndex:5];
 
@@ -116,10 +120,10 @@ static void RenderImage_common_metal(const ITMScene<TVoxel,ITMVoxelBlockHash> *s
             // this one is generally done for freeview visualisation, so
             // no, do not update the list of visible blocks
 
-            const void *entriesVisibleType = NULL;
+            const void *entriesVisibleStamp = NULL;
             if ((dynamic_cast<const ITMRenderState_VH*>(renderState)!=NULL))
             {
-                entriesVisibleType = ((ITMRenderState_VH*)renderState)->GetEntriesVisibleType_MB();
+                entriesVisibleStamp = ((ITMRenderState_VH*)renderState)->GetEntriesVisibleStamp_MB();
             }
 
             id<MTLCommandBuffer> commandBuffer = [[[MetalContext instance]commandQueue]commandBuffer];
@@ -135,12 +139,13 @@ static void RenderImage_common_metal(const ITMScene<TVoxel,ITMVoxelBlockHash> *s
             params->lightSource.y = -Vector3f(params->invM.getColumn(2)).y;
             params->lightSource.z = -Vector3f(params->invM.getColumn(2)).z;
             params->lightSource.w = scene->sceneParams->mu;
+            params->visibleStamp = 0;
 
             [commandEncoder setComputePipelineState:vis_metalBits.p_genericRaycastVH_device];
             [commandEncoder setBuffer:(__bridge id<MTLBuffer>) renderState->raycastResult->GetMetalBuffer()             offset:0 atIndex:0];
-            [commandEncoder setBuffer:(__bridge id<MTLBuffer>) entriesVisibleType                                       offset:0 atIndex:1];
+            [commandEncoder setBuffer:(__bridge id<MTLBuffer>) entriesVisibleStamp                                      offset:0 atIndex:1];
             [commandEncoder setBuffer:(__bridge id<MTLBuffer>) scene->localVBA.GetVoxelBlocks_MB()                      offset:0 atIndex:2];
-            [commandEncoder setBuffer:(__bridge id<MTLBuffer>) scene->index.getIndexData_MB()                           offset:0 atIndex:3];
+            [commandEncoder setBuffer:(__bridge id<MTLBuffer>) scene->index.getIndexData_MB()                           offset:sizeof(ITMHashEntry) atIndex:3];
             [commandEncoder setBuffer:(__bridge id<MTLBuffer>) renderState->renderingRangeImage->GetMetalBuffer()       offset:0 atIndex:4];
             [commandEncoder setBuffer:vis_metalBits.paramsBuffer                                                        offset:0 atIndex:5];
 
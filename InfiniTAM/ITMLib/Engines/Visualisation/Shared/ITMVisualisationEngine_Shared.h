@@ -98,10 +98,48 @@ _CPU_AND_GPU_CODE_ inline void CreateRenderingBlocks(DEVICEPTR(RenderingBlock) *
 
 #endif
 
+/** Distance along the ray, in voxels, that castRay() can step because
+    the block last read through @p cache holds no surface. Only blocks of
+    the voxel block hash have summaries. */
+template<class TCache>
+_CPU_AND_GPU_CODE_ inline float computeEmptySpaceSkip(const CONSTPTR(ITMVoxelBlockSummary) *blockSummaries, const THREADPTR(TCache) & cache,
+	const THREADPTR(Vector3f) & point, const THREADPTR(Vector3f) & rayDirection, float stepScale)
+{
+	return 0.0f;
+}
+
+_CPU_AND_GPU_CODE_ inline float computeEmptySpaceSkip(const CONSTPTR(ITMVoxelBlockSummary) *blockSummaries, const THREADPTR(ITMLib::ITMVoxelBlockHash::IndexCache) & cache,
+	const THREADPTR(Vector3f) & point, const THREADPTR(Vector3f) & rayDirection, float stepScale)
+{
+	if (blockSummaries == NULL) return 0.0f;
+
+	float minSDF = blockSummaries[cache.blockPtr / SDF_BLOCK_SIZE3].minSDF;
+	if (minSDF <= 0.0f) return 0.0f;
+
+	// interpolating between the voxels of this block cannot give a zero crossing,
+	// so go to where the ray leaves the box spanned by their centres
+	Vector3f boxMin = cache.blockPos.toFloat() * (float)SDF_BLOCK_SIZE;
+	Vector3f boxMax = boxMin + Vector3f((float)(SDF_BLOCK_SIZE - 1));
+
+	// no exit is further away than the diagonal of the box
+	float exitLength = 2.0f * SDF_BLOCK_SIZE;
+	if (rayDirection.x > 0.0f) exitLength = MIN(exitLength, (boxMax.x - point.x) / rayDirection.x);
+	else if (rayDirection.x < 0.0f) exitLength = MIN(exitLength, (boxMin.x - point.x) / rayDirection.x);
+	if (rayDirection.y > 0.0f) exitLength = MIN(exitLength, (boxMax.y - point.y) / rayDirection.y);
+	else if (rayDirection.y < 0.0f) exitLength = MIN(exitLength, (boxMin.y - point.y) / rayDirection.y);
+	if (rayDirection.z > 0.0f) exitLength = MIN(exitLength, (boxMax.z - point.z) / rayDirection.z);
+	else if (rayDirection.z < 0.0f) exitLength = MIN(exitLength, (boxMin.z - point.z) / rayDirection.z);
+
+	// the exit point still reads a voxel of this block, so take the step
+	// that castRay() would take there at once
+	return MAX(exitLength, 0.0f) + MAX(minSDF * stepScale, 1.0f);
+}
+
 template<class TVoxel, class TIndex, bool modifyVisibleEntries>
-_CPU_AND_GPU_CODE_ inline bool castRay(DEVICEPTR(Vector4f) &pt_out, DEVICEPTR(uchar) *entriesVisibleType, 
+_CPU_AND_GPU_CODE_ inline bool castRay(DEVICEPTR(Vector4f) &pt_out, DEVICEPTR(uint) *entriesVisibleStamp, uint visibleStamp,
 	int x, int y, const CONSTPTR(TVoxel) *voxelData, const CONSTPTR(typename TIndex::IndexData) *voxelIndex, 
-	Matrix4f invM, Vector4f invProjParams, float oneOverVoxelSize, float mu, const CONSTPTR(Vector2f) & viewFrustum_minmax)
+	const CONSTPTR(ITMVoxelBlockSummary) *blockSummaries, Matrix4f invM, Vector4f invProjParams, float oneOverVoxelSize, float mu,
+	const CONSTPTR(Vector2f) & viewFrustum_minmax)
 {
 	Vector4f pt_camera_f; Vector3f pt_block_s, pt_block_e, rayDirection, pt_result;
 	bool pt_found;
@@ -138,17 +176,18 @@ _CPU_AND_GPU_CODE_ inline bool castRay(DEVICEPTR(Vector4f) &pt_out, DEVICEPTR(uc
 
 		if (modifyVisibleEntries)
 		{
-			if (vmIndex) entriesVisibleType[vmIndex - 1] = 1;
+			if (vmIndex) entriesVisibleStamp[vmIndex - 1] = visibleStamp;
 		}
 
 		if (!vmIndex) {
 			stepLength = SDF_BLOCK_SIZE;
 		} else {
+			float skipLength = computeEmptySpaceSkip(blockSummaries, cache, pt_result, rayDirection, stepScale);
 			if ((sdfValue <= 0.1f) && (sdfValue >= -0.5f)) {
 				sdfValue = readFromSDF_float_interpolated(voxelData, voxelIndex, pt_result, vmIndex, cache);
 			}
 			if (sdfValue <= 0.0f) break;
-			stepLength = MAX(sdfValue * stepScale, 1.0f);
+			stepLength = MAX(MAX(sdfValue * stepScale, 1.0f), skipLength);
 		}
 
 		pt_result += stepLength * rayDirection; totalLength += stepLength;
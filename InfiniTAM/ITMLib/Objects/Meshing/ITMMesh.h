@@ -17,12 +17,17 @@ namespace ITMLib
 		MemoryDeviceType memoryType;
 
 		uint noTotalTriangles;
-		static const uint noMaxTriangles_default = SDF_LOCAL_BLOCK_NUM * 32* 2;
 		uint noMaxTriangles;
 
+		/** Number of triangles a mesh has room for per voxel block of the scene. */
+		static const uint noMaxTrianglesPerBlock = 32 * 2;
+
 		ORUtils::MemoryBlock<Triangle> *triangles;
 
-		explicit ITMMesh(MemoryDeviceType memoryType, uint maxTriangles = noMaxTriangles_default)
+		/** Room for the triangles of a scene with @p noVoxelBlocks voxel blocks. */
+		static uint GetMaxTriangles(int noVoxelBlocks) { return (uint)noVoxelBlocks * noMaxTrianglesPerBlock; }
+
+		explicit ITMMesh(MemoryDeviceType memoryType, uint maxTriangles)
 		{
 			this->memoryType = memoryType;
 			this->noTotalTriangles = 0;
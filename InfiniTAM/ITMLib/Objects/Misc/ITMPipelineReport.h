@@ -0,0 +1,65 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <stdio.h>
+
+namespace ITMLib
+{
+	/** \brief
+	    Time spent in the stages of ITMBasicEngine::ProcessFrame(),
+	    summed over all frames processed so far.
+
+	    All times are host side wall clock times in ms. With CUDA,
+	    a stage only counts the time until its kernels have been
+	    launched, unless it waits for their results.
+	*/
+	struct ITMPipelineReport
+	{
+		/// Number of frames that were tracked
+		int noFrames;
+
+		/// Time spent in ProcessFrame() and FlushPipeline()
+		double totalTime;
+
+		/// Time spent converting the input images into views
+		double viewBuildingTime;
+
+		/// Time spent tracking and relocalising
+		double trackingTime;
+
+		/// Time spent integrating the views into the scene
+		double fusionTime;
+
+		/// Time spent raycasting the scene for the next frame
+		double raycastTime;
+
+		/// Time spent waiting for the view of the next frame in pipelined mode
+		double waitTime;
+
+		ITMPipelineReport(void)
+		{
+			noFrames = 0;
+			totalTime = viewBuildingTime = trackingTime = fusionTime = raycastTime = waitTime = 0.0;
+		}
+
+		/** Fraction of the total time that a stage was busy. In
+		    pipelined mode view building overlaps the other stages,
+		    so the occupancies can add up to more than 1.
+		*/
+		double GetOccupancy(double stageTime) const
+		{
+			return totalTime > 0.0 ? stageTime / totalTime : 0.0;
+		}
+
+		void Print(FILE *out = stdout) const
+		{
+			fprintf(out, "%d frames in %.1f ms, %.2f ms per frame\n", noFrames, totalTime, noFrames > 0 ? totalTime / noFrames : 0.0);
+			fprintf(out, "  view building : %10.1f ms, %5.1f%% occupied\n", viewBuildingTime, 100.0 * GetOccupancy(viewBuildingTime));
+			fprintf(out, "  tracking      : %10.1f ms, %5.1f%% occupied\n", trackingTime, 100.0 * GetOccupancy(trackingTime));
+			fprintf(out, "  fusion        : %10.1f ms, %5.1f%% occupied\n", fusionTime, 100.0 * GetOccupancy(fusionTime));
+			fprintf(out, "  raycast       : %10.1f ms, %5.1f%% occupied\n", raycastTime, 100.0 * GetOccupancy(raycastTime));
+			fprintf(out, "  waiting       : %10.1f ms, %5.1f%% of the total\n", waitTime, 100.0 * GetOccupancy(waitTime));
+		}
+	};
+}
@@ -66,6 +66,7 @@ namespace ITMLib {
 				indexData_host.poses_vs[localMapId].m32 /= sceneParams.voxelSize;
 				indexData_host.posesInv[localMapId] = sceneManager.getEstimatedGlobalPose(localMapId).GetInvM();
 				indexData_host.index[localMapId] = sceneManager.getLocalMap(localMapId)->scene->index.getIndexData();
+				indexData_host.noTotalEntries[localMapId] = sceneManager.getLocalMap(localMapId)->scene->index.noTotalEntries;
 				voxelData_host.voxels[localMapId] = sceneManager.getLocalMap(localMapId)->scene->localVBA.GetVoxelBlocks();
 			}
 
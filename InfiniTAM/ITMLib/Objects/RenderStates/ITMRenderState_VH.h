@@ -24,30 +24,71 @@ namespace ITMLib
 		*/
 		ORUtils::MemoryBlock<int> *visibleEntryIDs;
 
-		/** A list of "visible entries", that are
-		currently being processed by integration
-		and tracker.
+		/** For each hash entry, the visibility stamp it was last
+		marked with. An entry is visible in the current frame iff
+		its stamp equals visibleStamp, so no per-frame clearing of
+		the whole table is needed.
 		*/
-		ORUtils::MemoryBlock<uchar> *entriesVisibleType;
+		ORUtils::MemoryBlock<uint> *entriesVisibleStamp;
            
 	public:
 		/** Number of entries in the live list. */
 		int noVisibleEntries;
+
+		/** Stamp of the current frame, advanced by two with every
+		call to AdvanceVisibleStamp(). visibleStamp - 1 marks the
+		entries that were in the live list of the previous frame
+		and still have to be checked for visibility. The stamp an
+		entry keeps afterwards tells how many frames ago it was
+		last visible, which the swapping engines evict by.
+		*/
+		uint visibleStamp;
            
 		ITMRenderState_VH(int noTotalEntries, const Vector2i & imgSize, float vf_min, float vf_max, MemoryDeviceType memoryType = MEMORYDEVICE_CPU)
 			: ITMRenderState(imgSize, vf_min, vf_max, memoryType)
 		{
 			this->memoryType = memoryType;
 
-			visibleEntryIDs = new ORUtils::MemoryBlock<int>(SDF_LOCAL_BLOCK_NUM, memoryType);
-			entriesVisibleType = new ORUtils::MemoryBlock<uchar>(noTotalEntries, memoryType);
+			visibleEntryIDs = new ORUtils::MemoryBlock<int>(noTotalEntries, memoryType);
+			entriesVisibleStamp = new ORUtils::MemoryBlock<uint>(noTotalEntries, memoryType);
 
 			noVisibleEntries = 0;
+			visibleStamp = 2;
 		}
+		/** Make sure the render state covers @p noTotalEntries
+		hash entries, e.g. after the excess list of the hash
+		table has grown. Existing visibility information is kept.
+		*/
+		void Resize(int noTotalEntries)
+		{
+			visibleEntryIDs->Grow(noTotalEntries);
+			entriesVisibleStamp->Grow(noTotalEntries);
+		}
+
+		/** Start a new frame: entries stamped in earlier frames
+		become invisible without touching the table. The table is
+		only cleared on the rare wrap-around of the counter.
+		*/
+		void AdvanceVisibleStamp(void)
+		{
+			visibleStamp += 2;
+			if (visibleStamp < 2)
+			{
+				entriesVisibleStamp->Clear();
+				visibleStamp = 2;
+			}
+		}
+
+		/** Stamp of the following frame. Entries marked with it,
+		e.g. by the raycast, are part of the live list of that
+		frame without being checked for visibility again.
+		*/
+		uint NextVisibleStamp(void) const { return visibleStamp + 2; }
+
 		~ITMRenderState_VH()
 		{
 			delete visibleEntryIDs;
-			delete entriesVisibleType;
+			delete entriesVisibleStamp;
 		}
 		/** Get the list of "visible entries", that are currently
 		processed by the tracker.
@@ -55,14 +96,13 @@ namespace ITMLib
 		const int *GetVisibleEntryIDs(void) const { return visibleEntryIDs->GetData(memoryType); }
 		int *GetVisibleEntryIDs(void) { return visibleEntryIDs->GetData(memoryType); }
 
-		/** Get the list of "visible entries", that are
-		currently processed by integration and tracker.
-		*/
-		uchar *GetEntriesVisibleType(void) { return entriesVisibleType->GetData(memoryType); }
+		/** Get the per entry visibility stamps, see visibleStamp. */
+		const uint *GetEntriesVisibleStamp(void) const { return entriesVisibleStamp->GetData(memoryType); }
+		uint *GetEntriesVisibleStamp(void) { return entriesVisibleStamp->GetData(memoryType); }
 
 #ifdef COMPILE_WITH_METAL
 		const void* GetVisibleEntryIDs_MB(void) { return visibleEntryIDs->GetMetalBuffer(); }
-		const void* GetEntriesVisibleType_MB(void) { return entriesVisibleType->GetMetalBuffer(); }
+		const void* GetEntriesVisibleStamp_MB(void) { return entriesVisibleStamp->GetMetalBuffer(); }
 #endif
 	};
 } 
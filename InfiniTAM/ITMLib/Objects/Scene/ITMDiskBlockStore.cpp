@@ -0,0 +1,96 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "ITMDiskBlockStore.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#define fseek64 _fseeki64
+#else
+#include <unistd.h>
+#define fseek64 fseeko
+#endif
+
+using namespace ITMLib;
+
+namespace
+{
+	// rounds towards minus infinity, unlike the division
+	inline int GetChunkCoordinate(int blockCoordinate, int chunkSize)
+	{
+		return blockCoordinate >= 0 ? blockCoordinate / chunkSize : (blockCoordinate - chunkSize + 1) / chunkSize;
+	}
+}
+
+ITMDiskBlockStore::ITMDiskBlockStore(const std::string &directory, size_t blockSize)
+	: blockSize(blockSize), fileSize(0), noBlocks(0)
+{
+	// several scenes, e.g. of ITMMultiEngine, or processes may share the directory
+	static int noStores = 0;
+	char name[64];
+	sprintf(name, "/itm_blocks_%d_%d.dat", (int)getpid(), noStores++);
+	fileName = directory + name;
+
+	file = fopen(fileName.c_str(), "w+b");
+	if (file == NULL) throw std::runtime_error("Could not create the block store " + fileName);
+}
+
+ITMDiskBlockStore::~ITMDiskBlockStore(void)
+{
+	fclose(file);
+	remove(fileName.c_str());
+}
+
+long long ITMDiskBlockStore::GetChunkKey(const Vector3s &blockPos)
+{
+	// block positions are shorts, so 21 bits per coordinate are plenty
+	const long long bias = 1 << 20;
+	long long x = GetChunkCoordinate(blockPos.x, chunkSize) + bias;
+	long long y = GetChunkCoordinate(blockPos.y, chunkSize) + bias;
+	long long z = GetChunkCoordinate(blockPos.z, chunkSize) + bias;
+	return (x << 42) | (y << 21) | z;
+}
+
+int ITMDiskBlockStore::GetBlockIndex(const Vector3s &blockPos)
+{
+	int x = blockPos.x - GetChunkCoordinate(blockPos.x, chunkSize) * chunkSize;
+	int y = blockPos.y - GetChunkCoordinate(blockPos.y, chunkSize) * chunkSize;
+	int z = blockPos.z - GetChunkCoordinate(blockPos.z, chunkSize) * chunkSize;
+	return x + (y + z * chunkSize) * chunkSize;
+}
+
+void ITMDiskBlockStore::Write(const Vector3s &blockPos, const void *data)
+{
+	std::map<long long, Chunk>::iterator it = chunks.find(GetChunkKey(blockPos));
+	if (it == chunks.end())
+	{
+		// the blocks of the chunk that are never written stay holes in the file on most file systems
+		Chunk chunk = { fileSize, 0 };
+		it = chunks.insert(std::make_pair(GetChunkKey(blockPos), chunk)).first;
+		fileSize += noBlocksPerChunk * (long long)blockSize;
+	}
+
+	int blockIdx = GetBlockIndex(blockPos);
+	if (fseek64(file, it->second.offset + blockIdx * (long long)blockSize, SEEK_SET) != 0 || fwrite(data, blockSize, 1, file) != 1)
+		throw std::runtime_error("Could not write to the block store " + fileName);
+
+	unsigned long long blockBit = 1ULL << blockIdx;
+	if ((it->second.writtenBlocks & blockBit) == 0) noBlocks++;
+	it->second.writtenBlocks |= blockBit;
+}
+
+bool ITMDiskBlockStore::Read(const Vector3s &blockPos, void *data)
+{
+	std::map<long long, Chunk>::const_iterator it = chunks.find(GetChunkKey(blockPos));
+	if (it == chunks.end()) return false;
+
+	int blockIdx = GetBlockIndex(blockPos);
+	if ((it->second.writtenBlocks & (1ULL << blockIdx)) == 0) return false;
+
+	if (fseek64(file, it->second.offset + blockIdx * (long long)blockSize, SEEK_SET) != 0 || fread(data, blockSize, 1, file) != 1)
+		throw std::runtime_error("Could not read from the block store " + fileName);
+
+	return true;
+}
@@ -0,0 +1,67 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <stdio.h>
+#include <map>
+#include <string>
+
+#include "../../Utils/ITMMath.h"
+
+namespace ITMLib
+{
+	/** \brief
+	    Stores voxel blocks of a fixed size in a file, keyed by their
+	    block position.
+
+	    The file is made of chunks of 4x4x4 neighbouring blocks,
+	    which are appended when the first of their blocks is written,
+	    so that blocks that are swapped out together end up close to
+	    each other. A block keeps its place in the file once written.
+	    The file only lives as long as the store, it is created in the
+	    given directory and removed again by the destructor.
+	*/
+	class ITMDiskBlockStore
+	{
+	private:
+		static const int chunkSize = 4;
+		static const int noBlocksPerChunk = chunkSize * chunkSize * chunkSize;
+
+		struct Chunk
+		{
+			long long offset;
+			/// One bit per block of the chunk that has been written
+			unsigned long long writtenBlocks;
+		};
+
+		std::string fileName;
+		FILE *file;
+		size_t blockSize;
+
+		std::map<long long, Chunk> chunks;
+		long long fileSize;
+		int noBlocks;
+
+		static long long GetChunkKey(const Vector3s &blockPos);
+		static int GetBlockIndex(const Vector3s &blockPos);
+
+		// Suppress the default copy constructor and assignment operator
+		ITMDiskBlockStore(const ITMDiskBlockStore&);
+		ITMDiskBlockStore& operator=(const ITMDiskBlockStore&);
+
+	public:
+		/// Throws a std::runtime_error if the file cannot be created
+		ITMDiskBlockStore(const std::string &directory, size_t blockSize);
+		~ITMDiskBlockStore(void);
+
+		/// Writes the @p blockSize bytes at @p data, replacing what was written for @p blockPos before
+		void Write(const Vector3s &blockPos, const void *data);
+
+		/// Reads the block written for @p blockPos, returns false if there is none
+		bool Read(const Vector3s &blockPos, void *data);
+
+		int GetNoBlocks(void) const { return noBlocks; }
+		/// Size of the file in bytes, including the unwritten blocks of its chunks
+		long long GetFileSize(void) const { return fileSize; }
+	};
+}
@@ -2,10 +2,17 @@
 
 #pragma once
 
+#include <algorithm>
 #include <stdlib.h>
 #include <stdio.h>
+#include <vector>
 
+#include "ITMDiskBlockStore.h"
+#include "ITMVoxelBlockCompression.h"
 #include "ITMVoxelBlockHash.h"
+#include "../../Utils/ITMProfiler.h"
+#include "../../Utils/ITMSwappingParams.h"
+#include "../../Utils/ITMWorkerThread.h"
 #include "../../../ORUtils/CUDADefines.h"
 
 namespace ITMLib
@@ -21,40 +28,410 @@ namespace ITMLib
 		uchar state;
 	};
 
+	/** \brief
+	    Host side storage of the voxel blocks that have been swapped
+	    out of active memory.
+
+	    Storage is only allocated for blocks that have actually been
+	    stored, in slabs of a fixed number of blocks that are added as
+	    needed, so that host memory grows with the explored area
+	    rather than with the size of the hash table. Each hash entry
+	    refers to its block in the slabs by index, and blocks do not
+	    move once stored.
+
+	    With a disk store, see ITMSwappingParams, at most
+	    maxHostBlocks blocks are kept in host memory. Beyond that, the
+	    block that got its place in host memory longest ago is moved
+	    to the disk store to make room, and read from there when it
+	    is swapped in again.
+
+	    With compression, see ITMVoxelBlockCompressor, each block in
+	    host memory is kept in a run of 32 byte chunks of 1 MB pages
+	    instead of the slabs. A block that still fits is rewritten in
+	    place, otherwise its run is freed for other blocks. Once a
+	    quarter of the chunks are not used by any block, the runs
+	    are moved together and the pages left empty are freed.
+	    Blocks on disk are not compressed.
+
+	    With asynchronous transfers, the copies between the host
+	    transfer buffers and the stored blocks run on a background
+	    thread, see StartTransfers(). The transfer buffers are then
+	    double buffered: the synced buffers hold the blocks to store,
+	    the swap-in buffers receive the blocks that were requested.
+	*/
 	template<class TVoxel>
 	class ITMGlobalCache
 	{
 	private:
-		bool *hasStoredData;
-		TVoxel *storedVoxelBlocks;
+		static const int noBlocksPerSlab = 1024;
+		static const int BLOCK_ON_DISK = -2;
+		static const int compressedChunkSize = 32;
+		static const int noChunksPerPage = 32768;
+
+		ITMSwappingParams swappingParams;
+
+		/** For every hash entry, the index of its stored block in
+		    the slabs, -1 if nothing has been stored or BLOCK_ON_DISK.
+		*/
+		int *storedBlockIds;
+		/// For every hash entry with stored data, its block position, which is the key of the disk store
+		Vector3s *storedBlockPositions;
+
+		std::vector<TVoxel*> slabs;
+		/// A compressed block in host memory, which takes the first size bytes of its run of chunks
+		struct CompressedBlock
+		{
+			int firstChunkId, noChunks, size;
+		};
+
+		/// With compression, the pages that hold the blocks in host memory instead of the slabs
+		std::vector<uchar*> compressedPages;
+		/// For every block in host memory
+		std::vector<CompressedBlock> compressedBlocks;
+		/// The first chunks of the freed runs, by the number of chunks in them
+		std::vector< std::vector<int> > freeCompressedChunks;
+		/// Chunks taken from the pages, including the freed ones, and the chunks the blocks need
+		int noCompressedChunks, noUsedCompressedChunks;
+		size_t noCompressedBytes;
+		/// Scratch space for compressing and for moving compressed blocks to disk
+		uchar *compressionBuffer;
+		TVoxel *blockBuffer;
+
+		/// For every block in host memory, the hash entry it belongs to
+		std::vector<int> hostBlockEntryIds;
+		int noHostBlocks, noBlocksOnDisk;
+		/// The next block in the slabs to move to the disk store
+		int nextEvictedBlockId;
+
+		ITMDiskBlockStore *diskStore;
+
 		ITMHashSwapState *swapStates_host, *swapStates_device;
 
 		bool *hasSyncedData_host, *hasSyncedData_device;
 		TVoxel *syncedVoxelBlocks_host, *syncedVoxelBlocks_device;
+		Vector3s *syncedBlockPositions_host, *syncedBlockPositions_device;
 
 		int *neededEntryIDs_host, *neededEntryIDs_device;
+
+		ITMWorkerThread *transferThread;
+
+		/// Blocks fetched by the asynchronous transfers, on the host only
+		bool *hasSwapInData_host;
+		TVoxel *swapInVoxelBlocks_host;
+		int *swapInEntryIDs_host;
+
+		int noSwapOutEntries, noSwapInEntries;
+		/// The block counts as of the last WaitForTransfers(), which the worker thread does not touch
+		int noHostBlocks_waited, noBlocksOnDisk_waited;
+		size_t noCompressedBytes_waited;
+
+		inline TVoxel *GetBlock(int blockId) const { return slabs[blockId / noBlocksPerSlab] + (blockId % noBlocksPerSlab) * SDF_BLOCK_SIZE3; }
+		inline uchar *GetCompressedChunk(int chunkId) const { return compressedPages[chunkId / noChunksPerPage] + (chunkId % noChunksPerPage) * compressedChunkSize; }
+
+		static inline int GetNoCompressedChunks(int size) { return (size + compressedChunkSize - 1) / compressedChunkSize; }
+
+		void FreeCompressedChunks(int chunkId, int noChunks)
+		{
+			if (noChunks > 0) freeCompressedChunks[noChunks].push_back(chunkId);
+		}
+
+		/// A run of @p noChunks chunks at the end of the used part of the pages
+		int TakeCompressedChunks(int noChunks)
+		{
+			// runs do not cross pages, the rest of a page that is too short is freed
+			int noPageChunks = noCompressedChunks % noChunksPerPage;
+			if (noPageChunks + noChunks > noChunksPerPage)
+			{
+				FreeCompressedChunks(noCompressedChunks, noChunksPerPage - noPageChunks);
+				noCompressedChunks += noChunksPerPage - noPageChunks;
+			}
+			if (noCompressedChunks / noChunksPerPage >= (int)compressedPages.size())
+				compressedPages.push_back((uchar*)malloc(noChunksPerPage * compressedChunkSize));
+
+			int chunkId = noCompressedChunks;
+			noCompressedChunks += noChunks;
+			noCompressedBytes = (size_t)noCompressedChunks * compressedChunkSize;
+			return chunkId;
+		}
+
+		/// Gives @p block a run of at least @p noChunks chunks, a freed one if there is one, else one from the pages
+		void AllocateCompressedChunks(CompressedBlock &block, int noChunks)
+		{
+			// freed runs are not split, the pieces would mostly be too short to be used again
+			for (int noFreeChunks = noChunks; noFreeChunks < (int)freeCompressedChunks.size(); noFreeChunks++)
+			{
+				if (freeCompressedChunks[noFreeChunks].empty()) continue;
+
+				block.firstChunkId = freeCompressedChunks[noFreeChunks].back();
+				block.noChunks = noFreeChunks;
+				freeCompressedChunks[noFreeChunks].pop_back();
+				return;
+			}
+
+			block.firstChunkId = TakeCompressedChunks(noChunks);
+			block.noChunks = noChunks;
+		}
+
+		/// Moves the runs of the blocks to the start of the pages, without the chunks they do not need, and frees the pages left empty
+		void CompactCompressedBlocks(void)
+		{
+			std::vector< std::pair<int, int> > runs;
+			for (int blockId = 0; blockId < (int)compressedBlocks.size(); blockId++)
+				if (compressedBlocks[blockId].noChunks > 0) runs.push_back(std::make_pair(compressedBlocks[blockId].firstChunkId, blockId));
+			std::sort(runs.begin(), runs.end());
+
+			for (size_t i = 0; i < freeCompressedChunks.size(); i++) freeCompressedChunks[i].clear();
+			noCompressedChunks = 0;
+
+			// in the order of the runs, each run only moves towards the start, past the runs already moved
+			for (size_t i = 0; i < runs.size(); i++)
+			{
+				CompressedBlock &block = compressedBlocks[runs[i].second];
+				int noChunks = GetNoCompressedChunks(block.size);
+				int chunkId = TakeCompressedChunks(noChunks);
+				memmove(GetCompressedChunk(chunkId), GetCompressedChunk(block.firstChunkId), block.size);
+				block.firstChunkId = chunkId;
+				block.noChunks = noChunks;
+			}
+
+			size_t noPages = (noCompressedChunks + noChunksPerPage - 1) / noChunksPerPage;
+			for (size_t i = noPages; i < compressedPages.size(); i++) free(compressedPages[i]);
+			compressedPages.resize(noPages);
+		}
+
+		void ResetCompressedBlocks(void)
+		{
+			for (size_t i = 0; i < compressedBlocks.size(); i++) compressedBlocks[i].noChunks = compressedBlocks[i].size = 0;
+			for (size_t i = 0; i < freeCompressedChunks.size(); i++) freeCompressedChunks[i].clear();
+			noCompressedChunks = noUsedCompressedChunks = 0;
+			noCompressedBytes = 0;
+		}
+
+		void WriteHostBlock(int blockId, const TVoxel *data)
+		{
+			if (!swappingParams.compressBlocks)
+			{
+				memcpy(GetBlock(blockId), data, sizeof(TVoxel) * SDF_BLOCK_SIZE3);
+				return;
+			}
+
+			CompressedBlock &block = compressedBlocks[blockId];
+			int compressedSize = ITMVoxelBlockCompressor<TVoxel>::Compress(data, compressionBuffer, swappingParams.quantiseBlocks);
+			int noChunks = GetNoCompressedChunks(compressedSize);
+			if (noChunks > block.noChunks)
+			{
+				FreeCompressedChunks(block.firstChunkId, block.noChunks);
+				AllocateCompressedChunks(block, noChunks);
+			}
+			noUsedCompressedChunks += noChunks - GetNoCompressedChunks(block.size);
+			block.size = compressedSize;
+
+			// the chunks of a run are contiguous
+			memcpy(GetCompressedChunk(block.firstChunkId), compressionBuffer, compressedSize);
+
+			int noUnusedChunks = noCompressedChunks - noUsedCompressedChunks;
+			if (noUnusedChunks > noCompressedChunks / 4 && noUnusedChunks > noChunksPerPage / 4) CompactCompressedBlocks();
+		}
+
+		void ReadHostBlock(int blockId, TVoxel *data) const
+		{
+			if (swappingParams.compressBlocks) ITMVoxelBlockCompressor<TVoxel>::Decompress(GetCompressedChunk(compressedBlocks[blockId].firstChunkId), data, swappingParams.quantiseBlocks);
+			else memcpy(data, GetBlock(blockId), sizeof(TVoxel) * SDF_BLOCK_SIZE3);
+		}
+
+		/// A free block in the slabs, which may be made free by moving another block to the disk store
+		int AllocateHostBlock(void)
+		{
+			if (diskStore == NULL || noHostBlocks < swappingParams.maxHostBlocks)
+			{
+				int blockId = noHostBlocks++;
+				if (blockId >= (int)hostBlockEntryIds.size())
+				{
+					hostBlockEntryIds.push_back(-1);
+					if (swappingParams.compressBlocks)
+					{
+						CompressedBlock block = { 0, 0, 0 };
+						compressedBlocks.push_back(block);
+					}
+					else if (blockId / noBlocksPerSlab >= (int)slabs.size())
+						slabs.push_back((TVoxel*)malloc(noBlocksPerSlab * sizeof(TVoxel) * SDF_BLOCK_SIZE3));
+				}
+				return blockId;
+			}
+
+			int blockId = nextEvictedBlockId;
+			nextEvictedBlockId = (nextEvictedBlockId + 1) % noHostBlocks;
+
+			int evictedEntryId = hostBlockEntryIds[blockId];
+			if (swappingParams.compressBlocks)
+			{
+				ReadHostBlock(blockId, blockBuffer);
+				diskStore->Write(storedBlockPositions[evictedEntryId], blockBuffer);
+			}
+			else diskStore->Write(storedBlockPositions[evictedEntryId], GetBlock(blockId));
+			storedBlockIds[evictedEntryId] = BLOCK_ON_DISK;
+			noBlocksOnDisk++;
+
+			return blockId;
+		}
+
+		static void RunTransfers(void *cache) { ((ITMGlobalCache*)cache)->RunTransfers(); }
+
+		void RunTransfers(void)
+		{
+			ITM_PROFILE_SCOPE("SwappingTransfers");
+
+			// stores first, as a block may be requested again right after it has been swapped out
+			StoreBlocks(neededEntryIDs_host, syncedBlockPositions_host, noSwapOutEntries, hasSyncedData_host, syncedVoxelBlocks_host);
+			FetchStoredBlocks(swapInEntryIDs_host, noSwapInEntries, hasSwapInData_host, swapInVoxelBlocks_host);
+		}
+
+		// Suppress the default copy constructor and assignment operator
+		ITMGlobalCache(const ITMGlobalCache&);
+		ITMGlobalCache& operator=(const ITMGlobalCache&);
+
 	public:
-		inline void SetStoredData(int address, TVoxel *data) 
+		inline void SetStoredData(int address, const Vector3s &blockPos, const TVoxel *data) 
 		{ 
-			hasStoredData[address] = true; 
-			memcpy(storedVoxelBlocks + address * SDF_BLOCK_SIZE3, data, sizeof(TVoxel) * SDF_BLOCK_SIZE3);
+			int blockId = storedBlockIds[address];
+			if (blockId < 0)
+			{
+				// a copy on disk is outdated now, and simply overwritten if the block is moved there again
+				if (blockId == BLOCK_ON_DISK) noBlocksOnDisk--;
+
+				blockId = AllocateHostBlock();
+				hostBlockEntryIds[blockId] = address;
+				storedBlockIds[address] = blockId;
+			}
+
+			storedBlockPositions[address] = blockPos;
+			WriteHostBlock(blockId, data);
+		}
+		inline bool HasStoredData(int address) const { return storedBlockIds[address] != -1; }
+
+		/** Copies the stored blocks of @p noEntries hash entries into
+		    @p blocks, with empty voxels and hasData[i] = false for
+		    the ones without stored data.
+		*/
+		void FetchStoredBlocks(const int *entryIDs, int noEntries, bool *hasData, TVoxel *blocks) const
+		{
+			if (noEntries <= 0) return;
+
+			std::fill_n(blocks, noEntries * SDF_BLOCK_SIZE3, TVoxel());
+			std::fill_n(hasData, noEntries, false);
+			for (int i = 0; i < noEntries; i++)
+			{
+				int blockId = storedBlockIds[entryIDs[i]];
+				if (blockId >= 0)
+				{
+					hasData[i] = true;
+					ReadHostBlock(blockId, blocks + i * SDF_BLOCK_SIZE3);
+				}
+				else if (blockId == BLOCK_ON_DISK)
+				{
+					hasData[i] = diskStore->Read(storedBlockPositions[entryIDs[i]], blocks + i * SDF_BLOCK_SIZE3);
+				}
+			}
+		}
+
+		/// Stores the blocks of @p noEntries hash entries at the given block positions, skipping the ones with hasData[i] = false
+		void StoreBlocks(const int *entryIDs, const Vector3s *blockPositions, int noEntries, const bool *hasData, const TVoxel *blocks)
+		{
+			for (int i = 0; i < noEntries; i++)
+			{
+				if (hasData[i]) SetStoredData(entryIDs[i], blockPositions[i], blocks + i * SDF_BLOCK_SIZE3);
+			}
+		}
+
+		bool UsesAsyncTransfers(void) const { return swappingParams.useAsyncTransfers; }
+
+		/** Stores the first @p noSwapOutEntries blocks of the synced
+		    buffers, and then fetches the blocks of the first
+		    @p noSwapInEntries entries of the swap-in buffers, on the
+		    background thread. None of the host buffers may be touched
+		    until WaitForTransfers() has returned. Only used with
+		    asynchronous transfers.
+		*/
+		void StartTransfers(int noSwapOutEntries, int noSwapInEntries)
+		{
+			WaitForTransfers();
+			if (noSwapOutEntries == 0 && noSwapInEntries == 0) { this->noSwapInEntries = 0; return; }
+
+			this->noSwapOutEntries = noSwapOutEntries;
+			this->noSwapInEntries = noSwapInEntries;
+
+			if (transferThread == NULL) transferThread = new ITMWorkerThread();
+			transferThread->Start(RunTransfers, this);
+		}
+
+		/// Waits for the transfers started by StartTransfers(), if any
+		void WaitForTransfers(void)
+		{
+			if (transferThread != NULL) transferThread->Wait();
+			noHostBlocks_waited = noHostBlocks;
+			noBlocksOnDisk_waited = noBlocksOnDisk;
+			noCompressedBytes_waited = noCompressedBytes;
+		}
+
+		/// The number of blocks fetched into the swap-in buffers by the last transfers
+		int GetNoSwapInEntries(void) const { return noSwapInEntries; }
+
+		bool *GetHasSwapInData(void) const { return hasSwapInData_host; }
+		TVoxel *GetSwapInVoxelBlocks(void) const { return swapInVoxelBlocks_host; }
+		int *GetSwapInEntryIDs(void) const { return swapInEntryIDs_host; }
+
+		/// With asynchronous transfers, the number as of the last WaitForTransfers()
+		int GetNoStoredBlocks(void) const { return GetNoHostBlocks() + GetNoBlocksOnDisk(); }
+		int GetNoHostBlocks(void) const { return UsesAsyncTransfers() ? noHostBlocks_waited : noHostBlocks; }
+		int GetNoBlocksOnDisk(void) const { return UsesAsyncTransfers() ? noBlocksOnDisk_waited : noBlocksOnDisk; }
+
+		/// Host memory taken by the stored blocks, in bytes
+		size_t GetStoredMemoryUsage(void) const
+		{
+			if (swappingParams.compressBlocks) return UsesAsyncTransfers() ? noCompressedBytes_waited : noCompressedBytes;
+
+			int noSlabs = (GetNoHostBlocks() + noBlocksPerSlab - 1) / noBlocksPerSlab;
+			return (size_t)noSlabs * noBlocksPerSlab * sizeof(TVoxel) * SDF_BLOCK_SIZE3;
 		}
-		inline bool HasStoredData(int address) const { return hasStoredData[address]; }
-		inline TVoxel *GetStoredVoxelBlock(int address) { return storedVoxelBlocks + address * SDF_BLOCK_SIZE3; }
 
 		bool *GetHasSyncedData(bool useGPU) const { return useGPU ? hasSyncedData_device : hasSyncedData_host; }
 		TVoxel *GetSyncedVoxelBlocks(bool useGPU) const { return useGPU ? syncedVoxelBlocks_device : syncedVoxelBlocks_host; }
+		Vector3s *GetSyncedBlockPositions(bool useGPU) const { return useGPU ? syncedBlockPositions_device : syncedBlockPositions_host; }
 
 		ITMHashSwapState *GetSwapStates(bool useGPU) { return useGPU ? swapStates_device : swapStates_host; }
 		int *GetNeededEntryIDs(bool useGPU) { return useGPU ? neededEntryIDs_device : neededEntryIDs_host; }
 
 		int noTotalEntries; 
 
-		ITMGlobalCache() : noTotalEntries(SDF_BUCKET_NUM + SDF_EXCESS_LIST_SIZE)
+		ITMGlobalCache(int noTotalEntries, const ITMSwappingParams &swappingParams = ITMSwappingParams())
+			: swappingParams(swappingParams), noTotalEntries(noTotalEntries)
 		{	
-			hasStoredData = (bool*)malloc(noTotalEntries * sizeof(bool));
-			storedVoxelBlocks = (TVoxel*)malloc(noTotalEntries * sizeof(TVoxel) * SDF_BLOCK_SIZE3);
-			memset(hasStoredData, 0, noTotalEntries);
+			storedBlockIds = (int*)malloc(noTotalEntries * sizeof(int));
+			for (int i = 0; i < noTotalEntries; i++) storedBlockIds[i] = -1;
+			storedBlockPositions = (Vector3s*)malloc(noTotalEntries * sizeof(Vector3s));
+			noHostBlocks = noBlocksOnDisk = 0;
+			noHostBlocks_waited = noBlocksOnDisk_waited = 0;
+			noCompressedChunks = noUsedCompressedChunks = 0;
+			noCompressedBytes = noCompressedBytes_waited = 0;
+			nextEvictedBlockId = 0;
+
+			compressionBuffer = NULL;
+			blockBuffer = NULL;
+			if (swappingParams.compressBlocks)
+			{
+				int maxCompressedSize = ITMVoxelBlockCompressor<TVoxel>::GetMaxCompressedSize(swappingParams.quantiseBlocks);
+				compressionBuffer = (uchar*)malloc(maxCompressedSize);
+				freeCompressedChunks.resize(GetNoCompressedChunks(maxCompressedSize) + 1);
+				blockBuffer = (TVoxel*)malloc(SDF_BLOCK_SIZE3 * sizeof(TVoxel));
+			}
+
+			diskStore = swappingParams.UsesDiskStore() ? new ITMDiskBlockStore(swappingParams.diskStoreDirectory, sizeof(TVoxel) * SDF_BLOCK_SIZE3) : NULL;
+
+			transferThread = NULL;
+			noSwapOutEntries = noSwapInEntries = 0;
+			hasSwapInData_host = NULL;
+			swapInVoxelBlocks_host = NULL;
+			swapInEntryIDs_host = NULL;
 
 			swapStates_host = (ITMHashSwapState *)malloc(noTotalEntries * sizeof(ITMHashSwapState));
 			memset(swapStates_host, 0, sizeof(ITMHashSwapState) * noTotalEntries);
@@ -63,6 +440,14 @@ namespace ITMLib
 			ORcudaSafeCall(cudaMallocHost((void**)&syncedVoxelBlocks_host, SDF_TRANSFER_BLOCK_NUM * sizeof(TVoxel) * SDF_BLOCK_SIZE3));
 			ORcudaSafeCall(cudaMallocHost((void**)&hasSyncedData_host, SDF_TRANSFER_BLOCK_NUM * sizeof(bool)));
 			ORcudaSafeCall(cudaMallocHost((void**)&neededEntryIDs_host, SDF_TRANSFER_BLOCK_NUM * sizeof(int)));
+			ORcudaSafeCall(cudaMallocHost((void**)&syncedBlockPositions_host, SDF_TRANSFER_BLOCK_NUM * sizeof(Vector3s)));
+
+			if (UsesAsyncTransfers())
+			{
+				ORcudaSafeCall(cudaMallocHost((void**)&swapInVoxelBlocks_host, SDF_TRANSFER_BLOCK_NUM * sizeof(TVoxel) * SDF_BLOCK_SIZE3));
+				ORcudaSafeCall(cudaMallocHost((void**)&hasSwapInData_host, SDF_TRANSFER_BLOCK_NUM * sizeof(bool)));
+				ORcudaSafeCall(cudaMallocHost((void**)&swapInEntryIDs_host, SDF_TRANSFER_BLOCK_NUM * sizeof(int)));
+			}
 
 			ORcudaSafeCall(cudaMalloc((void**)&swapStates_device, noTotalEntries * sizeof(ITMHashSwapState)));
 			ORcudaSafeCall(cudaMemset(swapStates_device, 0, noTotalEntries * sizeof(ITMHashSwapState)));
@@ -71,50 +456,121 @@ namespace ITMLib
 			ORcudaSafeCall(cudaMalloc((void**)&hasSyncedData_device, SDF_TRANSFER_BLOCK_NUM * sizeof(bool)));
 
 			ORcudaSafeCall(cudaMalloc((void**)&neededEntryIDs_device, SDF_TRANSFER_BLOCK_NUM * sizeof(int)));
+			ORcudaSafeCall(cudaMalloc((void**)&syncedBlockPositions_device, SDF_TRANSFER_BLOCK_NUM * sizeof(Vector3s)));
 #else
 			syncedVoxelBlocks_host = (TVoxel *)malloc(SDF_TRANSFER_BLOCK_NUM * sizeof(TVoxel) * SDF_BLOCK_SIZE3);
 			hasSyncedData_host = (bool*)malloc(SDF_TRANSFER_BLOCK_NUM * sizeof(bool));
 			neededEntryIDs_host = (int*)malloc(SDF_TRANSFER_BLOCK_NUM * sizeof(int));
+			syncedBlockPositions_host = (Vector3s*)malloc(SDF_TRANSFER_BLOCK_NUM * sizeof(Vector3s));
+
+			if (UsesAsyncTransfers())
+			{
+				swapInVoxelBlocks_host = (TVoxel *)malloc(SDF_TRANSFER_BLOCK_NUM * sizeof(TVoxel) * SDF_BLOCK_SIZE3);
+				hasSwapInData_host = (bool*)malloc(SDF_TRANSFER_BLOCK_NUM * sizeof(bool));
+				swapInEntryIDs_host = (int*)malloc(SDF_TRANSFER_BLOCK_NUM * sizeof(int));
+			}
+#endif
+		}
+
+		/** Grow the cache to cover @p newNoTotalEntries hash
+		entries, e.g. after the excess list of the hash table
+		has grown. Existing entries are kept, new ones start
+		without stored data.
+		*/
+		void Resize(int newNoTotalEntries)
+		{
+			if (newNoTotalEntries <= noTotalEntries) return;
+
+			WaitForTransfers();
+
+			int noNewEntries = newNoTotalEntries - noTotalEntries;
+
+			storedBlockIds = (int*)realloc(storedBlockIds, newNoTotalEntries * sizeof(int));
+			for (int i = noTotalEntries; i < newNoTotalEntries; i++) storedBlockIds[i] = -1;
+			storedBlockPositions = (Vector3s*)realloc(storedBlockPositions, newNoTotalEntries * sizeof(Vector3s));
+
+			swapStates_host = (ITMHashSwapState *)realloc(swapStates_host, newNoTotalEntries * sizeof(ITMHashSwapState));
+			memset(swapStates_host + noTotalEntries, 0, noNewEntries * sizeof(ITMHashSwapState));
+
+#ifndef COMPILE_WITHOUT_CUDA
+			ITMHashSwapState *newSwapStates_device;
+			ORcudaSafeCall(cudaMalloc((void**)&newSwapStates_device, newNoTotalEntries * sizeof(ITMHashSwapState)));
+			ORcudaSafeCall(cudaMemcpy(newSwapStates_device, swapStates_device, noTotalEntries * sizeof(ITMHashSwapState), cudaMemcpyDeviceToDevice));
+			ORcudaSafeCall(cudaMemset(newSwapStates_device + noTotalEntries, 0, noNewEntries * sizeof(ITMHashSwapState)));
+			ORcudaSafeCall(cudaFree(swapStates_device));
+			swapStates_device = newSwapStates_device;
 #endif
+
+			noTotalEntries = newNoTotalEntries;
 		}
 
-		void SaveToFile(char *fileName) const
+		/// The file has a block for every hash entry, as before the cache was sparse, with zeros for the ones without data
+		void SaveToFile(char *fileName)
 		{
-			TVoxel *storedData = storedVoxelBlocks;
+			WaitForTransfers();
 
 			FILE *f = fopen(fileName, "wb");
 
+			bool *hasStoredData = (bool*)malloc(noTotalEntries * sizeof(bool));
+			for (int i = 0; i < noTotalEntries; i++) hasStoredData[i] = HasStoredData(i);
 			fwrite(hasStoredData, sizeof(bool), noTotalEntries, f);
+			free(hasStoredData);
+
+			TVoxel *block = (TVoxel*)malloc(SDF_BLOCK_SIZE3 * sizeof(TVoxel));
 			for (int i = 0; i < noTotalEntries; i++)
 			{
-				fwrite(storedData, sizeof(TVoxel) * SDF_BLOCK_SIZE3, 1, f);
-				storedData += SDF_BLOCK_SIZE3;
+				bool hasData;
+				FetchStoredBlocks(&i, 1, &hasData, block);
+				fwrite(block, sizeof(TVoxel) * SDF_BLOCK_SIZE3, 1, f);
 			}
+			free(block);
 
 			fclose(f);
 		}
 
-		void ReadFromFile(char *fileName)
+		/// @p hashTable is a host copy of the hash table, for the positions of the blocks
+		void ReadFromFile(char *fileName, const ITMHashEntry *hashTable)
 		{
-			TVoxel *storedData = storedVoxelBlocks;
+			WaitForTransfers();
+
 			FILE *f = fopen(fileName, "rb");
 
+			// the slabs, the pages of compressed blocks and the disk store are reused, the
+			// disk store keeps its file until it gets a new block
+			for (int i = 0; i < noTotalEntries; i++) storedBlockIds[i] = -1;
+			noHostBlocks = noBlocksOnDisk = 0;
+			ResetCompressedBlocks();
+			nextEvictedBlockId = 0;
+
+			bool *hasStoredData = (bool*)malloc(noTotalEntries * sizeof(bool));
 			size_t tmp = fread(hasStoredData, sizeof(bool), noTotalEntries, f);
 			if (tmp == (size_t)noTotalEntries) {
+				TVoxel *block = (TVoxel*)malloc(SDF_BLOCK_SIZE3 * sizeof(TVoxel));
 				for (int i = 0; i < noTotalEntries; i++)
 				{
-					fread(storedData, sizeof(TVoxel) * SDF_BLOCK_SIZE3, 1, f);
-					storedData += SDF_BLOCK_SIZE3;
+					if (!hasStoredData[i]) { fseek(f, sizeof(TVoxel) * SDF_BLOCK_SIZE3, SEEK_CUR); continue; }
+					if (fread(block, sizeof(TVoxel) * SDF_BLOCK_SIZE3, 1, f) != 1) break;
+					SetStoredData(i, hashTable[i].pos, block);
 				}
+				free(block);
 			}
+			free(hasStoredData);
 
 			fclose(f);
 		}
 
 		~ITMGlobalCache(void) 
 		{
-			free(hasStoredData);
-			free(storedVoxelBlocks);
+			// the transfers may still write into the stored blocks
+			delete transferThread;
+
+			free(storedBlockIds);
+			free(storedBlockPositions);
+			for (size_t i = 0; i < slabs.size(); i++) free(slabs[i]);
+			for (size_t i = 0; i < compressedPages.size(); i++) free(compressedPages[i]);
+			free(compressionBuffer);
+			free(blockBuffer);
+			delete diskStore;
 
 			free(swapStates_host);
 
@@ -122,15 +578,29 @@ namespace ITMLib
 			ORcudaSafeCall(cudaFreeHost(hasSyncedData_host));
 			ORcudaSafeCall(cudaFreeHost(syncedVoxelBlocks_host));
 			ORcudaSafeCall(cudaFreeHost(neededEntryIDs_host));
+			ORcudaSafeCall(cudaFreeHost(syncedBlockPositions_host));
+
+			if (UsesAsyncTransfers())
+			{
+				ORcudaSafeCall(cudaFreeHost(hasSwapInData_host));
+				ORcudaSafeCall(cudaFreeHost(swapInVoxelBlocks_host));
+				ORcudaSafeCall(cudaFreeHost(swapInEntryIDs_host));
+			}
 
 			ORcudaSafeCall(cudaFree(swapStates_device));
 			ORcudaSafeCall(cudaFree(syncedVoxelBlocks_device));
 			ORcudaSafeCall(cudaFree(hasSyncedData_device));
 			ORcudaSafeCall(cudaFree(neededEntryIDs_device));
+			ORcudaSafeCall(cudaFree(syncedBlockPositions_device));
 #else
 			free(hasSyncedData_host);
 			free(syncedVoxelBlocks_host);
 			free(neededEntryIDs_host);
+			free(syncedBlockPositions_host);
+
+			free(hasSwapInData_host);
+			free(swapInVoxelBlocks_host);
+			free(swapInEntryIDs_host);
 #endif
 		}
 	};
@@ -4,6 +4,7 @@
 
 #include "../../../ORUtils/MemoryBlock.h"
 #include "../../../ORUtils/MemoryBlockPersister.h"
+#include "ITMVoxelBlockHash.h"
 
 namespace ITMLib
 {
@@ -17,6 +18,7 @@ namespace ITMLib
 	private:
 		ORUtils::MemoryBlock<TVoxel> *voxelBlocks;
 		ORUtils::MemoryBlock<int> *allocationList;
+		ORUtils::MemoryBlock<ITMVoxelBlockSummary> *blockSummaries;
 
 		MemoryDeviceType memoryType;
 
@@ -25,9 +27,14 @@ namespace ITMLib
 		inline const TVoxel *GetVoxelBlocks(void) const { return voxelBlocks->GetData(memoryType); }
 		int *GetAllocationList(void) { return allocationList->GetData(memoryType); }
 
+		/** One summary per voxel block, indexed like the blocks. */
+		inline ITMVoxelBlockSummary *GetBlockSummaries(void) { return blockSummaries->GetData(memoryType); }
+		inline const ITMVoxelBlockSummary *GetBlockSummaries(void) const { return blockSummaries->GetData(memoryType); }
+
 #ifdef COMPILE_WITH_METAL
 		const void* GetVoxelBlocks_MB() const { return voxelBlocks->GetMetalBuffer(); }
 		const void* GetAllocationList_MB(void) const { return allocationList->GetMetalBuffer(); }
+		const void* GetBlockSummaries_MB(void) const { return blockSummaries->GetMetalBuffer(); }
 #endif
 		int lastFreeBlockId;
 
@@ -37,10 +44,12 @@ namespace ITMLib
 		{
 			std::string VBFileName = outputDirectory + "voxel.dat";
 			std::string ALFileName = outputDirectory + "alloc.dat";
+			std::string BSFileName = outputDirectory + "summary.dat";
 			std::string AllocSizeFileName = outputDirectory + "vba.txt";
 
 			ORUtils::MemoryBlockPersister::SaveMemoryBlock(VBFileName, *voxelBlocks, memoryType);
 			ORUtils::MemoryBlockPersister::SaveMemoryBlock(ALFileName, *allocationList, memoryType);
+			ORUtils::MemoryBlockPersister::SaveMemoryBlock(BSFileName, *blockSummaries, memoryType);
 
 			std::ofstream ofs(AllocSizeFileName.c_str());
 			if (!ofs) throw std::runtime_error("Could not open " + AllocSizeFileName + " for writing");
@@ -52,11 +61,28 @@ namespace ITMLib
 		{
 			std::string VBFileName = inputDirectory + "voxel.dat";
 			std::string ALFileName = inputDirectory + "alloc.dat";
+			std::string BSFileName = inputDirectory + "summary.dat";
 			std::string AllocSizeFileName = inputDirectory + "vba.txt";
 
+			// the voxel block array may have grown before it was saved
+			size_t noBlocks = ORUtils::MemoryBlockPersister::ReadBlockSize(ALFileName);
+			voxelBlocks->Resize(ORUtils::MemoryBlockPersister::ReadBlockSize(VBFileName));
+			allocationList->Resize(noBlocks);
+			blockSummaries->Resize(noBlocks);
+
 			ORUtils::MemoryBlockPersister::LoadMemoryBlock(VBFileName, *voxelBlocks, memoryType);
 			ORUtils::MemoryBlockPersister::LoadMemoryBlock(ALFileName, *allocationList, memoryType);
 
+			if (std::ifstream(BSFileName.c_str())) ORUtils::MemoryBlockPersister::LoadMemoryBlock(BSFileName, *blockSummaries, memoryType);
+			else
+			{
+				// scenes saved before there were block summaries
+				ORUtils::MemoryBlock<ITMVoxelBlockSummary> blockSummaries_host(noBlocks, MEMORYDEVICE_CPU);
+				ITMVoxelBlockSummary *summaries = blockSummaries_host.GetData(MEMORYDEVICE_CPU);
+				for (size_t blockId = 0; blockId < noBlocks; ++blockId) summaries[blockId] = ITMVoxelBlockSummary::unknownSummary();
+				blockSummaries->SetFrom(&blockSummaries_host, memoryType == MEMORYDEVICE_CUDA ? ORUtils::MemoryBlock<ITMVoxelBlockSummary>::CPU_TO_CUDA : ORUtils::MemoryBlock<ITMVoxelBlockSummary>::CPU_TO_CPU);
+			}
+
 			std::ifstream ifs(AllocSizeFileName.c_str());
 			if (!ifs) throw std::runtime_error("Could not open " + AllocSizeFileName + " for reading");
 
@@ -71,12 +97,30 @@ namespace ITMLib
 
 			voxelBlocks = new ORUtils::MemoryBlock<TVoxel>(allocatedSize, memoryType);
 			allocationList = new ORUtils::MemoryBlock<int>(noBlocks, memoryType);
+			blockSummaries = new ORUtils::MemoryBlock<ITMVoxelBlockSummary>(noBlocks, memoryType);
+		}
+
+		/** Grow the voxel block array to @p noBlocks blocks of
+		@p blockSize voxels, keeping all existing blocks. The
+		new blocks, block summaries and allocation list slots are
+		zeroed and have to be initialised by the caller.
+		*/
+		void Grow(int noBlocks, int blockSize)
+		{
+			if (noBlocks * blockSize <= allocatedSize) return;
+
+			allocatedSize = noBlocks * blockSize;
+
+			voxelBlocks->Grow(allocatedSize);
+			allocationList->Grow(noBlocks);
+			blockSummaries->Grow(noBlocks);
 		}
 
 		~ITMLocalVBA(void)
 		{
 			delete voxelBlocks;
 			delete allocationList;
+			delete blockSummaries;
 		}
 
 		// Suppress the default copy constructor and assignment operator
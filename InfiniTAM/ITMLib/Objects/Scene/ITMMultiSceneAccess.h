@@ -21,6 +21,8 @@ namespace ITMLib {
 			int numLocalMaps;
 			typedef TIndex IndexType;
 			typename TIndex::IndexData *index[MAX_NUM_LOCALMAPS];
+			/// number of entries in each of the hash tables in index
+			int noTotalEntries[MAX_NUM_LOCALMAPS];
 			Matrix4f poses_vs[MAX_NUM_LOCALMAPS];
 			Matrix4f posesInv[MAX_NUM_LOCALMAPS];
 		};
@@ -5,6 +5,7 @@
 #ifndef __METALC__
 
 #include "../../Utils/ITMMath.h"
+#include "../../Utils/ITMSceneParams.h"
 #include "../../../ORUtils/MemoryBlock.h"
 
 namespace ITMLib
@@ -41,7 +42,7 @@ namespace ITMLib
 		MemoryDeviceType memoryType;
 
 	public:
-		ITMPlainVoxelArray(MemoryDeviceType memoryType)
+		ITMPlainVoxelArray(const ITMSceneParams *sceneParams, MemoryDeviceType memoryType)
 		{
 			this->memoryType = memoryType;
 
@@ -58,7 +59,7 @@ namespace ITMLib
 		}
 
 		/** Maximum number of total entries. */
-		int getNumAllocatedVoxelBlocks(void) { return 1; }
+		int getNumAllocatedVoxelBlocks(void) const { return 1; }
 		int getVoxelBlockSize(void) 
 		{ 
 			return indexData->GetData(MEMORYDEVICE_CPU)->size.x * 
@@ -4,8 +4,20 @@
 
 #include "ITMVoxelBlockHash.h"
 
-template<typename T> _CPU_AND_GPU_CODE_ inline int hashIndex(const THREADPTR(T) & blockPos) {
-	return (((uint)blockPos.x * 73856093u) ^ ((uint)blockPos.y * 19349669u) ^ ((uint)blockPos.z * 83492791u)) & (uint)SDF_HASH_MASK;
+/** Bucket mask of a hash table, i.e. the number of ordered buckets minus one.
+It is stored in the header entry that precedes the table (see ITMVoxelBlockHash).
+*/
+_CPU_AND_GPU_CODE_ inline int hashMask(const CONSTPTR(ITMHashEntry) *hashTable) {
+	return hashTable[-1].offset;
+}
+
+template<typename T> _CPU_AND_GPU_CODE_ inline int hashIndex(const THREADPTR(T) & blockPos, int hashMask) {
+	return (((uint)blockPos.x * 73856093u) ^ ((uint)blockPos.y * 19349669u) ^ ((uint)blockPos.z * 83492791u)) & (uint)hashMask;
+}
+
+/** Index of the entry at (1-based) @p offset in the excess list, which follows the ordered buckets. */
+_CPU_AND_GPU_CODE_ inline int excessListIndex(int hashMask, int offset) {
+	return hashMask + offset;
 }
 
 _CPU_AND_GPU_CODE_ inline int pointToVoxelBlockPos(const THREADPTR(Vector3i) & point, THREADPTR(Vector3i) &blockPos) {
@@ -30,7 +42,8 @@ _CPU_AND_GPU_CODE_ inline int findVoxel(const CONSTPTR(ITMLib::ITMVoxelBlockHash
 		return cache.blockPtr + linearIdx;
 	}
 
-	int hashIdx = hashIndex(blockPos);
+	int mask = hashMask(voxelIndex);
+	int hashIdx = hashIndex(blockPos, mask);
 
 	while (true)
 	{
@@ -44,7 +57,7 @@ _CPU_AND_GPU_CODE_ inline int findVoxel(const CONSTPTR(ITMLib::ITMVoxelBlockHash
 		}
 
 		if (hashEntry.offset < 1) break;
-		hashIdx = SDF_BUCKET_NUM + hashEntry.offset - 1;
+		hashIdx = excessListIndex(mask, hashEntry.offset);
 	}
 
 	vmIndex = false;
@@ -79,7 +92,8 @@ _CPU_AND_GPU_CODE_ inline TVoxel readVoxel(const CONSTPTR(TVoxel) *voxelData, co
 		return voxelData[cache.blockPtr + linearIdx];
 	}
 
-	int hashIdx = hashIndex(blockPos);
+	int mask = hashMask(voxelIndex);
+	int hashIdx = hashIndex(blockPos, mask);
 
 	while (true)
 	{
@@ -94,7 +108,7 @@ _CPU_AND_GPU_CODE_ inline TVoxel readVoxel(const CONSTPTR(TVoxel) *voxelData, co
 		}
 
 		if (hashEntry.offset < 1) break;
-		hashIdx = SDF_BUCKET_NUM + hashEntry.offset - 1;
+		hashIdx = excessListIndex(mask, hashEntry.offset);
 	}
 
 	vmIndex = false;
@@ -40,10 +40,10 @@ namespace ITMLib
 			index.LoadFromDirectory(outputDirectory);			
 		}
 
-		ITMScene(const ITMSceneParams *_sceneParams, bool _useSwapping, MemoryDeviceType _memoryType)
-			: sceneParams(_sceneParams), index(_memoryType), localVBA(_memoryType, index.getNumAllocatedVoxelBlocks(), index.getVoxelBlockSize())
+		ITMScene(const ITMSceneParams *_sceneParams, bool _useSwapping, MemoryDeviceType _memoryType, const ITMSwappingParams &_swappingParams = ITMSwappingParams())
+			: sceneParams(_sceneParams), index(_sceneParams, _memoryType), localVBA(_memoryType, index.getNumAllocatedVoxelBlocks(), index.getVoxelBlockSize())
 		{
-			if (_useSwapping) globalCache = new ITMGlobalCache<TVoxel>();
+			if (_useSwapping) globalCache = new ITMGlobalCache<TVoxel>(_sceneParams->noHashBuckets + _sceneParams->noExcessListEntries, _swappingParams);
 			else globalCache = NULL;
 		}
 
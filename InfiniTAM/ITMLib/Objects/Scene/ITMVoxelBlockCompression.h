@@ -0,0 +1,425 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <string.h>
+
+#include "ITMVoxelBlockHash.h"
+
+namespace ITMLib
+{
+	namespace VoxelBlockCompression
+	{
+		/// Writes codes of up to 33 bits into a byte buffer, most significant bit first
+		class BitWriter
+		{
+		private:
+			uchar *out;
+			unsigned long long buffer;
+			int noBufferedBits;
+
+		public:
+			explicit BitWriter(uchar *out) : out(out), buffer(0), noBufferedBits(0) { }
+
+			void Write(unsigned long long value, int noBits)
+			{
+				buffer = (buffer << noBits) | (value & ((1ull << noBits) - 1));
+				noBufferedBits += noBits;
+				// at most 31 bits stay buffered
+				if (noBufferedBits >= 32) Flush();
+			}
+
+			/// Pads the last byte with zeros and returns the end of the output
+			uchar *Finish(void)
+			{
+				if (noBufferedBits % 8 != 0) Write(0, 8 - noBufferedBits % 8);
+				Flush();
+				return out;
+			}
+
+		private:
+			void Flush(void)
+			{
+				while (noBufferedBits >= 8)
+				{
+					noBufferedBits -= 8;
+					*out++ = (uchar)(buffer >> noBufferedBits);
+				}
+			}
+		};
+
+		class BitReader
+		{
+		private:
+			const uchar *in;
+			unsigned long long buffer;
+			int noBufferedBits;
+
+		public:
+			explicit BitReader(const uchar *in) : in(in), buffer(0), noBufferedBits(0) { }
+
+			unsigned long long Read(int noBits)
+			{
+				while (noBufferedBits < noBits)
+				{
+					buffer = (buffer << 8) | *in++;
+					noBufferedBits += 8;
+				}
+				noBufferedBits -= noBits;
+				return (buffer >> noBufferedBits) & ((1ull << noBits) - 1);
+			}
+		};
+
+		/** \brief
+		    Golomb-Rice codes whose parameter follows the mean of the
+		    values coded so far, as in LOCO-I. A value is written as
+		    its quotient in unary and its remainder in k bits, or, if
+		    the quotient reaches escapeLength, as is in @p noBits bits
+		    after escapeLength ones.
+		*/
+		class AdaptiveRiceCode
+		{
+		private:
+			static const int escapeLength = 24;
+
+			unsigned long long sum;
+			int count;
+			/// The smallest k with count << k >= sum, which changes little from one value to the next
+			int k;
+
+			int GetK(int noBits) const { return k < noBits ? k : noBits; }
+
+			void Update(unsigned long long value)
+			{
+				sum += value;
+				// halve the history now and then, so that the code adapts to the part of the block it is in
+				if (++count == 64) { sum = (sum + 1) / 2; count = 32; }
+
+				while (((unsigned long long)count << k) < sum) k++;
+				while (k > 0 && ((unsigned long long)count << (k - 1)) >= sum) k--;
+			}
+
+		public:
+			AdaptiveRiceCode(void) : sum(16), count(1), k(4) { }
+
+			static int GetMaxLength(int noBits) { return escapeLength + noBits; }
+
+			void Write(BitWriter &writer, unsigned long long value, int noBits)
+			{
+				int k = GetK(noBits);
+				unsigned long long quotient = value >> k;
+				if (quotient < (unsigned long long)escapeLength)
+				{
+					writer.Write(((1ull << quotient) - 1) << 1, (int)quotient + 1);
+					if (k > 0) writer.Write(value, k);
+				}
+				else
+				{
+					writer.Write((1ull << escapeLength) - 1, escapeLength);
+					writer.Write(value, noBits);
+				}
+				Update(value);
+			}
+
+			unsigned long long Read(BitReader &reader, int noBits)
+			{
+				int k = GetK(noBits);
+				int quotient = 0;
+				while (quotient < escapeLength && reader.Read(1) != 0) quotient++;
+
+				unsigned long long value;
+				if (quotient < escapeLength) value = ((unsigned long long)quotient << k) | (k > 0 ? reader.Read(k) : 0);
+				else value = reader.Read(noBits);
+				Update(value);
+				return value;
+			}
+		};
+
+		inline unsigned long long ResidualToCode(long long residual) { return residual >= 0 ? 2ull * residual : 2ull * -residual - 1; }
+		inline long long CodeToResidual(unsigned long long code) { return (code & 1) ? -(long long)(code >> 1) - 1 : (long long)(code >> 1); }
+
+		/// The bits of a float as an integer that increases with the float, so that nearby values have nearby codes
+		inline int FloatToChannel(float value)
+		{
+			int bits; memcpy(&bits, &value, sizeof(bits));
+			return bits >= 0 ? bits : bits ^ 0x7fffffff;
+		}
+
+		inline float ChannelToFloat(int channel)
+		{
+			int bits = channel >= 0 ? channel : channel ^ 0x7fffffff;
+			float value; memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		inline int SDFToChannel(short sdf) { return sdf; }
+		inline int SDFToChannel(float sdf) { return FloatToChannel(sdf); }
+		inline void ChannelToSDF(int channel, short &sdf) { sdf = (short)channel; }
+		inline void ChannelToSDF(int channel, float &sdf) { sdf = ChannelToFloat(channel); }
+
+		// the optional parts of a voxel as channels, without the padding of the voxel types
+		template<bool hasColor, class TVoxel> struct ColorChannels;
+
+		template<class TVoxel>
+		struct ColorChannels<false, TVoxel>
+		{
+			static const int noChannels = 0;
+			static void GetNoBits(int *noBits, bool quantise) { }
+			static void write(const TVoxel &voxel, int *channels, bool quantise) { }
+			static void read(TVoxel &voxel, const int *channels, bool quantise) { }
+		};
+
+		template<class TVoxel>
+		struct ColorChannels<true, TVoxel>
+		{
+			static const int noChannels = 4;
+
+			static void GetNoBits(int *noBits, bool quantise)
+			{
+				// RGB565 when quantised
+				noBits[0] = quantise ? 5 : 8; noBits[1] = quantise ? 6 : 8; noBits[2] = quantise ? 5 : 8; noBits[3] = 8;
+			}
+
+			static void write(const TVoxel &voxel, int *channels, bool quantise)
+			{
+				channels[0] = quantise ? voxel.clr.r >> 3 : voxel.clr.r;
+				channels[1] = quantise ? voxel.clr.g >> 2 : voxel.clr.g;
+				channels[2] = quantise ? voxel.clr.b >> 3 : voxel.clr.b;
+				channels[3] = voxel.w_color;
+			}
+
+			static void read(TVoxel &voxel, const int *channels, bool quantise)
+			{
+				if (quantise)
+				{
+					int r = channels[0], g = channels[1], b = channels[2];
+					voxel.clr = Vector3u((uchar)((r << 3) | (r >> 2)), (uchar)((g << 2) | (g >> 4)), (uchar)((b << 3) | (b >> 2)));
+				}
+				else voxel.clr = Vector3u((uchar)channels[0], (uchar)channels[1], (uchar)channels[2]);
+				voxel.w_color = (uchar)channels[3];
+			}
+		};
+
+		template<bool hasConfidence, class TVoxel> struct ConfidenceChannels;
+
+		template<class TVoxel>
+		struct ConfidenceChannels<false, TVoxel>
+		{
+			static const int noChannels = 0;
+			static void GetNoBits(int *noBits) { }
+			static void write(const TVoxel &voxel, int *channels) { }
+			static void read(TVoxel &voxel, const int *channels) { }
+		};
+
+		template<class TVoxel>
+		struct ConfidenceChannels<true, TVoxel>
+		{
+			static const int noChannels = 1;
+			static void GetNoBits(int *noBits) { noBits[0] = 32; }
+			static void write(const TVoxel &voxel, int *channels) { channels[0] = FloatToChannel(voxel.confidence); }
+			static void read(TVoxel &voxel, const int *channels) { voxel.confidence = ChannelToFloat(channels[0]); }
+		};
+	}
+
+	/** \brief
+	    Compresses voxel blocks for the host side store of swapped
+	    out blocks.
+
+	    Each voxel is split into integer channels: w_depth, the SDF
+	    and, if the voxel type has them, colour, w_color and
+	    confidence. Floats are taken bit for bit. Every channel is
+	    predicted from the left, upper and upper left voxels in its
+	    xy slice with the median predictor of LOCO-I, which follows
+	    the ramps of the SDF along surfaces, and only the residuals
+	    are written, with adaptive Golomb-Rice codes.
+
+	    Voxels whose channels all equal their predictions, e.g. the
+	    unobserved and the saturated free space ones, are run length
+	    encoded. Voxels without observations, i.e. with w_depth 0,
+	    are equal to TVoxel() and have no other channels. Optionally,
+	    the SDF is quantised to 8 bits and the colour to RGB565,
+	    which is lossy.
+
+	    The encoding is a bit stream of the voxels in memory order:
+	    the number of predicted voxels that follow, then the residual
+	    of each channel of the next voxel, and so on, up to a final
+	    run that may end the block.
+
+	    On the blocks that a noisy synthetic corridor swaps out,
+	    ITMVoxel_s takes about 670 of its 2048 bytes losslessly and
+	    380 bytes quantised. The low bits of the SDF near surfaces
+	    are sensor noise, which no lossless predictor removes.
+	*/
+	template<class TVoxel>
+	class ITMVoxelBlockCompressor
+	{
+	private:
+		typedef VoxelBlockCompression::ColorChannels<TVoxel::hasColorInformation, TVoxel> ColorChannels;
+		typedef VoxelBlockCompression::ConfidenceChannels<TVoxel::hasConfidenceInformation, TVoxel> ConfidenceChannels;
+		typedef VoxelBlockCompression::AdaptiveRiceCode AdaptiveRiceCode;
+
+		static const int noChannels = 2 + ColorChannels::noChannels + ConfidenceChannels::noChannels;
+
+		/// Bits of the length of a run, which may cover the whole block
+		static int GetNoRunBits(void)
+		{
+			int noBits = 1;
+			while ((1 << noBits) <= SDF_BLOCK_SIZE3) noBits++;
+			return noBits;
+		}
+
+		/// Bits of the values of each channel; the residuals and their codes take one more
+		static void GetNoBits(int *noBits, bool quantise)
+		{
+			noBits[0] = 8;
+			noBits[1] = quantise ? 8 : (int)sizeof(((TVoxel*)0)->sdf) * 8;
+			ColorChannels::GetNoBits(noBits + 2, quantise);
+			ConfidenceChannels::GetNoBits(noBits + 2 + ColorChannels::noChannels);
+		}
+
+		static void WriteChannels(const TVoxel &voxel, int *channels, bool quantise)
+		{
+			channels[0] = voxel.w_depth;
+
+			if (quantise)
+			{
+				float sdf = TVoxel::valueToFloat(voxel.sdf);
+				sdf = sdf < -1.0f ? -1.0f : (sdf > 1.0f ? 1.0f : sdf);
+				channels[1] = (int)(sdf * 127.0f + (sdf >= 0.0f ? 0.5f : -0.5f));
+			}
+			else channels[1] = VoxelBlockCompression::SDFToChannel(voxel.sdf);
+
+			ColorChannels::write(voxel, channels + 2, quantise);
+			ConfidenceChannels::write(voxel, channels + 2 + ColorChannels::noChannels);
+		}
+
+		static void ReadChannels(TVoxel &voxel, const int *channels, bool quantise)
+		{
+			voxel.w_depth = (uchar)channels[0];
+
+			if (quantise) voxel.sdf = TVoxel::floatToValue((float)channels[1] / 127.0f);
+			else VoxelBlockCompression::ChannelToSDF(channels[1], voxel.sdf);
+
+			ColorChannels::read(voxel, channels + 2, quantise);
+			ConfidenceChannels::read(voxel, channels + 2 + ColorChannels::noChannels);
+		}
+
+		/// The median predictor of LOCO-I within the xy slice, along the edges of the block the previous voxel
+		static void Predict(const int (*channels)[noChannels], int x, int y, int z, const int *initialChannels, int *prediction)
+		{
+			int i = x + (y + z * SDF_BLOCK_SIZE) * SDF_BLOCK_SIZE;
+			for (int c = 0; c < noChannels; c++)
+			{
+				if (x > 0 && y > 0)
+				{
+					int left = channels[i - 1][c], up = channels[i - SDF_BLOCK_SIZE][c], upLeft = channels[i - SDF_BLOCK_SIZE - 1][c];
+					int lower = left < up ? left : up, upper = left < up ? up : left;
+					if (upLeft >= upper) prediction[c] = lower;
+					else if (upLeft <= lower) prediction[c] = upper;
+					else prediction[c] = (int)((long long)left + up - upLeft);
+				}
+				else if (x > 0) prediction[c] = channels[i - 1][c];
+				else if (y > 0) prediction[c] = channels[i - SDF_BLOCK_SIZE][c];
+				else if (z > 0) prediction[c] = channels[i - SDF_BLOCK_SIZE * SDF_BLOCK_SIZE][c];
+				else prediction[c] = initialChannels[c];
+			}
+		}
+
+	public:
+		/// An upper bound for the size of a compressed block, which Compress() needs as space in its output
+		static int GetMaxCompressedSize(bool quantise)
+		{
+			int noBits[noChannels];
+			GetNoBits(noBits, quantise);
+
+			int maxVoxelLength = AdaptiveRiceCode::GetMaxLength(GetNoRunBits());
+			for (int c = 0; c < noChannels; c++) maxVoxelLength += AdaptiveRiceCode::GetMaxLength(noBits[c] + 1);
+
+			// the final run
+			return (SDF_BLOCK_SIZE3 * maxVoxelLength + AdaptiveRiceCode::GetMaxLength(GetNoRunBits()) + 7) / 8;
+		}
+
+		/** Compresses the SDF_BLOCK_SIZE3 voxels of @p block into
+		    @p compressed, and returns the number of bytes written.
+		*/
+		static int Compress(const TVoxel *block, uchar *compressed, bool quantise)
+		{
+			int noBits[noChannels], initialChannels[noChannels];
+			GetNoBits(noBits, quantise);
+			WriteChannels(TVoxel(), initialChannels, quantise);
+
+			int channels[SDF_BLOCK_SIZE3][noChannels];
+			for (int i = 0; i < SDF_BLOCK_SIZE3; i++)
+			{
+				if (block[i].w_depth == 0) memcpy(channels[i], initialChannels, sizeof(initialChannels));
+				else WriteChannels(block[i], channels[i], quantise);
+			}
+
+			VoxelBlockCompression::BitWriter writer(compressed);
+			AdaptiveRiceCode runCode, channelCodes[noChannels];
+			int runLength = 0;
+			for (int z = 0; z < SDF_BLOCK_SIZE; z++) for (int y = 0; y < SDF_BLOCK_SIZE; y++) for (int x = 0; x < SDF_BLOCK_SIZE; x++)
+			{
+				int i = x + (y + z * SDF_BLOCK_SIZE) * SDF_BLOCK_SIZE;
+				int prediction[noChannels];
+				Predict(channels, x, y, z, initialChannels, prediction);
+
+				// only w_depth is coded for voxels without observations
+				int noCodedChannels = channels[i][0] == 0 ? 1 : noChannels;
+				bool isPredicted = true;
+				for (int c = 0; c < noCodedChannels; c++) isPredicted &= channels[i][c] == prediction[c];
+				if (isPredicted) { runLength++; continue; }
+
+				runCode.Write(writer, runLength, GetNoRunBits());
+				runLength = 0;
+				for (int c = 0; c < noCodedChannels; c++)
+					channelCodes[c].Write(writer, VoxelBlockCompression::ResidualToCode((long long)channels[i][c] - prediction[c]), noBits[c] + 1);
+			}
+			if (runLength > 0) runCode.Write(writer, runLength, GetNoRunBits());
+
+			return (int)(writer.Finish() - compressed);
+		}
+
+		/// Restores the SDF_BLOCK_SIZE3 voxels of @p block from the output of Compress()
+		static void Decompress(const uchar *compressed, TVoxel *block, bool quantise)
+		{
+			int noBits[noChannels], initialChannels[noChannels];
+			GetNoBits(noBits, quantise);
+			WriteChannels(TVoxel(), initialChannels, quantise);
+
+			int channels[SDF_BLOCK_SIZE3][noChannels];
+			VoxelBlockCompression::BitReader reader(compressed);
+			AdaptiveRiceCode runCode, channelCodes[noChannels];
+			int runLength = -1;
+			for (int z = 0; z < SDF_BLOCK_SIZE; z++) for (int y = 0; y < SDF_BLOCK_SIZE; y++) for (int x = 0; x < SDF_BLOCK_SIZE; x++)
+			{
+				int i = x + (y + z * SDF_BLOCK_SIZE) * SDF_BLOCK_SIZE;
+				Predict(channels, x, y, z, initialChannels, channels[i]);
+
+				// a run is followed by a coded voxel, unless it ends the block
+				if (runLength < 0) runLength = (int)runCode.Read(reader, GetNoRunBits());
+				if (runLength > 0)
+				{
+					runLength--;
+				}
+				else
+				{
+					runLength = -1;
+					channels[i][0] += (int)VoxelBlockCompression::CodeToResidual(channelCodes[0].Read(reader, noBits[0] + 1));
+					if (channels[i][0] != 0)
+					{
+						for (int c = 1; c < noChannels; c++)
+							channels[i][c] = (int)(channels[i][c] + VoxelBlockCompression::CodeToResidual(channelCodes[c].Read(reader, noBits[c] + 1)));
+					}
+				}
+
+				if (channels[i][0] == 0)
+				{
+					memcpy(channels[i], initialChannels, sizeof(initialChannels));
+					block[i] = TVoxel();
+				}
+				else ReadChannels(block[i], channels[i], quantise);
+			}
+		}
+	};
+}
@@ -12,22 +12,13 @@
 #include "../../../ORUtils/MemoryBlock.h"
 #include "../../../ORUtils/MemoryBlockPersister.h"
 
+#ifndef __METALC__
+#include "../../Utils/ITMSceneParams.h"
+#endif
+
 #define SDF_BLOCK_SIZE 8				// SDF block size
 #define SDF_BLOCK_SIZE3 512				// SDF_BLOCK_SIZE3 = SDF_BLOCK_SIZE * SDF_BLOCK_SIZE * SDF_BLOCK_SIZE
 
-#define SDF_LOCAL_BLOCK_NUM 0x40000		// Number of locally stored blocks, currently 2^17
-
-#define SDF_BUCKET_NUM 0x100000			// Number of Hash Bucket, should be 2^n and bigger than SDF_LOCAL_BLOCK_NUM, SDF_HASH_MASK = SDF_BUCKET_NUM - 1
-#define SDF_HASH_MASK 0xfffff			// Used for get hashing value of the bucket index,  SDF_HASH_MASK = SDF_BUCKET_NUM - 1
-#define SDF_EXCESS_LIST_SIZE 0x20000	// 0x20000 Size of excess list, used to handle collisions. Also max offset (unsigned short) value.
-
-//// for loop closure
-//#define SDF_LOCAL_BLOCK_NUM 0x10000		// Number of locally stored blocks, currently 2^12
-//
-//#define SDF_BUCKET_NUM 0x40000			// Number of Hash Bucket, should be 2^n and bigger than SDF_LOCAL_BLOCK_NUM, SDF_HASH_MASK = SDF_BUCKET_NUM - 1
-//#define SDF_HASH_MASK 0x3ffff			// Used for get hashing value of the bucket index,  SDF_HASH_MASK = SDF_BUCKET_NUM - 1
-//#define SDF_EXCESS_LIST_SIZE 0x8000		// 0x8000 Size of excess list, used to handle collisions. Also max offset (unsigned short) value.
-
 #define SDF_TRANSFER_BLOCK_NUM 0x1000	// Maximum number of blocks transfered in one swap operation
 
 /** \brief
@@ -47,6 +38,56 @@ struct ITMHashEntry
 	int ptr;
 };
 
+/** \brief
+	Summary of the voxels in one block of the voxel block
+	array, so that whole blocks can be skipped without
+	looking at their voxels.
+*/
+struct ITMVoxelBlockSummary
+{
+	/** Bounds on the SDF values of the voxels in the block. */
+	float minSDF, maxSDF;
+	/** Whether every voxel in the block has reached maxW. */
+	bool saturated;
+
+	/** Summary of a block in which all voxels still have
+		their initial value.
+	*/
+	_CPU_AND_GPU_CODE_ static ITMVoxelBlockSummary initialSummary(void)
+	{
+		ITMVoxelBlockSummary summary;
+		summary.minSDF = 1.0f; summary.maxSDF = 1.0f; summary.saturated = false;
+		return summary;
+	}
+
+	/** Summary that is valid for any block, e.g. for one that
+		has been changed without updating its summary.
+	*/
+	_CPU_AND_GPU_CODE_ static ITMVoxelBlockSummary unknownSummary(void)
+	{
+		ITMVoxelBlockSummary summary;
+		summary.minSDF = -1.0f; summary.maxSDF = 1.0f; summary.saturated = false;
+		return summary;
+	}
+};
+
+template<class TVoxel>
+_CPU_AND_GPU_CODE_ inline ITMVoxelBlockSummary computeVoxelBlockSummary(const CONSTPTR(TVoxel) *voxelBlock, int maxW)
+{
+	ITMVoxelBlockSummary summary;
+	summary.minSDF = 1.0f; summary.maxSDF = -1.0f; summary.saturated = true;
+
+	for (int locId = 0; locId < SDF_BLOCK_SIZE3; locId++)
+	{
+		float sdf = TVoxel::valueToFloat(voxelBlock[locId].sdf);
+		summary.minSDF = MIN(summary.minSDF, sdf);
+		summary.maxSDF = MAX(summary.maxSDF, sdf);
+		summary.saturated &= voxelBlock[locId].w_depth == maxW;
+	}
+
+	return summary;
+}
+
 namespace ITMLib
 {
 	/** \brief
@@ -65,15 +106,23 @@ namespace ITMLib
 			_CPU_AND_GPU_CODE_ IndexCache(void) : blockPos(0x7fffffff), blockPtr(-1) {}
 		};
 
-		/** Maximum number of total entries. */
-		static const CONSTPTR(int) noTotalEntries = SDF_BUCKET_NUM + SDF_EXCESS_LIST_SIZE;
 		static const CONSTPTR(int) voxelBlockSize = SDF_BLOCK_SIZE * SDF_BLOCK_SIZE * SDF_BLOCK_SIZE;
 
 #ifndef __METALC__
 	private:
 		int lastFreeExcessListId;
 
-		/** The actual data in the hash table. */
+		/** Number of buckets in the ordered part of the hash table. */
+		int noHashBuckets;
+
+		/** Number of voxel blocks in the local voxel block array. */
+		int noVoxelBlocks;
+
+		/** The actual data in the hash table. The first entry
+		is a header that stores the bucket mask (see
+		hashIndex()), the ordered buckets and the excess list
+		follow it.
+		*/
 		ORUtils::MemoryBlock<ITMHashEntry> *hashEntries;
 
 		/** Identifies which entries of the overflow
@@ -83,28 +132,110 @@ namespace ITMLib
 		*/
 		ORUtils::MemoryBlock<int> *excessAllocationList;
 
+		/** Ids of all hash entries that are in use, i.e. that
+		have a voxel block in memory or swapped out, in the
+		order they were allocated. Lets sweeps over the scene
+		skip the unused bulk of the hash table.
+		*/
+		ORUtils::MemoryBlock<int> *allocatedEntryIDs;
+		int noAllocatedEntries;
+
 		MemoryDeviceType memoryType;
 
+		void WriteHeader(void)
+		{
+			ITMHashEntry header = ITMHashEntry();
+			header.offset = noHashBuckets - 1;
+			header.ptr = -2;
+
+			if (memoryType == MEMORYDEVICE_CUDA)
+			{
+#ifndef COMPILE_WITHOUT_CUDA
+				ORcudaSafeCall(cudaMemcpy(hashEntries->GetData(MEMORYDEVICE_CUDA), &header, sizeof(ITMHashEntry), cudaMemcpyHostToDevice));
+#endif
+			}
+			else hashEntries->GetData(MEMORYDEVICE_CPU)[0] = header;
+		}
+
+		/** Tag and version at the start of last.txt, see SaveToDirectory(). */
+		static const char *FileFormatTag(void) { return "ITMVoxelBlockHash"; }
+		static const int fileFormatVersion = 2;
+
+		/** @{ */
+		/** Sizes of the hash table that were fixed at compile time
+		when scenes were saved in file format version 1.
+		*/
+		static const int version1NoHashBuckets = 0x100000;
+		static const int version1NoExcessListEntries = 0x20000;
+		static const int version1NoVoxelBlocks = 0x40000;
+		/** @} */
+
+		/** Load a scene saved before the hash table was sized at
+		runtime. Its last.txt only holds the last free excess
+		list id and its hash.dat lacks the header entry.
+		*/
+		void LoadVersion1(const std::string &hashEntriesFileName, const std::string &excessAllocationListFileName, int lastFreeExcessListId)
+		{
+			if (noHashBuckets != version1NoHashBuckets)
+				throw std::runtime_error("Scenes saved with a fixed size hash table can only be loaded with 0x100000 hash buckets");
+
+			noTotalEntries = version1NoHashBuckets + version1NoExcessListEntries;
+			if ((int)ORUtils::MemoryBlockPersister::ReadBlockSize(hashEntriesFileName) != noTotalEntries)
+				throw std::runtime_error(hashEntriesFileName + " does not have the size of a fixed size hash table");
+
+			this->lastFreeExcessListId = lastFreeExcessListId;
+			this->noVoxelBlocks = version1NoVoxelBlocks;
+
+			ORUtils::MemoryBlock<ITMHashEntry> *savedEntries = ORUtils::MemoryBlockPersister::LoadMemoryBlock<ITMHashEntry>(hashEntriesFileName);
+			ORUtils::MemoryBlock<ITMHashEntry> hashEntries_host(noTotalEntries + 1, MEMORYDEVICE_CPU);
+			memcpy(hashEntries_host.GetData(MEMORYDEVICE_CPU) + 1, savedEntries->GetData(MEMORYDEVICE_CPU), noTotalEntries * sizeof(ITMHashEntry));
+			delete savedEntries;
+
+			hashEntries->SetFrom(&hashEntries_host, memoryType == MEMORYDEVICE_CUDA ? ORUtils::MemoryBlock<ITMHashEntry>::CPU_TO_CUDA : ORUtils::MemoryBlock<ITMHashEntry>::CPU_TO_CPU);
+			WriteHeader();
+
+			excessAllocationList->Resize(version1NoExcessListEntries);
+			allocatedEntryIDs->Resize(noTotalEntries);
+			ORUtils::MemoryBlockPersister::LoadMemoryBlock(excessAllocationListFileName.c_str(), *excessAllocationList, memoryType);
+
+			RebuildAllocatedEntryList();
+		}
+
 	public:
-		ITMVoxelBlockHash(MemoryDeviceType memoryType)
+		/** Number of total entries, i.e. buckets plus excess list. */
+		int noTotalEntries;
+
+		ITMVoxelBlockHash(const ITMSceneParams *sceneParams, MemoryDeviceType memoryType)
 		{
+			if (sceneParams->noHashBuckets <= 0 || (sceneParams->noHashBuckets & (sceneParams->noHashBuckets - 1)) != 0)
+				throw std::runtime_error("The number of hash buckets must be a power of two");
+
 			this->memoryType = memoryType;
-			hashEntries = new ORUtils::MemoryBlock<ITMHashEntry>(noTotalEntries, memoryType);
-			excessAllocationList = new ORUtils::MemoryBlock<int>(SDF_EXCESS_LIST_SIZE, memoryType);
+			this->noHashBuckets = sceneParams->noHashBuckets;
+			this->noVoxelBlocks = sceneParams->noVoxelBlocks;
+			this->noTotalEntries = sceneParams->noHashBuckets + sceneParams->noExcessListEntries;
+
+			hashEntries = new ORUtils::MemoryBlock<ITMHashEntry>(noTotalEntries + 1, memoryType);
+			excessAllocationList = new ORUtils::MemoryBlock<int>(sceneParams->noExcessListEntries, memoryType);
+			allocatedEntryIDs = new ORUtils::MemoryBlock<int>(noTotalEntries, memoryType);
+			noAllocatedEntries = 0;
+
+			WriteHeader();
 		}
 
 		~ITMVoxelBlockHash(void)
 		{
 			delete hashEntries;
 			delete excessAllocationList;
+			delete allocatedEntryIDs;
 		}
 
 		/** Get the list of actual entries in the hash table. */
-		const ITMHashEntry *GetEntries(void) const { return hashEntries->GetData(memoryType); }
-		ITMHashEntry *GetEntries(void) { return hashEntries->GetData(memoryType); }
+		const ITMHashEntry *GetEntries(void) const { return hashEntries->GetData(memoryType) + 1; }
+		ITMHashEntry *GetEntries(void) { return hashEntries->GetData(memoryType) + 1; }
 
-		const IndexData *getIndexData(void) const { return hashEntries->GetData(memoryType); }
-		IndexData *getIndexData(void) { return hashEntries->GetData(memoryType); }
+		const IndexData *getIndexData(void) const { return hashEntries->GetData(memoryType) + 1; }
+		IndexData *getIndexData(void) { return hashEntries->GetData(memoryType) + 1; }
 
 		/** Get the list that identifies which entries of the
 		overflow list are allocated. This is used if too
@@ -116,15 +247,70 @@ namespace ITMLib
 		int GetLastFreeExcessListId(void) { return lastFreeExcessListId; }
 		void SetLastFreeExcessListId(int lastFreeExcessListId) { this->lastFreeExcessListId = lastFreeExcessListId; }
 
+		/** Get the ids of the hash entries that are in use, see
+		GetNumAllocatedEntries(). Entries are appended by the
+		allocation in the scene reconstruction engine. Entries
+		that get swapped out stay in use, while those deleted by
+		CleanLocalMemory() of the CUDA swapping engine are taken
+		out by compacting the list, so its order is not stable.
+		*/
+		const int *GetAllocatedEntryIDs(void) const { return allocatedEntryIDs->GetData(memoryType); }
+		int *GetAllocatedEntryIDs(void) { return allocatedEntryIDs->GetData(memoryType); }
+
+		int GetNumAllocatedEntries(void) const { return noAllocatedEntries; }
+		void SetNumAllocatedEntries(int noAllocatedEntries) { this->noAllocatedEntries = noAllocatedEntries; }
+
 #ifdef COMPILE_WITH_METAL
 		const void* GetEntries_MB(void) { return hashEntries->GetMetalBuffer(); }
 		const void* GetExcessAllocationList_MB(void) { return excessAllocationList->GetMetalBuffer(); }
 		const void* getIndexData_MB(void) const { return hashEntries->GetMetalBuffer(); }
 #endif
 
+		/** Number of buckets in the ordered part of the hash table. */
+		int getNumHashBuckets(void) const { return noHashBuckets; }
+		/** Number of entries in the excess list. */
+		int getExcessListSize(void) const { return noTotalEntries - noHashBuckets; }
+
 		/** Maximum number of total entries. */
-		int getNumAllocatedVoxelBlocks(void) { return SDF_LOCAL_BLOCK_NUM; }
-		int getVoxelBlockSize(void) { return SDF_BLOCK_SIZE3; }
+		int getNumAllocatedVoxelBlocks(void) const { return noVoxelBlocks; }
+		int getVoxelBlockSize(void) const { return SDF_BLOCK_SIZE3; }
+
+		/** Record that the local voxel block array has been grown to @p noVoxelBlocks blocks. */
+		void SetNumAllocatedVoxelBlocks(int noVoxelBlocks) { this->noVoxelBlocks = noVoxelBlocks; }
+
+		/** Grow the excess list to @p noExcessListEntries entries.
+		All existing entries keep their index, so that anything
+		keyed by entry id stays valid. The new hash entries and
+		excess allocation list slots are zeroed and have to be
+		initialised by the caller.
+		*/
+		void GrowExcessList(int noExcessListEntries)
+		{
+			if (noExcessListEntries <= getExcessListSize()) return;
+
+			noTotalEntries = noHashBuckets + noExcessListEntries;
+			hashEntries->Grow(noTotalEntries + 1);
+			excessAllocationList->Grow(noExcessListEntries);
+			allocatedEntryIDs->Grow(noTotalEntries);
+		}
+
+		/** Rebuild the list of entries in use from the hash table. */
+		void RebuildAllocatedEntryList(void)
+		{
+			ORUtils::MemoryBlock<ITMHashEntry> hashEntries_host(noTotalEntries + 1, MEMORYDEVICE_CPU);
+			ORUtils::MemoryBlock<int> allocatedEntryIDs_host(noTotalEntries, MEMORYDEVICE_CPU);
+
+			hashEntries_host.SetFrom(hashEntries, memoryType == MEMORYDEVICE_CUDA ? ORUtils::MemoryBlock<ITMHashEntry>::CUDA_TO_CPU : ORUtils::MemoryBlock<ITMHashEntry>::CPU_TO_CPU);
+
+			const ITMHashEntry *entries = hashEntries_host.GetData(MEMORYDEVICE_CPU) + 1;
+			int *entryIDs = allocatedEntryIDs_host.GetData(MEMORYDEVICE_CPU);
+
+			noAllocatedEntries = 0;
+			for (int entryId = 0; entryId < noTotalEntries; entryId++)
+				if (entries[entryId].ptr >= -1) entryIDs[noAllocatedEntries++] = entryId;
+
+			allocatedEntryIDs->SetFrom(&allocatedEntryIDs_host, memoryType == MEMORYDEVICE_CUDA ? ORUtils::MemoryBlock<int>::CPU_TO_CUDA : ORUtils::MemoryBlock<int>::CPU_TO_CPU);
+		}
 
 		void SaveToDirectory(const std::string &outputDirectory) const
 		{
@@ -135,7 +321,7 @@ namespace ITMLib
 			std::ofstream ofs(lastFreeExcessListIdFileName.c_str());
 			if (!ofs) throw std::runtime_error("Could not open " + lastFreeExcessListIdFileName + " for writing");
 
-			ofs << lastFreeExcessListId;
+			ofs << FileFormatTag() << ' ' << fileFormatVersion << '\n' << lastFreeExcessListId << ' ' << noHashBuckets << ' ' << noVoxelBlocks;
 			ORUtils::MemoryBlockPersister::SaveMemoryBlock(hashEntriesFileName, *hashEntries, memoryType);
 			ORUtils::MemoryBlockPersister::SaveMemoryBlock(excessAllocationListFileName, *excessAllocationList, memoryType);
 		}
@@ -149,9 +335,38 @@ namespace ITMLib
 			std::ifstream ifs(lastFreeExcessListIdFileName.c_str());
 			if (!ifs) throw std::runtime_error("Count not open " + lastFreeExcessListIdFileName + " for reading");
 
-			ifs >> this->lastFreeExcessListId;
+			std::string tag;
+			ifs >> tag;
+			if (tag != FileFormatTag())
+			{
+				// version 1 files only hold the last free excess list id
+				char *tagEnd;
+				long lastFreeExcessListId = strtol(tag.c_str(), &tagEnd, 10);
+				if (tag.empty() || *tagEnd != '\0') throw std::runtime_error(lastFreeExcessListIdFileName + " does not describe a saved voxel block hash");
+
+				LoadVersion1(hashEntriesFileName, excessAllocationListFileName, (int)lastFreeExcessListId);
+				return;
+			}
+
+			int version = 0;
+			ifs >> version;
+			if (version != fileFormatVersion) throw std::runtime_error("Saved voxel block hash has an unsupported file format version");
+
+			int savedNoHashBuckets;
+			ifs >> this->lastFreeExcessListId >> savedNoHashBuckets >> this->noVoxelBlocks;
+			if (!ifs) throw std::runtime_error("Could not read " + lastFreeExcessListIdFileName);
+			if (savedNoHashBuckets != noHashBuckets) throw std::runtime_error("Saved scene uses a different number of hash buckets");
+
+			// the excess list may have grown before the scene was saved
+			noTotalEntries = (int)ORUtils::MemoryBlockPersister::ReadBlockSize(hashEntriesFileName) - 1;
+			hashEntries->Resize(noTotalEntries + 1);
+			excessAllocationList->Resize(noTotalEntries - noHashBuckets);
+			allocatedEntryIDs->Resize(noTotalEntries);
+
 			ORUtils::MemoryBlockPersister::LoadMemoryBlock(hashEntriesFileName.c_str(), *hashEntries, memoryType);
 			ORUtils::MemoryBlockPersister::LoadMemoryBlock(excessAllocationListFileName.c_str(), *excessAllocationList, memoryType);
+
+			RebuildAllocatedEntryList();
 		}
 
 		// Suppress the default copy constructor and assignment operator
@@ -0,0 +1,10 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#ifdef WITH_SIMD
+
+#include "../../Utils/ITMSIMDOps_AVX512.h"
+#include "ITMExtendedTrackerRows_SIMD.h"
+
+namespace ITMLib { namespace AVX512 { ITM_DEFINE_EXTENDED_TRACKER_ROWS } }
+
+#endif
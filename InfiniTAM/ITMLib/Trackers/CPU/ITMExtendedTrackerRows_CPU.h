@@ -0,0 +1,119 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <stdlib.h>
+
+#include "../../Utils/ITMCPUFeatures.h"
+
+namespace ITMLib
+{
+	/** \brief
+	    Everything the vectorised evaluation of the depth term of
+	    ITMExtendedTracker needs for one row, as plain data so that
+	    the kernels do not call into code shared with the scalar
+	    build. Images of vectors are given as their floats.
+	*/
+	struct ITMExtendedTrackerDepthRowParams
+	{
+		/** Depth image of the current frame and the fx, fy, cx, cy of its camera. */
+		const float *depth;
+		int viewWidth;
+		float viewIntrinsics[4];
+
+		/** Points and normals rendered from the scene, four floats per pixel. */
+		const float *pointsMap, *normalsMap;
+		int sceneWidth, sceneHeight;
+		float sceneIntrinsics[4];
+
+		/** Column major, as in Matrix4f::m. */
+		float approxInvPose[16], scenePose[16];
+
+		float spaceThresh, viewFrustum_min, viewFrustum_max, tukeyCutOff;
+		int framesToSkip, framesToWeight;
+
+		/** The template arguments of computePerPointGH_exDepth(). */
+		bool shortIteration, rotationOnly, useWeights;
+	};
+
+	/** \brief
+	    The same for the colour term, see
+	    computePerPointGH_exRGB_inv_Ab().
+	*/
+	struct ITMExtendedTrackerRGBRowParams
+	{
+		/** Points of the current frame, four floats per depth pixel, and their intensities. */
+		const float *points_curr, *intensities_curr;
+		int depthWidth;
+
+		/** Intensities of the previous frame and their gradients, two floats per pixel. */
+		const float *intensities_prev, *gradients;
+		int rgbWidth, rgbHeight;
+		float intrinsics_rgb[4];
+
+		/** Column major, as in Matrix4f::m. */
+		float approxInvPose[16], scenePose[16];
+
+		float colourThresh, minGradient, viewFrustum_min, viewFrustum_max, tukeyCutOff;
+
+		bool shortIteration, rotationOnly;
+	};
+
+	/** Evaluate the depth or colour term for all pixels of row @p y,
+	    several pixels at a time, with the arithmetic of
+	    computePerPointGH_exDepth() and
+	    computePerPointGH_exRGB_inv_Ab(). The error, gradient and
+	    lower triangle of the Hessian of the valid points are added
+	    to @p f, @p nabla and @p hessian, in an order that only
+	    depends on the instruction set. Returns the number of valid
+	    points.
+	*/
+#define ITM_DECLARE_EXTENDED_TRACKER_ROWS \
+	int ComputeDepthRowGH(const ITMExtendedTrackerDepthRowParams &params, int y, float &f, float *nabla, float *hessian); \
+	int ComputeRGBRowGH(const ITMExtendedTrackerRGBRowParams &params, int y, float &f, float *nabla, float *hessian);
+
+#ifdef WITH_SIMD
+	namespace SSE4 { ITM_DECLARE_EXTENDED_TRACKER_ROWS }
+	namespace AVX2 { ITM_DECLARE_EXTENDED_TRACKER_ROWS }
+	namespace AVX512 { ITM_DECLARE_EXTENDED_TRACKER_ROWS }
+#endif
+
+#undef ITM_DECLARE_EXTENDED_TRACKER_ROWS
+
+	typedef int (*ITMDepthRowGHFunction)(const ITMExtendedTrackerDepthRowParams &params, int y, float &f, float *nabla, float *hessian);
+	typedef int (*ITMRGBRowGHFunction)(const ITMExtendedTrackerRGBRowParams &params, int y, float &f, float *nabla, float *hessian);
+
+	/** Picks the vectorised evaluation of the depth term for the
+	    instruction set of the CPU, or returns NULL if there is none.
+	*/
+	inline ITMDepthRowGHFunction SelectDepthRowGH(void)
+	{
+#ifdef WITH_SIMD
+		switch (GetCPUInstructionSet())
+		{
+		case CPU_INSTRUCTIONSET_AVX512: return &AVX512::ComputeDepthRowGH;
+		case CPU_INSTRUCTIONSET_AVX2: return &AVX2::ComputeDepthRowGH;
+		case CPU_INSTRUCTIONSET_SSE4: return &SSE4::ComputeDepthRowGH;
+		default: return NULL;
+		}
+#else
+		return NULL;
+#endif
+	}
+
+	/** The same for the colour term. */
+	inline ITMRGBRowGHFunction SelectRGBRowGH(void)
+	{
+#ifdef WITH_SIMD
+		switch (GetCPUInstructionSet())
+		{
+		case CPU_INSTRUCTIONSET_AVX512: return &AVX512::ComputeRGBRowGH;
+		case CPU_INSTRUCTIONSET_AVX2: return &AVX2::ComputeRGBRowGH;
+		case CPU_INSTRUCTIONSET_SSE4: return &SSE4::ComputeRGBRowGH;
+		default: return NULL;
+		}
+#else
+		return NULL;
+#endif
+	}
+}
@@ -0,0 +1,404 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+// Only to be included by the ITMExtendedTrackerRows_<ISA>.cpp files, after
+// they have included the SIMDOps for their instruction set. As for the voxel
+// block integration, nothing in here may call inline functions that are shared
+// with the rest of the library, so the per point terms of
+// ITMExtendedTracker_Shared.h are repeated here lane by lane, with their
+// operations in the same order.
+
+#include "ITMExtendedTrackerRows_CPU.h"
+
+namespace
+{
+	typedef SIMDOps::vf vf; typedef SIMDOps::vi vi; typedef SIMDOps::mask mask;
+
+	inline vf abs_(vf a) { return SIMDOps::max(a, SIMDOps::sub(SIMDOps::set1(0.0f), a)); }
+
+	inline vf dot3(vf ax, vf ay, vf az, vf bx, vf by, vf bz)
+	{
+		return SIMDOps::add(SIMDOps::add(SIMDOps::mul(ax, bx), SIMDOps::mul(ay, by)), SIMDOps::mul(az, bz));
+	}
+
+	/** A column major 4x4 matrix in all lanes. */
+	struct Pose
+	{
+		vf m[16];
+
+		explicit Pose(const float *m_) { for (int i = 0; i < 16; i++) m[i] = SIMDOps::set1(m_[i]); }
+
+		// as Matrix4f * Vector4f with w = 1
+		void transform(vf x, vf y, vf z, vf &outX, vf &outY, vf &outZ) const
+		{
+			outX = SIMDOps::add(SIMDOps::add(SIMDOps::add(SIMDOps::mul(m[0], x), SIMDOps::mul(m[4], y)), SIMDOps::mul(m[8], z)), m[12]);
+			outY = SIMDOps::add(SIMDOps::add(SIMDOps::add(SIMDOps::mul(m[1], x), SIMDOps::mul(m[5], y)), SIMDOps::mul(m[9], z)), m[13]);
+			outZ = SIMDOps::add(SIMDOps::add(SIMDOps::add(SIMDOps::mul(m[2], x), SIMDOps::mul(m[6], y)), SIMDOps::mul(m[10], z)), m[14]);
+		}
+	};
+
+	/** The four pixels around a position in an image, as indices of
+	    their first float, and the position within them.
+	*/
+	struct Corners
+	{
+		vi a, b, c, d;
+		vf dx, dy;
+
+		Corners(vf u, vf v, int width, int noComponents)
+		{
+			vf pu = SIMDOps::floor(u), pv = SIMDOps::floor(v);
+			dx = SIMDOps::sub(u, pu); dy = SIMDOps::sub(v, pv);
+
+			vi step = SIMDOps::set1i(noComponents), rowStep = SIMDOps::set1i(width * noComponents);
+			a = SIMDOps::muli(SIMDOps::addi(SIMDOps::cvtt(pu), SIMDOps::muli(SIMDOps::cvtt(pv), SIMDOps::set1i(width))), step);
+			b = SIMDOps::addi(a, step);
+			c = SIMDOps::addi(a, rowStep);
+			d = SIMDOps::addi(c, step);
+		}
+
+		// as interpolateBilinear_*() in ITMPixelUtils.h
+		vf interpolate(vf va, vf vb, vf vc, vf vd) const
+		{
+			vf one = SIMDOps::set1(1.0f);
+			vf ox = SIMDOps::sub(one, dx), oy = SIMDOps::sub(one, dy);
+			return SIMDOps::add(SIMDOps::add(SIMDOps::add(SIMDOps::mul(SIMDOps::mul(va, ox), oy), SIMDOps::mul(SIMDOps::mul(vb, dx), oy)),
+				SIMDOps::mul(SIMDOps::mul(vc, ox), dy)), SIMDOps::mul(SIMDOps::mul(vd, dx), dy));
+		}
+
+		vf interpolate(const float *image, mask valid) const
+		{
+			vf zero = SIMDOps::set1(0.0f);
+			return interpolate(SIMDOps::gather(image, a, valid, zero), SIMDOps::gather(image, b, valid, zero),
+				SIMDOps::gather(image, c, valid, zero), SIMDOps::gather(image, d, valid, zero));
+		}
+	};
+
+	/** Error, gradient and Hessian of the valid points, summed per lane. */
+	struct RowSums
+	{
+		vf f, g[6], h[6 + 5 + 4 + 3 + 2 + 1];
+		int noValidPoints;
+
+		RowSums(void)
+		{
+			f = SIMDOps::set1(0.0f);
+			for (int i = 0; i < 6; i++) g[i] = f;
+			for (int i = 0; i < 6 + 5 + 4 + 3 + 2 + 1; i++) h[i] = f;
+			noValidPoints = 0;
+		}
+
+		/** Adds the terms of the valid lanes, with the Hessian as
+		    hessianLeft[r] * hessianRight[c], as in the scalar code.
+		*/
+		void add(mask valid, vf localF, const vf *localGradient, const vf *hessianLeft, const vf *hessianRight, int noPara)
+		{
+			vf zero = SIMDOps::set1(0.0f);
+
+			int validBits = SIMDOps::bits(valid);
+			for (int i = 0; i < SIMDOps::W; i++) if (validBits & (1 << i)) noValidPoints++;
+
+			f = SIMDOps::add(f, SIMDOps::select(valid, localF, zero));
+			for (int r = 0, counter = 0; r < noPara; r++)
+			{
+				g[r] = SIMDOps::add(g[r], SIMDOps::select(valid, localGradient[r], zero));
+				for (int c = 0; c <= r; c++, counter++)
+					h[counter] = SIMDOps::add(h[counter], SIMDOps::select(valid, SIMDOps::mul(hessianLeft[r], hessianRight[c]), zero));
+			}
+		}
+
+		static float sumLanes(vf a)
+		{
+			float lanes[SIMDOps::W], sum = 0.0f;
+			SIMDOps::storef(lanes, a);
+			for (int i = 0; i < SIMDOps::W; i++) sum += lanes[i];
+			return sum;
+		}
+
+		int addTo(float &f_out, float *nabla, float *hessian, int noPara) const
+		{
+			f_out += sumLanes(f);
+			for (int r = 0, counter = 0; r < noPara; r++)
+			{
+				nabla[r] += sumLanes(g[r]);
+				for (int c = 0; c <= r; c++, counter++) hessian[counter] += sumLanes(h[counter]);
+			}
+			return noValidPoints;
+		}
+	};
+
+	/** The x coordinates of the pixels [x0, x0 + W) and which of them are in a row of the given width. */
+	inline vi pixelColumns(int x0, int width, mask &inRow)
+	{
+		int xs[SIMDOps::W];
+		for (int i = 0; i < SIMDOps::W; i++) xs[i] = x0 + i;
+		vi x = SIMDOps::loadi(xs);
+		inRow = SIMDOps::gt(SIMDOps::set1((float)width), SIMDOps::cvt(x));
+		return x;
+	}
+
+	int computeDepthRowGH(const ITMLib::ITMExtendedTrackerDepthRowParams &params, int y, float &f, float *nabla, float *hessian)
+	{
+		const int W = SIMDOps::W;
+		const int noPara = params.shortIteration ? 3 : 6;
+
+		const vf zero = SIMDOps::set1(0.0f), one = SIMDOps::set1(1.0f), two = SIMDOps::set1(2.0f);
+
+		const Pose approxInvPose(params.approxInvPose), scenePose(params.scenePose);
+
+		const vf viewFx = SIMDOps::set1(params.viewIntrinsics[0]), viewFy = SIMDOps::set1(params.viewIntrinsics[1]);
+		const vf viewCx = SIMDOps::set1(params.viewIntrinsics[2]), viewCy = SIMDOps::set1(params.viewIntrinsics[3]);
+		const vf sceneFx = SIMDOps::set1(params.sceneIntrinsics[0]), sceneFy = SIMDOps::set1(params.sceneIntrinsics[1]);
+		const vf sceneCx = SIMDOps::set1(params.sceneIntrinsics[2]), sceneCy = SIMDOps::set1(params.sceneIntrinsics[3]);
+		const vf sceneMaxX = SIMDOps::set1((float)(params.sceneWidth - 2)), sceneMaxY = SIMDOps::set1((float)(params.sceneHeight - 2));
+
+		const vf minDepth = SIMDOps::set1(1e-8f), maxDist = SIMDOps::set1(params.tukeyCutOff * params.spaceThresh);
+		const vf huber = SIMDOps::set1(params.spaceThresh), minusHuber = SIMDOps::set1(-params.spaceThresh);
+		const vf frustumMin = SIMDOps::set1(params.viewFrustum_min), frustumRange = SIMDOps::set1(params.viewFrustum_max - params.viewFrustum_min);
+		const vf framesToSkip = SIMDOps::set1((float)params.framesToSkip), framesToWeight = SIMDOps::set1((float)params.framesToWeight);
+
+		const float *depthRow = params.depth + y * params.viewWidth;
+		const vf pixelY = SIMDOps::set1((float)y);
+
+		RowSums sums;
+
+		for (int x0 = 0; x0 < params.viewWidth; x0 += W)
+		{
+			mask inRow;
+			vi pixelX = pixelColumns(x0, params.viewWidth, inRow);
+
+			vf depth = x0 + W <= params.viewWidth ? SIMDOps::loadf(depthRow + x0) : SIMDOps::gather(depthRow, pixelX, inRow, zero);
+			mask valid = SIMDOps::and_(inRow, SIMDOps::gt(depth, minDepth));
+			if (SIMDOps::bits(valid) == 0) continue;
+
+			vf tmpX = SIMDOps::mul(depth, SIMDOps::div(SIMDOps::sub(SIMDOps::cvt(pixelX), viewCx), viewFx));
+			vf tmpY = SIMDOps::mul(depth, SIMDOps::div(SIMDOps::sub(pixelY, viewCy), viewFy));
+
+			// transform to previous frame coordinates
+			vf ptX, ptY, ptZ;
+			approxInvPose.transform(tmpX, tmpY, depth, ptX, ptY, ptZ);
+
+			// project into previous rendered image
+			vf reprojX, reprojY, reprojZ;
+			scenePose.transform(ptX, ptY, ptZ, reprojX, reprojY, reprojZ);
+			valid = SIMDOps::and_(valid, SIMDOps::gt(reprojZ, zero));
+
+			vf u = SIMDOps::add(SIMDOps::div(SIMDOps::mul(sceneFx, reprojX), reprojZ), sceneCx);
+			vf v = SIMDOps::add(SIMDOps::div(SIMDOps::mul(sceneFy, reprojY), reprojZ), sceneCy);
+			valid = SIMDOps::and_(valid, SIMDOps::and_(SIMDOps::ge(u, zero), SIMDOps::le(u, sceneMaxX)));
+			valid = SIMDOps::and_(valid, SIMDOps::and_(SIMDOps::ge(v, zero), SIMDOps::le(v, sceneMaxY)));
+			if (SIMDOps::bits(valid) == 0) continue;
+
+			// interpolateBilinear_withHoles() of the points, which fails if any of the four has w < 0
+			Corners corners(u, v, params.sceneWidth, 4);
+			vf aw = SIMDOps::gather(params.pointsMap + 3, corners.a, valid, zero), bw = SIMDOps::gather(params.pointsMap + 3, corners.b, valid, zero);
+			vf cw = SIMDOps::gather(params.pointsMap + 3, corners.c, valid, zero), dw = SIMDOps::gather(params.pointsMap + 3, corners.d, valid, zero);
+			valid = SIMDOps::and_(valid, SIMDOps::and_(SIMDOps::ge(aw, zero), SIMDOps::ge(bw, zero)));
+			valid = SIMDOps::and_(valid, SIMDOps::and_(SIMDOps::ge(cw, zero), SIMDOps::ge(dw, zero)));
+			if (SIMDOps::bits(valid) == 0) continue;
+
+			vf currW = corners.interpolate(aw, bw, cw, dw);
+			vf diffX = SIMDOps::sub(corners.interpolate(params.pointsMap, valid), ptX);
+			vf diffY = SIMDOps::sub(corners.interpolate(params.pointsMap + 1, valid), ptY);
+			vf diffZ = SIMDOps::sub(corners.interpolate(params.pointsMap + 2, valid), ptZ);
+			vf dist = dot3(diffX, diffY, diffZ, diffX, diffY, diffZ);
+			valid = SIMDOps::and_(valid, SIMDOps::le(dist, maxDist));
+			if (SIMDOps::bits(valid) == 0) continue;
+
+			// interpolateBilinear_withHoles() of the normals, which are zero next to a hole
+			mask normalValid = SIMDOps::and_(valid, SIMDOps::and_(
+				SIMDOps::and_(SIMDOps::ge(SIMDOps::gather(params.normalsMap + 3, corners.a, valid, zero), zero), SIMDOps::ge(SIMDOps::gather(params.normalsMap + 3, corners.b, valid, zero), zero)),
+				SIMDOps::and_(SIMDOps::ge(SIMDOps::gather(params.normalsMap + 3, corners.c, valid, zero), zero), SIMDOps::ge(SIMDOps::gather(params.normalsMap + 3, corners.d, valid, zero), zero))));
+			vf normalX = SIMDOps::select(normalValid, corners.interpolate(params.normalsMap, normalValid), zero);
+			vf normalY = SIMDOps::select(normalValid, corners.interpolate(params.normalsMap + 1, normalValid), zero);
+			vf normalZ = SIMDOps::select(normalValid, corners.interpolate(params.normalsMap + 2, normalValid), zero);
+
+			vf depthWeight = SIMDOps::max(zero, SIMDOps::sub(one, SIMDOps::div(SIMDOps::sub(depth, frustumMin), frustumRange)));
+			depthWeight = SIMDOps::mul(depthWeight, depthWeight);
+
+			if (params.useWeights)
+			{
+				valid = SIMDOps::and_(valid, SIMDOps::ge(currW, framesToSkip));
+				depthWeight = SIMDOps::mul(depthWeight, SIMDOps::div(SIMDOps::sub(currW, framesToSkip), framesToWeight));
+			}
+
+			vf b = dot3(normalX, normalY, normalZ, diffX, diffY, diffZ);
+
+			vf A[6];
+			if (!params.shortIteration || params.rotationOnly)
+			{
+				A[0] = SIMDOps::sub(SIMDOps::mul(ptZ, normalY), SIMDOps::mul(ptY, normalZ));
+				A[1] = SIMDOps::sub(SIMDOps::mul(ptX, normalZ), SIMDOps::mul(ptZ, normalX));
+				A[2] = SIMDOps::sub(SIMDOps::mul(ptY, normalX), SIMDOps::mul(ptX, normalY));
+			}
+			if (!params.shortIteration || !params.rotationOnly)
+			{
+				int first = params.shortIteration ? 0 : 3;
+				A[first] = normalX; A[first + 1] = normalY; A[first + 2] = normalZ;
+			}
+
+			// rho(), rho_deriv() and rho_deriv2()
+			vf absB = abs_(b);
+			vf overHuber = SIMDOps::max(SIMDOps::sub(absB, huber), zero);
+			vf localF = SIMDOps::mul(SIMDOps::sub(SIMDOps::mul(b, b), SIMDOps::mul(overHuber, overHuber)), depthWeight);
+			vf nablaCoeff = SIMDOps::mul(SIMDOps::mul(two, SIMDOps::min(SIMDOps::max(b, minusHuber), huber)), depthWeight);
+			vf hessianCoeff = SIMDOps::mul(SIMDOps::select(SIMDOps::gt(huber, absB), two, zero), depthWeight);
+
+			vf localNabla[6], localHessianCoeff[6];
+			for (int r = 0; r < noPara; r++)
+			{
+				localNabla[r] = SIMDOps::mul(nablaCoeff, A[r]);
+				localHessianCoeff[r] = SIMDOps::mul(hessianCoeff, A[r]);
+			}
+
+			sums.add(valid, localF, localNabla, localHessianCoeff, A, noPara);
+		}
+
+		return sums.addTo(f, nabla, hessian, noPara);
+	}
+
+	int computeRGBRowGH(const ITMLib::ITMExtendedTrackerRGBRowParams &params, int y, float &f, float *nabla, float *hessian)
+	{
+		const int W = SIMDOps::W;
+		const int noPara = params.shortIteration ? 3 : 6;
+		const int firstPara = params.shortIteration && !params.rotationOnly ? 3 : 0;
+
+		const vf zero = SIMDOps::set1(0.0f), one = SIMDOps::set1(1.0f), minusOne = SIMDOps::set1(-1.0f);
+
+		const Pose approxInvPose(params.approxInvPose), scenePose(params.scenePose);
+
+		const vf fx = SIMDOps::set1(params.intrinsics_rgb[0]), fy = SIMDOps::set1(params.intrinsics_rgb[1]);
+		const vf cx = SIMDOps::set1(params.intrinsics_rgb[2]), cy = SIMDOps::set1(params.intrinsics_rgb[3]);
+		const vf minusFx = SIMDOps::set1(-params.intrinsics_rgb[0]), minusFy = SIMDOps::set1(-params.intrinsics_rgb[1]);
+		const vf rgbMaxX = SIMDOps::set1((float)(params.rgbWidth - 1)), rgbMaxY = SIMDOps::set1((float)(params.rgbHeight - 1));
+
+		const vf minZ = SIMDOps::set1(1e-3f), frustumMax = SIMDOps::set1(params.viewFrustum_max);
+		const vf frustumMin = SIMDOps::set1(params.viewFrustum_min), frustumRange = SIMDOps::set1(params.viewFrustum_max - params.viewFrustum_min);
+		const vf maxDiff = SIMDOps::set1(params.tukeyCutOff * params.colourThresh), minGradient = SIMDOps::set1(params.minGradient);
+
+		// tukey_rho(), tukey_rho_deriv() and tukey_rho_deriv2()
+		const float c = params.colourThresh;
+		const vf tukeyC = SIMDOps::set1(c), tukeyCSq6 = SIMDOps::set1(c * c / 6.f);
+
+		// rows of the rotation of scenePose, to be used in the pose derivative
+		const vf *m = scenePose.m;
+
+		RowSums sums;
+
+		for (int x0 = 0; x0 < params.depthWidth; x0 += W)
+		{
+			mask inRow;
+			vi pixelX = pixelColumns(x0, params.depthWidth, inRow);
+			vi pixelIdx = SIMDOps::addi(pixelX, SIMDOps::set1i(y * params.depthWidth));
+			vi pointIdx = SIMDOps::muli(pixelIdx, SIMDOps::set1i(4));
+
+			vf currX = SIMDOps::gather(params.points_curr, pointIdx, inRow, zero);
+			vf currY = SIMDOps::gather(params.points_curr + 1, pointIdx, inRow, zero);
+			vf currZ = SIMDOps::gather(params.points_curr + 2, pointIdx, inRow, zero);
+			vf currW = SIMDOps::gather(params.points_curr + 3, pointIdx, inRow, minusOne);
+			vf intensityCurr = SIMDOps::gather(params.intensities_curr, pixelIdx, inRow, minusOne);
+
+			// invalid point or too far away
+			mask valid = SIMDOps::and_(inRow, SIMDOps::and_(SIMDOps::ge(currW, zero), SIMDOps::ge(intensityCurr, zero)));
+			valid = SIMDOps::and_(valid, SIMDOps::and_(SIMDOps::ge(currZ, minZ), SIMDOps::le(currZ, frustumMax)));
+			if (SIMDOps::bits(valid) == 0) continue;
+
+			vf worldX, worldY, worldZ, prevX, prevY, prevZ;
+			approxInvPose.transform(currX, currY, currZ, worldX, worldY, worldZ);
+			scenePose.transform(worldX, worldY, worldZ, prevX, prevY, prevZ);
+			valid = SIMDOps::and_(valid, SIMDOps::gt(prevZ, zero));
+
+			vf u = SIMDOps::add(SIMDOps::div(SIMDOps::mul(fx, prevX), prevZ), cx);
+			vf v = SIMDOps::add(SIMDOps::div(SIMDOps::mul(fy, prevY), prevZ), cy);
+			valid = SIMDOps::and_(valid, SIMDOps::and_(SIMDOps::ge(u, zero), SIMDOps::gt(rgbMaxX, u)));
+			valid = SIMDOps::and_(valid, SIMDOps::and_(SIMDOps::ge(v, zero), SIMDOps::gt(rgbMaxY, v)));
+			if (SIMDOps::bits(valid) == 0) continue;
+
+			// the pixels beyond the position are read even where their weight is zero, unlike
+			// interpolateBilinear_single(), which gives the same result for finite images
+			vf intensityPrev = Corners(u, v, params.rgbWidth, 1).interpolate(params.intensities_prev, valid);
+			Corners gradientCorners(u, v, params.rgbWidth, 2);
+			vf gradientX = gradientCorners.interpolate(params.gradients, valid);
+			vf gradientY = gradientCorners.interpolate(params.gradients + 1, valid);
+
+			vf intensityDiff = SIMDOps::sub(intensityPrev, intensityCurr);
+			vf absDiff = abs_(intensityDiff);
+
+			valid = SIMDOps::and_(valid, SIMDOps::gt(maxDiff, absDiff));
+			valid = SIMDOps::and_(valid, SIMDOps::and_(SIMDOps::ge(abs_(gradientX), minGradient), SIMDOps::ge(abs_(gradientY), minGradient)));
+			if (SIMDOps::bits(valid) == 0) continue;
+
+			// projection derivatives
+			vf invZ = SIMDOps::div(one, prevZ);
+			vf invZSq = SIMDOps::mul(invZ, invZ);
+			vf projXx = SIMDOps::mul(fx, invZ), projXz = SIMDOps::mul(SIMDOps::mul(minusFx, prevX), invZSq);
+			vf projYy = SIMDOps::mul(fy, invZ), projYz = SIMDOps::mul(SIMDOps::mul(minusFy, prevY), invZSq);
+
+			vf localNabla[6];
+			for (int para = 0; para < noPara; para++)
+			{
+				// derivatives of approxInvPose wrt. the current parameter, with the translation negated
+				vf colX = zero, colY = zero, colZ = zero;
+				switch (para + firstPara)
+				{
+				case 0: colY = SIMDOps::sub(zero, worldZ); colZ = worldY; break;
+				case 1: colX = worldZ; colZ = SIMDOps::sub(zero, worldX); break;
+				case 2: colX = SIMDOps::sub(zero, worldY); colY = worldX; break;
+				case 3: colX = minusOne; break;
+				case 4: colY = minusOne; break;
+				case 5: colZ = minusOne; break;
+				}
+
+				// chain with scenePose, the projection and the intensity gradient
+				vf rotX = dot3(m[0], m[4], m[8], colX, colY, colZ);
+				vf rotY = dot3(m[1], m[5], m[9], colX, colY, colZ);
+				vf rotZ = dot3(m[2], m[6], m[10], colX, colY, colZ);
+
+				vf projX = dot3(projXx, zero, projXz, rotX, rotY, rotZ);
+				vf projY = dot3(zero, projYy, projYz, rotX, rotY, rotZ);
+
+				localNabla[para] = SIMDOps::add(SIMDOps::mul(gradientX, projX), SIMDOps::mul(gradientY, projY));
+			}
+
+			// weigh less the points far away from the camera
+			vf depthWeight = SIMDOps::max(SIMDOps::sub(one, SIMDOps::div(SIMDOps::sub(currZ, frustumMin), frustumRange)), zero);
+			depthWeight = SIMDOps::mul(depthWeight, depthWeight);
+
+			mask inTukey = SIMDOps::le(absDiff, tukeyC);
+			vf tukeyR = SIMDOps::div(intensityDiff, tukeyC);
+			tukeyR = SIMDOps::mul(tukeyR, tukeyR);
+			tukeyR = SIMDOps::sub(one, tukeyR);
+			vf tukeyRSq = SIMDOps::mul(tukeyR, tukeyR);
+
+			vf rho = SIMDOps::select(inTukey, SIMDOps::mul(tukeyCSq6, SIMDOps::sub(one, SIMDOps::mul(tukeyRSq, tukeyR))), tukeyCSq6);
+			vf rhoDeriv = SIMDOps::select(inTukey, SIMDOps::mul(intensityDiff, tukeyRSq), zero);
+			vf rhoDeriv2 = SIMDOps::select(SIMDOps::gt(tukeyC, absDiff), one, zero);
+
+			vf localF = SIMDOps::mul(depthWeight, rho);
+			vf gradientCoeff = SIMDOps::mul(depthWeight, rhoDeriv);
+			vf hessianCoeff = SIMDOps::mul(depthWeight, rhoDeriv2);
+
+			vf localGradient[6], localHessianCoeff[6];
+			for (int para = 0; para < noPara; para++)
+			{
+				localGradient[para] = SIMDOps::mul(gradientCoeff, localNabla[para]);
+				localHessianCoeff[para] = SIMDOps::mul(hessianCoeff, localNabla[para]);
+			}
+
+			sums.add(valid, localF, localGradient, localHessianCoeff, localNabla, noPara);
+		}
+
+		return sums.addTo(f, nabla, hessian, noPara);
+	}
+}
+
+#define ITM_DEFINE_EXTENDED_TRACKER_ROWS \
+	int ComputeDepthRowGH(const ITMExtendedTrackerDepthRowParams &params, int y, float &f, float *nabla, float *hessian) \
+	{ \
+		return computeDepthRowGH(params, y, f, nabla, hessian); \
+	} \
+	int ComputeRGBRowGH(const ITMExtendedTrackerRGBRowParams &params, int y, float &f, float *nabla, float *hessian) \
+	{ \
+		return computeRGBRowGH(params, y, f, nabla, hessian); \
+	}
@@ -1,10 +1,59 @@
 // Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
 
 #include "ITMExtendedTracker_CPU.h"
+#include "ITMExtendedTrackerRows_CPU.h"
 #include "../Shared/ITMExtendedTracker_Shared.h"
 
 using namespace ITMLib;
 
+struct ITMExtendedTracker_CPU::AccuCell
+{
+	int numPoints;
+	float f;
+	float g[6];
+	float h[6+5+4+3+2+1];
+};
+
+static inline void clearAccuCell(ITMExtendedTracker_CPU::AccuCell &accu, int noPara, int noParaSQ)
+{
+	accu.numPoints = 0; accu.f = 0.0f;
+	for (int i = 0; i < noPara; i++) accu.g[i] = 0.0f;
+	for (int i = 0; i < noParaSQ; i++) accu.h[i] = 0.0f;
+}
+
+// adds up the rows in order, the threads only ever write to their own rows
+static int sumAccuRows(const ITMExtendedTracker_CPU::AccuCell *rowAccu, int noRows, int noPara, int noParaSQ, float &f, float *nabla, float *hessian)
+{
+	float sumHessian[6 * 6], sumNabla[6], sumF = 0.0f; int noValidPoints = 0;
+
+	memset(sumHessian, 0, sizeof(float) * noParaSQ);
+	memset(sumNabla, 0, sizeof(float) * noPara);
+
+	for (int y = 0; y < noRows; y++)
+	{
+		noValidPoints += rowAccu[y].numPoints;
+		sumF += rowAccu[y].f;
+		for (int i = 0; i < noPara; i++) sumNabla[i] += rowAccu[y].g[i];
+		for (int i = 0; i < noParaSQ; i++) sumHessian[i] += rowAccu[y].h[i];
+	}
+
+	// Copy the lower triangular part of the matrix.
+	for (int r = 0, counter = 0; r < noPara; r++)
+		for (int c = 0; c <= r; c++, counter++)
+			hessian[r + c * 6] = sumHessian[counter];
+
+	// Transpose to fill the upper triangle.
+	for (int r = 0; r < noPara; ++r)
+		for (int c = r + 1; c < noPara; c++)
+			hessian[r + c * 6] = hessian[c + r * 6];
+
+	memcpy(nabla, sumNabla, noPara * sizeof(float));
+
+	f = sumF;
+
+	return noValidPoints;
+}
+
 ITMExtendedTracker_CPU::ITMExtendedTracker_CPU(Vector2i imgSize_d,
 											   Vector2i imgSize_rgb,
 											   bool useDepth,
@@ -38,9 +87,15 @@ ITMExtendedTracker_CPU::ITMExtendedTracker_CPU(Vector2i imgSize_d,
 						 framesToWeight,
 						 lowLevelEngine,
 						 MEMORYDEVICE_CPU)
-{ }
+{
+	// the lower levels of the hierarchy are smaller
+	rowAccu = new ORUtils::MemoryBlock<AccuCell>(imgSize_d.y, MEMORYDEVICE_CPU);
+}
 
-ITMExtendedTracker_CPU::~ITMExtendedTracker_CPU(void) { }
+ITMExtendedTracker_CPU::~ITMExtendedTracker_CPU(void)
+{
+	delete rowAccu;
+}
 
 int ITMExtendedTracker_CPU::ComputeGandH_Depth(float &f, float *nabla, float *hessian, Matrix4f approxInvPose)
 {
@@ -58,97 +113,113 @@ int ITMExtendedTracker_CPU::ComputeGandH_Depth(float &f, float *nabla, float *he
 	bool shortIteration = (currentIterationType == TRACKER_ITERATION_ROTATION)
 						   || (currentIterationType == TRACKER_ITERATION_TRANSLATION);
 
-	float sumHessian[6 * 6], sumNabla[6], sumF; int noValidPoints;
 	int noPara = shortIteration ? 3 : 6, noParaSQ = shortIteration ? 3 + 2 + 1 : 6 + 5 + 4 + 3 + 2 + 1;
 
-	noValidPoints = 0; sumF = 0.0f;
-	memset(sumHessian, 0, sizeof(float) * noParaSQ);
-	memset(sumNabla, 0, sizeof(float) * noPara);
+	AccuCell *rowAccu = this->rowAccu->GetData(MEMORYDEVICE_CPU);
 
-	for (int y = 0; y < viewImageSize.y; y++) for (int x = 0; x < viewImageSize.x; x++)
+	// whole rows at a time where the CPU allows
+	ITMDepthRowGHFunction computeRowGH = SelectDepthRowGH();
+	ITMExtendedTrackerDepthRowParams rowParams;
+	if (computeRowGH != NULL)
 	{
-		float localHessian[6 + 5 + 4 + 3 + 2 + 1], localNabla[6], localF = 0;
-
-		for (int i = 0; i < noPara; i++) localNabla[i] = 0.0f;
-		for (int i = 0; i < noParaSQ; i++) localHessian[i] = 0.0f;
+		rowParams.depth = depth; rowParams.viewWidth = viewImageSize.x;
+		rowParams.pointsMap = (const float*)pointsMap; rowParams.normalsMap = (const float*)normalsMap;
+		rowParams.sceneWidth = sceneImageSize.x; rowParams.sceneHeight = sceneImageSize.y;
+		for (int i = 0; i < 4; i++) { rowParams.viewIntrinsics[i] = viewIntrinsics[i]; rowParams.sceneIntrinsics[i] = sceneIntrinsics[i]; }
+		for (int i = 0; i < 16; i++) { rowParams.approxInvPose[i] = approxInvPose.m[i]; rowParams.scenePose[i] = scenePose.m[i]; }
+		rowParams.spaceThresh = spaceThresh[currentLevelId]; rowParams.tukeyCutOff = tukeyCutOff;
+		rowParams.viewFrustum_min = viewFrustum_min; rowParams.viewFrustum_max = viewFrustum_max;
+		rowParams.framesToSkip = framesToSkip; rowParams.framesToWeight = framesToWeight;
+		rowParams.shortIteration = shortIteration;
+		rowParams.rotationOnly = currentIterationType == TRACKER_ITERATION_ROTATION;
+		rowParams.useWeights = framesProcessed >= 100;
+	}
 
-		bool isValidPoint;
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < viewImageSize.y; y++)
+	{
+		AccuCell &accu = rowAccu[y];
+		clearAccuCell(accu, noPara, noParaSQ);
 
-		float depthWeight;
+		if (computeRowGH != NULL)
+		{
+			accu.numPoints = computeRowGH(rowParams, y, accu.f, accu.g, accu.h);
+			continue;
+		}
 
-		if (framesProcessed < 100)
+		for (int x = 0; x < viewImageSize.x; x++)
 		{
-			switch (currentIterationType)
+			float localHessian[6 + 5 + 4 + 3 + 2 + 1], localNabla[6], localF = 0;
+
+			for (int i = 0; i < noPara; i++) localNabla[i] = 0.0f;
+			for (int i = 0; i < noParaSQ; i++) localHessian[i] = 0.0f;
+
+			bool isValidPoint;
+
+			float depthWeight;
+
+			if (framesProcessed < 100)
 			{
-			case TRACKER_ITERATION_ROTATION:
-				isValidPoint = computePerPointGH_exDepth<true, true, false>(localNabla, localHessian, localF, x, y, depth[x + y * viewImageSize.x], depthWeight,
-					viewImageSize, viewIntrinsics, sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, spaceThresh[currentLevelId],
-					viewFrustum_min, viewFrustum_max, tukeyCutOff, framesToSkip, framesToWeight);
-				break;
-			case TRACKER_ITERATION_TRANSLATION:
-				isValidPoint = computePerPointGH_exDepth<true, false, false>(localNabla, localHessian, localF, x, y, depth[x + y * viewImageSize.x], depthWeight,
-					viewImageSize, viewIntrinsics, sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, spaceThresh[currentLevelId],
-					viewFrustum_min, viewFrustum_max, tukeyCutOff, framesToSkip, framesToWeight);
-				break;
-			case TRACKER_ITERATION_BOTH:
-				isValidPoint = computePerPointGH_exDepth<false, false, false>(localNabla, localHessian, localF, x, y, depth[x + y * viewImageSize.x], depthWeight,
-					viewImageSize, viewIntrinsics, sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, spaceThresh[currentLevelId],
-					viewFrustum_min, viewFrustum_max, tukeyCutOff, framesToSkip, framesToWeight);
-				break;
-			default:
-				isValidPoint = false;
-				break;
+				switch (currentIterationType)
+				{
+				case TRACKER_ITERATION_ROTATION:
+					isValidPoint = computePerPointGH_exDepth<true, true, false>(localNabla, localHessian, localF, x, y, depth[x + y * viewImageSize.x], depthWeight,
+						viewImageSize, viewIntrinsics, sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, spaceThresh[currentLevelId],
+						viewFrustum_min, viewFrustum_max, tukeyCutOff, framesToSkip, framesToWeight);
+					break;
+				case TRACKER_ITERATION_TRANSLATION:
+					isValidPoint = computePerPointGH_exDepth<true, false, false>(localNabla, localHessian, localF, x, y, depth[x + y * viewImageSize.x], depthWeight,
+						viewImageSize, viewIntrinsics, sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, spaceThresh[currentLevelId],
+						viewFrustum_min, viewFrustum_max, tukeyCutOff, framesToSkip, framesToWeight);
+					break;
+				case TRACKER_ITERATION_BOTH:
+					isValidPoint = computePerPointGH_exDepth<false, false, false>(localNabla, localHessian, localF, x, y, depth[x + y * viewImageSize.x], depthWeight,
+						viewImageSize, viewIntrinsics, sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, spaceThresh[currentLevelId],
+						viewFrustum_min, viewFrustum_max, tukeyCutOff, framesToSkip, framesToWeight);
+					break;
+				default:
+					isValidPoint = false;
+					break;
+				}
 			}
-		}
-		else
-		{
-			switch (currentIterationType)
+			else
 			{
-			case TRACKER_ITERATION_ROTATION:
-				isValidPoint = computePerPointGH_exDepth<true, true, true>(localNabla, localHessian, localF, x, y, depth[x + y * viewImageSize.x], depthWeight,
-					viewImageSize, viewIntrinsics, sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, spaceThresh[currentLevelId],
-					viewFrustum_min, viewFrustum_max, tukeyCutOff, framesToSkip, framesToWeight);
-				break;
-			case TRACKER_ITERATION_TRANSLATION:
-				isValidPoint = computePerPointGH_exDepth<true, false, true>(localNabla, localHessian, localF, x, y, depth[x + y * viewImageSize.x], depthWeight,
-					viewImageSize, viewIntrinsics, sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, spaceThresh[currentLevelId],
-					viewFrustum_min, viewFrustum_max, tukeyCutOff, framesToSkip, framesToWeight);
-				break;
-			case TRACKER_ITERATION_BOTH:
-				isValidPoint = computePerPointGH_exDepth<false, false, true>(localNabla, localHessian, localF, x, y, depth[x + y * viewImageSize.x], depthWeight,
-					viewImageSize, viewIntrinsics, sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, spaceThresh[currentLevelId],
-					viewFrustum_min, viewFrustum_max, tukeyCutOff, framesToSkip, framesToWeight);
-				break;
-			default:
-				isValidPoint = false;
-				break;
+				switch (currentIterationType)
+				{
+				case TRACKER_ITERATION_ROTATION:
+					isValidPoint = computePerPointGH_exDepth<true, true, true>(localNabla, localHessian, localF, x, y, depth[x + y * viewImageSize.x], depthWeight,
+						viewImageSize, viewIntrinsics, sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, spaceThresh[currentLevelId],
+						viewFrustum_min, viewFrustum_max, tukeyCutOff, framesToSkip, framesToWeight);
+					break;
+				case TRACKER_ITERATION_TRANSLATION:
+					isValidPoint = computePerPointGH_exDepth<true, false, true>(localNabla, localHessian, localF, x, y, depth[x + y * viewImageSize.x], depthWeight,
+						viewImageSize, viewIntrinsics, sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, spaceThresh[currentLevelId],
+						viewFrustum_min, viewFrustum_max, tukeyCutOff, framesToSkip, framesToWeight);
+					break;
+				case TRACKER_ITERATION_BOTH:
+					isValidPoint = computePerPointGH_exDepth<false, false, true>(localNabla, localHessian, localF, x, y, depth[x + y * viewImageSize.x], depthWeight,
+						viewImageSize, viewIntrinsics, sceneImageSize, sceneIntrinsics, approxInvPose, scenePose, pointsMap, normalsMap, spaceThresh[currentLevelId],
+						viewFrustum_min, viewFrustum_max, tukeyCutOff, framesToSkip, framesToWeight);
+					break;
+				default:
+					isValidPoint = false;
+					break;
+				}
 			}
-		}
 
-		if (isValidPoint)
-		{
-			noValidPoints++;
-			sumF += localF;
-			for (int i = 0; i < noPara; i++) sumNabla[i] += localNabla[i];
-			for (int i = 0; i < noParaSQ; i++) sumHessian[i] += localHessian[i];
+			if (isValidPoint)
+			{
+				accu.numPoints++;
+				accu.f += localF;
+				for (int i = 0; i < noPara; i++) accu.g[i] += localNabla[i];
+				for (int i = 0; i < noParaSQ; i++) accu.h[i] += localHessian[i];
+			}
 		}
 	}
 
-	// Copy the lower triangular part of the matrix.
-	for (int r = 0, counter = 0; r < noPara; r++)
-		for (int c = 0; c <= r; c++, counter++)
-			hessian[r + c * 6] = sumHessian[counter];
-
-	// Transpose to fill the upper triangle.
-	for (int r = 0; r < noPara; ++r)
-		for (int c = r + 1; c < noPara; c++)
-			hessian[r + c * 6] = hessian[c + r * 6];
-
-	memcpy(nabla, sumNabla, noPara * sizeof(float));
-
-	f = sumF;
-
-	return noValidPoints;
+	return sumAccuRows(rowAccu, viewImageSize.y, noPara, noParaSQ, f, nabla, hessian);
 }
 
 int ITMExtendedTracker_CPU::ComputeGandH_RGB(float &f, float *nabla, float *hessian, Matrix4f approxInvPose)
@@ -169,126 +240,142 @@ int ITMExtendedTracker_CPU::ComputeGandH_RGB(float &f, float *nabla, float *hess
 	bool shortIteration = (currentIterationType == TRACKER_ITERATION_ROTATION)
 						   || (currentIterationType == TRACKER_ITERATION_TRANSLATION);
 
-	float sumHessian[6 * 6], sumNabla[6], sumF;
-	int noValidPoints;
 	int noPara = shortIteration ? 3 : 6, noParaSQ = shortIteration ? 3 + 2 + 1 : 6 + 5 + 4 + 3 + 2 + 1;
 
-	noValidPoints = 0; sumF = 0.0f;
-	memset(sumHessian, 0, sizeof(float) * noParaSQ);
-	memset(sumNabla, 0, sizeof(float) * noPara);
+	const Matrix4f scenePose_rgb = depthToRGBTransform * scenePose;
 
-	for (int y = 0; y < viewImageSize_depth.y; y++) for (int x = 0; x < viewImageSize_depth.x; x++)
-	{
-		float localHessian[6 + 5 + 4 + 3 + 2 + 1], localNabla[6], localF = 0;
+	AccuCell *rowAccu = this->rowAccu->GetData(MEMORYDEVICE_CPU);
 
-		for (int i = 0; i < noPara; i++) localNabla[i] = 0.0f;
-		for (int i = 0; i < noParaSQ; i++) localHessian[i] = 0.0f;
+	// whole rows at a time where the CPU allows
+	ITMRGBRowGHFunction computeRowGH = SelectRGBRowGH();
+	ITMExtendedTrackerRGBRowParams rowParams;
+	if (computeRowGH != NULL)
+	{
+		rowParams.points_curr = (const float*)points_curr; rowParams.intensities_curr = intensities_current;
+		rowParams.depthWidth = viewImageSize_depth.x;
+		rowParams.intensities_prev = intensities_prev; rowParams.gradients = (const float*)gradients;
+		rowParams.rgbWidth = viewImageSize_rgb.x; rowParams.rgbHeight = viewImageSize_rgb.y;
+		for (int i = 0; i < 4; i++) rowParams.intrinsics_rgb[i] = projParams_rgb[i];
+		for (int i = 0; i < 16; i++) { rowParams.approxInvPose[i] = approxInvPose.m[i]; rowParams.scenePose[i] = scenePose_rgb.m[i]; }
+		rowParams.colourThresh = colourThresh[currentLevelId]; rowParams.minGradient = minColourGradient;
+		rowParams.viewFrustum_min = viewFrustum_min; rowParams.viewFrustum_max = viewFrustum_max; rowParams.tukeyCutOff = tukeyCutOff;
+		rowParams.shortIteration = shortIteration;
+		rowParams.rotationOnly = currentIterationType == TRACKER_ITERATION_ROTATION;
+	}
 
-		bool isValidPoint = false;
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < viewImageSize_depth.y; y++)
+	{
+		AccuCell &accu = rowAccu[y];
+		clearAccuCell(accu, noPara, noParaSQ);
 
-		switch (currentIterationType)
+		if (computeRowGH != NULL)
 		{
-		case TRACKER_ITERATION_ROTATION:
-			isValidPoint = computePerPointGH_exRGB_inv_Ab<true, true>(
-					localF,
-					localNabla,
-					localHessian,
-					x,
-					y,
-					points_curr,
-					intensities_current,
-					intensities_prev,
-					gradients,
-					viewImageSize_depth,
-					viewImageSize_rgb,
-					projParams_depth,
-					projParams_rgb,
-					approxInvPose,
-					depthToRGBTransform * scenePose,
-					colourThresh[currentLevelId],
-					minColourGradient,
-					viewFrustum_min,
-					viewFrustum_max,
-					tukeyCutOff
-					);
-			break;
-		case TRACKER_ITERATION_TRANSLATION:
-			isValidPoint = computePerPointGH_exRGB_inv_Ab<true, false>(
-					localF,
-					localNabla,
-					localHessian,
-					x,
-					y,
-					points_curr,
-					intensities_current,
-					intensities_prev,
-					gradients,
-					viewImageSize_depth,
-					viewImageSize_rgb,
-					projParams_depth,
-					projParams_rgb,
-					approxInvPose,
-					depthToRGBTransform * scenePose,
-					colourThresh[currentLevelId],
-					minColourGradient,
-					viewFrustum_min,
-					viewFrustum_max,
-					tukeyCutOff
-					);
-			break;
-		case TRACKER_ITERATION_BOTH:
-			isValidPoint = computePerPointGH_exRGB_inv_Ab<false, false>(
-					localF,
-					localNabla,
-					localHessian,
-					x,
-					y,
-					points_curr,
-					intensities_current,
-					intensities_prev,
-					gradients,
-					viewImageSize_depth,
-					viewImageSize_rgb,
-					projParams_depth,
-					projParams_rgb,
-					approxInvPose,
-					depthToRGBTransform * scenePose,
-					colourThresh[currentLevelId],
-					minColourGradient,
-					viewFrustum_min,
-					viewFrustum_max,
-					tukeyCutOff
-					);
-			break;
-		default:
-			isValidPoint = false;
-			break;
+			accu.numPoints = computeRowGH(rowParams, y, accu.f, accu.g, accu.h);
+			continue;
 		}
 
-		if (isValidPoint)
+		for (int x = 0; x < viewImageSize_depth.x; x++)
 		{
-			noValidPoints++;
-			sumF += localF;
-			for (int i = 0; i < noPara; i++) sumNabla[i] += localNabla[i];
-			for (int i = 0; i < noParaSQ; i++) sumHessian[i] += localHessian[i];
-		}
-	}
+			float localHessian[6 + 5 + 4 + 3 + 2 + 1], localNabla[6], localF = 0;
 
-	// Copy the lower triangular part of the matrix.
-	for (int r = 0, counter = 0; r < noPara; r++)
-		for (int c = 0; c <= r; c++, counter++)
-			hessian[r + c * 6] = sumHessian[counter];
+			for (int i = 0; i < noPara; i++) localNabla[i] = 0.0f;
+			for (int i = 0; i < noParaSQ; i++) localHessian[i] = 0.0f;
 
-	// Transpose to fill the upper triangle.
-	for (int r = 0; r < noPara; ++r)
-		for (int c = r + 1; c < noPara; c++)
-			hessian[r + c * 6] = hessian[c + r * 6];
+			bool isValidPoint = false;
 
-	memcpy(nabla, sumNabla, noPara * sizeof(float));
+			switch (currentIterationType)
+			{
+			case TRACKER_ITERATION_ROTATION:
+				isValidPoint = computePerPointGH_exRGB_inv_Ab<true, true>(
+						localF,
+						localNabla,
+						localHessian,
+						x,
+						y,
+						points_curr,
+						intensities_current,
+						intensities_prev,
+						gradients,
+						viewImageSize_depth,
+						viewImageSize_rgb,
+						projParams_depth,
+						projParams_rgb,
+						approxInvPose,
+						scenePose_rgb,
+						colourThresh[currentLevelId],
+						minColourGradient,
+						viewFrustum_min,
+						viewFrustum_max,
+						tukeyCutOff
+						);
+				break;
+			case TRACKER_ITERATION_TRANSLATION:
+				isValidPoint = computePerPointGH_exRGB_inv_Ab<true, false>(
+						localF,
+						localNabla,
+						localHessian,
+						x,
+						y,
+						points_curr,
+						intensities_current,
+						intensities_prev,
+						gradients,
+						viewImageSize_depth,
+						viewImageSize_rgb,
+						projParams_depth,
+						projParams_rgb,
+						approxInvPose,
+						scenePose_rgb,
+						colourThresh[currentLevelId],
+						minColourGradient,
+						viewFrustum_min,
+						viewFrustum_max,
+						tukeyCutOff
+						);
+				break;
+			case TRACKER_ITERATION_BOTH:
+				isValidPoint = computePerPointGH_exRGB_inv_Ab<false, false>(
+						localF,
+						localNabla,
+						localHessian,
+						x,
+						y,
+						points_curr,
+						intensities_current,
+						intensities_prev,
+						gradients,
+						viewImageSize_depth,
+						viewImageSize_rgb,
+						projParams_depth,
+						projParams_rgb,
+						approxInvPose,
+						scenePose_rgb,
+						colourThresh[currentLevelId],
+						minColourGradient,
+						viewFrustum_min,
+						viewFrustum_max,
+						tukeyCutOff
+						);
+				break;
+			default:
+				isValidPoint = false;
+				break;
+			}
 
-	f = sumF;
+			if (isValidPoint)
+			{
+				accu.numPoints++;
+				accu.f += localF;
+				for (int i = 0; i < noPara; i++) accu.g[i] += localNabla[i];
+				for (int i = 0; i < noParaSQ; i++) accu.h[i] += localHessian[i];
+			}
+		}
+	}
 
-	return noValidPoints;
+	return sumAccuRows(rowAccu, viewImageSize_depth.y, noPara, noParaSQ, f, nabla, hessian);
 }
 
 void ITMExtendedTracker_CPU::ProjectCurrentIntensityFrame(ITMFloat4Image *points_out,
@@ -310,6 +397,9 @@ void ITMExtendedTracker_CPU::ProjectCurrentIntensityFrame(ITMFloat4Image *points
 	Vector4f *pointsOut = points_out->GetData(MEMORYDEVICE_CPU);
 	float *intensityOut = intensity_out->GetData(MEMORYDEVICE_CPU);
 
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
 	for (int y = 0; y < imageSize_depth.y; y++) for (int x = 0; x < imageSize_depth.x; x++)
 		projectPoint_exRGB(x, y, pointsOut, intensityOut, intensityIn, depths, imageSize_rgb, imageSize_depth, intrinsics_rgb, intrinsics_depth, scenePose);
 }
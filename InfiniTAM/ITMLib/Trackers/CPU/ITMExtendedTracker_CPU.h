@@ -8,6 +8,15 @@ namespace ITMLib
 {
 	class ITMExtendedTracker_CPU : public ITMExtendedTracker
 	{
+	public:
+		struct AccuCell;
+
+	private:
+		/** One accumulator per image row, summed in row order so
+		    that the result does not depend on the number of threads.
+		*/
+		ORUtils::MemoryBlock<AccuCell> *rowAccu;
+
 	protected:
 		int ComputeGandH_Depth(float &f, float *nabla, float *hessian, Matrix4f approxInvPose);
 		int ComputeGandH_RGB(float &f, float *nabla, float *hessian, Matrix4f approxInvPose);
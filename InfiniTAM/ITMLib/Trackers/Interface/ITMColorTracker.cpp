@@ -2,6 +2,7 @@
 
 #include "ITMColorTracker.h"
 #include "../../../ORUtils/Cholesky.h"
+#include "../../Utils/ITMProfiler.h"
 
 #include <math.h>
 
@@ -31,6 +32,8 @@ void ITMColorTracker::TrackCamera(ITMTrackingState *trackingState, const ITMView
 	ORUtils::SE3Pose currentPara(view->calib.trafo_rgb_to_depth.calib_inv * trackingState->pose_d->GetM());
 	for (int levelId = viewHierarchy->GetNoLevels() - 1; levelId >= 0; levelId--)
 	{
+		ITM_PROFILE_SCOPE_INDEXED("Tracker level", levelId);
+
 		this->levelId = levelId;
 		this->iterationType = viewHierarchy->GetLevel(levelId)->iterationType;
 
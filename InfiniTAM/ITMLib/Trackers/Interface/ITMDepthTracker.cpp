@@ -2,6 +2,7 @@
 
 #include "ITMDepthTracker.h"
 #include "../../../ORUtils/Cholesky.h"
+#include "../../Utils/ITMProfiler.h"
 
 #include <math.h>
 
@@ -250,6 +251,8 @@ void ITMDepthTracker::TrackCamera(ITMTrackingState *trackingState, const ITMView
 		this->SetEvaluationParams(levelId);
 		if (iterationType == TRACKER_ITERATION_NONE) continue;
 
+		ITM_PROFILE_SCOPE_INDEXED("Tracker level", levelId);
+
 		Matrix4f approxInvPose = trackingState->pose_d->GetInvM();
 		ORUtils::SE3Pose lastKnownGoodPose(*(trackingState->pose_d));
 		f_old = 1e20f;
@@ -258,6 +261,8 @@ void ITMDepthTracker::TrackCamera(ITMTrackingState *trackingState, const ITMView
 
 		for (int iterNo = 0; iterNo < noIterationsPerLevel[levelId]; iterNo++)
 		{
+			ITM_PROFILE_SCOPE("Tracker iteration");
+
 			// evaluate error function and gradients
 			noValidPoints_new = this->ComputeGandH(f_new, nabla_new, hessian_new, approxInvPose);
 
@@ -291,5 +296,7 @@ void ITMDepthTracker::TrackCamera(ITMTrackingState *trackingState, const ITMView
 		}
 	}
 
+	ITM_PROFILE_COUNTER("ICP valid points", noValidPoints_old);
+
 	this->UpdatePoseQuality(noValidPoints_old, hessian_good, f_old);
 }
@@ -8,6 +8,7 @@
 #include "../../../ORUtils/Cholesky.h"
 
 #include "../../../ORUtils/FileUtils.h"
+#include "../../Utils/ITMProfiler.h"
 
 #include <math.h>
 #include <limits>
@@ -434,6 +435,8 @@ void ITMExtendedTracker::TrackCamera(ITMTrackingState *trackingState, const ITMV
 
 		if (currentIterationType == TRACKER_ITERATION_NONE) continue;
 
+		ITM_PROFILE_SCOPE_INDEXED("Tracker level", levelId);
+
 		Matrix4f approxInvPose = trackingState->pose_d->GetInvM();
 		ORUtils::SE3Pose lastKnownGoodPose(*(trackingState->pose_d));
 
@@ -442,6 +445,8 @@ void ITMExtendedTracker::TrackCamera(ITMTrackingState *trackingState, const ITMV
 
 		for (int iterNo = 0; iterNo < noIterationsPerLevel[levelId]; iterNo++)
 		{
+			ITM_PROFILE_SCOPE("Tracker iteration");
+
 			float hessian_depth[6 * 6], hessian_RGB[6 * 6];
 			float nabla_depth[6], nabla_RGB[6];
 			float f_depth = 0.f, f_RGB = 0.f;
@@ -580,5 +585,7 @@ void ITMExtendedTracker::TrackCamera(ITMTrackingState *trackingState, const ITMV
 		}
 	}
 
+	ITM_PROFILE_COUNTER("ICP valid points", noValidPoints_depth_good);
+
 	this->UpdatePoseQuality(noValidPoints_depth_good, hessian_depth_good, f_depth_good);
 }
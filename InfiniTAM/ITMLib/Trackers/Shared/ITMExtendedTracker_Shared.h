@@ -190,9 +190,9 @@ _CPU_AND_GPU_CODE_ inline bool computePerPointGH_exRGB_inv_Ab(
 	// Project the point in the previous intensity frame
 	const Vector2f pt_prev_proj = project(pt_prev, intrinsics_rgb);
 
-	// Outside the image plane
-	if (pt_prev_proj.x < 0 || pt_prev_proj.x >= imgSize_rgb.x - 1 ||
-		pt_prev_proj.y < 0 || pt_prev_proj.y >= imgSize_rgb.y - 1) return false;
+	// Outside the image plane, or not a number after a failed iteration
+	if (!(pt_prev_proj.x >= 0 && pt_prev_proj.x < imgSize_rgb.x - 1 &&
+		pt_prev_proj.y >= 0 && pt_prev_proj.y < imgSize_rgb.y - 1)) return false;
 
 	// Point should be valid, sample intensities and gradients
 	const float intensity_prev = interpolateBilinear_single(intensities_prev, pt_prev_proj, imgSize_rgb);
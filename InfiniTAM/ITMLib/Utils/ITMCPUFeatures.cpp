@@ -0,0 +1,61 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "ITMCPUFeatures.h"
+using namespace ITMLib;
+
+#if defined(WITH_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+static ITMCPUInstructionSet DetectCPUInstructionSet(void)
+{
+#if !defined(WITH_SIMD)
+	return CPU_INSTRUCTIONSET_SCALAR;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int noIds = info[0];
+
+	__cpuid(info, 1);
+	bool hasSSE41 = (info[2] & (1 << 19)) != 0;
+	bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+
+	// the OS has to save the AVX (and AVX-512) registers on context switches
+	unsigned long long xcr0 = hasOSXSave ? _xgetbv(0) : 0;
+	bool osSavesAVX = (xcr0 & 0x6) == 0x6, osSavesAVX512 = (xcr0 & 0xe6) == 0xe6;
+
+	bool hasAVX2 = false, hasAVX512 = false;
+	if (noIds >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		hasAVX2 = (info[1] & (1 << 5)) != 0;
+		hasAVX512 = (info[1] & (1 << 16)) != 0;
+	}
+
+	if (hasAVX512 && osSavesAVX512) return CPU_INSTRUCTIONSET_AVX512;
+	if (hasAVX2 && osSavesAVX) return CPU_INSTRUCTIONSET_AVX2;
+	if (hasSSE41) return CPU_INSTRUCTIONSET_SSE4;
+	return CPU_INSTRUCTIONSET_SCALAR;
+#else
+	// also checks that the OS saves the extended registers
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) return CPU_INSTRUCTIONSET_AVX512;
+	if (__builtin_cpu_supports("avx2")) return CPU_INSTRUCTIONSET_AVX2;
+	if (__builtin_cpu_supports("sse4.1")) return CPU_INSTRUCTIONSET_SSE4;
+	return CPU_INSTRUCTIONSET_SCALAR;
+#endif
+}
+
+static ITMCPUInstructionSet maxCPUInstructionSet = CPU_INSTRUCTIONSET_AVX512;
+
+ITMCPUInstructionSet ITMLib::GetCPUInstructionSet(void)
+{
+	static const ITMCPUInstructionSet detected = DetectCPUInstructionSet();
+	return detected < maxCPUInstructionSet ? detected : maxCPUInstructionSet;
+}
+
+void ITMLib::SetMaxCPUInstructionSet(ITMCPUInstructionSet maxInstructionSet)
+{
+	maxCPUInstructionSet = maxInstructionSet;
+}
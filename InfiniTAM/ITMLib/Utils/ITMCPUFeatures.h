@@ -0,0 +1,30 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+namespace ITMLib
+{
+	/** \brief
+	    Instruction sets for which vectorised CPU kernels
+	    can be built, in increasing order of preference.
+	*/
+	enum ITMCPUInstructionSet
+	{
+		CPU_INSTRUCTIONSET_SCALAR,
+		CPU_INSTRUCTIONSET_SSE4,
+		CPU_INSTRUCTIONSET_AVX2,
+		CPU_INSTRUCTIONSET_AVX512
+	};
+
+	/** Get the best instruction set that is supported by both
+	    the CPU and this build, see WITH_SIMD. The CPU is only
+	    queried on the first call.
+	*/
+	ITMCPUInstructionSet GetCPUInstructionSet(void);
+
+	/** Do not use any instruction set above @p maxInstructionSet,
+	    e.g. to compare the vectorised kernels against the scalar
+	    code. This only affects engines created afterwards.
+	*/
+	void SetMaxCPUInstructionSet(ITMCPUInstructionSet maxInstructionSet);
+}
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "../Objects/Scene/ITMVoxelBlockHash.h"
+
 template<class T>
 inline __device__ void warpReduce(volatile T* sdata, int tid) {
 	sdata[tid] += sdata[tid + 32];
@@ -95,6 +97,36 @@ __device__ static inline void atomicMax(float* address, float val)
 	} while (assumed != old);
 }
 
+/** Summarise a voxel block from the SDF value and saturation of
+    each of its voxels, one per thread of an SDF_BLOCK_SIZE^3 thread
+    block. Has to be reached by all threads of the block. */
+__device__ static inline void computeVoxelBlockSummary_device(ITMVoxelBlockSummary *summary, float sdf, bool saturated)
+{
+	__shared__ float minSDF[SDF_BLOCK_SIZE3], maxSDF[SDF_BLOCK_SIZE3];
+
+	int tid = threadIdx.x + threadIdx.y * SDF_BLOCK_SIZE + threadIdx.z * SDF_BLOCK_SIZE * SDF_BLOCK_SIZE;
+
+	minSDF[tid] = sdf; maxSDF[tid] = sdf;
+	bool allSaturated = __syncthreads_and(saturated);
+
+	for (int s = SDF_BLOCK_SIZE3 / 2; s > 0; s >>= 1)
+	{
+		if (tid < s)
+		{
+			minSDF[tid] = fminf(minSDF[tid], minSDF[tid + s]);
+			maxSDF[tid] = fmaxf(maxSDF[tid], maxSDF[tid + s]);
+		}
+		__syncthreads();
+	}
+
+	if (tid == 0)
+	{
+		summary->minSDF = minSDF[0];
+		summary->maxSDF = maxSDF[0];
+		summary->saturated = allSaturated;
+	}
+}
+
 template<typename T>
 __global__ void memsetKernel_device(T *devPtr, const T val, size_t nwords)
 {
@@ -128,19 +160,20 @@ inline void memsetKernel(T *devPtr, const T val, size_t nwords)
 }
 
 template<typename T>
-__global__ void fillArrayKernel_device(T *devPtr, size_t nwords)
+__global__ void fillArrayKernel_device(T *devPtr, size_t nwords, T firstValue)
 {
 	size_t offset = threadIdx.x + blockDim.x * blockIdx.x;
 	if (offset >= nwords) return;
-	devPtr[offset] = offset;
+	devPtr[offset] = firstValue + offset;
 }
 
+/** Fill devPtr[i] = firstValue + i for i in [0, nwords). */
 template<typename T>
-inline void fillArrayKernel(T *devPtr, size_t nwords)
+inline void fillArrayKernel(T *devPtr, size_t nwords, T firstValue = 0)
 {
 	dim3 blockSize(256);
 	dim3 gridSize((int)ceil((float)nwords / (float)blockSize.x));
-	fillArrayKernel_device<T> <<<gridSize,blockSize>>>(devPtr, nwords);
+	fillArrayKernel_device<T> <<<gridSize,blockSize>>>(devPtr, nwords, firstValue);
 	ORcudaKernelCheck;
 }
 
@@ -6,8 +6,8 @@ using namespace ITMLib;
 #include <climits>
 #include <cmath>
 
-ITMLibSettings::ITMLibSettings(void)
-:	sceneParams(0.02f, 100, 0.005f, 0.2f, 3.0f, false),
+ITMLibSettings::ITMLibSettings(LibMode libMode)
+:	sceneParams(0.02f, 100, 0.005f, 0.2f, 3.0f, false, 0x40000, 0x100000, 0x20000, true),
 	surfelSceneParams(0.5f, 0.6f, static_cast<float>(20 * M_PI / 180), 0.01f, 0.004f, 3.5f, 25.0f, 4, 1.0f, 5.0f, 20, 10000000, true, true)
 {
 	// skips every other point when using the colour renderer for creating a point cloud
@@ -29,21 +29,31 @@ ITMLibSettings::ITMLibSettings(void)
 
 	//deviceType = DEVICE_CPU;
 
+	/// size of the voxel block hash: 2^18 voxel blocks, 2^20 hash buckets and 2^17 excess list entries.
+	/// the voxel block array and the excess list grow on demand, so small scenes can start with much less, e.g. for loop closure
+	//sceneParams.noVoxelBlocks = 0x10000; sceneParams.noHashBuckets = 0x40000; sceneParams.noExcessListEntries = 0x8000;
+
 	/// how swapping works: disabled, fully enabled (still with dragons) and delete what's not visible - not supported in loop closure version
 	swappingMode = SWAPPINGMODE_DISABLED;
 
+	/// swapping and eviction rely on a voxel block array of fixed size, so the hash only grows without swapping, see ITMDenseMapper
+	sceneParams.allowHashGrowth = swappingMode == SWAPPINGMODE_DISABLED;
+
 	/// enables or disables approximate raycast
 	useApproximateRaycast = false;
 
 	/// enable or disable bilateral depth filtering
 	useBilateralFilter = false;
 
+	/// build the view of the next frame in the background - more frames per second, but the results lag one frame behind the input
+	usePipelinedProcessing = false;
+
 	/// what to do on tracker failure: ignore, relocalise or stop integration - not supported in loop closure version
 	behaviourOnFailure = FAILUREMODE_IGNORE;
 
 	/// switch between various library modes - basic, with loop closure, etc.
-	libMode = LIBMODE_BASIC;
-	//libMode = LIBMODE_BASIC_SURFELS;
+	this->libMode = libMode;
+	//this->libMode = LIBMODE_BASIC_SURFELS;
 
 	//// Default ICP tracking
 	//trackerConfig = "type=icp,levels=rrrbb,minstep=1e-3,"
@@ -71,7 +81,7 @@ ITMLibSettings::ITMLibSettings(void)
 	//trackerConfig = "type=extendedimu,levels=ttb,minstep=5e-4,outlierSpaceC=0.1,outlierSpaceF=0.004,numiterC=20,numiterF=5,tukeyCutOff=8,framesToSkip=20,framesToWeight=50,failureDec=20.0";
 
 	// Surfel tracking
-	if(libMode == LIBMODE_BASIC_SURFELS)
+	if(this->libMode == LIBMODE_BASIC_SURFELS)
 	{
 		trackerConfig = "extended,levels=rrbb,minstep=1e-4,outlierSpaceC=0.1,outlierSpaceF=0.004,numiterC=20,numiterF=20,tukeyCutOff=8,framesToSkip=0,framesToWeight=1,failureDec=20.0";
 	}
@@ -4,6 +4,7 @@
 
 #include "ITMSceneParams.h"
 #include "ITMSurfelSceneParams.h"
+#include "ITMSwappingParams.h"
 #include "../../ORUtils/MemoryDeviceType.h"
 
 namespace ITMLib
@@ -46,6 +47,9 @@ namespace ITMLib
 
 		bool useBilateralFilter;
 
+		/// Build the view of the next frame while the current one is tracked and fused, see ITMBasicEngine::ProcessFrame()
+		bool usePipelinedProcessing;
+
 		/// For ITMColorTracker: skip every other point in energy function evaluation.
 		bool skipPoints;
 
@@ -61,7 +65,11 @@ namespace ITMLib
 		ITMSceneParams sceneParams;
 		ITMSurfelSceneParams surfelSceneParams;
 
-		ITMLibSettings(void);
+		/// How swapped out blocks are stored, with SWAPPINGMODE_ENABLED
+		ITMSwappingParams swappingParams;
+
+		/// The defaults, including the tracker, depend on the library mode
+		explicit ITMLibSettings(LibMode libMode = LIBMODE_BASIC);
 		virtual ~ITMLibSettings(void) {}
 
 		// Suppress the default copy constructor and assignment operator
@@ -0,0 +1,321 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "ITMProfiler.h"
+
+#include <stdio.h>
+
+#if defined(WITH_PROFILING) && !defined(NO_CPP11)
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#endif
+
+using namespace ITMLib;
+
+#if defined(WITH_PROFILING) && !defined(NO_CPP11)
+
+struct ITMProfiler::PrivateData
+{
+	typedef std::map<std::string, double> FrameValues;
+
+	struct Summary
+	{
+		double sum, max;
+		int noFrames;
+	};
+
+	PrivateData(void)
+	{
+		isRecording = false;
+		csvFile = jsonFile = traceFile = NULL;
+		noFrames = 0;
+	}
+
+	/// Small thread ids in the order the threads were first seen, which the trace viewers show more nicely
+	int getThreadId(void)
+	{
+		std::map<std::thread::id, int>::iterator it = threadIds.find(std::this_thread::get_id());
+		if (it != threadIds.end()) return it->second;
+
+		int threadId = (int)threadIds.size();
+		threadIds[std::this_thread::get_id()] = threadId;
+		return threadId;
+	}
+
+	void addValue(const std::string &name, double value, bool accumulate)
+	{
+		if (currentFrame.find(name) == currentFrame.end())
+		{
+			if (knownColumns.insert(name).second)
+			{
+				columns.push_back(name);
+				if (!accumulate) counters.insert(name);
+			}
+			currentFrame[name] = value;
+		}
+		else if (accumulate) currentFrame[name] += value;
+		else currentFrame[name] = value;
+	}
+
+	void endFrame(double time)
+	{
+		if (jsonFile != NULL)
+		{
+			fprintf(jsonFile, "%s\n{\"frame\":%d", noFrames > 0 ? "," : "", noFrames);
+			for (FrameValues::const_iterator it = currentFrame.begin(); it != currentFrame.end(); ++it)
+				fprintf(jsonFile, ",\"%s\":%g", it->first.c_str(), it->second);
+			fprintf(jsonFile, "}");
+		}
+
+		if (traceFile != NULL)
+		{
+			fprintf(traceFile, "%s\n{\"name\":\"frame %d\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.1f,\"pid\":0,\"tid\":%d}",
+				hasTraceEvents ? "," : "", noFrames, time, getThreadId());
+			hasTraceEvents = true;
+		}
+
+		if (csvFile != NULL) frames.push_back(currentFrame);
+
+		for (FrameValues::const_iterator it = currentFrame.begin(); it != currentFrame.end(); ++it)
+		{
+			std::map<std::string, Summary>::iterator summary = summaries.find(it->first);
+			if (summary == summaries.end())
+			{
+				Summary newSummary = { it->second, it->second, 1 };
+				summaries[it->first] = newSummary;
+			}
+			else
+			{
+				summary->second.sum += it->second;
+				if (it->second > summary->second.max) summary->second.max = it->second;
+				summary->second.noFrames++;
+			}
+		}
+
+		currentFrame.clear();
+		noFrames++;
+	}
+
+	void writeCSV(void)
+	{
+		fprintf(csvFile, "frame");
+		for (size_t c = 0; c < columns.size(); ++c) fprintf(csvFile, ",%s", columns[c].c_str());
+		fprintf(csvFile, "\n");
+
+		for (size_t f = 0; f < frames.size(); ++f)
+		{
+			fprintf(csvFile, "%d", (int)f);
+			for (size_t c = 0; c < columns.size(); ++c)
+			{
+				FrameValues::const_iterator it = frames[f].find(columns[c]);
+				if (it != frames[f].end()) fprintf(csvFile, ",%g", it->second);
+				else fprintf(csvFile, ",");
+			}
+			fprintf(csvFile, "\n");
+		}
+	}
+
+	std::atomic<bool> isRecording;
+	std::chrono::steady_clock::time_point startTime;
+	std::mutex mutex;
+
+	FILE *csvFile, *jsonFile, *traceFile;
+	bool hasTraceEvents;
+
+	std::map<std::thread::id, int> threadIds;
+
+	int noFrames;
+	FrameValues currentFrame;
+
+	// only kept for the CSV file, whose columns are known at the end
+	std::vector<FrameValues> frames;
+	std::vector<std::string> columns;
+	std::set<std::string> knownColumns, counters;
+
+	std::map<std::string, Summary> summaries;
+};
+
+ITMProfiler::ITMProfiler(void) { privateData = new PrivateData(); }
+ITMProfiler::~ITMProfiler(void) { Close(); delete privateData; }
+
+bool ITMProfiler::Open(const char *csvFileName, const char *jsonFileName, const char *traceFileName)
+{
+	Close();
+
+	std::lock_guard<std::mutex> lock(privateData->mutex);
+
+	bool success = true;
+	if (csvFileName != NULL && (privateData->csvFile = fopen(csvFileName, "w")) == NULL) success = false;
+	if (jsonFileName != NULL && (privateData->jsonFile = fopen(jsonFileName, "w")) == NULL) success = false;
+	if (traceFileName != NULL && (privateData->traceFile = fopen(traceFileName, "w")) == NULL) success = false;
+
+	if (privateData->jsonFile != NULL) fprintf(privateData->jsonFile, "[");
+	if (privateData->traceFile != NULL) fprintf(privateData->traceFile, "{\"traceEvents\":[");
+	privateData->hasTraceEvents = false;
+
+	privateData->noFrames = 0;
+	privateData->currentFrame.clear();
+	privateData->frames.clear();
+	privateData->columns.clear();
+	privateData->knownColumns.clear();
+	privateData->counters.clear();
+	privateData->summaries.clear();
+	privateData->threadIds.clear();
+
+	privateData->startTime = std::chrono::steady_clock::now();
+	privateData->isRecording = true;
+
+	return success;
+}
+
+void ITMProfiler::Close(void)
+{
+	if (!privateData->isRecording) return;
+	privateData->isRecording = false;
+
+	double time = GetTime();
+	std::lock_guard<std::mutex> lock(privateData->mutex);
+
+	// e.g. the last frame of a pipelined engine, which is processed after the app ended its frame
+	if (!privateData->currentFrame.empty()) privateData->endFrame(time);
+
+	if (privateData->csvFile != NULL)
+	{
+		privateData->writeCSV();
+		fclose(privateData->csvFile);
+		privateData->csvFile = NULL;
+	}
+
+	if (privateData->jsonFile != NULL)
+	{
+		fprintf(privateData->jsonFile, "\n]\n");
+		fclose(privateData->jsonFile);
+		privateData->jsonFile = NULL;
+	}
+
+	if (privateData->traceFile != NULL)
+	{
+		fprintf(privateData->traceFile, "\n]}\n");
+		fclose(privateData->traceFile);
+		privateData->traceFile = NULL;
+	}
+
+	privateData->frames.clear();
+}
+
+bool ITMProfiler::IsRecording(void) const
+{
+	return privateData->isRecording;
+}
+
+double ITMProfiler::GetTime(void) const
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - privateData->startTime).count();
+}
+
+void ITMProfiler::EndFrame(void)
+{
+	if (!privateData->isRecording) return;
+
+	double time = GetTime();
+	std::lock_guard<std::mutex> lock(privateData->mutex);
+	privateData->endFrame(time);
+}
+
+void ITMProfiler::AddStage(const char *name, int index, double startTime)
+{
+	if (!privateData->isRecording) return;
+
+	double endTime = GetTime();
+
+	std::string fullName(name);
+	if (index >= 0)
+	{
+		char indexString[16];
+		sprintf(indexString, " %d", index);
+		fullName += indexString;
+	}
+
+	std::lock_guard<std::mutex> lock(privateData->mutex);
+
+	// stages are summed up in ms, the trace is in us
+	privateData->addValue(fullName, (endTime - startTime) / 1000.0, true);
+
+	if (privateData->traceFile != NULL)
+	{
+		fprintf(privateData->traceFile, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.1f,\"dur\":%.1f,\"pid\":0,\"tid\":%d}",
+			privateData->hasTraceEvents ? "," : "", fullName.c_str(), startTime, endTime - startTime, privateData->getThreadId());
+		privateData->hasTraceEvents = true;
+	}
+}
+
+void ITMProfiler::SetCounter(const char *name, double value)
+{
+	if (!privateData->isRecording) return;
+
+	double time = GetTime();
+	std::lock_guard<std::mutex> lock(privateData->mutex);
+
+	privateData->addValue(name, value, false);
+
+	if (privateData->traceFile != NULL)
+	{
+		fprintf(privateData->traceFile, "%s\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.1f,\"pid\":0,\"args\":{\"value\":%g}}",
+			privateData->hasTraceEvents ? "," : "", name, time, value);
+		privateData->hasTraceEvents = true;
+	}
+}
+
+void ITMProfiler::WriteSummary(FILE *out) const
+{
+	std::lock_guard<std::mutex> lock(privateData->mutex);
+
+	bool isFirst = true;
+	fprintf(out, "{");
+	for (size_t c = 0; c < privateData->columns.size(); ++c)
+	{
+		const std::string &name = privateData->columns[c];
+		std::map<std::string, PrivateData::Summary>::const_iterator it = privateData->summaries.find(name);
+		if (it == privateData->summaries.end()) continue;
+
+		const PrivateData::Summary &summary = it->second;
+		int noFrames = privateData->counters.count(name) > 0 ? summary.noFrames : privateData->noFrames;
+		fprintf(out, "%s\"%s\":{\"mean\":%g,\"max\":%g}", isFirst ? "" : ",", name.c_str(), summary.sum / noFrames, summary.max);
+		isFirst = false;
+	}
+	fprintf(out, "}");
+}
+
+#else
+
+struct ITMProfiler::PrivateData { };
+
+ITMProfiler::ITMProfiler(void) { privateData = new PrivateData(); }
+ITMProfiler::~ITMProfiler(void) { delete privateData; }
+
+bool ITMProfiler::Open(const char *csvFileName, const char *jsonFileName, const char *traceFileName)
+{
+	printf("warning: InfiniTAM was built without WITH_PROFILING, nothing will be recorded\n");
+	return false;
+}
+
+void ITMProfiler::Close(void) { }
+bool ITMProfiler::IsRecording(void) const { return false; }
+double ITMProfiler::GetTime(void) const { return 0.0; }
+void ITMProfiler::EndFrame(void) { }
+void ITMProfiler::AddStage(const char *name, int index, double startTime) { }
+void ITMProfiler::SetCounter(const char *name, double value) { }
+void ITMProfiler::WriteSummary(FILE *out) const { fprintf(out, "{}"); }
+
+#endif
+
+ITMProfiler& ITMProfiler::Instance(void)
+{
+	static ITMProfiler instance;
+	return instance;
+}
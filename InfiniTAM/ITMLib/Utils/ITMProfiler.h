@@ -0,0 +1,122 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <stdio.h>
+
+namespace ITMLib
+{
+	/** \brief
+	    Records how long the stages of the engines take and
+	    counters such as the number of visible blocks, without
+	    the need for an external profiler.
+
+	    Stages are timed with ITM_PROFILE_SCOPE() and counters set
+	    with ITM_PROFILE_COUNTER(). Both compile to nothing unless
+	    WITH_PROFILING is defined, see cmake/UseProfiling.cmake,
+	    and cost a single check while no files are open.
+
+	    Once Open() has been called, the time spent in every stage
+	    and the last value of every counter are summed up per frame,
+	    where a frame ends with each call to EndFrame(). The frames
+	    are written to a JSON file as they end and to a CSV file on
+	    Close(), with one column per stage and counter. Every single
+	    stage and counter update also goes to a trace file in the
+	    trace event format, which can be viewed in chrome://tracing.
+
+	    All times are host side wall clock times. With CUDA, a stage
+	    only covers the time until its kernels have been launched,
+	    unless it waits for their results.
+	*/
+	class ITMProfiler
+	{
+	private:
+		struct PrivateData;
+		PrivateData *privateData;
+
+		ITMProfiler(void);
+		~ITMProfiler(void);
+
+		// Suppress the default copy constructor and assignment operator
+		ITMProfiler(const ITMProfiler&);
+		ITMProfiler& operator=(const ITMProfiler&);
+
+	public:
+		static ITMProfiler& Instance(void);
+
+		/** Starts recording into the given files, any of which may
+		    be NULL. Returns false if a file could not be opened, or
+		    if the library was built without WITH_PROFILING.
+		*/
+		bool Open(const char *csvFileName, const char *jsonFileName, const char *traceFileName);
+
+		/// Writes the CSV file and closes all files
+		void Close(void);
+
+		bool IsRecording(void) const;
+
+		/// Ends the current frame, usually called by the app after ITMMainEngine::ProcessFrame()
+		void EndFrame(void);
+
+		/// Microseconds since Open(), as used for the trace
+		double GetTime(void) const;
+
+		/** Records a stage of @p name that started at @p startTime
+		    and ends now. If @p index is not negative, e.g. for the
+		    levels of a tracker, it is appended to the name.
+		*/
+		void AddStage(const char *name, int index, double startTime);
+
+		/// Sets a counter for the current frame
+		void SetCounter(const char *name, double value);
+
+		/** Writes the mean per frame and the maximum of every stage
+		    and counter since Open() as a JSON object. Stages count
+		    as 0 ms in frames that they did not run in, counters are
+		    averaged over the frames that set them.
+		*/
+		void WriteSummary(FILE *out) const;
+	};
+
+	/** \brief
+	    Times the stage from its construction until the end of the
+	    enclosing scope, see ITM_PROFILE_SCOPE().
+	*/
+	class ITMProfileScope
+	{
+	private:
+		const char *name;
+		int index;
+		double startTime;
+
+	public:
+		ITMProfileScope(const char *name, int index = -1)
+		{
+			this->name = name;
+			this->index = index;
+			startTime = ITMProfiler::Instance().IsRecording() ? ITMProfiler::Instance().GetTime() : -1.0;
+		}
+
+		~ITMProfileScope(void)
+		{
+			if (startTime >= 0.0) ITMProfiler::Instance().AddStage(name, index, startTime);
+		}
+	};
+}
+
+#define ITM_PROFILE_CONCAT_(a, b) a##b
+#define ITM_PROFILE_CONCAT(a, b) ITM_PROFILE_CONCAT_(a, b)
+
+#ifdef WITH_PROFILING
+/// Times the rest of the enclosing scope as a stage called @p name, which must be a string literal
+#define ITM_PROFILE_SCOPE(name) ITMLib::ITMProfileScope ITM_PROFILE_CONCAT(itmProfileScope, __LINE__)(name)
+/// As ITM_PROFILE_SCOPE(), for one of several numbered stages such as the levels of a tracker
+#define ITM_PROFILE_SCOPE_INDEXED(name, index) ITMLib::ITMProfileScope ITM_PROFILE_CONCAT(itmProfileScope, __LINE__)(name, index)
+/// Sets the counter @p name to @p value, which is only evaluated when profiling is compiled in
+#define ITM_PROFILE_COUNTER(name, value) ITMLib::ITMProfiler::Instance().SetCounter(name, (double)(value))
+#else
+#define ITM_PROFILE_SCOPE(name)
+#define ITM_PROFILE_SCOPE_INDEXED(name, index)
+// not evaluated, but still a statement that uses the variables in @p value
+#define ITM_PROFILE_COUNTER(name, value) ((void)sizeof(value))
+#endif
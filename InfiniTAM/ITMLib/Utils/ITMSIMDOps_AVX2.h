@@ -0,0 +1,52 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+// The AVX2 operations used by the vectorised CPU kernels. Only to be included
+// by the source files that are compiled for this instruction set, see
+// UseSIMD.cmake, and only inside #ifdef WITH_SIMD.
+
+#include <immintrin.h>
+
+namespace
+{
+	struct SIMDOps
+	{
+		enum { W = 8 };
+		typedef __m256 vf;
+		typedef __m256i vi;
+		typedef __m256 mask;
+
+		static inline vf set1(float a) { return _mm256_set1_ps(a); }
+		static inline vi set1i(int a) { return _mm256_set1_epi32(a); }
+		static inline vi loadi(const int *p) { return _mm256_loadu_si256((const __m256i*)p); }
+		static inline vf loadf(const float *p) { return _mm256_loadu_ps(p); }
+		static inline void storef(float *p, vf a) { _mm256_storeu_ps(p, a); }
+
+		static inline vf cvt(vi a) { return _mm256_cvtepi32_ps(a); }
+		static inline vi cvtt(vf a) { return _mm256_cvttps_epi32(a); }
+
+		static inline vf add(vf a, vf b) { return _mm256_add_ps(a, b); }
+		static inline vf sub(vf a, vf b) { return _mm256_sub_ps(a, b); }
+		static inline vf mul(vf a, vf b) { return _mm256_mul_ps(a, b); }
+		static inline vf div(vf a, vf b) { return _mm256_div_ps(a, b); }
+		static inline vf min(vf a, vf b) { return _mm256_min_ps(a, b); }
+		static inline vf max(vf a, vf b) { return _mm256_max_ps(a, b); }
+		static inline vf sqrt(vf a) { return _mm256_sqrt_ps(a); }
+		static inline vf floor(vf a) { return _mm256_floor_ps(a); }
+		// a * 2^n for small integers n
+		static inline vf scale2(vf a, vi n) { return _mm256_mul_ps(a, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23))); }
+		static inline vi addi(vi a, vi b) { return _mm256_add_epi32(a, b); }
+		static inline vi muli(vi a, vi b) { return _mm256_mullo_epi32(a, b); }
+
+		static inline mask gt(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+		static inline mask ge(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+		static inline mask le(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+		static inline mask and_(mask a, mask b) { return _mm256_and_ps(a, b); }
+		static inline int bits(mask m) { return _mm256_movemask_ps(m); }
+		static inline vf select(mask m, vf a, vf b) { return _mm256_blendv_ps(b, a, m); }
+
+		// masked out lanes are not read
+		static inline vf gather(const float *base, vi idx, mask m, vf src) { return _mm256_mask_i32gather_ps(src, base, idx, m, 4); }
+	};
+}
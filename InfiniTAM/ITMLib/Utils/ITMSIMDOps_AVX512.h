@@ -0,0 +1,56 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+// The AVX512 operations used by the vectorised CPU kernels. Only to be included
+// by the source files that are compiled for this instruction set, see
+// UseSIMD.cmake, and only inside #ifdef WITH_SIMD.
+
+#include <immintrin.h>
+
+namespace
+{
+	struct SIMDOps
+	{
+		enum { W = 16 };
+		typedef __m512 vf;
+		typedef __m512i vi;
+		typedef __mmask16 mask;
+
+		static inline vf set1(float a) { return _mm512_set1_ps(a); }
+		static inline vi set1i(int a) { return _mm512_set1_epi32(a); }
+		static inline vi loadi(const int *p) { return _mm512_loadu_si512(p); }
+		static inline vf loadf(const float *p) { return _mm512_loadu_ps(p); }
+		static inline void storef(float *p, vf a) { _mm512_storeu_ps(p, a); }
+
+		// the unmasked forms of some intrinsics pass _mm512_undefined_*() as the source of their masked out
+		// lanes, which GCC reports as maybe uninitialised, so they are written with an explicit zero source
+		static inline mask all(void) { return (mask)0xFFFF; }
+
+		static inline vf cvt(vi a) { return _mm512_mask_cvtepi32_ps(_mm512_setzero_ps(), all(), a); }
+		static inline vi cvtt(vf a) { return _mm512_mask_cvttps_epi32(_mm512_setzero_si512(), all(), a); }
+
+		static inline vf add(vf a, vf b) { return _mm512_add_ps(a, b); }
+		static inline vf sub(vf a, vf b) { return _mm512_sub_ps(a, b); }
+		static inline vf mul(vf a, vf b) { return _mm512_mul_ps(a, b); }
+		static inline vf div(vf a, vf b) { return _mm512_div_ps(a, b); }
+		static inline vf min(vf a, vf b) { return _mm512_mask_min_ps(_mm512_setzero_ps(), all(), a, b); }
+		static inline vf max(vf a, vf b) { return _mm512_mask_max_ps(_mm512_setzero_ps(), all(), a, b); }
+		static inline vf sqrt(vf a) { return _mm512_mask_sqrt_ps(_mm512_setzero_ps(), all(), a); }
+		static inline vf floor(vf a) { return _mm512_mask_roundscale_ps(_mm512_setzero_ps(), all(), a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+		// a * 2^n for small integers n
+		static inline vf scale2(vf a, vi n) { return _mm512_mul_ps(a, _mm512_castsi512_ps(_mm512_mask_slli_epi32(_mm512_setzero_si512(), all(), _mm512_add_epi32(n, _mm512_set1_epi32(127)), 23))); }
+		static inline vi addi(vi a, vi b) { return _mm512_add_epi32(a, b); }
+		static inline vi muli(vi a, vi b) { return _mm512_mullo_epi32(a, b); }
+
+		static inline mask gt(vf a, vf b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+		static inline mask ge(vf a, vf b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+		static inline mask le(vf a, vf b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+		static inline mask and_(mask a, mask b) { return (mask)(a & b); }
+		static inline int bits(mask m) { return (int)m; }
+		static inline vf select(mask m, vf a, vf b) { return _mm512_mask_blend_ps(m, b, a); }
+
+		// masked out lanes are not read
+		static inline vf gather(const float *base, vi idx, mask m, vf src) { return _mm512_mask_i32gather_ps(src, m, idx, base, 4); }
+	};
+}
@@ -0,0 +1,59 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+// The SSE4.1 operations used by the vectorised CPU kernels. Only to be included
+// by the source files that are compiled for this instruction set, see
+// UseSIMD.cmake, and only inside #ifdef WITH_SIMD.
+
+#include <smmintrin.h>
+
+namespace
+{
+	struct SIMDOps
+	{
+		enum { W = 4 };
+		typedef __m128 vf;
+		typedef __m128i vi;
+		typedef __m128 mask;
+
+		static inline vf set1(float a) { return _mm_set1_ps(a); }
+		static inline vi set1i(int a) { return _mm_set1_epi32(a); }
+		static inline vi loadi(const int *p) { return _mm_loadu_si128((const __m128i*)p); }
+		static inline vf loadf(const float *p) { return _mm_loadu_ps(p); }
+		static inline void storef(float *p, vf a) { _mm_storeu_ps(p, a); }
+
+		static inline vf cvt(vi a) { return _mm_cvtepi32_ps(a); }
+		static inline vi cvtt(vf a) { return _mm_cvttps_epi32(a); }
+
+		static inline vf add(vf a, vf b) { return _mm_add_ps(a, b); }
+		static inline vf sub(vf a, vf b) { return _mm_sub_ps(a, b); }
+		static inline vf mul(vf a, vf b) { return _mm_mul_ps(a, b); }
+		static inline vf div(vf a, vf b) { return _mm_div_ps(a, b); }
+		static inline vf min(vf a, vf b) { return _mm_min_ps(a, b); }
+		static inline vf max(vf a, vf b) { return _mm_max_ps(a, b); }
+		static inline vf sqrt(vf a) { return _mm_sqrt_ps(a); }
+		static inline vf floor(vf a) { return _mm_floor_ps(a); }
+		// a * 2^n for small integers n
+		static inline vf scale2(vf a, vi n) { return _mm_mul_ps(a, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23))); }
+		static inline vi addi(vi a, vi b) { return _mm_add_epi32(a, b); }
+		static inline vi muli(vi a, vi b) { return _mm_mullo_epi32(a, b); }
+
+		static inline mask gt(vf a, vf b) { return _mm_cmpgt_ps(a, b); }
+		static inline mask ge(vf a, vf b) { return _mm_cmpge_ps(a, b); }
+		static inline mask le(vf a, vf b) { return _mm_cmple_ps(a, b); }
+		static inline mask and_(mask a, mask b) { return _mm_and_ps(a, b); }
+		static inline int bits(mask m) { return _mm_movemask_ps(m); }
+		static inline vf select(mask m, vf a, vf b) { return _mm_blendv_ps(b, a, m); }
+
+		// there is no gather before AVX2
+		static inline vf gather(const float *base, vi idx, mask m, vf src)
+		{
+			int idx_s[W], m_s = bits(m); float res[W];
+			_mm_storeu_si128((__m128i*)idx_s, idx);
+			_mm_storeu_ps(res, src);
+			for (int i = 0; i < W; i++) if (m_s & (1 << i)) res[i] = base[idx_s[i]];
+			return _mm_loadu_ps(res);
+		}
+	};
+}
@@ -42,16 +42,37 @@ namespace ITMLib
 		/** Stop integration once maxW has been reached. */
 		bool stopIntegratingAtMaxW;
 
+		/** Number of 8x8x8 blocks the local voxel block array can hold initially. */
+		int noVoxelBlocks;
+
+		/** Number of buckets in the ordered part of the hash table, must be a power of two. */
+		int noHashBuckets;
+
+		/** Number of entries in the excess list of the hash table initially. */
+		int noExcessListEntries;
+
+		/** Grow the voxel block array and the excess list when
+		    allocation runs out of free entries, rather than
+		    dropping the new blocks. Not supported together with
+		    swapping, which needs a bounded voxel block array.
+		*/
+		bool allowHashGrowth;
+
 		ITMSceneParams(void) {}
 
 		ITMSceneParams(float mu, int maxW, float voxelSize, 
-			float viewFrustum_min, float viewFrustum_max, bool stopIntegratingAtMaxW)
+			float viewFrustum_min, float viewFrustum_max, bool stopIntegratingAtMaxW,
+			int noVoxelBlocks, int noHashBuckets, int noExcessListEntries, bool allowHashGrowth)
 		{
 			this->mu = mu;
 			this->maxW = maxW;
 			this->voxelSize = voxelSize;
 			this->viewFrustum_min = viewFrustum_min; this->viewFrustum_max = viewFrustum_max;
 			this->stopIntegratingAtMaxW = stopIntegratingAtMaxW;
+			this->noVoxelBlocks = noVoxelBlocks;
+			this->noHashBuckets = noHashBuckets;
+			this->noExcessListEntries = noExcessListEntries;
+			this->allowHashGrowth = allowHashGrowth;
 		}
 
 		explicit ITMSceneParams(const ITMSceneParams *sceneParams) { this->SetFrom(sceneParams); }
@@ -64,6 +85,10 @@ namespace ITMLib
 			this->mu = sceneParams->mu;
 			this->maxW = sceneParams->maxW;
 			this->stopIntegratingAtMaxW = sceneParams->stopIntegratingAtMaxW;
+			this->noVoxelBlocks = sceneParams->noVoxelBlocks;
+			this->noHashBuckets = sceneParams->noHashBuckets;
+			this->noExcessListEntries = sceneParams->noExcessListEntries;
+			this->allowHashGrowth = sceneParams->allowHashGrowth;
 		}
 	};
 }
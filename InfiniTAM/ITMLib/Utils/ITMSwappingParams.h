@@ -0,0 +1,94 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <string>
+
+namespace ITMLib
+{
+	/** \brief
+	    Stores parameters of the host side store of swapped out voxel
+	    blocks, see ITMGlobalCache, and of the swapping engines. Only
+	    the eviction settings are also used with
+	    ITMLibSettings::SWAPPINGMODE_DELETE.
+	*/
+	class ITMSwappingParams
+	{
+	public:
+		typedef enum
+		{
+			//! Evict every block that is out of view, in the order of the hash table
+			EVICTIONPOLICY_INVISIBLE,
+			//! Evict the blocks that were seen least recently, and only while more than maxActiveBlocks are in use
+			EVICTIONPOLICY_LEAST_RECENTLY_SEEN
+		} EvictionPolicy;
+
+		/// Which blocks are swapped out of or deleted from active memory
+		EvictionPolicy evictionPolicy;
+
+		/** \brief
+		    With EVICTIONPOLICY_LEAST_RECENTLY_SEEN, the number of
+		    blocks that may stay in active memory. If 0,
+		    ITMSceneParams::noVoxelBlocks less SDF_TRANSFER_BLOCK_NUM
+		    blocks, which are kept free for new blocks. This does not
+		    grow with the voxel block array under allowHashGrowth.
+		*/
+		int maxActiveBlocks;
+
+		/** With EVICTIONPOLICY_LEAST_RECENTLY_SEEN, blocks seen in
+		    the last minEvictionAge frames are never evicted, so that
+		    blocks at the border of the view do not go back and forth.
+		*/
+		int minEvictionAge;
+
+		/** Copy blocks to and from the store on a background thread,
+		    which delays swapping in by a frame.
+		*/
+		bool useAsyncTransfers;
+
+		/** \brief
+		    Directory for a file that holds the blocks which do not
+		    fit into host memory. If empty, all swapped out blocks
+		    are kept in host memory.
+		*/
+		std::string diskStoreDirectory;
+
+		/** Number of blocks kept in host memory when there is a disk store. */
+		int maxHostBlocks;
+
+		/** \brief
+		    Compress the blocks kept in host memory, see
+		    ITMVoxelBlockCompressor. Expect about 3x for ITMVoxel_s,
+		    and 5x with quantiseBlocks, rather than an order of
+		    magnitude: the SDF near surfaces is noisy, and losslessly
+		    those bits have to be kept. Compressing costs about as
+		    much time as the rest of swapping.
+		*/
+		bool compressBlocks;
+
+		/** Quantise the SDF to 8 bits and the colour to RGB565 in compressed blocks, which is lossy. */
+		bool quantiseBlocks;
+
+		/** \brief
+		    Maximum number of stored blocks fetched per frame ahead of
+		    the camera, whose next pose is predicted from its motion.
+		    0 disables prefetching, so that blocks are only fetched
+		    once they are visible.
+		*/
+		int maxPrefetchBlocks;
+
+		ITMSwappingParams(void)
+		{
+			evictionPolicy = EVICTIONPOLICY_INVISIBLE;
+			maxActiveBlocks = 0;
+			minEvictionAge = 5;
+			useAsyncTransfers = false;
+			maxHostBlocks = 0x10000;
+			compressBlocks = false;
+			quantiseBlocks = false;
+			maxPrefetchBlocks = 0;
+		}
+
+		bool UsesDiskStore(void) const { return !diskStoreDirectory.empty() && maxHostBlocks > 0; }
+	};
+}
@@ -0,0 +1,123 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "ITMWorkerThread.h"
+
+#include <stdlib.h>
+
+#ifndef NO_CPP11
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#endif
+
+using namespace ITMLib;
+
+struct ITMWorkerThread::PrivateData
+{
+	PrivateData(void)
+	{
+		task = NULL;
+		data = NULL;
+
+#ifndef NO_CPP11
+		hasTask = false;
+		stopThread = false;
+		workerThread = std::thread(&PrivateData::run, this);
+#endif
+	}
+
+	~PrivateData(void)
+	{
+#ifndef NO_CPP11
+		{
+			std::lock_guard<std::mutex> lock(taskMutex);
+			stopThread = true;
+		}
+		taskChanged.notify_all();
+		workerThread.join();
+#endif
+	}
+
+#ifndef NO_CPP11
+	void run(void)
+	{
+		std::unique_lock<std::mutex> lock(taskMutex);
+		while (true)
+		{
+			taskChanged.wait(lock, [this] { return hasTask || stopThread; });
+			if (stopThread) break;
+
+			lock.unlock();
+			std::exception_ptr exception;
+			try { task(data); }
+			catch (...) { exception = std::current_exception(); }
+			lock.lock();
+
+			taskException = exception;
+			hasTask = false;
+			taskChanged.notify_all();
+		}
+	}
+
+	std::thread workerThread;
+	std::mutex taskMutex;
+	std::condition_variable taskChanged;
+	bool hasTask, stopThread;
+	/// Thrown by the current task, rethrown on the calling thread by Wait()
+	std::exception_ptr taskException;
+#endif
+
+	// the current task
+	Task task;
+	void *data;
+};
+
+ITMWorkerThread::ITMWorkerThread(void)
+{
+	privateData = new PrivateData();
+}
+
+ITMWorkerThread::~ITMWorkerThread(void)
+{
+	// the exception of an unawaited task is dropped, destructors must not throw
+	WaitForTask();
+	delete privateData;
+}
+
+void ITMWorkerThread::Start(Task task, void *data)
+{
+	Wait();
+
+	privateData->task = task;
+	privateData->data = data;
+
+#ifndef NO_CPP11
+	{
+		std::lock_guard<std::mutex> lock(privateData->taskMutex);
+		privateData->hasTask = true;
+	}
+	privateData->taskChanged.notify_all();
+#else
+	task(data);
+#endif
+}
+
+void ITMWorkerThread::Wait(void)
+{
+	WaitForTask();
+
+#ifndef NO_CPP11
+	std::exception_ptr exception = privateData->taskException;
+	privateData->taskException = nullptr;
+	if (exception) std::rethrow_exception(exception);
+#endif
+}
+
+void ITMWorkerThread::WaitForTask(void)
+{
+#ifndef NO_CPP11
+	std::unique_lock<std::mutex> lock(privateData->taskMutex);
+	privateData->taskChanged.wait(lock, [this] { return !privateData->hasTask; });
+#endif
+}
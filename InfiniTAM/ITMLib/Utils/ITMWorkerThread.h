@@ -0,0 +1,44 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+namespace ITMLib
+{
+	/** \brief
+	    A thread that runs one task at a time in the background, e.g.
+	    host side transfers that can overlap with the next frame.
+
+	    The thread is kept for the lifetime of the object. Without
+	    C++11 the tasks run synchronously in Start().
+
+	    An exception thrown by a task is caught on the thread and
+	    rethrown by the next Wait(), or by Start() as it waits.
+	*/
+	class ITMWorkerThread
+	{
+	public:
+		typedef void (*Task)(void *data);
+
+	private:
+		struct PrivateData;
+		PrivateData *privateData;
+
+		// Suppress the default copy constructor and assignment operator
+		ITMWorkerThread(const ITMWorkerThread&);
+		ITMWorkerThread& operator=(const ITMWorkerThread&);
+
+		/// As Wait(), without rethrowing the exception of the task
+		void WaitForTask(void);
+
+	public:
+		ITMWorkerThread(void);
+		/// Waits for the current task before the thread is stopped
+		~ITMWorkerThread(void);
+
+		/// Runs task(data) on the thread, after waiting for the previous task
+		void Start(Task task, void *data);
+
+		/// Waits until the last task passed to Start() has finished, and rethrows its exception, if any
+		void Wait(void);
+	};
+}
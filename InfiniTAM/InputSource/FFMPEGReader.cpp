@@ -24,11 +24,17 @@ extern "C" {
 #include <libavutil/pixdesc.h>
 }
 
+#include <condition_variable>
 #include <deque>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 using namespace InputSource;
 
+/** Demuxes, decodes and filters one file in a background thread, which
+    keeps a bounded queue of filtered frames per wanted stream filled.
+*/
 class FFMPEGReader::PrivateData {
 	private:
 	typedef struct FilteringContext {
@@ -37,89 +43,75 @@ class FFMPEGReader::PrivateData {
 		AVFilterGraph *filter_graph;
 	} FilteringContext;
 
+	/** The background thread stops decoding once every wanted stream has this many frames queued. */
+	static const size_t maxQueuedFrames = 8;
+
 	public:
 	PrivateData(void)
 	{
 		depthStreamIdx = colorStreamIdx = -1;
+		depthImageSize = colorImageSize = Vector2i(0,0);
 		av_init_packet(&packet);
 		packet.data = NULL;
 		packet.size = 0;
 		frame = NULL;
 		ifmt_ctx = NULL;
 		filter_ctx = NULL;
+		wantColor = wantDepth = true;
+		decodingFinished = true;
+		stopDecoding = false;
 	}
 
 	~PrivateData(void)
 	{
+		stopDecodingThread();
+		flushQueue(true);
+		flushQueue(false);
 		av_packet_unref(&packet);
 		av_frame_free(&frame);
 	}
 
-	bool open(const char *filename);
-	bool readFrames(void);
+	/** Streams that are not wanted, e.g. because another file provides
+	    them, are neither decoded nor queued.
+	*/
+	bool open(const char *filename, bool wantColor = true, bool wantDepth = true);
 	bool close(void);
 
+	// the sizes are read when opening the file, as the decoder contexts belong to the background thread afterwards
 	Vector2i getDepthImageSize(void) const
-	{
-		if (!providesDepth()) return Vector2i(0,0);
-		AVCodecContext *dec_ctx = ifmt_ctx->streams[depthStreamIdx]->codec;
-		return Vector2i(dec_ctx->width, dec_ctx->height);
-		//return Vector2i(dec_ctx->width + 128, dec_ctx->height + 96);
-	}
-
+	{ return depthImageSize; }
 	Vector2i getColorImageSize(void) const
-	{
-		if (!providesColor()) return Vector2i(0,0);
-		AVCodecContext *dec_ctx = ifmt_ctx->streams[colorStreamIdx]->codec;
-		return Vector2i(dec_ctx->width, dec_ctx->height);
-	}
+	{ return colorImageSize; }
 
 	bool providesDepth(void) const
 	{ return (depthStreamIdx >= 0); }
-	bool hasQueuedDepth(void) const
-	{ return (depthFrames.size()>0); }
+	/** Waits for the next depth frame, returns NULL at the end of the file. */
 	AVFrame* getFromDepthQueue(void)
-	{
-		if (depthFrames.size() == 0) return NULL;
-		AVFrame *ret = depthFrames.front();
-		depthFrames.pop_front();
-		return ret;
-	}
+	{ return popQueue(depthFrames); }
 
 	bool providesColor(void) const
 	{ return (colorStreamIdx >= 0); }
-	bool hasQueuedColor(void) const
-	{ return (colorFrames.size()>0); }
+	/** Waits for the next colour frame, returns NULL at the end of the file. */
 	AVFrame* getFromColorQueue(void)
-	{
-		if (colorFrames.size() == 0) return NULL;
-		AVFrame *ret = colorFrames.front();
-		colorFrames.pop_front();
-		return ret;
-	}
+	{ return popQueue(colorFrames); }
 
 	bool hasMoreImages(void)
 	{
-		//fprintf(stderr, "check: %i %i %i %i\n", providesColor(), hasQueuedColor(), providesDepth(), hasQueuedDepth());
-		if (providesColor()) {
-			if (!hasQueuedColor()) readFrames();
-			if (!hasQueuedColor()) return false;
-		}
-		if (providesDepth()) {
-			if (!hasQueuedDepth()) readFrames();
-			if (!hasQueuedDepth()) return false;
-		}
+		std::unique_lock<std::mutex> lock(queueMutex);
+		if (providesColor() && wantColor && !waitForQueue(colorFrames, lock)) return false;
+		if (providesDepth() && wantDepth && !waitForQueue(depthFrames, lock)) return false;
 		return true;
 	}
 	void flushQueue(bool depth)
 	{
-		while (true) {
-			AVFrame *tmp;
-			if (depth) tmp = getFromDepthQueue();
-			else tmp = getFromColorQueue();
-			if (tmp == NULL) break;
+		std::lock_guard<std::mutex> lock(queueMutex);
+		std::deque<AVFrame*> &frames = depth ? depthFrames : colorFrames;
+		while (!frames.empty()) {
+			AVFrame *tmp = frames.front();
+			frames.pop_front();
 			av_frame_free(&tmp);
 		}
+		queueChanged.notify_all();
 	}
 
 	private:
@@ -129,16 +121,53 @@ class FFMPEGReader::PrivateData {
 	int filter_decode_frame(AVFrame *frame, int stream_index);
 	void flush_decoder_and_filter(void);
 
+	bool wantsStream(int stream_index) const
+	{ return ((stream_index == colorStreamIdx)&&wantColor) || ((stream_index == depthStreamIdx)&&wantDepth); }
+	bool needsFrames(void) const
+	{
+		return (providesColor() && wantColor && (colorFrames.size() < maxQueuedFrames)) ||
+		       (providesDepth() && wantDepth && (depthFrames.size() < maxQueuedFrames));
+	}
+	bool waitForQueue(const std::deque<AVFrame*> &frames, std::unique_lock<std::mutex> &lock)
+	{
+		while (frames.empty() && !decodingFinished) queueChanged.wait(lock);
+		return !frames.empty();
+	}
+	AVFrame* popQueue(std::deque<AVFrame*> &frames)
+	{
+		std::unique_lock<std::mutex> lock(queueMutex);
+		if (!waitForQueue(frames, lock)) return NULL;
+		AVFrame *ret = frames.front();
+		frames.pop_front();
+		queueChanged.notify_all();
+		return ret;
+	}
+
+	/** Decodes and filters the next packet of a wanted stream, returns false at the end of the file or on errors. */
+	bool decodeNextPacket(void);
+	/** The body of the background thread. */
+	void decodeFrames(void);
+	void stopDecodingThread(void);
+
 	AVFormatContext *ifmt_ctx;
 	FilteringContext *filter_ctx;
 
+	// only used by the background thread once it is running
 	AVPacket packet;
 	AVFrame *frame;
 
 	int depthStreamIdx;
 	int colorStreamIdx;
+	Vector2i depthImageSize, colorImageSize;
+	bool wantColor, wantDepth;
+
+	// the queues and flags below are protected by queueMutex
 	std::deque<AVFrame*> depthFrames;
 	std::deque<AVFrame*> colorFrames;
+	bool decodingFinished, stopDecoding;
+	std::mutex queueMutex;
+	std::condition_variable queueChanged;
+	std::thread decodingThread;
 };
 
 int FFMPEGReader::PrivateData::open_input_file(const char *filename)
@@ -160,7 +189,9 @@ int FFMPEGReader::PrivateData::open_input_file(const char *filename)
 		codec_ctx = stream->codec;
 		/* Reencode video & audio and remux subtitles etc. */
 		if (codec_ctx->codec_type == AVMEDIA_TYPE_VIDEO) {
-			/* Open decoder */
+			/* Open decoder, letting libavcodec decode several frames and slices in parallel */
+			codec_ctx->thread_count = 0;
+			codec_ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
 			ret = avcodec_open2(codec_ctx, avcodec_find_decoder(codec_ctx->codec_id), NULL);
 			if (ret < 0) {
 				std::cerr << "Failed to open decoder for stream #" << i << std::endl;
@@ -301,19 +332,37 @@ int FFMPEGReader::PrivateData::filter_decode_frame(AVFrame *frame, int stream_in
 		}
 		filt_frame->pict_type = AV_PICTURE_TYPE_NONE;
 
-		if (stream_index == depthStreamIdx) depthFrames.push_back(filt_frame);
-		else if (stream_index == colorStreamIdx) colorFrames.push_back(filt_frame);
+		std::lock_guard<std::mutex> lock(queueMutex);
+		if ((stream_index == depthStreamIdx)&&wantDepth) depthFrames.push_back(filt_frame);
+		else if ((stream_index == colorStreamIdx)&&wantColor) colorFrames.push_back(filt_frame);
 		else av_frame_free(&filt_frame);
+		queueChanged.notify_all();
 	}
 	return ret;
 }
 
-bool FFMPEGReader::PrivateData::open(const char *filename)
+bool FFMPEGReader::PrivateData::open(const char *filename, bool wantColor, bool wantDepth)
 {
+	this->wantColor = wantColor;
+	this->wantDepth = wantDepth;
+
 	av_register_all();
 	avfilter_register_all();
 	if (open_input_file(filename) < 0) return false;
 	if (init_filters() < 0) return false;
+
+	if (providesDepth()) {
+		AVCodecContext *dec_ctx = ifmt_ctx->streams[depthStreamIdx]->codec;
+		depthImageSize = Vector2i(dec_ctx->width, dec_ctx->height);
+	}
+	if (providesColor()) {
+		AVCodecContext *dec_ctx = ifmt_ctx->streams[colorStreamIdx]->codec;
+		colorImageSize = Vector2i(dec_ctx->width, dec_ctx->height);
+	}
+
+	decodingFinished = false;
+	stopDecoding = false;
+	decodingThread = std::thread(&PrivateData::decodeFrames, this);
 	return true;
 }
 
@@ -328,7 +377,7 @@ void FFMPEGReader::PrivateData::flush_decoder_and_filter(void)
 
 	/* flush filters and decoders */
 	for (int i = 0; (unsigned int)i < ifmt_ctx->nb_streams; i++) {
-		if ((i != colorStreamIdx)&&(i != depthStreamIdx)) continue;
+		if (!wantsStream(i)) continue;
 		if (filter_ctx[i].filter_graph == NULL) continue;
 
 		/* flush decoder */
@@ -361,58 +410,80 @@ end:
 	return;
 }
 
-bool FFMPEGReader::PrivateData::readFrames(void)
+bool FFMPEGReader::PrivateData::decodeNextPacket(void)
 {
 	int ret = 0;
-	int stream_index;
 	int got_frame;
 
-	while (1) {
-		// do we have to read more images?
-		bool waitForColor = providesColor()&&(!hasQueuedColor());
-		bool waitForDepth = providesDepth()&&(!hasQueuedDepth());
-		if ((!waitForColor)&&(!waitForDepth)) break;
-
-		// read packets
-		if ((ret = av_read_frame(ifmt_ctx, &packet)) < 0) {
-			flush_decoder_and_filter();
-			break;
-		}
-		stream_index = packet.stream_index;
-		if ((stream_index != colorStreamIdx)&&(stream_index != depthStreamIdx)) continue;
-		if (filter_ctx[stream_index].filter_graph) {
-			frame = av_frame_alloc();
-			if (!frame) {
-				ret = AVERROR(ENOMEM);
-				break;
-			}
-			av_packet_rescale_ts(&packet,
-			     ifmt_ctx->streams[stream_index]->time_base,
-			     ifmt_ctx->streams[stream_index]->codec->time_base);
-			ret = avcodec_decode_video2(ifmt_ctx->streams[stream_index]->codec, frame, &got_frame, &packet);
-			if (ret < 0) {
-				av_frame_free(&frame);
-				std::cerr << "Decoding failed" << std::endl;
-				break;
-			}
-			if (got_frame) {
-				frame->pts = av_frame_get_best_effort_timestamp(frame);
-				ret = filter_decode_frame(frame, stream_index);
-				av_frame_free(&frame);
-				//if (ret < 0) goto end;
-				break;
-			} else {
-				av_frame_free(&frame);
-			}
-		}
+	// read packets
+	if (av_read_frame(ifmt_ctx, &packet) < 0) {
+		flush_decoder_and_filter();
+		return false;
+	}
+	int stream_index = packet.stream_index;
+	if ((!wantsStream(stream_index))||(filter_ctx[stream_index].filter_graph == NULL)) {
+		av_packet_unref(&packet);
+		return true;
+	}
+
+	frame = av_frame_alloc();
+	if (!frame) {
 		av_packet_unref(&packet);
+		return false;
+	}
+	av_packet_rescale_ts(&packet,
+	     ifmt_ctx->streams[stream_index]->time_base,
+	     ifmt_ctx->streams[stream_index]->codec->time_base);
+	ret = avcodec_decode_video2(ifmt_ctx->streams[stream_index]->codec, frame, &got_frame, &packet);
+	av_packet_unref(&packet);
+	if (ret < 0) {
+		av_frame_free(&frame);
+		std::cerr << "Decoding failed" << std::endl;
+		return false;
+	}
+	if (got_frame) {
+		frame->pts = av_frame_get_best_effort_timestamp(frame);
+		ret = filter_decode_frame(frame, stream_index);
 	}
+	av_frame_free(&frame);
 
-	return (ret == 0);
+	return (ret >= 0);
+}
+
+void FFMPEGReader::PrivateData::decodeFrames(void)
+{
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			while (!stopDecoding && !needsFrames()) queueChanged.wait(lock);
+			if (stopDecoding) break;
+		}
+
+		if (!decodeNextPacket()) break;
+	}
+
+	std::lock_guard<std::mutex> lock(queueMutex);
+	decodingFinished = true;
+	queueChanged.notify_all();
+}
+
+void FFMPEGReader::PrivateData::stopDecodingThread(void)
+{
+	if (!decodingThread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopDecoding = true;
+	}
+	queueChanged.notify_all();
+	decodingThread.join();
 }
 
 bool FFMPEGReader::PrivateData::close(void)
 {
+	stopDecodingThread();
+	flushQueue(true);
+	flushQueue(false);
+
 	if (ifmt_ctx != NULL) {
 		for (unsigned int i = 0; i < ifmt_ctx->nb_streams; i++) {
 			avcodec_close(ifmt_ctx->streams[i]->codec);
@@ -433,8 +504,9 @@ FFMPEGReader::FFMPEGReader(const char *calibFilename, const char *filename1, con
 	isValid = mData1->open(filename1);
 
 	if (isValid && (filename2 != NULL)) {
+		// only decode what the first file does not provide
 		mData2 = new PrivateData();
-		mData2->open(filename2);
+		mData2->open(filename2, !mData1->providesColor(), !mData1->providesDepth());
 	} else {
 		mData2 = NULL;
 	}
@@ -483,48 +555,23 @@ void FFMPEGReader::getImages(ITMUChar4Image *rgbImage, ITMShortImage *depthImage
 	bool gotColour = false;
 	bool gotDepth = false;
 	if (isValid) {
-		if (mData1->providesColor()) {
-			if (mData2 != NULL) mData2->flushQueue(false);
-
-			if (!mData1->hasQueuedColor()) mData1->readFrames();
-			if (mData1->hasQueuedColor()) {
-				AVFrame *frame = mData1->getFromColorQueue();
-				copyRgba(frame, rgb);
-				av_frame_free(&frame);
-
-				gotColour = true;
-			}
-		} else if (mData2 != NULL) if (mData2->providesColor()) {
-			if (!mData2->hasQueuedColor()) mData2->readFrames();
-			if (mData2->hasQueuedColor()) {
-				AVFrame *frame = mData2->getFromColorQueue();
-				copyRgba(frame, rgb);
-				av_frame_free(&frame);
+		AVFrame *frame = NULL;
+		if (mData1->providesColor()) frame = mData1->getFromColorQueue();
+		else if (mData2 != NULL) if (mData2->providesColor()) frame = mData2->getFromColorQueue();
+		if (frame != NULL) {
+			copyRgba(frame, rgb);
+			av_frame_free(&frame);
 
-				gotColour = true;
-			}
+			gotColour = true;
 		}
 
-		if (mData1->providesDepth()) {
-			if (mData2 != NULL) mData2->flushQueue(true);
-
-			if (!mData1->hasQueuedDepth()) mData1->readFrames();
-			if (mData1->hasQueuedDepth()) {
-				AVFrame *frame = mData1->getFromDepthQueue();
-				copyDepth(frame, depth);
-				av_frame_free(&frame);
-
-				gotDepth = true;
-			}
-		} else if (mData2 != NULL) if (mData2->providesDepth()) {
-			if (!mData2->hasQueuedDepth()) mData2->readFrames();
-			if (mData2->hasQueuedDepth()) {
-				AVFrame *frame = mData2->getFromDepthQueue();
-				copyDepth(frame, depth);
-				av_frame_free(&frame);
+		if (mData1->providesDepth()) frame = mData1->getFromDepthQueue();
+		else if (mData2 != NULL) if (mData2->providesDepth()) frame = mData2->getFromDepthQueue();
+		if (frame != NULL) {
+			copyDepth(frame, depth);
+			av_frame_free(&frame);
 
-				gotDepth = true;
-			}
+			gotDepth = true;
 		}
 	}
 	if (!gotColour) memset(rgb, 0, rgbImage->dataSize * sizeof(Vector4u));
@@ -25,12 +25,26 @@ extern "C" {
 #include <libavutil/imgutils.h>
 }
 
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <string.h>
+#include <thread>
+#include <vector>
 
 using namespace InputSource;
 
 class FFMPEGWriter::PrivateData {
 	public:
+	PrivateData(size_t queueCapacity, FullQueuePolicy fullQueuePolicy)
+	{
+		ofmt_ctx = NULL;
+		queue.resize(queueCapacity > 0 ? queueCapacity : 1, NULL);
+		this->fullQueuePolicy = fullQueuePolicy;
+		queueHead = noQueuedFrames = noDroppedFrames = 0;
+		encodingFailed = stopEncoding = false;
+	}
+
 	int open(const char *filename, int size_x, int size_y, bool isDepth, int fps);
 	int init_filters(void);
 	int encode_write_frame(AVFrame *filt_frame, unsigned int stream_index, int *got_frame);
@@ -38,7 +52,24 @@ class FFMPEGWriter::PrivateData {
 	int flush_encoder(unsigned int stream_index);
 	int close(void);
 
-	AVFrame* getFrame(void) { return frame; }
+	void startEncoderThread(void);
+	/** Returns a free frame of the queue to copy the next image into,
+	    or NULL if the frame is dropped or encoding has failed.
+	*/
+	AVFrame* beginFrame(void);
+	/** Hands the frame returned by beginFrame() to the encoder thread. */
+	void endFrame(void);
+
+	size_t getNoQueuedFrames(void)
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		return noQueuedFrames;
+	}
+	size_t getNoDroppedFrames(void)
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		return noDroppedFrames;
+	}
 
 	private:
 	typedef struct FilteringContext {
@@ -47,15 +78,28 @@ class FFMPEGWriter::PrivateData {
 		AVFilterGraph *filter_graph;
 	} FilteringContext;
 
-	void allocFrame(bool isDepth);
-	void freeFrame(void);
+	AVFrame* allocFrame(bool isDepth);
+	static void freeFrame(AVFrame *frame);
 	static int init_filter(FilteringContext* fctx, AVCodecContext *enc_ctx, const char *filter_spec);
 
+	/** The body of the encoder thread. */
+	void encodeFrames(void);
 
 	AVFormatContext *ofmt_ctx;
-	AVFrame *frame;
 
 	FilteringContext filter_ctx;
+
+	// a ring of preallocated frames, the encoder thread owns the
+	// noQueuedFrames frames starting at queueHead
+	std::vector<AVFrame*> queue;
+	FullQueuePolicy fullQueuePolicy;
+
+	// protected by queueMutex
+	size_t queueHead, noQueuedFrames, noDroppedFrames;
+	bool encodingFailed, stopEncoding;
+	std::mutex queueMutex;
+	std::condition_variable queueChanged;
+	std::thread encoderThread;
 };
 
 int FFMPEGWriter::PrivateData::open(const char *filename, int size_x, int size_y, bool isDepth, int fps)
@@ -126,7 +170,10 @@ int FFMPEGWriter::PrivateData::open(const char *filename, int size_x, int size_y
 		return ret;
 	}
 
-	allocFrame(isDepth);
+	for (size_t i = 0; i < queue.size(); ++i) {
+		queue[i] = allocFrame(isDepth);
+		if (queue[i] == NULL) return -1;
+	}
 
 	return 0;
 }
@@ -295,9 +342,69 @@ int FFMPEGWriter::PrivateData::flush_encoder(unsigned int stream_index)
 	return ret;
 }
 
+void FFMPEGWriter::PrivateData::startEncoderThread(void)
+{
+	queueHead = noQueuedFrames = noDroppedFrames = 0;
+	encodingFailed = stopEncoding = false;
+	encoderThread = std::thread(&PrivateData::encodeFrames, this);
+}
+
+AVFrame* FFMPEGWriter::PrivateData::beginFrame(void)
+{
+	std::unique_lock<std::mutex> lock(queueMutex);
+	if (fullQueuePolicy == BLOCK_WHEN_FULL) {
+		while ((noQueuedFrames == queue.size())&&(!encodingFailed)) queueChanged.wait(lock);
+	} else if (noQueuedFrames == queue.size()) {
+		++noDroppedFrames;
+		return NULL;
+	}
+	if (encodingFailed) return NULL;
+
+	return queue[(queueHead + noQueuedFrames) % queue.size()];
+}
+
+void FFMPEGWriter::PrivateData::endFrame(void)
+{
+	std::lock_guard<std::mutex> lock(queueMutex);
+	++noQueuedFrames;
+	queueChanged.notify_all();
+}
+
+void FFMPEGWriter::PrivateData::encodeFrames(void)
+{
+	std::unique_lock<std::mutex> lock(queueMutex);
+	while (true) {
+		while ((noQueuedFrames == 0)&&(!stopEncoding)) queueChanged.wait(lock);
+		if (noQueuedFrames == 0) break;
+
+		// the frame at the head is not touched by writeFrame() until it is released below
+		AVFrame *frame = queue[queueHead];
+		bool skip = encodingFailed;
+		lock.unlock();
+		int ret = skip ? 0 : filter_encode_write_frame(frame, /*stream_index*/0);
+		lock.lock();
+
+		if (ret < 0) encodingFailed = true;
+		queueHead = (queueHead + 1) % queue.size();
+		--noQueuedFrames;
+		queueChanged.notify_all();
+	}
+}
+
 int FFMPEGWriter::PrivateData::close(void)
 {
 	int ret = 0;
+
+	/* encode everything that is still queued */
+	if (encoderThread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			stopEncoding = true;
+		}
+		queueChanged.notify_all();
+		encoderThread.join();
+	}
+
         /* flush filter */
 	do {
 	        if (!filter_ctx.filter_graph) continue;
@@ -326,19 +433,22 @@ end:
 	if (ret < 0)
 		std::cerr << "Error occurred: " /* << std::string(av_err2str(ret)) */<< std::endl;
 
-	freeFrame();
+	for (size_t i = 0; i < queue.size(); ++i) {
+		freeFrame(queue[i]);
+		queue[i] = NULL;
+	}
 	return ret;
 }
 
-void FFMPEGWriter::PrivateData::allocFrame(bool isDepth)
+AVFrame* FFMPEGWriter::PrivateData::allocFrame(bool isDepth)
 {
 	AVCodecContext *enc_ctx = ofmt_ctx->streams[0]->codec; 
 	int ret = 0;
 
-	frame = av_frame_alloc();
+	AVFrame *frame = av_frame_alloc();
 	if (!frame) {
 		std::cerr << "Could not allocate video frame" << std::endl;
-		return;
+		return NULL;
 	}
 	frame->format = isDepth?AV_PIX_FMT_GRAY16LE:AV_PIX_FMT_RGBA;
 	frame->width  = enc_ctx->width;
@@ -349,20 +459,23 @@ void FFMPEGWriter::PrivateData::allocFrame(bool isDepth)
 
 	if (ret < 0) {
 		fprintf(stderr, "Could not allocate raw picture buffer\n");
-		return;
+		av_frame_free(&frame);
+		return NULL;
 	}
+	return frame;
 }
 
-void FFMPEGWriter::PrivateData::freeFrame(void)
+void FFMPEGWriter::PrivateData::freeFrame(AVFrame *frame)
 {
+	if (frame == NULL) return;
 	av_freep(&frame->data[0]);
 	av_frame_free(&frame);
 }
 
 
-FFMPEGWriter::FFMPEGWriter(void)
+FFMPEGWriter::FFMPEGWriter(size_t queueCapacity, FullQueuePolicy fullQueuePolicy)
 {
-	mData = new PrivateData();
+	mData = new PrivateData(queueCapacity, fullQueuePolicy);
 	counter = -1;
 }
 
@@ -382,6 +495,7 @@ bool FFMPEGWriter::open(const char *filename, int size_x, int size_y, bool isDep
 	avfilter_register_all();
 	if ((ret = mData->open(filename, size_x, size_y, isDepth, fps)) < 0) return false;
 	if ((ret = mData->init_filters()) < 0) return false;
+	mData->startEncoderThread();
 
 	counter = 0;
 	return true;
@@ -392,7 +506,8 @@ bool FFMPEGWriter::writeFrame(ITMUChar4Image *rgbImage)
 {
 	if (!isOpen()) return false;
 
-	AVFrame *frame = mData->getFrame();
+	AVFrame *frame = mData->beginFrame();
+	if (frame == NULL) return false;
 
 	if ((frame->format != AV_PIX_FMT_RGBA)||(frame->width != rgbImage->noDims.x)||(frame->height != rgbImage->noDims.y)) {
 		std::cerr << "FFMPEGWriter: wrong image format for rgb stream" << std::endl;
@@ -407,28 +522,30 @@ bool FFMPEGWriter::writeFrame(ITMUChar4Image *rgbImage)
 	}
 
 	frame->pts = counter++;
-	int ret = mData->filter_encode_write_frame(frame, /*stream_index*/0);
-	return (ret>=0);
+	mData->endFrame();
+	return true;
 }
 
 bool FFMPEGWriter::writeFrame(ITMShortImage *depthImage)
 {
 	if (!isOpen()) return false;
 
-	AVFrame *frame = mData->getFrame();
+	AVFrame *frame = mData->beginFrame();
+	if (frame == NULL) return false;
 
 	if ((frame->format != AV_PIX_FMT_GRAY16LE)||(frame->width != depthImage->noDims.x)||(frame->height != depthImage->noDims.y)) {
 		std::cerr << "FFMPEGWriter: wrong image format for depth stream" << std::endl;
 	}
 
+	// the image may change as soon as this returns, so it is copied as well
 	short *depth = depthImage->GetData(MEMORYDEVICE_CPU);
-	unsigned char *tmp = frame->data[0];
-	frame->data[0] = (unsigned char*)depth;
+	for (int y = 0; y < frame->height; ++y) {
+		memcpy(frame->data[0] + y*frame->linesize[0], depth + y*depthImage->noDims.x, frame->width*sizeof(short));
+	}
 
 	frame->pts = counter++;
-	int ret = mData->filter_encode_write_frame(frame, /*stream_index*/0);
-	frame->data[0] = tmp;
-	return (ret>=0);
+	mData->endFrame();
+	return true;
 }
 
 bool FFMPEGWriter::close(void)
@@ -445,11 +562,21 @@ bool FFMPEGWriter::isOpen(void) const
 	return (counter>=0);
 }
 
+size_t FFMPEGWriter::getNoQueuedFrames(void) const
+{
+	return mData->getNoQueuedFrames();
+}
+
+size_t FFMPEGWriter::getNoDroppedFrames(void) const
+{
+	return mData->getNoDroppedFrames();
+}
+
 #else
 
 using namespace InputSource;
 
-FFMPEGWriter::FFMPEGWriter(void)
+FFMPEGWriter::FFMPEGWriter(size_t queueCapacity, FullQueuePolicy fullQueuePolicy)
 {}
 FFMPEGWriter::~FFMPEGWriter(void)
 {}
@@ -463,6 +590,10 @@ bool FFMPEGWriter::close(void)
 { return false; }
 bool FFMPEGWriter::isOpen(void) const
 { return false; }
+size_t FFMPEGWriter::getNoQueuedFrames(void) const
+{ return 0; }
+size_t FFMPEGWriter::getNoDroppedFrames(void) const
+{ return 0; }
 
 #endif
 
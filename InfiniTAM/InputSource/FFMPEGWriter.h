@@ -6,21 +6,42 @@
 
 namespace InputSource {
 
+/** \brief
+    Writes a colour or depth video. writeFrame() only copies the image
+    into a bounded queue, the colour conversion, encoding and muxing
+    happen in a background thread.
+*/
 class FFMPEGWriter
 {
 	public:
 	class PrivateData;
 
-	FFMPEGWriter(void);
+	/** What writeFrame() does if the queue is full because encoding is slower than recording. */
+	enum FullQueuePolicy
+	{
+		/** Wait for the background thread to encode a frame. */
+		BLOCK_WHEN_FULL,
+		/** Drop the new frame. */
+		DROP_WHEN_FULL
+	};
+
+	FFMPEGWriter(size_t queueCapacity = 8, FullQueuePolicy fullQueuePolicy = BLOCK_WHEN_FULL);
 	~FFMPEGWriter(void);
 
 	bool open(const char *filename, int size_x, int size_y, bool isDepth, int fps);
+	/** Returns false if the frame was dropped or an earlier frame could not be encoded. */
 	bool writeFrame(ITMUChar4Image *rgbImage);
 	bool writeFrame(ITMShortImage *depthImage);
+	/** Waits for all queued frames to be encoded before closing the file. */
 	bool close(void);
 
 	bool isOpen(void) const;
 
+	/** The number of frames that are waiting to be encoded. */
+	size_t getNoQueuedFrames(void) const;
+	/** The number of frames dropped since the file was opened. */
+	size_t getNoDroppedFrames(void) const;
+
 	private:
 	PrivateData *mData;
 	int counter;
@@ -0,0 +1,62 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <stdint.h>
+
+namespace InputSource {
+
+/*
+ * Layout of a packed RGB-D sequence file, all little endian:
+ *
+ *   PackedSequenceHeader
+ *   the payloads of all frames, each starting at a multiple of PACKED_SEQUENCE_ALIGNMENT
+ *   the calibration, in the text format of writeRGBDCalib()
+ *   one PackedSequenceFrame per frame
+ *
+ * The header is written last, so a file whose writer did not finish has no valid magic.
+ */
+
+static const char PACKED_SEQUENCE_MAGIC[8] = { 'I', 'T', 'M', 'S', 'E', 'Q', '\0', '\0' };
+static const uint32_t PACKED_SEQUENCE_VERSION = 1;
+static const uint64_t PACKED_SEQUENCE_ALIGNMENT = 64;
+
+enum PackedSequenceFlags
+{
+	PACKED_SEQUENCE_HAS_IMU = 1
+};
+
+enum PackedSequenceEncoding
+{
+	/** The pixels as they are stored in ITMUChar4Image / ITMShortImage. */
+	PACKED_SEQUENCE_ENCODING_RAW = 0,
+	/** Depth only: the lossless depth codec of RVLCodec.h. */
+	PACKED_SEQUENCE_ENCODING_RVL = 1
+};
+
+struct PackedSequenceHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t flags;
+
+	int32_t rgbWidth, rgbHeight;
+	int32_t depthWidth, depthHeight;
+	uint32_t rgbEncoding, depthEncoding;
+
+	uint64_t noFrames;
+	uint64_t frameTableOffset;
+	uint64_t calibOffset, calibSize;
+};
+
+struct PackedSequenceFrame
+{
+	uint64_t rgbOffset, rgbSize;
+	uint64_t depthOffset, depthSize;
+
+	/** ITMIMUMeasurement::R.m, if the sequence has PACKED_SEQUENCE_HAS_IMU. */
+	float imu[9];
+	uint32_t padding;
+};
+
+}
@@ -0,0 +1,259 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "PackedSequenceReader.h"
+#include "RVLCodec.h"
+
+#include "../ITMLib/Objects/Camera/ITMCalibIO.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace InputSource;
+using namespace ITMLib;
+
+class PackedSequenceReader::PrivateData
+{
+	public:
+	PrivateData(void)
+	{
+		data = NULL;
+		size = 0;
+#ifdef _WIN32
+		file = INVALID_HANDLE_VALUE;
+		mapping = NULL;
+#endif
+	}
+
+	~PrivateData(void)
+	{
+#ifdef _WIN32
+		if (data != NULL) UnmapViewOfFile(data);
+		if (mapping != NULL) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+		if (data != NULL) munmap((void*)data, size);
+#endif
+	}
+
+	bool map(const char *filename)
+	{
+#ifdef _WIN32
+		file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return false;
+		size = (size_t)fileSize.QuadPart;
+
+		mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL) return false;
+
+		data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		return data != NULL;
+#else
+		int fd = open(filename, O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+		size = (size_t)st.st_size;
+
+		void *mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (mapped == MAP_FAILED) return false;
+
+		data = (const unsigned char*)mapped;
+		return true;
+#endif
+	}
+
+	/** Tells the OS that a range of the file will be read soon. */
+	void willNeed(uint64_t offset, uint64_t length) const
+	{
+#ifndef _WIN32
+		static const uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+		uint64_t start = offset - offset % pageSize;
+		madvise((void*)(data + start), (size_t)(offset + length - start), MADV_WILLNEED);
+#endif
+	}
+
+	const unsigned char *data;
+	size_t size;
+
+	private:
+#ifdef _WIN32
+	HANDLE file, mapping;
+#endif
+};
+
+PackedSequenceReader::PackedSequenceReader(const char *calibFilename, const char *filename)
+	: BaseImageSourceEngine(calibFilename)
+{
+	mData = new PrivateData();
+	header = NULL;
+	frames = NULL;
+	currentFrameNo = 0;
+
+	isValid = mData->map(filename) && validate(filename);
+	if (!isValid) return;
+
+	if (!calibFilename || strlen(calibFilename) == 0)
+	{
+		std::istringstream calibText(std::string((const char*)mData->data + header->calibOffset, (size_t)header->calibSize));
+		if (readRGBDCalib(calibText, calib)) printf("using the calibration stored in '%s'\n", filename);
+		else printf("warning: could not read the calibration stored in '%s'\n", filename);
+	}
+
+	seekToFrame(0);
+}
+
+PackedSequenceReader::~PackedSequenceReader(void)
+{
+	delete mData;
+}
+
+bool PackedSequenceReader::validate(const char *filename)
+{
+	const uint64_t fileSize = mData->size;
+
+	// quietly, as the apps also try other readers on the same file
+	if (fileSize < sizeof(PackedSequenceHeader) || memcmp(mData->data, PACKED_SEQUENCE_MAGIC, sizeof(PACKED_SEQUENCE_MAGIC)) != 0) return false;
+
+	header = (const PackedSequenceHeader*)mData->data;
+	if (header->version != PACKED_SEQUENCE_VERSION)
+	{
+		printf("error: '%s' has version %u of the packed sequence format, expected %u\n", filename, header->version, PACKED_SEQUENCE_VERSION);
+		return false;
+	}
+
+	if (header->rgbEncoding != PACKED_SEQUENCE_ENCODING_RAW
+		|| (header->depthEncoding != PACKED_SEQUENCE_ENCODING_RAW && header->depthEncoding != PACKED_SEQUENCE_ENCODING_RVL))
+	{
+		printf("error: '%s' uses an unknown encoding\n", filename);
+		return false;
+	}
+
+	bool rangesValid = header->calibOffset <= fileSize && header->calibSize <= fileSize - header->calibOffset
+		&& header->frameTableOffset <= fileSize && header->noFrames <= (fileSize - header->frameTableOffset) / sizeof(PackedSequenceFrame)
+		&& header->frameTableOffset % sizeof(uint64_t) == 0;
+
+	const uint64_t rgbSize = (uint64_t)header->rgbWidth * header->rgbHeight * sizeof(Vector4u);
+	const uint64_t depthSize = (uint64_t)header->depthWidth * header->depthHeight * sizeof(short);
+	const bool depthIsRaw = header->depthEncoding == PACKED_SEQUENCE_ENCODING_RAW;
+
+	if (rangesValid) frames = (const PackedSequenceFrame*)(mData->data + header->frameTableOffset);
+
+	for (uint64_t i = 0; rangesValid && i < header->noFrames; i++)
+	{
+		const PackedSequenceFrame &frame = frames[i];
+		rangesValid = frame.rgbSize == rgbSize && frame.rgbOffset <= fileSize && rgbSize <= fileSize - frame.rgbOffset
+			&& (frame.depthSize == depthSize || !depthIsRaw) && frame.depthOffset <= fileSize && frame.depthSize <= fileSize - frame.depthOffset
+			&& frame.rgbOffset % PACKED_SEQUENCE_ALIGNMENT == 0 && frame.depthOffset % PACKED_SEQUENCE_ALIGNMENT == 0;
+	}
+
+	if (!rangesValid)
+	{
+		printf("error: '%s' is truncated or corrupt\n", filename);
+		return false;
+	}
+
+	return true;
+}
+
+bool PackedSequenceReader::hasMoreImages(void) const
+{
+	return isValid && currentFrameNo < header->noFrames;
+}
+
+void PackedSequenceReader::getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth)
+{
+	if (!hasMoreImages()) return;
+
+	const PackedSequenceFrame &frame = frames[currentFrameNo];
+
+	rgb->ChangeDims(getRGBImageSize());
+	memcpy(rgb->GetData(MEMORYDEVICE_CPU), mData->data + frame.rgbOffset, (size_t)frame.rgbSize);
+
+	rawDepth->ChangeDims(getDepthImageSize());
+	if (header->depthEncoding == PACKED_SEQUENCE_ENCODING_RVL)
+	{
+		if (!DecodeRVL(mData->data + frame.depthOffset, (size_t)frame.depthSize, rawDepth->GetData(MEMORYDEVICE_CPU), rawDepth->dataSize))
+			throw std::runtime_error("The depth image of a frame in a packed sequence is corrupt");
+	}
+	else memcpy(rawDepth->GetData(MEMORYDEVICE_CPU), mData->data + frame.depthOffset, (size_t)frame.depthSize);
+
+	++currentFrameNo;
+
+	// let the OS read the next frame while this one is processed
+	if (currentFrameNo < header->noFrames)
+	{
+		const PackedSequenceFrame &next = frames[currentFrameNo];
+		mData->willNeed(next.rgbOffset, next.rgbSize);
+		mData->willNeed(next.depthOffset, next.depthSize);
+	}
+}
+
+Vector2i PackedSequenceReader::getDepthImageSize(void) const
+{
+	return isValid ? Vector2i(header->depthWidth, header->depthHeight) : Vector2i(0, 0);
+}
+
+Vector2i PackedSequenceReader::getRGBImageSize(void) const
+{
+	return isValid ? Vector2i(header->rgbWidth, header->rgbHeight) : Vector2i(0, 0);
+}
+
+size_t PackedSequenceReader::getNoFrames(void) const
+{
+	return isValid ? (size_t)header->noFrames : 0;
+}
+
+size_t PackedSequenceReader::getCurrentFrameNo(void) const
+{
+	return currentFrameNo;
+}
+
+void PackedSequenceReader::seekToFrame(size_t frameNo)
+{
+	currentFrameNo = frameNo < getNoFrames() ? frameNo : getNoFrames();
+
+	if (currentFrameNo < getNoFrames())
+	{
+		const PackedSequenceFrame &frame = frames[currentFrameNo];
+		mData->willNeed(frame.rgbOffset, frame.rgbSize);
+		mData->willNeed(frame.depthOffset, frame.depthSize);
+	}
+}
+
+bool PackedSequenceReader::hasIMU(void) const
+{
+	return isValid && (header->flags & PACKED_SEQUENCE_HAS_IMU) != 0;
+}
+
+void PackedSequenceReader::getIMUMeasurement(size_t frameNo, ITMIMUMeasurement *imu) const
+{
+	if (!hasIMU() || frameNo >= getNoFrames()) return;
+	memcpy(imu->R.m, frames[frameNo].imu, sizeof(frames[frameNo].imu));
+}
+
+const Vector4u *PackedSequenceReader::getRGBData(size_t frameNo) const
+{
+	return frameNo < getNoFrames() ? (const Vector4u*)(mData->data + frames[frameNo].rgbOffset) : NULL;
+}
+
+const short *PackedSequenceReader::getDepthData(size_t frameNo) const
+{
+	if (frameNo >= getNoFrames() || header->depthEncoding != PACKED_SEQUENCE_ENCODING_RAW) return NULL;
+	return (const short*)(mData->data + frames[frameNo].depthOffset);
+}
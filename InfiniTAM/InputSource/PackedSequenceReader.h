@@ -0,0 +1,60 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include "ImageSourceEngine.h"
+#include "PackedSequenceFormat.h"
+#include "../ITMLib/Objects/Misc/ITMIMUMeasurement.h"
+
+namespace InputSource {
+
+/** \brief
+    Reads a sequence written by PackedSequenceWriter. The file is
+    mapped into memory, so the frames are copied straight from the
+    page cache into the images passed to getImages(), and any frame
+    can be reached without reading the ones before it.
+*/
+class PackedSequenceReader : public BaseImageSourceEngine
+{
+	public:
+	class PrivateData;
+
+	/** If @p calibFilename is empty, the calibration stored in the
+	    sequence is used. If the file cannot be read, the image sizes
+	    are (0,0) and there are no images.
+	*/
+	PackedSequenceReader(const char *calibFilename, const char *filename);
+	~PackedSequenceReader(void);
+
+	bool hasMoreImages(void) const;
+	void getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth);
+
+	Vector2i getDepthImageSize(void) const;
+	Vector2i getRGBImageSize(void) const;
+
+	size_t getNoFrames(void) const;
+	/** The frame that the next call to getImages() returns. */
+	size_t getCurrentFrameNo(void) const;
+	void seekToFrame(size_t frameNo);
+
+	bool hasIMU(void) const;
+	void getIMUMeasurement(size_t frameNo, ITMLib::ITMIMUMeasurement *imu) const;
+
+	/** The pixels of a frame inside the mapped file, valid as long
+	    as the reader exists. Compressed depth images cannot be
+	    accessed like this, getDepthData() returns NULL for them.
+	*/
+	const Vector4u *getRGBData(size_t frameNo) const;
+	const short *getDepthData(size_t frameNo) const;
+
+	private:
+	bool validate(const char *filename);
+
+	PrivateData *mData;
+	const PackedSequenceHeader *header;
+	const PackedSequenceFrame *frames;
+	size_t currentFrameNo;
+	bool isValid;
+};
+
+}
@@ -0,0 +1,138 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "PackedSequenceWriter.h"
+#include "RVLCodec.h"
+
+#include "../ITMLib/Objects/Camera/ITMCalibIO.h"
+
+#include <sstream>
+#include <string.h>
+
+using namespace InputSource;
+using namespace ITMLib;
+
+PackedSequenceWriter::PackedSequenceWriter(void)
+{
+	file = NULL;
+	fileSize = 0;
+}
+
+PackedSequenceWriter::~PackedSequenceWriter(void)
+{
+	close();
+}
+
+bool PackedSequenceWriter::open(const char *filename, const ITMRGBDCalib &calib, Vector2i rgbSize, Vector2i depthSize, bool withIMU,
+	PackedSequenceEncoding depthEncoding)
+{
+	if (isOpen()) return false;
+	if (depthEncoding != PACKED_SEQUENCE_ENCODING_RAW && depthEncoding != PACKED_SEQUENCE_ENCODING_RVL) return false;
+
+	file = fopen(filename, "wb");
+	if (file == NULL) return false;
+
+	memset(&header, 0, sizeof(header));
+	header.version = PACKED_SEQUENCE_VERSION;
+	header.flags = withIMU ? PACKED_SEQUENCE_HAS_IMU : 0;
+	header.rgbWidth = rgbSize.x; header.rgbHeight = rgbSize.y;
+	header.depthWidth = depthSize.x; header.depthHeight = depthSize.y;
+	header.rgbEncoding = PACKED_SEQUENCE_ENCODING_RAW;
+	header.depthEncoding = depthEncoding;
+
+	this->calib = calib;
+	frames.clear();
+
+	// the magic stays zero until close() has written everything else
+	fileSize = 0;
+	if (!writePayload(&header, sizeof(header), header.frameTableOffset))
+	{
+		fclose(file);
+		file = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+bool PackedSequenceWriter::writePayload(const void *data, size_t size, uint64_t &offset)
+{
+	static const char zeros[PACKED_SEQUENCE_ALIGNMENT] = { 0 };
+
+	size_t padding = (size_t)((PACKED_SEQUENCE_ALIGNMENT - fileSize % PACKED_SEQUENCE_ALIGNMENT) % PACKED_SEQUENCE_ALIGNMENT);
+	if (padding > 0 && fwrite(zeros, 1, padding, file) != padding) return false;
+	fileSize += padding;
+
+	offset = fileSize;
+	if (size > 0 && fwrite(data, 1, size, file) != size) return false;
+	fileSize += size;
+
+	return true;
+}
+
+bool PackedSequenceWriter::writeFrame(const ITMUChar4Image *rgbImage, const ITMShortImage *depthImage, const ITMIMUMeasurement *imu)
+{
+	if (!isOpen()) return false;
+
+	Vector2i rgbSize(header.rgbWidth, header.rgbHeight), depthSize(header.depthWidth, header.depthHeight);
+	if (rgbImage->noDims != rgbSize || depthImage->noDims != depthSize)
+	{
+		fprintf(stderr, "error: all frames of a packed sequence must have the same image sizes\n");
+		return false;
+	}
+
+	PackedSequenceFrame frame;
+	memset(&frame, 0, sizeof(frame));
+
+	frame.rgbSize = rgbImage->dataSize * sizeof(Vector4u);
+	if (!writePayload(rgbImage->GetData(MEMORYDEVICE_CPU), (size_t)frame.rgbSize, frame.rgbOffset)) return false;
+
+	if (header.depthEncoding == PACKED_SEQUENCE_ENCODING_RVL)
+	{
+		encodedDepth.resize(MaxRVLEncodedSize(depthImage->dataSize));
+		frame.depthSize = EncodeRVL(depthImage->GetData(MEMORYDEVICE_CPU), depthImage->dataSize, &encodedDepth[0]);
+		if (!writePayload(&encodedDepth[0], (size_t)frame.depthSize, frame.depthOffset)) return false;
+	}
+	else
+	{
+		frame.depthSize = depthImage->dataSize * sizeof(short);
+		if (!writePayload(depthImage->GetData(MEMORYDEVICE_CPU), (size_t)frame.depthSize, frame.depthOffset)) return false;
+	}
+
+	ITMIMUMeasurement noRotation;
+	memcpy(frame.imu, (imu != NULL ? imu : &noRotation)->R.m, sizeof(frame.imu));
+
+	frames.push_back(frame);
+	return true;
+}
+
+bool PackedSequenceWriter::close(void)
+{
+	if (!isOpen()) return false;
+
+	std::ostringstream calibText;
+	writeRGBDCalib(calibText, calib);
+	std::string calibString = calibText.str();
+
+	bool success = writePayload(calibString.c_str(), calibString.size(), header.calibOffset);
+	header.calibSize = calibString.size();
+
+	header.noFrames = frames.size();
+	if (success) success = writePayload(frames.empty() ? NULL : &frames[0], frames.size() * sizeof(PackedSequenceFrame), header.frameTableOffset);
+
+	if (success)
+	{
+		memcpy(header.magic, PACKED_SEQUENCE_MAGIC, sizeof(header.magic));
+		success = fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+	}
+
+	if (fclose(file) != 0) success = false;
+	file = NULL;
+	frames.clear();
+
+	return success;
+}
+
+bool PackedSequenceWriter::isOpen(void) const
+{
+	return file != NULL;
+}
@@ -0,0 +1,54 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+
+#include "PackedSequenceFormat.h"
+#include "../ITMLib/Objects/Camera/ITMRGBDCalib.h"
+#include "../ITMLib/Objects/Misc/ITMIMUMeasurement.h"
+#include "../ITMLib/Utils/ITMImageTypes.h"
+
+namespace InputSource {
+
+/** \brief
+    Writes RGB-D frames, and optionally IMU measurements, into a
+    single packed sequence file, see PackedSequenceFormat.h, that
+    PackedSequenceReader can map into memory.
+*/
+class PackedSequenceWriter
+{
+	public:
+	PackedSequenceWriter(void);
+	~PackedSequenceWriter(void);
+
+	/** All frames must have the given image sizes. An RGB size
+	    of (0,0) can be used for depth-only sequences. The depth
+	    images can be stored either raw or with the RVL codec, which
+	    is lossless and typically 3-5 times smaller, but prevents
+	    PackedSequenceReader::getDepthData() from accessing them.
+	*/
+	bool open(const char *filename, const ITMLib::ITMRGBDCalib &calib, Vector2i rgbSize, Vector2i depthSize, bool withIMU = false,
+		PackedSequenceEncoding depthEncoding = PACKED_SEQUENCE_ENCODING_RAW);
+	bool writeFrame(const ITMUChar4Image *rgbImage, const ITMShortImage *depthImage, const ITMLib::ITMIMUMeasurement *imu = NULL);
+	/** Writes the calibration, frame table and header, the file
+	    cannot be read before this.
+	*/
+	bool close(void);
+
+	bool isOpen(void) const;
+
+	private:
+	bool writePayload(const void *data, size_t size, uint64_t &offset);
+
+	FILE *file;
+	uint64_t fileSize;
+
+	PackedSequenceHeader header;
+	ITMLib::ITMRGBDCalib calib;
+	std::vector<PackedSequenceFrame> frames;
+	std::vector<unsigned char> encodedDepth;
+};
+
+}
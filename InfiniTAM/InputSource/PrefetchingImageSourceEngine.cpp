@@ -0,0 +1,161 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "PrefetchingImageSourceEngine.h"
+
+#include <chrono>
+#include <stdexcept>
+
+namespace InputSource {
+
+//#################### CONSTRUCTORS ####################
+
+PrefetchingImageSourceEngine::PrefetchingImageSourceEngine(ImageSourceEngine *source, size_t capacity)
+: m_count(0), m_finished(false), m_frames(capacity > 0 ? capacity : 1), m_head(0), m_source(source), m_stopRequested(false)
+{
+  for(size_t i = 0, size = m_frames.size(); i < size; ++i)
+  {
+    m_frames[i].rgb = new ITMUChar4Image(true, false);
+    m_frames[i].rawDepth = new ITMShortImage(true, false);
+  }
+
+  m_thread = std::thread(&PrefetchingImageSourceEngine::prefetch, this);
+}
+
+//#################### DESTRUCTOR ####################
+
+PrefetchingImageSourceEngine::~PrefetchingImageSourceEngine()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopRequested = true;
+  }
+  m_ringChanged.notify_all();
+  m_thread.join();
+
+  for(size_t i = 0, size = m_frames.size(); i < size; ++i)
+  {
+    delete m_frames[i].rgb;
+    delete m_frames[i].rawDepth;
+  }
+
+  delete m_source;
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+ITMLib::ITMRGBDCalib PrefetchingImageSourceEngine::getCalib(void) const
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  const Frame *frame = waitForNextFrame(lock);
+
+  // Once the wrapped engine has run out of images, the background thread no longer uses it.
+  return frame != NULL ? frame->calib : m_source->getCalib();
+}
+
+Vector2i PrefetchingImageSourceEngine::getDepthImageSize(void) const
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  const Frame *frame = waitForNextFrame(lock);
+  return frame != NULL ? frame->rawDepth->noDims : m_source->getDepthImageSize();
+}
+
+void PrefetchingImageSourceEngine::getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  const Frame *frame = waitForNextFrame(lock);
+  if(frame == NULL) return;
+
+  // The background thread does not touch the frames in the ring, so they can be copied without holding the lock.
+  lock.unlock();
+  rgb->SetFrom(frame->rgb, ORUtils::MemoryBlock<Vector4u>::CPU_TO_CPU);
+  rawDepth->SetFrom(frame->rawDepth, ORUtils::MemoryBlock<short>::CPU_TO_CPU);
+  lock.lock();
+
+  m_head = (m_head + 1) % m_frames.size();
+  --m_count;
+  m_ringChanged.notify_all();
+}
+
+Vector2i PrefetchingImageSourceEngine::getRGBImageSize(void) const
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  const Frame *frame = waitForNextFrame(lock);
+  return frame != NULL ? frame->rgb->noDims : m_source->getRGBImageSize();
+}
+
+bool PrefetchingImageSourceEngine::hasImagesNow(void) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if(m_count == 0 && !m_error.empty()) throw std::runtime_error(m_error);
+  return m_count > 0;
+}
+
+bool PrefetchingImageSourceEngine::hasMoreImages(void) const
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  return waitForNextFrame(lock) != NULL;
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void PrefetchingImageSourceEngine::prefetch(void)
+{
+  try
+  {
+    for(;;)
+    {
+      size_t tail;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while(!m_stopRequested && m_count == m_frames.size()) m_ringChanged.wait(lock);
+        if(m_stopRequested) return;
+        tail = (m_head + m_count) % m_frames.size();
+      }
+
+      if(!m_source->hasMoreImages()) break;
+
+      // Live sources can be temporarily unable to yield images.
+      if(!m_source->hasImagesNow())
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        continue;
+      }
+
+      // The frame at the tail of the ring is not visible to the consumer until m_count is increased.
+      Frame& frame = m_frames[tail];
+      frame.calib = m_source->getCalib();
+      frame.rgb->ChangeDims(m_source->getRGBImageSize(), false);
+      frame.rawDepth->ChangeDims(m_source->getDepthImageSize(), false);
+      m_source->getImages(frame.rgb, frame.rawDepth);
+
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_count;
+      }
+      m_ringChanged.notify_all();
+    }
+  }
+  catch(std::exception& e)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_error = e.what();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_finished = true;
+  }
+  m_ringChanged.notify_all();
+}
+
+const PrefetchingImageSourceEngine::Frame *PrefetchingImageSourceEngine::waitForNextFrame(std::unique_lock<std::mutex>& lock) const
+{
+  while(m_count == 0 && !m_finished) m_ringChanged.wait(lock);
+
+  // Any images that were read before the wrapped engine failed are still handed out.
+  if(m_count == 0 && !m_error.empty()) throw std::runtime_error(m_error);
+
+  return m_count > 0 ? &m_frames[m_head] : NULL;
+}
+
+}
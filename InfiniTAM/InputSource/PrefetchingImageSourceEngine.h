@@ -0,0 +1,125 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ImageSourceEngine.h"
+
+namespace InputSource {
+
+/**
+ * \brief An instance of this class can be used to read the images of another image source engine ahead of time,
+ *        so that loading and decoding them does not hold up the processing of the previous frames.
+ *
+ * The wrapped engine is only ever used from a single background thread, so that it yields its images in order and
+ * does not have to be thread-safe. That thread fills a bounded ring of RGB-D image pairs, which getImages() empties.
+ */
+class PrefetchingImageSourceEngine : public ImageSourceEngine
+{
+  //#################### NESTED TYPES ####################
+private:
+  /** A prefetched RGB-D image pair, together with what the wrapped engine reported for it. */
+  struct Frame
+  {
+    ITMLib::ITMRGBDCalib calib;
+    ITMUChar4Image *rgb;
+    ITMShortImage *rawDepth;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The number of prefetched frames in the ring. */
+  size_t m_count;
+
+  /** The error message of an exception thrown by the wrapped engine, if any. */
+  std::string m_error;
+
+  /** Whether or not the wrapped engine has run out of images (or failed). */
+  bool m_finished;
+
+  /** The ring of prefetched frames. */
+  std::vector<Frame> m_frames;
+
+  /** The index of the oldest prefetched frame in the ring. */
+  size_t m_head;
+
+  /** Signalled whenever a frame is added to or removed from the ring, or the background thread stops. */
+  mutable std::condition_variable m_ringChanged;
+
+  /** Guards everything above. */
+  mutable std::mutex m_mutex;
+
+  /** The image source engine being read ahead of time. */
+  ImageSourceEngine *m_source;
+
+  /** Tells the background thread to stop. */
+  bool m_stopRequested;
+
+  /** The background thread. */
+  std::thread m_thread;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a prefetching image source engine and starts reading from the wrapped engine.
+   *
+   * \param source    The image source engine to read ahead of time. The prefetching engine takes ownership of it.
+   * \param capacity  The maximum number of RGB-D image pairs to read ahead of time.
+   */
+  explicit PrefetchingImageSourceEngine(ImageSourceEngine *source, size_t capacity = 8);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Stops the background thread and destroys the prefetching engine, together with the wrapped engine.
+   */
+  ~PrefetchingImageSourceEngine();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  PrefetchingImageSourceEngine(const PrefetchingImageSourceEngine&);
+  PrefetchingImageSourceEngine& operator=(const PrefetchingImageSourceEngine&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /** Override */
+  virtual ITMLib::ITMRGBDCalib getCalib(void) const;
+
+  /** Override */
+  virtual Vector2i getDepthImageSize(void) const;
+
+  /** Override */
+  virtual void getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth);
+
+  /** Override */
+  virtual Vector2i getRGBImageSize(void) const;
+
+  /** Override */
+  virtual bool hasImagesNow(void) const;
+
+  /** Override */
+  virtual bool hasMoreImages(void) const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Reads images from the wrapped engine into the ring until it runs out of images or the thread is stopped.
+   */
+  void prefetch(void);
+
+  /**
+   * \brief Waits until there is a prefetched frame or the wrapped engine has run out of images.
+   *
+   * \param lock  A lock on m_mutex.
+   * \return      The oldest prefetched frame, or NULL if there are no more images.
+   */
+  const Frame *waitForNextFrame(std::unique_lock<std::mutex>& lock) const;
+};
+
+}
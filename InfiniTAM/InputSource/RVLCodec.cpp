@@ -0,0 +1,175 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "RVLCodec.h"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace {
+
+class NibbleWriter
+{
+	public:
+	NibbleWriter(unsigned char *output)
+	{
+		this->output = output;
+		word = 0;
+		noNibbles = 0;
+	}
+
+	void writeVLE(uint32_t value)
+	{
+		do
+		{
+			uint32_t nibble = value & 0x7;
+			value >>= 3;
+			if (value != 0) nibble |= 0x8;
+
+			word = (word << 4) | nibble;
+			if (++noNibbles == 8) flushWord();
+		} while (value != 0);
+	}
+
+	/** Writes the last partial word and returns the number of bytes written in total. */
+	size_t finish(unsigned char *start)
+	{
+		if (noNibbles > 0)
+		{
+			word <<= 4 * (8 - noNibbles);
+			flushWord();
+		}
+
+		return (size_t)(output - start);
+	}
+
+	private:
+	void flushWord(void)
+	{
+		memcpy(output, &word, sizeof(word));
+		output += sizeof(word);
+		word = 0;
+		noNibbles = 0;
+	}
+
+	unsigned char *output;
+	uint32_t word;
+	int noNibbles;
+};
+
+class NibbleReader
+{
+	public:
+	NibbleReader(const unsigned char *input, size_t inputSize)
+	{
+		this->input = input;
+		this->end = input + (inputSize - inputSize % sizeof(uint32_t));
+		word = 0;
+		noNibbles = 0;
+	}
+
+	bool readVLE(uint32_t &value)
+	{
+		value = 0;
+		for (int shift = 0; shift < 32; shift += 3)
+		{
+			if (noNibbles == 0)
+			{
+				if (input == end) return false;
+				memcpy(&word, input, sizeof(word));
+				input += sizeof(word);
+				noNibbles = 8;
+			}
+
+			uint32_t nibble = word >> 28;
+			word <<= 4;
+			--noNibbles;
+
+			value |= (nibble & 0x7) << shift;
+			if ((nibble & 0x8) == 0) return true;
+		}
+
+		// no value written by the encoder needs more than 11 nibbles
+		return false;
+	}
+
+	private:
+	const unsigned char *input, *end;
+	uint32_t word;
+	int noNibbles;
+};
+
+}
+
+namespace InputSource {
+
+size_t MaxRVLEncodedSize(size_t noPixels)
+{
+	// every non-zero pixel takes at most 6 nibbles for its value, and the run
+	// lengths take at most one more nibble per non-zero pixel plus one nibble
+	// per zero pixel, apart from the two runs that may be empty
+	size_t maxNibbles = 7 * noPixels + 2;
+	return (maxNibbles + 7) / 8 * sizeof(uint32_t);
+}
+
+size_t EncodeRVL(const short *depth, size_t noPixels, unsigned char *output)
+{
+	NibbleWriter writer(output);
+
+	const short *end = depth + noPixels;
+	int previous = 0;
+
+	while (depth != end)
+	{
+		const short *runStart = depth;
+		while (depth != end && *depth == 0) ++depth;
+		writer.writeVLE((uint32_t)(depth - runStart));
+
+		runStart = depth;
+		while (depth != end && *depth != 0) ++depth;
+		writer.writeVLE((uint32_t)(depth - runStart));
+
+		for (const short *pixel = runStart; pixel != depth; ++pixel)
+		{
+			int delta = *pixel - previous;
+			writer.writeVLE(((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+			previous = *pixel;
+		}
+	}
+
+	return writer.finish(output);
+}
+
+bool DecodeRVL(const unsigned char *input, size_t inputSize, short *depth, size_t noPixels)
+{
+	NibbleReader reader(input, inputSize);
+
+	short *end = depth + noPixels;
+	int previous = 0;
+
+	while (depth != end)
+	{
+		uint32_t noZeros, noNonZeros;
+
+		if (!reader.readVLE(noZeros) || noZeros > (size_t)(end - depth)) return false;
+		memset(depth, 0, noZeros * sizeof(short));
+		depth += noZeros;
+
+		if (!reader.readVLE(noNonZeros) || noNonZeros > (size_t)(end - depth)) return false;
+		if (noZeros == 0 && noNonZeros == 0) return false;
+
+		for (short *pixelEnd = depth + noNonZeros; depth != pixelEnd; ++depth)
+		{
+			// the difference of two 16 bit values needs at most 17 bits
+			uint32_t zigzag;
+			if (!reader.readVLE(zigzag) || zigzag > 0x1ffff) return false;
+
+			int delta = (int)(zigzag >> 1) ^ -(int)(zigzag & 1);
+			previous = (short)(previous + delta);
+			*depth = (short)previous;
+		}
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,37 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include <stddef.h>
+
+namespace InputSource {
+
+/*
+ * Lossless compression of 16 bit depth images with the run length and
+ * variable length scheme of RVL (A. D. Wilson, "Fast Lossless Depth Image
+ * Compression", ISS 2017).
+ *
+ * The pixels are split into alternating runs of zeros and non-zeros. The
+ * length of every run is stored, and each non-zero pixel is stored as the
+ * zigzag encoded difference to the previous non-zero pixel. All numbers are
+ * written as little-endian-first groups of 3 bits, with the fourth bit of
+ * each nibble telling whether another group follows, and the nibbles are
+ * packed into 32 bit words starting at the most significant one.
+ */
+
+/** The largest number of bytes that EncodeRVL() can write for an image with @p noPixels pixels. */
+size_t MaxRVLEncodedSize(size_t noPixels);
+
+/** Encodes @p noPixels depth values into @p output, which must hold at
+    least MaxRVLEncodedSize(noPixels) bytes, and returns the number of
+    bytes written, which is always a multiple of 4.
+*/
+size_t EncodeRVL(const short *depth, size_t noPixels, unsigned char *output);
+
+/** Decodes an image of @p noPixels depth values from the @p inputSize
+    bytes at @p input. Returns false if the input is corrupt or does not
+    describe exactly @p noPixels pixels.
+*/
+bool DecodeRVL(const unsigned char *input, size_t inputSize, short *depth, size_t noPixels);
+
+}
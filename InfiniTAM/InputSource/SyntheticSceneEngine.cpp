@@ -0,0 +1,393 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#include "SyntheticSceneEngine.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace InputSource;
+using namespace ITMLib;
+
+namespace
+{
+	// depth beyond this is not measured, as for most sensors
+	const float MAX_DEPTH = 8.0f;
+
+	enum PrimitiveType { PRIMITIVE_BOX, PRIMITIVE_SPHERE, PRIMITIVE_ROOM };
+
+	/// An axis aligned box, a sphere, or the inside of an axis aligned box
+	struct Primitive
+	{
+		PrimitiveType type;
+		Vector3f centre;
+		Vector3f halfSize; // the radius in x for spheres
+		Vector3f colour;
+	};
+
+	struct Hit
+	{
+		float t;
+		Vector3f normal;
+		const Primitive *primitive;
+	};
+
+	/// Integer hash, used for textures and noise that do not depend on the order the pixels are rendered in
+	inline unsigned int hash(unsigned int x)
+	{
+		x ^= x >> 16; x *= 0x7feb352dU;
+		x ^= x >> 15; x *= 0x846ca68bU;
+		x ^= x >> 16;
+		return x;
+	}
+
+	inline float uniform(unsigned int seed)
+	{
+		return ((hash(seed) >> 8) + 0.5f) / 16777216.0f;
+	}
+
+	inline float gaussian(unsigned int seed)
+	{
+		float u1 = uniform(seed * 2 + 0), u2 = uniform(seed * 2 + 1);
+		return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+	}
+
+	/** Intersects the ray with the slabs of a box, the direction need
+	    not be normalised. Returns the entry and exit distance and
+	    the axes they are on.
+	*/
+	inline bool intersectSlabs(const Vector3f &origin, const Vector3f &dir, const Vector3f &minCorner, const Vector3f &maxCorner,
+		float &tNear, int &axisNear, float &tFar, int &axisFar)
+	{
+		tNear = -1e30f; tFar = 1e30f; axisNear = axisFar = 0;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (fabsf(dir[axis]) < 1e-12f)
+			{
+				if (origin[axis] < minCorner[axis] || origin[axis] > maxCorner[axis]) return false;
+				continue;
+			}
+
+			float t0 = (minCorner[axis] - origin[axis]) / dir[axis];
+			float t1 = (maxCorner[axis] - origin[axis]) / dir[axis];
+			if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+
+			if (t0 > tNear) { tNear = t0; axisNear = axis; }
+			if (t1 < tFar) { tFar = t1; axisFar = axis; }
+			if (tNear > tFar) return false;
+		}
+		return true;
+	}
+
+	inline bool intersect(const Primitive &primitive, const Vector3f &origin, const Vector3f &dir, Hit &hit)
+	{
+		if (primitive.type == PRIMITIVE_SPHERE)
+		{
+			float radius = primitive.halfSize.x;
+			Vector3f offset = origin - primitive.centre;
+			float a = dot(dir, dir), b = dot(offset, dir), c = dot(offset, offset) - radius * radius;
+			float discriminant = b * b - a * c;
+			if (discriminant < 0.0f) return false;
+
+			float t = (-b - sqrtf(discriminant)) / a;
+			if (t <= 0.0f || t >= hit.t) return false;
+
+			hit.t = t;
+			hit.normal = (origin + dir * t - primitive.centre) / radius;
+			hit.primitive = &primitive;
+			return true;
+		}
+
+		float tNear, tFar; int axisNear, axisFar;
+		if (!intersectSlabs(origin, dir, primitive.centre - primitive.halfSize, primitive.centre + primitive.halfSize, tNear, axisNear, tFar, axisFar)) return false;
+
+		// the walls of a room are seen from the inside, i.e. where the ray leaves the box
+		float t = primitive.type == PRIMITIVE_ROOM ? tFar : tNear;
+		int axis = primitive.type == PRIMITIVE_ROOM ? axisFar : axisNear;
+		if (t <= 0.0f || t >= hit.t) return false;
+
+		hit.t = t;
+		hit.normal = Vector3f(0.0f);
+		hit.normal[axis] = (dir[axis] > 0.0f) ? -1.0f : 1.0f;
+		hit.primitive = &primitive;
+		return true;
+	}
+
+	/// Camera to world transformation of a camera at @p position looking at @p target, with y pointing down as in the images
+	Matrix4f lookAt(const Vector3f &position, const Vector3f &target)
+	{
+		Vector3f z = normalize(target - position);
+		Vector3f x = normalize(cross(Vector3f(0.0f, 1.0f, 0.0f), z));
+		Vector3f y = cross(z, x);
+
+		Matrix4f M; M.setIdentity();
+		for (int r = 0; r < 3; ++r)
+		{
+			M.m[0 + r] = x[r];
+			M.m[4 + r] = y[r];
+			M.m[8 + r] = z[r];
+			M.m[12 + r] = position[r];
+		}
+		return M;
+	}
+}
+
+class SyntheticSceneEngine::PrivateData
+{
+	public:
+	void addBox(const Vector3f &centre, const Vector3f &halfSize, const Vector3f &colour, PrimitiveType type = PRIMITIVE_BOX)
+	{
+		Primitive primitive = { type, centre, halfSize, colour };
+		primitives.push_back(primitive);
+	}
+
+	void addSphere(const Vector3f &centre, float radius, const Vector3f &colour)
+	{
+		Primitive primitive = { PRIMITIVE_SPHERE, centre, Vector3f(radius, radius, radius), colour };
+		primitives.push_back(primitive);
+	}
+
+	/// Checkerboard with some fine grained variation, which gives the colour trackers something to lock on to
+	Vector3f texture(const Primitive &primitive, const Vector3f &point) const
+	{
+		int cx = (int)floorf(point.x * 4.0f), cy = (int)floorf(point.y * 4.0f), cz = (int)floorf(point.z * 4.0f);
+		float checker = ((cx + cy + cz) & 1) ? 1.0f : 0.75f;
+
+		int fx = (int)floorf(point.x * 40.0f), fy = (int)floorf(point.y * 40.0f), fz = (int)floorf(point.z * 40.0f);
+		float grain = 0.85f + 0.3f * uniform((unsigned int)(fx * 73856093) ^ (unsigned int)(fy * 19349663) ^ (unsigned int)(fz * 83492791));
+
+		return primitive.colour * (checker * grain);
+	}
+
+	std::vector<Primitive> primitives;
+	Vector4f projParams;
+};
+
+SyntheticSceneEngine::SyntheticSceneEngine(const char *calibFilename, SceneType sceneType, Vector2i imageSize, size_t noFrames, float noiseLevel)
+	: BaseImageSourceEngine(calibFilename)
+{
+	this->sceneType = sceneType;
+	this->imgSize = imageSize;
+	this->noFrames = noFrames;
+	this->noiseLevel = noiseLevel;
+	currentFrameNo = 0;
+
+	mData = new PrivateData();
+
+	if (calibFilename == NULL || strlen(calibFilename) == 0)
+	{
+		// the defaults are for 640x480
+		float ratio = imageSize.x / 640.0f;
+		calib.intrinsics_d.SetFrom(580.0f * ratio, 580.0f * ratio, imageSize.x * 0.5f, imageSize.y * 0.5f);
+		calib.intrinsics_rgb = calib.intrinsics_d;
+	}
+	else calib.intrinsics_rgb = calib.intrinsics_d;
+
+	calib.trafo_rgb_to_depth = ITMExtrinsics();
+	calib.disparityCalib.SetStandard();
+
+	const ITMIntrinsics::ProjectionParamsSimple &params = calib.intrinsics_d.projectionParamsSimple;
+	mData->projParams = Vector4f(params.fx, params.fy, params.px, params.py);
+
+	// the world has y pointing down, as the cameras, with the floor at y = 1.5
+	switch (sceneType)
+	{
+	case SCENE_ROOM:
+		mData->addBox(Vector3f(0.0f, 0.1f, 0.0f), Vector3f(3.0f, 1.4f, 3.0f), Vector3f(0.85f, 0.8f, 0.7f), PRIMITIVE_ROOM);
+		mData->addBox(Vector3f(0.0f, 1.12f, 0.0f), Vector3f(0.6f, 0.03f, 0.4f), Vector3f(0.6f, 0.35f, 0.2f));
+		mData->addBox(Vector3f(0.0f, 1.32f, 0.0f), Vector3f(0.05f, 0.18f, 0.05f), Vector3f(0.3f, 0.3f, 0.3f));
+		mData->addBox(Vector3f(-2.4f, 1.1f, 0.5f), Vector3f(0.45f, 0.4f, 1.1f), Vector3f(0.2f, 0.3f, 0.7f));
+		mData->addBox(Vector3f(2.6f, 0.4f, -1.5f), Vector3f(0.35f, 1.1f, 0.4f), Vector3f(0.7f, 0.5f, 0.3f));
+		mData->addSphere(Vector3f(0.2f, 0.92f, 0.1f), 0.17f, Vector3f(0.9f, 0.2f, 0.2f));
+		mData->addSphere(Vector3f(-0.3f, 1.0f, -0.15f), 0.09f, Vector3f(0.2f, 0.8f, 0.3f));
+		mData->addSphere(Vector3f(1.8f, 1.2f, 2.0f), 0.3f, Vector3f(0.9f, 0.8f, 0.2f));
+		break;
+	case SCENE_CORRIDOR:
+	{
+		// long enough for the whole trajectory, which moves 1.5cm per frame
+		float length = 0.015f * noFrames + 10.0f;
+		mData->addBox(Vector3f(0.0f, 0.4f, length * 0.5f - 3.0f), Vector3f(0.9f, 1.1f, length * 0.5f), Vector3f(0.8f, 0.8f, 0.75f), PRIMITIVE_ROOM);
+
+		// irregularly spaced, as the trackers and the relocaliser cannot tell repeating structures apart
+		unsigned int i = 0;
+		for (float z = -2.0f; z < length - 3.0f; z += 0.8f + 1.2f * uniform(i * 8 + 0), ++i)
+		{
+			Vector3f colour(0.3f + 0.6f * uniform(i * 8 + 1), 0.3f + 0.6f * uniform(i * 8 + 2), 0.3f + 0.6f * uniform(i * 8 + 3));
+			float side = (i % 2 == 0) ? -1.0f : 1.0f;
+			float width = 0.06f + 0.1f * uniform(i * 8 + 4);
+
+			mData->addBox(Vector3f(side * 0.85f, 0.4f, z), Vector3f(width, 1.1f, width), colour);
+
+			// rails at different heights, without which the walls and pillars leave the height of the camera open
+			mData->addBox(Vector3f(-side * 0.87f, 1.3f - 1.8f * uniform(i * 8 + 5), z + 0.4f), Vector3f(0.05f, 0.04f, 0.5f), colour);
+			if (i % 3 == 1) mData->addBox(Vector3f(0.0f, -0.62f, z), Vector3f(0.9f, 0.08f, 0.15f), colour);
+			if (i % 4 == 2) mData->addBox(Vector3f(-side * 0.6f, 1.4f - 0.2f * uniform(i * 8 + 6), z + 0.4f), Vector3f(0.2f, 0.2f, 0.25f), colour);
+			if (i % 5 == 3) mData->addSphere(Vector3f(side * 0.55f, 1.3f, z - 0.3f), 0.1f + 0.1f * uniform(i * 8 + 7), colour);
+		}
+		break;
+	}
+	case SCENE_CLUTTER:
+		mData->addBox(Vector3f(0.0f, 0.0f, 0.0f), Vector3f(5.0f, 1.5f, 5.0f), Vector3f(0.8f, 0.8f, 0.8f), PRIMITIVE_ROOM);
+		for (unsigned int i = 0; i < 100; ++i)
+		{
+			float angle = 6.2831853f * uniform(i * 8 + 0);
+			float radius = 1.8f * sqrtf(uniform(i * 8 + 1));
+			float size = 0.05f + 0.2f * uniform(i * 8 + 2);
+			Vector3f colour(0.2f + 0.8f * uniform(i * 8 + 3), 0.2f + 0.8f * uniform(i * 8 + 4), 0.2f + 0.8f * uniform(i * 8 + 5));
+
+			// some of the objects are stacked on top of others
+			float height = 1.5f - size - (uniform(i * 8 + 6) < 0.3f ? 0.4f * uniform(i * 8 + 7) : 0.0f);
+			Vector3f centre(radius * cosf(angle), height, radius * sinf(angle));
+
+			if (i % 2 == 0) mData->addSphere(centre, size, colour);
+			else mData->addBox(centre, Vector3f(size, size, size * (0.5f + uniform(i * 8 + 7))), colour);
+		}
+		break;
+	}
+
+	invFirstPose.setIdentity();
+	Matrix4f firstPose = getPose(0);
+	firstPose.inv(invFirstPose);
+}
+
+SyntheticSceneEngine::~SyntheticSceneEngine(void)
+{
+	delete mData;
+}
+
+bool SyntheticSceneEngine::getSceneType(const char *name, SceneType &sceneType)
+{
+	if (strcmp(name, "room") == 0) sceneType = SCENE_ROOM;
+	else if (strcmp(name, "corridor") == 0) sceneType = SCENE_CORRIDOR;
+	else if (strcmp(name, "clutter") == 0) sceneType = SCENE_CLUTTER;
+	else return false;
+	return true;
+}
+
+Matrix4f SyntheticSceneEngine::getPose(size_t frameNo) const
+{
+	float t = (float)frameNo;
+	Matrix4f pose;
+
+	// all trajectories move by about 1.5cm and 1 degree per frame, which the trackers can follow
+	switch (sceneType)
+	{
+	case SCENE_ROOM:
+	{
+		float angle = t * 0.01f;
+		Vector3f position(1.5f * cosf(angle), 0.1f * sinf(t * 0.03f), 1.5f * sinf(angle));
+		pose = lookAt(position, Vector3f(0.3f * sinf(t * 0.007f), 0.6f, 0.0f));
+		break;
+	}
+	case SCENE_CORRIDOR:
+	{
+		// looking down at the floor, without which little within the depth range of the scene pins down the height of the camera
+		Vector3f position(0.2f * sinf(t * 0.02f), 0.05f * sinf(t * 0.05f), t * 0.015f);
+		pose = lookAt(position, position + Vector3f(0.25f * sinf(t * 0.013f), 0.4f, 1.0f));
+		break;
+	}
+	case SCENE_CLUTTER:
+	default:
+	{
+		float angle = t * 0.006f;
+		Vector3f position(2.5f * cosf(angle), 0.2f * sinf(t * 0.02f), 2.5f * sinf(angle));
+		pose = lookAt(position, Vector3f(0.0f, 1.2f, 0.0f));
+		break;
+	}
+	}
+
+	return invFirstPose * pose;
+}
+
+bool SyntheticSceneEngine::writePoses(const char *poseMask) const
+{
+	for (size_t frameNo = 0; frameNo < noFrames; ++frameNo)
+	{
+		char fileName[2048];
+		sprintf(fileName, poseMask, frameNo);
+
+		FILE *f = fopen(fileName, "w");
+		if (f == NULL) return false;
+
+		// in the order ITMFileBasedTracker reads them
+		Matrix4f M = getPose(frameNo);
+		fprintf(f, "%f %f %f %f\n%f %f %f %f\n%f %f %f %f\n%f %f %f %f\n",
+			M.m00, M.m10, M.m20, M.m30, M.m01, M.m11, M.m21, M.m31,
+			M.m02, M.m12, M.m22, M.m32, M.m03, M.m13, M.m23, M.m33);
+
+		if (fclose(f) != 0) return false;
+	}
+	return true;
+}
+
+bool SyntheticSceneEngine::hasMoreImages(void) const
+{
+	return currentFrameNo < noFrames;
+}
+
+void SyntheticSceneEngine::getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth)
+{
+	// the primitives are placed relative to the world, not to the first frame
+	Matrix4f firstPose, pose;
+	invFirstPose.inv(firstPose);
+	pose = firstPose * getPose(currentFrameNo);
+
+	Vector3f origin(pose.m[12], pose.m[13], pose.m[14]);
+	Vector4f projParams = mData->projParams;
+	const std::vector<Primitive> &primitives = mData->primitives;
+	const Vector3f lightDir = normalize(Vector3f(0.3f, 1.0f, 0.2f));
+
+	Vector4u *rgbData = rgb->GetData(MEMORYDEVICE_CPU);
+	short *depthData = rawDepth->GetData(MEMORYDEVICE_CPU);
+	int width = imgSize.x, height = imgSize.y;
+	unsigned int frameSeed = hash((unsigned int)currentFrameNo + 1);
+
+#ifdef WITH_OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y = 0; y < height; ++y) for (int x = 0; x < width; ++x)
+	{
+		int locId = x + y * width;
+
+		// a ray with a z of 1 in camera coordinates, so that its parameter is the depth
+		Vector3f rayCamera((x - projParams.z) / projParams.x, (y - projParams.w) / projParams.y, 1.0f);
+		Vector3f dir(pose.m[0] * rayCamera.x + pose.m[4] * rayCamera.y + pose.m[8] * rayCamera.z,
+			pose.m[1] * rayCamera.x + pose.m[5] * rayCamera.y + pose.m[9] * rayCamera.z,
+			pose.m[2] * rayCamera.x + pose.m[6] * rayCamera.y + pose.m[10] * rayCamera.z);
+
+		Hit hit; hit.t = MAX_DEPTH; hit.primitive = NULL;
+		for (size_t i = 0; i < primitives.size(); ++i) intersect(primitives[i], origin, dir, hit);
+
+		if (hit.primitive == NULL)
+		{
+			rgbData[locId] = Vector4u((uchar)0, (uchar)0, (uchar)0, (uchar)255);
+			depthData[locId] = 0;
+			continue;
+		}
+
+		Vector3f point = origin + dir * hit.t;
+		float shading = 0.35f + 0.65f * fabsf(dot(hit.normal, lightDir));
+		Vector3f colour = mData->texture(*hit.primitive, point) * (255.0f * shading);
+
+		float depth = hit.t;
+		if (noiseLevel > 0.0f)
+		{
+			unsigned int pixelSeed = hash(frameSeed ^ (unsigned int)locId);
+			float cosAngle = fabsf(dot(hit.normal, dir)) / length(dir);
+
+			// axial noise of a structured light sensor, see Nguyen et al., 3DIMPVT 2012
+			float sigma = 0.0012f + 0.0019f * (depth - 0.4f) * (depth - 0.4f);
+			depth += noiseLevel * sigma * gaussian(pixelSeed);
+			if (cosAngle < 0.1f * noiseLevel) depth = 0.0f;
+
+			for (int c = 0; c < 3; ++c) colour[c] += noiseLevel * 3.0f * gaussian(pixelSeed + 1 + c);
+		}
+
+		for (int c = 0; c < 3; ++c) colour[c] = colour[c] < 0.0f ? 0.0f : (colour[c] > 255.0f ? 255.0f : colour[c]);
+		rgbData[locId] = Vector4u((uchar)colour.x, (uchar)colour.y, (uchar)colour.z, (uchar)255);
+		depthData[locId] = depth > 0.0f ? (short)(depth * 1000.0f + 0.5f) : 0;
+	}
+
+	++currentFrameNo;
+}
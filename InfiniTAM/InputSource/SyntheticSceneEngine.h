@@ -0,0 +1,88 @@
+// Copyright 2014-2017 Oxford University Innovation Limited and the authors of InfiniTAM
+
+#pragma once
+
+#include "ImageSourceEngine.h"
+
+namespace InputSource {
+
+	/** \brief
+	    Renders depth and colour images of an analytic scene along a
+	    scripted camera trajectory, so that tracking, allocation and
+	    swapping can be tested at any scale without recorded data.
+
+	    The scenes consist of boxes and spheres, which are ray cast
+	    exactly, with a colour texture that is fixed in world space.
+	    Depth and colour come from the same camera, i.e. the images
+	    are registered, and the depth is in mm as for the default
+	    ITMDisparityCalib. With a noise level above zero, the depth
+	    gets the axial noise of a structured light sensor, growing
+	    quadratically with the distance, scaled by the noise level,
+	    and pixels seen at grazing angles are dropped.
+
+	    The poses of the camera are relative to the first frame, as
+	    they are estimated by the trackers, and can be written out for
+	    ITMFileBasedTracker with writePoses().
+	*/
+	class SyntheticSceneEngine : public BaseImageSourceEngine
+	{
+	public:
+		enum SceneType
+		{
+			//! A furnished room, with the camera circling around its centre
+			SCENE_ROOM,
+			//! A long corridor with pillars, which the camera walks along, so that the scene keeps growing
+			SCENE_CORRIDOR,
+			//! Many small objects on the floor of a large room, with the camera circling around them
+			SCENE_CLUTTER
+		};
+
+		class PrivateData;
+
+		/** If @p calibFilename is empty, the default intrinsics are
+		    scaled to @p imageSize. Otherwise the intrinsics of the
+		    file are used for both images.
+		*/
+		SyntheticSceneEngine(const char *calibFilename, SceneType sceneType, Vector2i imageSize, size_t noFrames, float noiseLevel = 0.0f);
+		~SyntheticSceneEngine(void);
+
+		/// Looks up a scene by the name used on command lines, i.e. "room", "corridor" or "clutter"
+		static bool getSceneType(const char *name, SceneType &sceneType);
+
+		bool hasMoreImages(void) const;
+		void getImages(ITMUChar4Image *rgb, ITMShortImage *rawDepth);
+
+		Vector2i getDepthImageSize(void) const { return imgSize; }
+		Vector2i getRGBImageSize(void) const { return imgSize; }
+
+		size_t getNoFrames(void) const { return noFrames; }
+		/** The frame that the next call to getImages() returns. */
+		size_t getCurrentFrameNo(void) const { return currentFrameNo; }
+
+		/** The ground truth pose of the camera, as camera to world
+		    transformation relative to the first frame, i.e. as in
+		    ITMTrackingState::pose_d->GetInvM().
+		*/
+		Matrix4f getPose(size_t frameNo) const;
+
+		/** Writes the pose of every frame to a text file called
+		    @p poseMask with the frame number filled in, as read by
+		    ITMFileBasedTracker.
+		*/
+		bool writePoses(const char *poseMask) const;
+
+	private:
+		// Suppress the default copy constructor and assignment operator
+		SyntheticSceneEngine(const SyntheticSceneEngine&);
+		SyntheticSceneEngine& operator=(const SyntheticSceneEngine&);
+
+		PrivateData *mData;
+		SceneType sceneType;
+		Vector2i imgSize;
+		size_t noFrames;
+		size_t currentFrameNo;
+		float noiseLevel;
+		Matrix4f invFirstPose;
+	};
+
+}
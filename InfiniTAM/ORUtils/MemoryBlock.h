@@ -144,6 +144,23 @@ namespace ORUtils
 			this->dataSize = newDataSize;
 		}
 
+		/** Grow a memory block, keeping all old data.
+		The newly added elements are set to zero.
+		*/
+		void Grow(size_t newDataSize)
+		{
+			if (newDataSize <= dataSize) return;
+
+			MemoryBlock<T> grown(newDataSize, isAllocated_CPU, isAllocated_CUDA, isMetalCompatible);
+
+			if (isAllocated_CPU) memcpy(grown.data_cpu, data_cpu, dataSize * sizeof(T));
+#ifndef COMPILE_WITHOUT_CUDA
+			if (isAllocated_CUDA) ORcudaSafeCall(cudaMemcpy(grown.data_cuda, data_cuda, dataSize * sizeof(T), cudaMemcpyDeviceToDevice));
+#endif
+
+			this->Swap(grown);
+		}
+
 		/** Transfer data from CPU to GPU, if possible. */
 		void UpdateDeviceFromHost() const {
 #ifndef COMPILE_WITHOUT_CUDA
@@ -214,6 +231,8 @@ namespace ORUtils
 			Free();
 
 			this->dataSize = dataSize;
+			this->data_cpu = NULL;
+			this->data_cuda = NULL;
 
 			if (allocate_CPU)
 			{
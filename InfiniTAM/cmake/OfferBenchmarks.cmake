@@ -0,0 +1,5 @@
+#########################
+# OfferBenchmarks.cmake #
+#########################
+
+OPTION(WITH_BENCHMARKS "Build the benchmarks and stress tests in Apps/InfiniTAM_bench?" ON)
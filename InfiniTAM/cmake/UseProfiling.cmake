@@ -0,0 +1,11 @@
+######################
+# UseProfiling.cmake #
+######################
+
+# on by default, so that the benchmark reports of InfiniTAM_cli include the stages and counters;
+# while no profile is being recorded, each timer and counter costs a single check
+OPTION(WITH_PROFILING "Build the per-stage timers and counters of ITMLib (see ITMProfiler.h)?" ON)
+
+IF(WITH_PROFILING)
+  ADD_DEFINITIONS(-DWITH_PROFILING)
+ENDIF()
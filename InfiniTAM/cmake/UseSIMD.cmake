@@ -0,0 +1,23 @@
+#################
+# UseSIMD.cmake #
+#################
+
+OPTION(WITH_SIMD "Build vectorised CPU kernels (SSE4, AVX2, AVX-512), chosen at runtime?" ON)
+
+IF(WITH_SIMD AND NOT CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|amd64|i[3-6]86|x86)$")
+  MESSAGE(STATUS "WITH_SIMD is only supported on x86 processors and has been disabled")
+  SET(WITH_SIMD OFF)
+ENDIF()
+
+IF(WITH_SIMD)
+  IF(MSVC)
+    SET(SIMD_SSE4_FLAGS "")
+    SET(SIMD_AVX2_FLAGS "/arch:AVX2")
+    SET(SIMD_AVX512_FLAGS "/arch:AVX512")
+  ELSE()
+    SET(SIMD_SSE4_FLAGS "-msse4.1")
+    SET(SIMD_AVX2_FLAGS "-mavx2")
+    SET(SIMD_AVX512_FLAGS "-mavx512f")
+  ENDIF()
+  ADD_DEFINITIONS(-DWITH_SIMD)
+ENDIF()